@@ -35,6 +35,7 @@ const char* Services_Common::CONFIG_FILE = "config.conf";
 const char* Services_Common::SYSTEM_DIR = "/etc";
 const char* Services_Common::LOG_DIR = NULL;
 bool Services_Common::APPEND_PID = false;
+bool Services_Common::APPEND_RANK = false;
 
 Services_Common::Services_Common()
 {
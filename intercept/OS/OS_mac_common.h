@@ -37,6 +37,8 @@
 #include <sstream>
 #include <string>
 
+#include "OS_mpi.h"
+
 /*****************************************************************************\
 
 MACRO:
@@ -64,6 +66,7 @@ public:
     static const char* SYSTEM_DIR;
     static const char* LOG_DIR;
     static bool        APPEND_PID;
+    static bool        APPEND_RANK;
 
     Services_Common();
     ~Services_Common();
@@ -74,6 +77,13 @@ public:
     uint64_t    GetThreadID() const;
 
     std::string GetProcessName() const;
+    std::string GetHostName() const;
+
+    bool    GetMPIRank(
+                std::string& rank ) const;
+    bool    GetMPILocalRank(
+                int& localRank,
+                int& localSize ) const;
 
     bool    GetControl(
                 const std::string& name,
@@ -185,6 +195,24 @@ inline void* Services_Common::GetFunctionPointer(
     }
 }
 
+inline std::string Services_Common::GetHostName() const
+{
+    return GetHostNameString();
+}
+
+inline bool Services_Common::GetMPIRank(
+    std::string& rank ) const
+{
+    return GetMPIRankString( rank );
+}
+
+inline bool Services_Common::GetMPILocalRank(
+    int& localRank,
+    int& localSize ) const
+{
+    return GetMPILocalRankAndSize( localRank, localSize );
+}
+
 inline void Services_Common::GetDumpDirectoryNameWithoutPid(
     const std::string& subDir,
     std::string& directoryName ) const
@@ -227,6 +255,17 @@ inline void Services_Common::GetDumpDirectoryName(
        directoryName += ".";
        directoryName += std::to_string(GetProcessID());
     }
+    if( APPEND_RANK )
+    {
+        std::string rank;
+        if( GetMPIRank( rank ) )
+        {
+            directoryName += ".";
+            directoryName += GetHostName();
+            directoryName += ".rank";
+            directoryName += rank;
+        }
+    }
 }
 
 inline void Services_Common::GetDumpDirectoryNameWithoutProcessName(
@@ -0,0 +1,142 @@
+/*
+// Copyright (c) 2018-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+// These helpers query the host name and the MPI rank of the process.  They
+// are shared by the Services_Common implementations for each OS.
+
+namespace OS
+{
+
+inline bool GetEnvString(
+    const char* name,
+    std::string& value )
+{
+#if defined(_WIN32)
+    char*   envVal = NULL;
+    size_t  length = 0;
+
+    _dupenv_s( &envVal, &length, name );
+    if( envVal == NULL )
+    {
+        return false;
+    }
+
+    value = envVal;
+    free( envVal );
+    return true;
+#else
+    const char* envVal = getenv( name );
+    if( envVal == NULL )
+    {
+        return false;
+    }
+
+    value = envVal;
+    return true;
+#endif
+}
+
+inline std::string GetHostNameString()
+{
+#if defined(_WIN32)
+    char    hostName[ MAX_COMPUTERNAME_LENGTH + 1 ] = "";
+    DWORD   size = sizeof( hostName );
+
+    if( GetComputerNameA( hostName, &size ) == FALSE )
+    {
+        return std::string("localhost");
+    }
+
+    return std::string(hostName);
+#else
+    char    hostName[ 256 ] = "";
+
+    if( gethostname( hostName, sizeof( hostName ) - 1 ) != 0 )
+    {
+        return std::string("localhost");
+    }
+    hostName[ sizeof( hostName ) - 1 ] = 0;
+
+    // Only use the first component of a fully-qualified host name.
+    char*   dot = strchr( hostName, '.' );
+    if( dot )
+    {
+        *dot = 0;
+    }
+
+    return std::string(hostName);
+#endif
+}
+
+inline bool GetMPIRankString(
+    std::string& rank )
+{
+    // These are set by MPICH and Intel MPI, Open MPI, and Slurm.
+    return GetEnvString( "PMI_RANK", rank ) ||
+           GetEnvString( "OMPI_COMM_WORLD_RANK", rank ) ||
+           GetEnvString( "SLURM_PROCID", rank );
+}
+
+inline bool GetMPILocalRankAndSize(
+    int& localRank,
+    int& localSize )
+{
+    std::string rank;
+    std::string size;
+
+    if( GetEnvString( "MPI_LOCALRANKID", rank ) )
+    {
+        GetEnvString( "MPI_LOCALNRANKS", size );
+    }
+    else if( GetEnvString( "OMPI_COMM_WORLD_LOCAL_RANK", rank ) )
+    {
+        GetEnvString( "OMPI_COMM_WORLD_LOCAL_SIZE", size );
+    }
+    else if( GetEnvString( "SLURM_LOCALID", rank ) )
+    {
+        // SLURM_TASKS_PER_NODE may not be a simple number, so the local
+        // size is unknown for Slurm.
+    }
+    else
+    {
+        return false;
+    }
+
+    localRank = atoi( rank.c_str() );
+    localSize = size.empty() ? 0 : atoi( size.c_str() );
+    return true;
+}
+
+}
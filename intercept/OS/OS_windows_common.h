@@ -25,6 +25,8 @@
 #include <Windows.h>
 #include <string>
 
+#include "OS_mpi.h"
+
 /*****************************************************************************\
 
 MACRO:
@@ -57,6 +59,7 @@ public:
     static const char* REGISTRY_KEY;
     static const char* LOG_DIR;
     static bool        APPEND_PID;
+    static bool        APPEND_RANK;
 
     Services_Common();
     ~Services_Common();
@@ -67,6 +70,13 @@ public:
     uint64_t    GetThreadID() const;
 
     std::string GetProcessName() const;
+    std::string GetHostName() const;
+
+    bool    GetMPIRank(
+                std::string& rank ) const;
+    bool    GetMPILocalRank(
+                int& localRank,
+                int& localSize ) const;
 
     bool    GetControl(
                 const std::string& name,
@@ -262,6 +272,24 @@ inline void* Services_Common::GetFunctionPointer(
     }
 }
 
+inline std::string Services_Common::GetHostName() const
+{
+    return GetHostNameString();
+}
+
+inline bool Services_Common::GetMPIRank(
+    std::string& rank ) const
+{
+    return GetMPIRankString( rank );
+}
+
+inline bool Services_Common::GetMPILocalRank(
+    int& localRank,
+    int& localSize ) const
+{
+    return GetMPILocalRankAndSize( localRank, localSize );
+}
+
 inline void Services_Common::GetDumpDirectoryNameWithoutPid(
     const std::string& subDir,
     std::string& directoryName ) const
@@ -302,6 +330,17 @@ inline void Services_Common::GetDumpDirectoryName(
         directoryName += ".";
         directoryName += std::to_string(GetProcessID());
     }
+    if( APPEND_RANK )
+    {
+        std::string rank;
+        if( GetMPIRank( rank ) )
+        {
+            directoryName += ".";
+            directoryName += GetHostName();
+            directoryName += ".rank";
+            directoryName += rank;
+        }
+    }
 }
 
 inline void Services_Common::GetDumpDirectoryNameWithoutProcessName(
@@ -160,7 +160,7 @@ cl_command_queue CLIntercept::createMDAPICommandQueue(
             "clCreatePerfCountersCommandQueueINTEL" );
     }
 
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     auto dispatchX = this->dispatchX(platform);
     if( dispatchX.clCreatePerfCountersCommandQueueINTEL == NULL )
@@ -32,6 +32,7 @@ CLI_CONTROL_SEPARATOR( Logging Controls: )
 CLI_CONTROL( bool,          SuppressLogging,                        false, "If set to a nonzero value, suppresses all logging output from the Intercept Layer for OpenCL Applications.  This is particularly useful for tools that only want report data." )
 CLI_CONTROL( bool,          AppendFiles,                            false, "By default, the Intercept Layer for OpenCL Applications log files will be created from scratch when the intercept DLL is loaded, and any Intercept Layer for OpenCL Applications report files will be created from scratch when the intercept DLL is unloaded. If AppendFiles is set to a nonzero value, the Intercept Layer for OpenCL Applications will append to an existing file instead of recreating it. This can be useful if an application loads and unloads the intercept DLL multiple times, or to simply preserve log or report data from run-to-run." )
 CLI_CONTROL( bool,          LogToFile,                              false, "If set to a nonzero value, sends log information to the file \"clintercept_log.txt\" instead of to stderr." )
+CLI_CONTROL( bool,          LogToFileCompress,                      false, "If set to a nonzero value and LogToFile is also set, the Intercept Layer for OpenCL Applications will compress the log file using gzip compression, and the log file will be named \"clintercept_log.txt.gz\".  Note that compressed log data is written in blocks, so the most recent log data may be lost if the application terminates abnormally." )
 CLI_CONTROL( bool,          LogToDebugger,                          false, "If set to a nonzero value, sends log information to the debugger instead of to stderr.  If both LogToFile and LogToDebugger are nonzero then log information will be sent both to a file and to the debugger." )
 CLI_CONTROL( int,           LogIndent,                              0,     "Indents each log entry by this many spaces." )
 CLI_CONTROL( bool,          BuildLogging,                           false, "If set to a nonzero value, logs the program build log after each call to clBuildProgram().  This will likely only function correctly for synchronous builds.  Note that the build log is logged regardless of whether the program built successfully, which allows compiler warnings to be logged for successful compiles." )
@@ -45,6 +46,8 @@ CLI_CONTROL( bool,          CallLoggingElapsedTime,                 false, "If s
 CLI_CONTROL( bool,          ITTCallLogging,                         false, "If set to a nonzero value, logs function entry and exit information for every OpenCL call using the ITT APIs.  This feature will only function if the Intercept Layer for OpenCL Applications is built with ITT support." )
 CLI_CONTROL( bool,          ChromeCallLogging,                      false, "If set to a nonzero value, logs function entry and exit information for every OpenCL call to a JSON file that may be used for Chrome Tracing." )
 CLI_CONTROL( bool,          ErrorLogging,                           false, "If set to a nonzero value, logs all OpenCL errors and the function name that caused the error." )
+CLI_CONTROL( cl_uint,       ErrorLoggingMaxRepeats,                 0,     "If set to a nonzero value and ErrorLogging is enabled, the Intercept Layer for OpenCL Applications will only log the first N occurrences of each error, where errors are distinguished by function name, error code, and kernel name, if any.  Subsequent occurrences of each error are counted and logged periodically as a summary instead.  This can reduce logging overhead significantly for applications that repeatedly call a failing function.  Occurrences that have not been summarized yet are summarized when the application exits.  A table of all errors is included in the report." )
+CLI_CONTROL( cl_uint,       ErrorLoggingSummaryIntervalMilliseconds, 1000, "The minimum time in milliseconds between summaries of each error that is no longer logged because of ErrorLoggingMaxRepeats." )
 CLI_CONTROL( bool,          ErrorAssert,                            false, "If set to a nonzero value, breaks into the debugger when an OpenCL error occurs." )
 CLI_CONTROL( bool,          ContextCallbackLogging,                 false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will install a callback for every context and log any calls to the context callback.  The application's context callback, if any, will be invoked after the Intercept Layer for OpenCL Applications' context callback." )
 CLI_CONTROL( cl_uint,       ContextHintLevel,                       0,     "If set to a nonzero value, the Intercept Layer for OpenCL Applications will attempt to create contexts with the CL_CONTEXT_SHOW_DIAGNOSTICS_INTEL property set to the specified value.  If this property is specified by the application, the Intercept Layer for OpenCL Applications will overwrite it with the specified value, otherwise the property and the specified value will be added to the list of context creation properties.  This functionality is only available for OpenCL implementations that support the cl_intel_driver_diagnostics extension.  If this functionality is not available in the underlying OpenCL implementation, the unmodified list of context properties will be used to create the context instead. More information about this feature, including valid values and their meaning, can be found in the cl_intel_driver_diagnostics extension specification." )
@@ -56,12 +59,14 @@ CLI_CONTROL( bool,          USMChecking,                            false, "If s
 CLI_CONTROL( bool,          CLInfoLogging,                          false, "If set to a nonzero value, logs information about the platforms and devices in the system on the first call to clGetPlatformIDs()." )
 CLI_CONTROL( std::string,   DumpDir,                                "",    "If set, the Intercept Layer for OpenCL Applications will emit logs and dumps to this directory instead of the default directory.  The default log and dump directory is \"%SYSTEMDRIVE%\\Intel\\CLIntercept_Dump\\<Process Name>\" on Windows and \"~/CLIntercept_Dump/<Process Name>\" on other operating systems.  The log and dump directory must be writeable, otherwise the Intercept Layer for OpenCL Applications will not be able to create or modify log or dump files." )
 CLI_CONTROL( bool,          AppendPid,                              false, "If set, the Intercept Layer for OpenCL Applications will append process ID to the log directory name." )
+CLI_CONTROL( bool,          AppendRank,                             false, "If set, and the application is running as part of an MPI job, the Intercept Layer for OpenCL Applications will append the host name and MPI rank to the log directory name, for example \"<Process Name>.<Host Name>.rank<Rank>\".  The MPI rank is read from the PMI_RANK, OMPI_COMM_WORLD_RANK, or SLURM_PROCID environment variables.  This is most useful in combination with DumpDir to write the output for all ranks to a shared directory." )
 CLI_CONTROL( bool,          KernelNameHashTracking,                 false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will append the program and build option hashes to the kernel name in logs and reports." )
 CLI_CONTROL( cl_uint,       LongKernelNameCutoff,                   UINT_MAX, "If an OpenCL application uses kernels with very long names, the Intercept Layer for OpenCL Applications can substitute a \"short\" kernel identifier for a \"long\" kernel name in logs and reports.  This control defines how long a kernel name must be (in characters) before it is replaced by a \"short\" kernel identifier." )
 
 CLI_CONTROL_SEPARATOR( Reporting Controls: )
 CLI_CONTROL( bool,          ReportToStderr,                         false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will emit reports to stderr." )
 CLI_CONTROL( bool,          ReportToFile,                           true,  "If set to a nonzero value, the Intercept Layer for OpenCL Applications will write results to the file \"clintercept_report.txt\"." )
+CLI_CONTROL( bool,          NodeReport,                             false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will merge the host and device performance timing results for all processes on the same node through a shared memory segment when each process exits, and write them to the file \"clintercept_node_report.<Host Name>.txt\" in the log directory (without the process ID or MPI rank).  Each process attaches to the segment when it starts, the report is rewritten as each process exits, and the last process to exit removes the segment, so the report is complete after the last process on the node exits.  Processes from the same job step or MPI launch share a segment, and processes that are not launched by MPI do not share a segment.  Per-process report files are still written as usual.  This is intended for MPI jobs with many ranks per node.  This feature is not supported on Windows." )
 
 CLI_CONTROL_SEPARATOR( Performance Timing Controls: )
 CLI_CONTROL( bool,          HostPerformanceTiming,                  false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will track the minimum, maximum, and average host CPU time for each OpenCL entry point.  When the process exits, this information will be included in the file \"clIntercept_report.txt\"." )
@@ -71,6 +76,8 @@ CLI_CONTROL( bool,          DevicePerformanceTimeGWOTracking,       false, "If s
 CLI_CONTROL( bool,          DevicePerformanceTimeGWSTracking,       false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will distinguish between OpenCL NDRange kernels with different global work sizes for the purpose of device performance timing." )
 CLI_CONTROL( bool,          DevicePerformanceTimeLWSTracking,       false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will distinguish between OpenCL NDRange kernels with different local work sizes for the purpose of device performance timing." )
 CLI_CONTROL( bool,          DevicePerformanceTimeSuggestedLWSTracking, false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will attempt to query and track the suggested local work size when the passed-in local work size is NULL." )
+CLI_CONTROL( std::string,   DevicePerformanceTimeScalarArgTracking, "",    "If set, the Intercept Layer for OpenCL Applications will include the values of selected scalar kernel arguments when tracking the device performance timing of kernels.  The value is a semicolon-separated list of <kernel name>:<argument> pairs, where the argument is an argument index or an argument name, and a kernel name of * matches any kernel.  For example: \"gemm:3;conv:mode\".  Argument names are only available if the program was built with -cl-kernel-arg-info." )
+CLI_CONTROL( cl_uint,       DevicePerformanceTimeScalarArgMaxValues, 16,   "The maximum number of distinct values of each tracked scalar kernel argument that are tracked separately when DevicePerformanceTimeScalarArgTracking is set.  Additional values are tracked together as *." )
 CLI_CONTROL( bool,          DevicePerformanceTimingSkipUnmap,       false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will skip device performance timing for unmap operations.  This is a workaround for a bug in some OpenCL implementations, where querying events created from unmap operations results in driver crashes." )
 CLI_CONTROL( cl_uint,       HostPerformanceTimingMinEnqueue,        0,     "The Intercept Layer for OpenCL Applications will only collect host performance timing metrics when the enqueue counter is greater than this value, inclusive." )
 CLI_CONTROL( cl_uint,       HostPerformanceTimingMaxEnqueue,        UINT_MAX, "The Intercept Layer for OpenCL Applications will only collect host performance timing metrics when the enqueue counter is less than this value, inclusive." )
@@ -79,6 +86,34 @@ CLI_CONTROL( cl_uint,       DevicePerformanceTimingMaxEnqueue,      UINT_MAX, "T
 CLI_CONTROL( bool,          HostPerformanceTimeLogging,             false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will log the host elapsed time for each OpenCL entry point.  This can be useful to identify OpenCL entry points that execute significantly slower or faster than average on the host." )
 CLI_CONTROL( bool,          DevicePerformanceTimeLogging,           false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will log the device execution time deltas for each OpenCL command.  This can be useful to identify specific OpenCL commands that execute significantly slower or faster than average on the device.  If DevicePerformanceTiming is disabled then this control will have no effect." )
 CLI_CONTROL( bool,          DevicePerformanceTimelineLogging,       false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will log the device execution times for each OpenCL command.  This can be useful to visualize the execution timeline of OpenCL commands that execute on the device.  If DevicePerformanceTiming is disabled then this control will have no effect." )
+CLI_CONTROL( bool,          HostBlockingTimeAttribution,            false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will record which device commands were still executing when the host blocked in clFinish, clWaitForEvents, or a blocking read, write, map, or copy, and will attribute the host blocking time to these device commands using their event profiling timestamps.  When the process exits, this information will be included in the file \"clIntercept_report.txt\".  If DevicePerformanceTiming is disabled then this control will have no effect." )
+CLI_CONTROL( bool,          RedundantSyncChecking,                  false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will detect and count synchronization that is likely unnecessary: clFinish when no commands were enqueued to the queue since it was last synchronized, clWaitForEvents when all events were already complete, clFlush directly followed by a blocking call, barriers and markers on in-order queues that do not return an event and do not wait on events from other queues, and, as a heuristic, blocking reads that were quickly followed by another enqueue from the same thread.  When the process exits, the number of calls and the host time for each finding will be included in the file \"clIntercept_report.txt\"." )
+CLI_CONTROL( cl_uint,       RedundantSyncReadGapMicroseconds,       100,   "If RedundantSyncChecking is enabled, a blocking read is reported as possibly unnecessary if the same thread enqueues another command less than this many microseconds after the blocking read returned, since this suggests the application did not process the results of the read before enqueueing more work.  This is a heuristic: it cannot tell whether the host used the results of the read, so it may report correct code and miss unnecessary blocking reads." )
+CLI_CONTROL( bool,          ZeroCopyChecking,                       false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will check whether buffers could be zero-copy buffers.  Buffers created with CL_MEM_COPY_HOST_PTR, or created with CL_MEM_USE_HOST_PTR and a host pointer that is not page aligned or a size that is not a multiple of the CL_DEVICE_MEM_BASE_ADDR_ALIGN of the devices in the context, are reported along with buffers that are frequently read, written, or mapped by the host.  The report includes an estimate of the bytes copied that could have been avoided with zero-copy buffers." )
+CLI_CONTROL( bool,          RedundantKernelChecking,                false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will track a write generation for every buffer, image, SVM allocation, and USM allocation, and will detect kernel enqueues with the same kernel, argument values, and work sizes as a previous enqueue, where none of the memory used by the kernel has been modified since the previous enqueue.  Memory arguments that are not const, __constant, or read_only are assumed to be written by the kernel, and memory arguments that are not write_only are assumed to be read by the kernel, so kernels that may update memory in place are never reported as redundant.  Kernels using fine-grain SVM allocations or USM host or shared allocations are not checked, since host writes to this memory cannot be tracked.  When the process exits, the number of redundant enqueues and, if DevicePerformanceTiming is enabled, the device time spent in redundant enqueues for each kernel will be included in the file \"clIntercept_report.txt\"." )
+CLI_CONTROL( cl_uint,       RedundantKernelCheckingMaxRecords,      16384, "If RedundantKernelChecking is enabled, this is the maximum number of distinct kernel enqueues that are remembered.  When this limit is reached all remembered enqueues are discarded." )
+CLI_CONTROL( bool,          BottleneckAnalysis,                     false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will classify each phase of the application, and the application as a whole, as host-bound, launch-bound, transfer-bound, or compute-bound, based on the device utilization, the median kernel duration, the average interval between enqueues, and the share of device time spent in transfers.  This requires device timestamps, so DevicePerformanceTiming or ChromePerformanceTiming must also be enabled.  When the process exits, the classification and the evidence for it will be included in the file \"clIntercept_report.txt\"." )
+CLI_CONTROL( cl_uint,       BottleneckAnalysisPhaseMilliseconds,    1000,  "The length in milliseconds of each interval classified by BottleneckAnalysis.  Adjacent intervals with the same classification are reported as one phase." )
+CLI_CONTROL( bool,          StartupProfile,                         false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will record when the Intercept Layer for OpenCL Applications was loaded and initialized, the first call to clGetPlatformIDs() and clGetDeviceIDs(), the first context and command queue creation, each program build, the first kernel enqueue, and the completion of the first kernel, along with the host time of the OpenCL calls made between each of these milestones.  When the process exits, the startup profile will be included in the file \"clIntercept_report.txt\".  If ChromeCallLogging or ChromePerformanceTiming is enabled, the startup profile will also be included as a separate track in the Chrome trace file." )
+CLI_CONTROL( bool,          SubmitLatencyAnalysis,                  false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will aggregate the queued to submit and submit to start times of each command into histograms per command queue, per command type, and per flush pattern.  The flush pattern describes how the command was submitted: by clFlush(), clFinish(), clWaitForEvents(), or a blocking enqueue, and how many commands were submitted together, or implicitly by the OpenCL implementation.  This requires DevicePerformanceTiming.  When the process exits, the submission latency analysis will be included in the file \"clIntercept_report.txt\"." )
+CLI_CONTROL( cl_uint,       RollingStatsWindowSeconds,              0,     "If set to a nonzero value, the Intercept Layer for OpenCL Applications will aggregate host and device timing into windows of this many seconds, in addition to the cumulative timing in the report.  The windowed timing is written as a time series to the file \"clintercept_rolling_stats.csv\".  This requires HostPerformanceTiming for host timing and DevicePerformanceTiming for device timing." )
+CLI_CONTROL( cl_uint,       RollingStatsLateWindows,                1,     "The number of windows after a window ends during which device timing that completes late may still be attributed to it, when RollingStatsWindowSeconds is enabled.  Each window is written to the time series file once this many following windows have ended.  Device timing that completes later than this is not included in the time series." )
+CLI_CONTROL( bool,          KernelAnomalyDetection,                 false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will keep a running mean and variance of the execution time of each kernel, and will log kernel executions that are much slower than usual, along with the enqueue counter, the global and local work size, the queue depth when the kernel was enqueued, and the number of commands that were in flight on the device.  This requires DevicePerformanceTiming.  When the process exits, a summary of the kernel anomalies will be included in the file \"clIntercept_report.txt\"." )
+CLI_CONTROL( cl_uint,       KernelAnomalySigma,                     5,     "A kernel execution is an anomaly if its execution time exceeds the mean execution time of the kernel by more than this many standard deviations.  If set to zero, the standard deviation is not used to detect anomalies." )
+CLI_CONTROL( cl_uint,       KernelAnomalyMedianMultiple,            0,     "If set to a nonzero value, a kernel execution is also an anomaly if its execution time exceeds this multiple of the estimated median execution time of the kernel." )
+CLI_CONTROL( cl_uint,       KernelAnomalyEWMAPercent,               0,     "If set to a nonzero value, KernelAnomalySigma uses an exponentially weighted moving average and variance with this weight, as a percentage, instead of the mean and variance of all executions.  This adapts to slow changes in kernel execution time." )
+CLI_CONTROL( cl_uint,       KernelAnomalyMinSamples,                16,    "Kernel anomalies are only detected after the kernel has executed at least this many times." )
+CLI_CONTROL( bool,          KernelAnomalyDumpBuffers,               false, "If set to a nonzero value, a kernel anomaly will trigger a dump of the buffer, SVM, and USM kernel arguments after the next enqueue of the same kernel.  The buffers are dumped to the directory \"memDumpAnomalyEnqueue\"." )
+CLI_CONTROL( cl_uint,       OverheadBudgetPercent,                  0,     "If set to a nonzero value, the Intercept Layer for OpenCL Applications will measure the host time it spends on call logging, Chrome call logging, and device performance timing, and will adaptively reduce its instrumentation to keep this overhead below this percentage of elapsed host time.  Instrumentation is reduced by first disabling ChromePerformanceTimingInStages, then by timing only a sample of enqueues, and finally by pausing call logging.  Instrumentation is restored when the overhead falls well below the budget.  Every adjustment is logged, and the final sampling factors are included in the file \"clIntercept_report.txt\"." )
+CLI_CONTROL( cl_uint,       OverheadBudgetIntervalMilliseconds,     1000,  "The interval in milliseconds over which OverheadBudgetPercent measures the intercept overhead and adjusts the instrumentation." )
+CLI_CONTROL( cl_uint,       OverheadBudgetMaxSampleFactor,          64,    "The maximum device performance timing sampling factor used by OverheadBudgetPercent.  With a sampling factor of N, only one of every N enqueues is timed." )
+CLI_CONTROL( bool,          DeviceConcurrencyAnalysis,              false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will record the start and end time of each command on each device, from all command queues, and will compute how often commands execute concurrently: kernels with kernels, kernels with transfers, and transfers with transfers.  This requires DevicePerformanceTiming.  When the process exits, the distribution of concurrency levels will be included in the file \"clIntercept_report.txt\"." )
+CLI_CONTROL( cl_uint,       DeviceConcurrencyAnalysisMaxCommands,   1000000, "The maximum number of commands recorded per device by DeviceConcurrencyAnalysis.  Commands beyond this limit are not included in the analysis." )
+CLI_CONTROL( bool,          KernelFootprintAnalysis,                false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will compute the memory footprint of each kernel enqueue, which is the total size of the buffers, images, and SVM or USM allocations passed as kernel arguments.  When combined with DevicePerformanceTiming, the footprint is paired with the device time of the enqueue to estimate the effective bandwidth of each kernel.  When the process exits, the kernel footprints will be included in the file \"clIntercept_report.txt\"." )
+CLI_CONTROL( bool,          MapAccessTracking,                      false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will protect the pages of each region returned by a blocking clEnqueueMapBuffer() and will record the pages that are read or written by the host before the region is unmapped.  Maps that touch a small fraction of the mapped region are reported, along with the bytes that were transferred needlessly.  Only pages that are entirely within the mapped region are tracked.  This is only supported on Linux.  Note that system calls that access a protected region, such as read() into a mapped region, will fail while this control is enabled.  If a fault occurs outside of a tracked region, tracking stops and the fault is handed back to the previous SIGSEGV handler.  When the process exits, the map access results will be included in the file \"clIntercept_report.txt\"." )
+CLI_CONTROL( cl_uint,       MapAccessTrackingThreshold,             25,    "MapAccessTracking reports a map as a low-touch map if the host touched less than this percentage of the tracked pages in the mapped region." )
+CLI_CONTROL( bool,          LockContentionTracking,                 false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will track how often its internal lock is acquired, how often the lock is contended, and how long threads wait to acquire the lock, for each function that acquires the lock.  The most contended functions are included in the report.  This can help to determine which features of the Intercept Layer for OpenCL Applications are expensive for multi-threaded applications." )
+CLI_CONTROL( cl_uint,       LockContentionChromeCounters,           0,     "If set to a nonzero value, and LockContentionTracking and ChromeCallLogging are enabled, the Intercept Layer for OpenCL Applications will write counters for lock acquisitions, contended lock acquisitions, and lock wait time to the JSON file at most once per this many milliseconds." )
 CLI_CONTROL( std::string,   DevicePerfCounterLibName,               "",    "Full path to MDAPI shared library. If not set, the default MDAPI library will be used.")
 CLI_CONTROL( bool,          DevicePerfCounterEventBasedSampling,    false, "If set to a nonzero value and DevicePerfCounterCustom is set, the Intercept Layer for OpenCL Applications will enable Intel GPU Performance Counters to track the minimum, maximum, and average performance counter deltas for each OpenCL command. This operation may be fairly intrusive and may have side effects; in particular it forces all command queues to be created with PROFILING_ENABLED and may increment the reference count for application events. This feature will only function if the Intercept Layer for OpenCL Applications is built with MDAPI support." )
 CLI_CONTROL( bool,          DevicePerfCounterTimeBasedSampling,     false, "If set to a nonzero value and DevicePerfCounterCustom is set, the Intercept Layer for OpenCL Applications will enable Intel GPU Performance Counters to track performance counter deltas at regular time intervals. This operation may be fairly intrusive and may have side effects. This feature will only function if the Intercept Layer for OpenCL Applications is built with MDAPI support." )
@@ -92,6 +127,17 @@ CLI_CONTROL( bool,          ChromePerformanceTiming,                false, "If s
 CLI_CONTROL( bool,          ChromePerformanceTimingInStages,        false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will separate the performance information placed in the JSON file into Queued, Submitted, and Execution stages. It will also reorder the threads/queues by starting runtime. This flag is only functional when ChromePerformanceTiming is also set." )
 CLI_CONTROL( bool,          ChromePerformanceTimingPerKernel,       false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will organize the performance information placed in the JSON file on a per kernel name basis. It is only functional when ChromePerformanceTiming is also set. When ChromePerformanceTimingInStages is also set, information about event stages will be retained." )
 
+CLI_CONTROL( bool,          ChromeTraceCompress,                    false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will compress the JSON file generated by ChromeCallLogging or ChromePerformanceTiming using gzip compression, and the file will be named \"clintercept_trace.json.gz\".  The compressed file may be loaded directly into most Chrome Tracing viewers." )
+CLI_CONTROL( cl_uint,       ChromeTraceRotateMB,                    0,     "If set to a nonzero value, the Intercept Layer for OpenCL Applications will start a new JSON file for ChromeCallLogging or ChromePerformanceTiming after this many megabytes of (uncompressed) trace data have been written to the current file.  The files will be numbered, for example \"clintercept_trace.0000.json\", \"clintercept_trace.0001.json\", and so on.  Each file is a complete JSON file and includes the process and thread metadata, so each file may be loaded independently." )
+CLI_CONTROL( cl_uint,       ChromeTraceRotateSeconds,               0,     "If set to a nonzero value, the Intercept Layer for OpenCL Applications will start a new JSON file for ChromeCallLogging or ChromePerformanceTiming after this many seconds.  The files are numbered the same way as for ChromeTraceRotateMB, and both controls may be set at the same time." )
+
+CLI_CONTROL_SEPARATOR( Capture Window Controls: )
+CLI_CONTROL( cl_uint,       CaptureWindowStartSeconds,              0,     "If set to a nonzero value, the Intercept Layer for OpenCL Applications will not start capturing call logging, Chrome call logging, or device performance timing until this many seconds after the intercept DLL is loaded.  Outside of the capture window, CallLogging and ChromeCallLogging are paused, and device performance timing events are not created.  The capture window is checked on each enqueue, without taking a lock unless the capture window may start or stop.  If CaptureWindowStartKernelName is also set, the capture window will start on the first enqueue of the named kernel after this many seconds." )
+CLI_CONTROL( std::string,   CaptureWindowStartKernelName,           "",    "If set, the Intercept Layer for OpenCL Applications will not start capturing call logging, Chrome call logging, or device performance timing until the first enqueue of a kernel with this name.  The capture window includes the kernel enqueue that started it." )
+CLI_CONTROL( int,           CaptureWindowStartSignal,               0,     "If set to a nonzero value, the Intercept Layer for OpenCL Applications will not start capturing call logging, Chrome call logging, or device performance timing until the process receives this signal, for example 10 for SIGUSR1 on Linux.  Receiving the signal again stops the capture window, and subsequent signals start and stop additional capture windows.  Since the capture window is checked on each enqueue, the capture window starts or stops on the first enqueue after the signal is received.  This feature is not supported on Windows." )
+CLI_CONTROL( cl_uint,       CaptureWindowDurationSeconds,           0,     "If set to a nonzero value, the Intercept Layer for OpenCL Applications will stop the capture window this many seconds after it started.  This control has no effect unless a capture window start control is also set." )
+CLI_CONTROL( cl_uint,       CaptureWindowEnqueueCount,              0,     "If set to a nonzero value, the Intercept Layer for OpenCL Applications will stop the capture window after this many enqueues.  This control has no effect unless a capture window start control is also set." )
+
 CLI_CONTROL_SEPARATOR( Controls for Dumping and Injecting Programs and Build Options: )
 CLI_CONTROL( bool,          OmitProgramNumber,                      false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will omit the program number from dumped file names and hash tracking.  This can produce deterministic results even if programs are built in a non-deterministic order (say, by multiple threads)." )
 CLI_CONTROL( bool,          SimpleDumpProgramSource,                false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will dump the last string(s) passed to clCreateProgramWithSource() to the file kernel.cl, and the last program options passed to clBuildProgram() to the file kernel.txt.  These files will be dumped to the application's working directory.  If an application fails to compile a program and exits the program immediately after detecting a compile failure SimpleDumpProgram may be all that is needed to identify the program and program options that are failing to compile." )
@@ -170,12 +216,27 @@ CLI_CONTROL( bool,          FlushAfterEnqueueBarrier,               false, "If s
 CLI_CONTROL( bool,          InOrderQueue,                           false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will force all queues to be created in-order.  This can be used for performance analysis, but may lead to deadlocks in some cases." )
 CLI_CONTROL( bool,          NoProfilingQueue,                       false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will force all queues to be created without event profiling support.  This can be used for performance analysis, but may lead to errors if the application requires event profiling." )
 CLI_CONTROL( bool,          DummyOutOfOrderQueue,                   false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will create and destroy a dummy out-of-order queue.  This may be useful for performance analysis." )
+CLI_CONTROL( bool,          AutoOutOfOrderQueue,                    false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will create out-of-order command queues when the application requests an in-order host command queue and the device supports out-of-order queues.  The Intercept Layer for OpenCL Applications will then add event dependencies between commands based on the buffers, images, SVM and USM allocations, and host memory each command accesses, so commands that access different memory may execute concurrently.  Commands that may access unknown memory, including kernels with memory arguments that are not tracked, wait for all previous commands.  Commands that return an event to the application also wait for all previous commands, so the event still indicates that all previous commands in the queue have completed." )
+CLI_CONTROL( bool,          CoalesceBufferWrites,                   false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will combine small non-blocking clEnqueueWriteBuffer() calls to adjacent ranges of the same buffer on an in-order queue into a single transfer.  The data for each write is copied into a staging area, and the combined transfer is issued when the next write is not adjacent, when the application requests an event for a write, or when any other command is enqueued to the queue, the queue is flushed or finished, or the buffer is released.  Note that the writes that were combined have already returned CL_SUCCESS, so an error from a combined transfer cannot be returned to them.  It is only returned if the combined transfer is issued because the application requested an event for a write; otherwise it is logged and counted as a failed transfer in the report, and the data for the failed transfer is discarded." )
+CLI_CONTROL( cl_uint,       CoalesceBufferWritesMaxSize,            4096,  "The maximum size in bytes of an individual clEnqueueWriteBuffer() call that may be combined with adjacent writes when CoalesceBufferWrites is enabled." )
+CLI_CONTROL( cl_uint,       CoalesceBufferWritesMaxBatchSize,       1048576, "The maximum size in bytes of a combined transfer when CoalesceBufferWrites is enabled." )
+CLI_CONTROL( bool,          PinnedStagingTransfers,                 false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will route large clEnqueueWriteBuffer() calls and large blocking clEnqueueReadBuffer() calls on in-order queues through a pool of pinned staging buffers allocated with CL_MEM_ALLOC_HOST_PTR.  Transfers are split into chunks, and the host copy of each chunk overlaps with the device transfer of the previous chunk.  Host pointers to known SVM or USM allocations are not staged.  Transfers that are timed by DevicePerformanceTiming or the other device timing controls are not staged, so device timing always describes an entire transfer.  If a chunk fails, the error is returned and the transfer is not retried." )
+CLI_CONTROL( cl_uint,       PinnedStagingMinSize,                   1048576, "The minimum size in bytes of a transfer that is routed through the pinned staging buffers when PinnedStagingTransfers is enabled." )
+CLI_CONTROL( cl_uint,       PinnedStagingChunkSize,                 4194304, "The size in bytes of each pinned staging buffer when PinnedStagingTransfers is enabled." )
+CLI_CONTROL( cl_uint,       PinnedStagingBufferCount,               3,     "The number of pinned staging buffers per command queue when PinnedStagingTransfers is enabled." )
+CLI_CONTROL( cl_uint,       PinnedStagingCopyThreads,               1,     "The maximum number of threads used to copy each chunk between the application's memory and a pinned staging buffer when PinnedStagingTransfers is enabled, including the calling thread.  Each thread copies at least 1MB, so smaller chunks are copied by fewer threads.  The additional threads are created for each copy, so this is most useful with a large PinnedStagingChunkSize." )
+CLI_CONTROL( cl_uint,       PinnedStagingCompareInterval,           16,    "When PinnedStagingTransfers is enabled, every Nth blocking transfer that could be staged is issued directly instead, so the report can compare the bandwidth with and without staging.  If set to zero, all transfers that can be staged are staged." )
+CLI_CONTROL( bool,          RecycleKernels,                         false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will keep a pristine clone of the first kernel created for each program and kernel name, and will satisfy later calls to clCreateKernel() for the same program and kernel name with clones of this kernel.  Cloning a kernel is usually much cheaper than creating a kernel from a program.  The template kernels are released when the application releases its last reference to the program, and before the program is built, compiled, or linked again.  Released kernels are not reused, since the arguments of a released kernel cannot be reset.  This requires clCloneKernel().  When the process exits, the kernel recycling hit rate and the estimated host time saved will be included in the file \"clIntercept_report.txt\"." )
 CLI_CONTROL( bool,          NullEnqueue,                            false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will silently ignore any enqueue.  This can be used for performance analysis, but will likely cause errors if the application relies on any sort of information from OpenCL events and should be used carefully." )
 CLI_CONTROL( bool,          NullLocalWorkSize,                      false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will force the local work size argument to clEnqueueNDRangeKernel() to be NULL, which causes the OpenCL implementation to pick the local work size. Note that this control takes effect before NullLocalWorkSizeX / NullLocalWorkSizeY / NullLocalWorkSizeZ (see below), so enabling both controls will have the effect of forcing a specific local work size." )
 CLI_CONTROL( size_t,        NullLocalWorkSizeX,                     0,     "If set to a nonzero value, the Intercept Layer for OpenCL Applications will set the local work size that will be used if an application passes NULL as the local work size to clEnqueueNDRangeKernel().  1D dispatches will only look at NullLocalWorkSizeX, 2D dispatches will only look at NullLocalWorkSizeX and NullLocalWorkSizeY, while 3D dispatches will look at NullLocalWorkSizeX, NullLocalWorkSizeY, and NullLocalWorkSizeZ.  If the specified values for NullLocalWorkSize do not evenly divide the global work size then the specified values of NullLocalWorkSize will not take effect." )
 CLI_CONTROL( size_t,        NullLocalWorkSizeY,                     0,     "If set to a nonzero value, the Intercept Layer for OpenCL Applications will set the local work size that will be used if an application passes NULL as the local work size to clEnqueueNDRangeKernel().  1D dispatches will only look at NullLocalWorkSizeX, 2D dispatches will only look at NullLocalWorkSizeX and NullLocalWorkSizeY, while 3D dispatches will look at NullLocalWorkSizeX, NullLocalWorkSizeY, and NullLocalWorkSizeZ.  If the specified values for NullLocalWorkSize do not evenly divide the global work size then the specified values of NullLocalWorkSize will not take effect." )
 CLI_CONTROL( size_t,        NullLocalWorkSizeZ,                     0,     "If set to a nonzero value, the Intercept Layer for OpenCL Applications will set the local work size that will be used if an application passes NULL as the local work size to clEnqueueNDRangeKernel().  1D dispatches will only look at NullLocalWorkSizeX, 2D dispatches will only look at NullLocalWorkSizeX and NullLocalWorkSizeY, while 3D dispatches will look at NullLocalWorkSizeX, NullLocalWorkSizeY, and NullLocalWorkSizeZ.  If the specified values for NullLocalWorkSize do not evenly divide the global work size then the specified values of NullLocalWorkSize will not take effect." )
-CLI_CONTROL( bool,          InitializeBuffers,                      false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will initialize the contents of allocated buffers with zero.  Only valid for non-COPY_HOST_PTR and non-USE_HOST_PTR allocations." )
+CLI_CONTROL( bool,          InitializeBuffers,                      false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will initialize the contents of allocated buffers with zero.  Only valid for non-COPY_HOST_PTR and non-USE_HOST_PTR allocations.  Buffers are filled with zero on an internal command queue for each context, or, if filling is not supported, written from a shared block of zeros, so no host memory proportional to the buffer size is allocated.  The internal command queue holds a reference to its context, so it is released when the application releases the context or queries CL_CONTEXT_REFERENCE_COUNT, and is created again for the next buffer." )
+CLI_CONTROL( cl_uint,       HostAllocationHugePages,                0,     "Controls the page size of large host allocations made by the Intercept Layer for OpenCL Applications, such as emulated USM host and shared allocations, buffer dump staging memory, and InitializeBuffers zero data.  If set to 1, these allocations are advised to use transparent huge pages.  If set to 2, these allocations use explicit huge pages, falling back to normal pages if no huge pages are available.  This is only supported on Linux." )
+CLI_CONTROL( cl_uint,       HostAllocationNUMAPolicy,               0,     "Controls the NUMA placement of large host allocations made by the Intercept Layer for OpenCL Applications.  If set to 1, these allocations prefer the NUMA node given by HostAllocationNUMANode.  If set to 2, these allocations prefer the NUMA node of the calling thread.  Pages are placed on other nodes if the preferred node is out of memory.  This is only supported on Linux." )
+CLI_CONTROL( cl_uint,       HostAllocationNUMANode,                 0,     "The NUMA node used by HostAllocationNUMAPolicy." )
+CLI_CONTROL( bool,          HostAllocationBenchmark,                false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will measure host copy bandwidth when it is initialized, using normal host allocations and using host allocations placed according to HostAllocationHugePages and HostAllocationNUMAPolicy, and will log the results.  The benchmark thread is pinned to the CPU it is running on for the duration of the benchmark." )
 CLI_CONTROL( cl_uint,       DefaultQueuePriorityHint,               0,     "If set to a nonzero value, and if no other priority hint is specified by the application, the Intercept Layer for OpencL Applications will attempt to create a command queue with this priority hint value.  Note: HIGH priority is 1, MED priority is 2, and LOW priority is 4." )
 CLI_CONTROL( cl_uint,       DefaultQueueThrottleHint,               0,     "If set to a nonzero value, and if no other throttle hint is specified by the application, the Intercept Layer for OpencL Applications will attempt to create a command queue with this throttle hint value.  Note: HIGH throttle is 1, MED throttle is 2, and LOW throttle is 4." )
 CLI_CONTROL( bool,          RelaxAllocationLimits,                  false, "If set to a nonzero value, the Intercept Layer for OpenCL Applications will attempt to relax allocation limits to enable allocations larger than CL_DEVICE_MAX_MEM_ALLOC_SIZE." )
@@ -593,6 +593,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clReleaseContext)(
     if( pIntercept && pIntercept->dispatch().clReleaseContext )
     {
         GET_ENQUEUE_COUNTER();
+        INITIALIZE_BUFFERS_RELEASE_CONTEXT( context );
 
         cl_uint ref_count =
             pIntercept->config().CallLogging ?
@@ -647,6 +648,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clGetContextInfo)(
         CALL_LOGGING_ENTER( "param_name = %s (%08X)",
             pIntercept->enumName().name( param_name ).c_str(),
             param_name );
+        INITIALIZE_BUFFERS_CONTEXT_INFO( context, param_name );
         CPU_PERFORMANCE_TIMING_START();
 
         cl_int retVal = pIntercept->dispatch().clGetContextInfo(
@@ -728,7 +730,8 @@ CL_API_ENTRY cl_command_queue CL_API_CALL CLIRN(clCreateCommandQueue)(
             pIntercept->enumName().name_command_queue_properties( properties ).c_str(),
             properties );
         DUMMY_COMMAND_QUEUE( context, device );
-        pIntercept->modifyCommandQueueProperties( properties );
+        AUTO_OUT_OF_ORDER_QUEUE_INIT( properties );
+        pIntercept->modifyCommandQueueProperties( device, properties );
         CREATE_COMMAND_QUEUE_PROPERTIES( device, properties, newProperties );
 
         CHECK_ERROR_INIT( errcode_ret );
@@ -780,6 +783,7 @@ CL_API_ENTRY cl_command_queue CL_API_CALL CLIRN(clCreateCommandQueue)(
         ADD_OBJECT_ALLOCATION( retVal );
         CALL_LOGGING_EXIT( errcode_ret[0], "returned %p", retVal );
         ADD_QUEUE( context, retVal );
+        ADD_AUTO_OUT_OF_ORDER_QUEUE( retVal );
         QUEUE_INFO_LOGGING( device, retVal );
 
         return retVal;
@@ -835,6 +839,11 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clReleaseCommandQueue)(
     {
         GET_ENQUEUE_COUNTER();
         REMOVE_QUEUE( command_queue );
+        REMOVE_AUTO_OUT_OF_ORDER_QUEUE( command_queue );
+        REMOVE_COALESCED_BUFFER_WRITES( command_queue );
+        REMOVE_PINNED_STAGING_POOL( command_queue );
+        REDUNDANT_SYNC_RELEASE_QUEUE( command_queue );
+        SUBMIT_LATENCY_RELEASE_QUEUE( command_queue );
 
         cl_uint ref_count =
             pIntercept->config().CallLogging ?
@@ -888,6 +897,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clGetCommandQueueInfo)(
 
         CPU_PERFORMANCE_TIMING_END();
         CHECK_ERROR( retVal );
+        AUTO_OUT_OF_ORDER_QUEUE_INFO( command_queue, param_name, param_value );
         CALL_LOGGING_EXIT( retVal );
 
         return retVal;
@@ -961,7 +971,8 @@ CL_API_ENTRY cl_mem CL_API_CALL CLIRN(clCreateBuffer)(
 
         CPU_PERFORMANCE_TIMING_END();
         ADD_BUFFER( retVal );
-        INITIALIZE_BUFFER_CONTENTS_CLEANUP( flags, host_ptr );
+        ZERO_COPY_CHECK_BUFFER( retVal, flags, size, host_ptr );
+        INITIALIZE_BUFFER_CONTENTS( retVal, size );
         DUMP_BUFFER_AFTER_CREATE( retVal, flags, host_ptr, size );
         CHECK_ERROR( errcode_ret[0] );
         ADD_OBJECT_ALLOCATION( retVal );
@@ -1018,7 +1029,8 @@ CL_API_ENTRY cl_mem CL_API_CALL CLIRN(clCreateBufferWithProperties)(
 
         CPU_PERFORMANCE_TIMING_END();
         ADD_BUFFER( retVal );
-        INITIALIZE_BUFFER_CONTENTS_CLEANUP( flags, host_ptr );
+        ZERO_COPY_CHECK_BUFFER( retVal, flags, size, host_ptr );
+        INITIALIZE_BUFFER_CONTENTS( retVal, size );
         DUMP_BUFFER_AFTER_CREATE( retVal, flags, host_ptr, size );
         CHECK_ERROR( errcode_ret[0] );
         ADD_OBJECT_ALLOCATION( retVal );
@@ -1071,7 +1083,8 @@ CL_API_ENTRY cl_mem CL_API_CALL clCreateBufferNV(
 
             CPU_PERFORMANCE_TIMING_END();
             ADD_BUFFER( retVal );
-            INITIALIZE_BUFFER_CONTENTS_CLEANUP( flags, host_ptr );
+            ZERO_COPY_CHECK_BUFFER( retVal, flags, size, host_ptr );
+            INITIALIZE_BUFFER_CONTENTS( retVal, size );
             DUMP_BUFFER_AFTER_CREATE( retVal, flags, host_ptr, size );
             CHECK_ERROR( errcode_ret[0] );
             ADD_OBJECT_ALLOCATION( retVal );
@@ -1498,7 +1511,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clReleaseMemObject)(
     if( pIntercept && pIntercept->dispatch().clReleaseMemObject )
     {
         GET_ENQUEUE_COUNTER();
+        FLUSH_COALESCED_BUFFER_WRITES_FOR_MEMOBJ( memobj );
         REMOVE_MEMOBJ( memobj );
+        ZERO_COPY_CHECK_RELEASE( memobj );
 
         cl_uint ref_count =
             pIntercept->config().CallLogging ?
@@ -1889,6 +1904,7 @@ CL_API_ENTRY cl_program CL_API_CALL CLIRN(clCreateProgramWithSource)(
         CPU_PERFORMANCE_TIMING_END();
         CHECK_ERROR( errcode_ret[0] );
         ADD_OBJECT_ALLOCATION( retVal );
+        ADD_RECYCLED_KERNELS_PROGRAM_REF( retVal );
         CALL_LOGGING_EXIT( errcode_ret[0], "returned %p, program number = %04d",
             retVal,
             pIntercept->getProgramNumber() );
@@ -1953,6 +1969,7 @@ CL_API_ENTRY cl_program CL_API_CALL CLIRN(clCreateProgramWithBinary)(
         CPU_PERFORMANCE_TIMING_END();
         CHECK_ERROR( errcode_ret[0] );
         ADD_OBJECT_ALLOCATION( retVal );
+        ADD_RECYCLED_KERNELS_PROGRAM_REF( retVal );
         CALL_LOGGING_EXIT( errcode_ret[0], "returned %p", retVal );
 
         DUMP_INPUT_PROGRAM_BINARIES(
@@ -2014,6 +2031,7 @@ CL_API_ENTRY cl_program CL_API_CALL CLIRN(clCreateProgramWithBuiltInKernels)(
         CPU_PERFORMANCE_TIMING_END();
         CHECK_ERROR( errcode_ret[0] );
         ADD_OBJECT_ALLOCATION( retVal );
+        ADD_RECYCLED_KERNELS_PROGRAM_REF( retVal );
         CALL_LOGGING_EXIT( errcode_ret[0], "returned %p", retVal );
 
         return retVal;
@@ -2047,6 +2065,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clRetainProgram)(
         CPU_PERFORMANCE_TIMING_END();
         CHECK_ERROR( retVal );
         ADD_OBJECT_RETAIN( program );
+        ADD_RECYCLED_KERNELS_PROGRAM_REF( retVal == CL_SUCCESS ? program : NULL );
         ref_count =
             pIntercept->config().CallLogging ?
             pIntercept->getRefCount( program ) : 0;
@@ -2075,6 +2094,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clReleaseProgram)(
         CALL_LOGGING_ENTER( "[ ref count = %d ] program = %p",
             ref_count,
             program );
+        RELEASE_RECYCLED_KERNELS( program );
         CPU_PERFORMANCE_TIMING_START();
 
         cl_int  retVal = pIntercept->dispatch().clReleaseProgram(
@@ -2117,6 +2137,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clBuildProgram)(
 
         CALL_LOGGING_ENTER( "program = %p, pfn_notify = %p", program, pfn_notify );
         BUILD_LOGGING_INIT();
+        RELEASE_RECYCLED_KERNEL_TEMPLATES( program );
         CPU_PERFORMANCE_TIMING_START();
 
         cl_int  retVal = CL_INVALID_OPERATION;
@@ -2190,6 +2211,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clCompileProgram)(
 
         CALL_LOGGING_ENTER( "program = %p, pfn_notify = %p", program, pfn_notify );
         BUILD_LOGGING_INIT();
+        RELEASE_RECYCLED_KERNEL_TEMPLATES( program );
         CPU_PERFORMANCE_TIMING_START();
 
         cl_int  retVal = CL_INVALID_OPERATION;
@@ -2269,6 +2291,7 @@ CL_API_ENTRY cl_program CL_API_CALL CLIRN(clLinkProgram)(
             pfn_notify );
         CHECK_ERROR_INIT( errcode_ret );
         BUILD_LOGGING_INIT();
+        RELEASE_RECYCLED_KERNEL_TEMPLATES_FOR_LINK( num_input_programs, input_programs );
         CPU_PERFORMANCE_TIMING_START();
 
         if( ( retVal == NULL ) && newOptions )
@@ -2302,6 +2325,7 @@ CL_API_ENTRY cl_program CL_API_CALL CLIRN(clLinkProgram)(
         CHECK_ERROR( errcode_ret[0] );
         BUILD_LOGGING( retVal, num_devices, device_list );
         ADD_OBJECT_ALLOCATION( retVal );
+        ADD_RECYCLED_KERNELS_PROGRAM_REF( retVal );
         CALL_LOGGING_EXIT( errcode_ret[0], "returned %p", retVal );
 
         // TODO: How do we compute a hash for the linked program?
@@ -2542,7 +2566,15 @@ CL_API_ENTRY cl_kernel CL_API_CALL CLIRN(clCreateKernel)(
                 errcode_ret );
         }
 
-        if( retVal == NULL )
+        if( ( retVal == NULL ) &&
+            pIntercept->config().RecycleKernels )
+        {
+            retVal = pIntercept->createRecycledKernel(
+                program,
+                kernel_name,
+                errcode_ret );
+        }
+        else if( retVal == NULL )
         {
             retVal = pIntercept->dispatch().clCreateKernel(
                 program,
@@ -2760,7 +2792,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clSetKernelArg)(
             arg_value );
 
         CPU_PERFORMANCE_TIMING_END();
-        CHECK_ERROR( retVal );
+        CHECK_ERROR_KERNEL( retVal, kernel );
         CALL_LOGGING_EXIT( retVal );
 
         return retVal;
@@ -2796,7 +2828,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clGetKernelInfo)(
             param_value_size_ret );
 
         CPU_PERFORMANCE_TIMING_END();
-        CHECK_ERROR( retVal );
+        CHECK_ERROR_KERNEL( retVal, kernel );
         CALL_LOGGING_EXIT( retVal );
 
         return retVal;
@@ -2835,7 +2867,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clGetKernelArgInfo)(
             param_value_size_ret );
 
         CPU_PERFORMANCE_TIMING_END();
-        CHECK_ERROR( retVal );
+        CHECK_ERROR_KERNEL( retVal, kernel );
         CALL_LOGGING_EXIT( retVal );
 
         return retVal;
@@ -2873,7 +2905,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clGetKernelWorkGroupInfo)(
             param_value_size_ret );
 
         CPU_PERFORMANCE_TIMING_END();
-        CHECK_ERROR( retVal );
+        CHECK_ERROR_KERNEL( retVal, kernel );
         CALL_LOGGING_EXIT( retVal );
 
         return retVal;
@@ -2905,6 +2937,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clWaitForEvents)(
         CALL_LOGGING_ENTER( "event_list = %s",
             eventList.c_str() );
         CHECK_EVENT_LIST( num_events, event_list, NULL );
+        HOST_BLOCKING_TIME_WAIT_START( num_events, event_list );
+        REDUNDANT_SYNC_CHECK_WAIT_START( num_events, event_list );
+        SUBMIT_LATENCY_CHECK_WAIT( num_events, event_list );
         CPU_PERFORMANCE_TIMING_START();
 
         cl_int  retVal = pIntercept->dispatch().clWaitForEvents(
@@ -2912,6 +2947,8 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clWaitForEvents)(
             event_list );
 
         CPU_PERFORMANCE_TIMING_END();
+        HOST_BLOCKING_TIME_END( true, NULL );
+        REDUNDANT_SYNC_CHECK_WAIT_END();
         CHECK_ERROR( retVal );
         CALL_LOGGING_EXIT( retVal );
 
@@ -3180,12 +3217,15 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clFlush)(
     {
         GET_ENQUEUE_COUNTER();
         CALL_LOGGING_ENTER( "queue = %p", command_queue );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
+        SUBMIT_LATENCY_CHECK_FLUSH( command_queue, "clFlush" );
         CPU_PERFORMANCE_TIMING_START();
 
         cl_int  retVal = pIntercept->dispatch().clFlush(
             command_queue );
 
         CPU_PERFORMANCE_TIMING_END();
+        REDUNDANT_SYNC_CHECK_FLUSH( command_queue );
         CHECK_ERROR( retVal );
         CALL_LOGGING_EXIT( retVal );
 
@@ -3208,12 +3248,18 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clFinish)(
     {
         GET_ENQUEUE_COUNTER();
         CALL_LOGGING_ENTER( "queue = %p", command_queue );
+        HOST_BLOCKING_TIME_START( true, command_queue );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
+        SUBMIT_LATENCY_CHECK_FLUSH( command_queue, "clFinish" );
         CPU_PERFORMANCE_TIMING_START();
 
         cl_int  retVal = pIntercept->dispatch().clFinish(
             command_queue );
 
         CPU_PERFORMANCE_TIMING_END();
+        HOST_BLOCKING_TIME_END( true, NULL );
+        REDUNDANT_SYNC_CHECK_FINISH( command_queue );
+        AUTO_OUT_OF_ORDER_QUEUE_SYNC( command_queue );
         CHECK_ERROR( retVal );
         CALL_LOGGING_EXIT( retVal );
 
@@ -3246,6 +3292,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueReadBuffer)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, blocking_read );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, blocking_read );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -3265,11 +3314,43 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueReadBuffer)(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            HOST_BLOCKING_TIME_START( blocking_read, command_queue );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                blocking_read,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                readMem( buffer ).writePtr( ptr, cb ) );
             CPU_PERFORMANCE_TIMING_START();
 
             ITT_ADD_PARAM_AS_METADATA( blocking_read );
 
-            if( pIntercept->config().OverrideReadBuffer )
+            retVal = CL_INVALID_OPERATION;
+
+            // Staged transfers are split into chunks with separate events,
+            // so transfers that are timed on the device are not staged.
+            bool    staged = false;
+            if( pIntercept->config().PinnedStagingTransfers && !deviceTiming )
+            {
+                staged = pIntercept->stagedReadBuffer(
+                    command_queue,
+                    buffer,
+                    blocking_read,
+                    offset,
+                    cb,
+                    ptr,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    retVal );
+            }
+
+            if( staged )
+            {
+                // The read was staged.
+            }
+            else if( pIntercept->config().OverrideReadBuffer )
             {
                 retVal = pIntercept->ReadBuffer(
                     command_queue,
@@ -3297,6 +3378,10 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueReadBuffer)(
             }
 
             CPU_PERFORMANCE_TIMING_END();
+            HOST_BLOCKING_TIME_END( blocking_read, ( retVal == CL_SUCCESS && event ) ? event[0] : NULL );
+            REDUNDANT_SYNC_CHECK_BLOCKING_READ( blocking_read );
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
+            ZERO_COPY_CHECK_TRANSFER( retVal == CL_SUCCESS, buffer, ptr, cb, true );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -3345,6 +3430,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueReadBufferRect)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, blocking_read );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, blocking_read );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -3377,6 +3465,14 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueReadBufferRect)(
             }
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            HOST_BLOCKING_TIME_START( blocking_read, command_queue );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                blocking_read,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                readMem( buffer ).fullBarrier() );
             CPU_PERFORMANCE_TIMING_START();
 
             ITT_ADD_PARAM_AS_METADATA( blocking_read );
@@ -3398,6 +3494,10 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueReadBufferRect)(
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            HOST_BLOCKING_TIME_END( blocking_read, ( retVal == CL_SUCCESS && event ) ? event[0] : NULL );
+            REDUNDANT_SYNC_CHECK_BLOCKING_READ( blocking_read );
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
+            ZERO_COPY_CHECK_TRANSFER( retVal == CL_SUCCESS, buffer, ptr, region[0] * region[1] * region[2], true );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -3440,6 +3540,8 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueWriteBuffer)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, blocking_write );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, blocking_write );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -3459,11 +3561,59 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueWriteBuffer)(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            HOST_BLOCKING_TIME_START( blocking_write, command_queue );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                blocking_write,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                writeMem( buffer ).readPtr( ptr, cb ) );
             CPU_PERFORMANCE_TIMING_START();
 
             ITT_ADD_PARAM_AS_METADATA( blocking_write );
 
-            if( pIntercept->config().OverrideWriteBuffer )
+            retVal = CL_INVALID_OPERATION;
+
+            if( pIntercept->config().CoalesceBufferWrites )
+            {
+                // Only request an event for a combined write if the
+                // application requested one.  Writes with a wait list are
+                // never combined, so only the number of events is needed.
+                retVal = pIntercept->coalesceWriteBuffer(
+                    command_queue,
+                    buffer,
+                    blocking_write,
+                    offset,
+                    cb,
+                    ptr,
+                    num_events_in_wait_list,
+                    retainAppEvent ? event : NULL );
+            }
+            // Staged transfers are split into chunks with separate events,
+            // so transfers that are timed on the device are not staged.
+            bool    staged = false;
+            if( ( retVal != CL_SUCCESS ) &&
+                pIntercept->config().PinnedStagingTransfers && !deviceTiming )
+            {
+                staged = pIntercept->stagedWriteBuffer(
+                    command_queue,
+                    buffer,
+                    blocking_write,
+                    offset,
+                    cb,
+                    ptr,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    retVal );
+            }
+
+            if( retVal == CL_SUCCESS || staged )
+            {
+                // The write was combined with other writes or staged.
+            }
+            else if( pIntercept->config().OverrideWriteBuffer )
             {
                 retVal = pIntercept->WriteBuffer(
                     command_queue,
@@ -3491,6 +3641,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueWriteBuffer)(
             }
 
             CPU_PERFORMANCE_TIMING_END();
+            HOST_BLOCKING_TIME_END( blocking_write, ( retVal == CL_SUCCESS && event ) ? event[0] : NULL );
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
+            ZERO_COPY_CHECK_TRANSFER( retVal == CL_SUCCESS, buffer, ptr, cb, false );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -3539,6 +3692,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueWriteBufferRect)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, blocking_write );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, blocking_write );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -3571,6 +3727,14 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueWriteBufferRect)(
             }
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            HOST_BLOCKING_TIME_START( blocking_write, command_queue );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                blocking_write,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                writeMem( buffer ).fullBarrier() );
             CPU_PERFORMANCE_TIMING_START();
 
             ITT_ADD_PARAM_AS_METADATA( blocking_write );
@@ -3592,6 +3756,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueWriteBufferRect)(
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            HOST_BLOCKING_TIME_END( blocking_write, ( retVal == CL_SUCCESS && event ) ? event[0] : NULL );
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
+            ZERO_COPY_CHECK_TRANSFER( retVal == CL_SUCCESS, buffer, ptr, region[0] * region[1] * region[2], false );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -3635,6 +3802,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueFillBuffer)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -3652,6 +3822,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueFillBuffer)(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                writeMem( buffer ) );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueFillBuffer(
@@ -3666,6 +3843,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueFillBuffer)(
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -3703,6 +3881,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyBuffer)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -3721,6 +3902,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyBuffer)(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                readMem( src_buffer ).writeMem( dst_buffer ) );
             CPU_PERFORMANCE_TIMING_START();
 
             if( pIntercept->config().OverrideCopyBuffer )
@@ -3751,6 +3939,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyBuffer)(
             }
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -3793,6 +3982,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyBufferRect)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -3823,6 +4015,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyBufferRect)(
             }
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                readMem( src_buffer ).writeMem( dst_buffer ) );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueCopyBufferRect(
@@ -3841,6 +4040,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyBufferRect)(
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -3880,6 +4080,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueReadImage)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, blocking_read );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, blocking_read );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -3913,6 +4116,14 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueReadImage)(
             }
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            HOST_BLOCKING_TIME_START( blocking_read, command_queue );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                blocking_read,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                readMem( image ).fullBarrier() );
             CPU_PERFORMANCE_TIMING_START();
 
             ITT_ADD_PARAM_AS_METADATA( blocking_read );
@@ -3949,6 +4160,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueReadImage)(
             }
 
             CPU_PERFORMANCE_TIMING_END();
+            HOST_BLOCKING_TIME_END( blocking_read, ( retVal == CL_SUCCESS && event ) ? event[0] : NULL );
+            REDUNDANT_SYNC_CHECK_BLOCKING_READ( blocking_read );
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -3993,6 +4207,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueWriteImage)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, blocking_write );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, blocking_write );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -4010,6 +4227,14 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueWriteImage)(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            HOST_BLOCKING_TIME_START( blocking_write, command_queue );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                blocking_write,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                writeMem( image ).fullBarrier() );
             CPU_PERFORMANCE_TIMING_START();
 
             ITT_ADD_PARAM_AS_METADATA( blocking_write );
@@ -4046,6 +4271,8 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueWriteImage)(
             }
 
             CPU_PERFORMANCE_TIMING_END();
+            HOST_BLOCKING_TIME_END( blocking_write, ( retVal == CL_SUCCESS && event ) ? event[0] : NULL );
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -4088,6 +4315,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueFillImage)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -4102,6 +4332,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueFillImage)(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                writeMem( image ) );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueFillImage(
@@ -4115,6 +4352,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueFillImage)(
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -4152,6 +4390,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyImage)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -4167,6 +4408,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyImage)(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                readMem( src_image ).writeMem( dst_image ) );
             CPU_PERFORMANCE_TIMING_START();
 
             if( pIntercept->config().OverrideCopyImage )
@@ -4197,6 +4445,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyImage)(
             }
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -4234,6 +4483,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyImageToBuffer)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -4249,6 +4501,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyImageToBuffer)(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                readMem( src_image ).writeMem( dst_buffer ) );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueCopyImageToBuffer(
@@ -4263,6 +4522,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyImageToBuffer)(
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -4300,6 +4560,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyBufferToImage)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -4315,6 +4578,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyBufferToImage)(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                readMem( src_buffer ).writeMem( dst_image ) );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueCopyBufferToImage(
@@ -4329,6 +4599,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueCopyBufferToImage)(
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -4367,6 +4638,9 @@ CL_API_ENTRY void* CL_API_CALL CLIRN(clEnqueueMapBuffer)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, blocking_map );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, blocking_map );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -4400,6 +4674,14 @@ CL_API_ENTRY void* CL_API_CALL CLIRN(clEnqueueMapBuffer)(
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
             CHECK_ERROR_INIT( errcode_ret );
+            HOST_BLOCKING_TIME_START( blocking_map, command_queue );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                blocking_map,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                mapMem( buffer, map_flags ) );
             CPU_PERFORMANCE_TIMING_START();
 
             ITT_ADD_PARAM_AS_METADATA( blocking_map );
@@ -4417,8 +4699,12 @@ CL_API_ENTRY void* CL_API_CALL CLIRN(clEnqueueMapBuffer)(
                 errcode_ret );
 
             CPU_PERFORMANCE_TIMING_END();
+            HOST_BLOCKING_TIME_END( blocking_map, ( retVal != NULL && event ) ? event[0] : NULL );
+            AUTO_OUT_OF_ORDER_END( retVal != NULL, event );
+            ZERO_COPY_CHECK_MAP( retVal != NULL, buffer, cb );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             DUMP_BUFFER_AFTER_MAP( command_queue, buffer, blocking_map, map_flags, retVal, offset, cb );
+            MAP_ACCESS_TRACKING_MAP( buffer, blocking_map, map_flags, retVal, cb );
             CHECK_ERROR( errcode_ret[0] );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
             if( pIntercept->config().CallLogging )
@@ -4475,6 +4761,9 @@ CL_API_ENTRY void* CL_API_CALL CLIRN(clEnqueueMapImage)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, blocking_map );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, blocking_map );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -4524,6 +4813,14 @@ CL_API_ENTRY void* CL_API_CALL CLIRN(clEnqueueMapImage)(
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
             CHECK_ERROR_INIT( errcode_ret );
+            HOST_BLOCKING_TIME_START( blocking_map, command_queue );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                blocking_map,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                mapMem( image, map_flags ) );
             CPU_PERFORMANCE_TIMING_START();
 
             ITT_ADD_PARAM_AS_METADATA( blocking_map );
@@ -4543,6 +4840,8 @@ CL_API_ENTRY void* CL_API_CALL CLIRN(clEnqueueMapImage)(
                 errcode_ret );
 
             CPU_PERFORMANCE_TIMING_END();
+            HOST_BLOCKING_TIME_END( blocking_map, ( retVal != NULL && event ) ? event[0] : NULL );
+            AUTO_OUT_OF_ORDER_END( retVal != NULL, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( errcode_ret[0] );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -4593,8 +4892,12 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueUnmapMemObject)(
         cl_int  retVal = CL_SUCCESS;
 
         INCREMENT_ENQUEUE_COUNTER();
+        MAP_ACCESS_TRACKING_UNMAP( memobj, mapped_ptr );
         DUMP_BUFFER_BEFORE_UNMAP( memobj, command_queue );
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -4623,6 +4926,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueUnmapMemObject)(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                writeMem( memobj ) );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueUnmapMemObject(
@@ -4634,6 +4944,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueUnmapMemObject)(
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -4680,6 +4991,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueMigrateMemObjects)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -4696,6 +5010,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueMigrateMemObjects)(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                fullBarrier() );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueMigrateMemObjects(
@@ -4708,6 +5029,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueMigrateMemObjects)(
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -4742,7 +5064,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueNDRangeKernel)(
     {
         cl_int  retVal = CL_SUCCESS;
 
-        INCREMENT_ENQUEUE_COUNTER();
+        INCREMENT_ENQUEUE_COUNTER_KERNEL( kernel );
         DUMP_BUFFERS_BEFORE_ENQUEUE( kernel, command_queue );
         DUMP_IMAGES_BEFORE_ENQUEUE( kernel, command_queue );
         CHECK_AUBCAPTURE_START_KERNEL(
@@ -4751,6 +5073,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueNDRangeKernel)(
             global_work_size,
             local_work_size,
             command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -4786,6 +5111,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueNDRangeKernel)(
 
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                useKernel( kernel ) );
             CPU_PERFORMANCE_TIMING_START();
 
 //            ITT_ADD_PARAM_AS_METADATA(command_queue);
@@ -4836,6 +5168,20 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueNDRangeKernel)(
             }
 
             CPU_PERFORMANCE_TIMING_END_KERNEL(kernel);
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
+            STARTUP_PROFILE_KERNEL_ENQUEUE(
+                command_queue,
+                retVal == CL_SUCCESS );
+            REDUNDANT_KERNEL_CHECK(
+                retVal == CL_SUCCESS,
+                kernel,
+                work_dim,
+                global_work_offset,
+                global_work_size,
+                local_work_size );
+            KERNEL_FOOTPRINT_CHECK(
+                retVal == CL_SUCCESS,
+                kernel );
             DEVICE_PERFORMANCE_TIMING_END_KERNEL(
                 command_queue,
                 event,
@@ -4844,7 +5190,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueNDRangeKernel)(
                 global_work_offset,
                 global_work_size,
                 local_work_size );
-            CHECK_ERROR( retVal );
+            CHECK_ERROR_KERNEL( retVal, kernel );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
             CALL_LOGGING_EXIT_KERNEL_EVENT( retVal, kernel, event );
             ADD_EVENT( event ? event[0] : NULL );
@@ -4852,6 +5198,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueNDRangeKernel)(
 
         DUMP_BUFFERS_AFTER_ENQUEUE( kernel, command_queue );
         DUMP_IMAGES_AFTER_ENQUEUE( kernel, command_queue );
+        KERNEL_ANOMALY_DUMP_BUFFERS( kernel, command_queue );
         FINISH_OR_FLUSH_AFTER_ENQUEUE( command_queue );
         CHECK_AUBCAPTURE_STOP( command_queue );
 
@@ -4876,8 +5223,11 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueTask)(
     {
         cl_int  retVal = CL_SUCCESS;
 
-        INCREMENT_ENQUEUE_COUNTER();
+        INCREMENT_ENQUEUE_COUNTER_KERNEL( kernel );
         CHECK_AUBCAPTURE_START_KERNEL( kernel, 0, NULL, NULL, command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -4894,6 +5244,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueTask)(
                 eventWaitListString.c_str());
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                useKernel( kernel ) );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueTask(
@@ -4904,6 +5261,20 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueTask)(
                 event );
 
             CPU_PERFORMANCE_TIMING_END_KERNEL(kernel);
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
+            STARTUP_PROFILE_KERNEL_ENQUEUE(
+                command_queue,
+                retVal == CL_SUCCESS );
+            REDUNDANT_KERNEL_CHECK(
+                retVal == CL_SUCCESS,
+                kernel,
+                0,
+                NULL,
+                NULL,
+                NULL );
+            KERNEL_FOOTPRINT_CHECK(
+                retVal == CL_SUCCESS,
+                kernel );
             DEVICE_PERFORMANCE_TIMING_END_KERNEL(
                 command_queue,
                 event,
@@ -4912,12 +5283,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueTask)(
                 NULL,
                 NULL,
                 NULL );
-            CHECK_ERROR( retVal );
+            CHECK_ERROR_KERNEL( retVal, kernel );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
             CALL_LOGGING_EXIT_KERNEL_EVENT( retVal, kernel, event );
             ADD_EVENT( event ? event[0] : NULL );
         }
 
+        KERNEL_ANOMALY_DUMP_BUFFERS( kernel, command_queue );
         FINISH_OR_FLUSH_AFTER_ENQUEUE( command_queue );
         CHECK_AUBCAPTURE_STOP( command_queue );
 
@@ -4949,6 +5321,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueNativeKernel)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -4956,6 +5331,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueNativeKernel)(
                 command_queue );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                fullBarrier() );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueNativeKernel(
@@ -4971,6 +5353,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueNativeKernel)(
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -5001,6 +5384,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueMarker)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -5045,6 +5431,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueWaitForEvents)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -5100,6 +5489,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueBarrier)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -5111,6 +5503,8 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueBarrier)(
                 command_queue );
 
             CPU_PERFORMANCE_TIMING_END();
+            REDUNDANT_SYNC_CHECK_BARRIER( command_queue, 0, NULL, NULL );
+            AUTO_OUT_OF_ORDER_QUEUE_SYNC( command_queue );
             CHECK_ERROR( retVal );
             CALL_LOGGING_EXIT( retVal );
         }
@@ -5142,6 +5536,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueMarkerWithWaitList)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -5154,6 +5551,14 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueMarkerWithWaitList)(
                 command_queue,
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
+            AUTO_OUT_OF_ORDER_START_APP_EVENT(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                event != NULL,
+                marker() );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueMarkerWithWaitList(
@@ -5163,6 +5568,8 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueMarkerWithWaitList)(
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
+            REDUNDANT_SYNC_CHECK_BARRIER( command_queue, num_events_in_wait_list, event_wait_list, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
             CALL_LOGGING_EXIT_EVENT( retVal, event );
@@ -5195,6 +5602,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueBarrierWithWaitList)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -5207,6 +5617,14 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueBarrierWithWaitList)(
                 command_queue,
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
+            AUTO_OUT_OF_ORDER_START_APP_EVENT(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                event != NULL,
+                queueBarrier() );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueBarrierWithWaitList(
@@ -5216,6 +5634,8 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueBarrierWithWaitList)(
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
+            REDUNDANT_SYNC_CHECK_BARRIER( command_queue, num_events_in_wait_list, event_wait_list, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
             CALL_LOGGING_EXIT_EVENT( retVal, event );
@@ -5408,6 +5828,9 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueWaitSemaphoresKHR(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
@@ -5416,6 +5839,13 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueWaitSemaphoresKHR(
                     num_sema_objects );
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueWaitSemaphoresKHR(
@@ -5428,6 +5858,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueWaitSemaphoresKHR(
                     event );
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -5467,6 +5898,9 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueSignalSemaphoresKHR(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
@@ -5475,6 +5909,13 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueSignalSemaphoresKHR(
                     num_sema_objects );
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueSignalSemaphoresKHR(
@@ -5487,6 +5928,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueSignalSemaphoresKHR(
                     event );
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -6071,6 +6513,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueAcquireGLObjects)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -6085,6 +6530,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueAcquireGLObjects)(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                fullBarrier() );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueAcquireGLObjects(
@@ -6096,6 +6548,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueAcquireGLObjects)(
                 event);
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -6138,6 +6591,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueReleaseGLObjects)(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -6152,6 +6608,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueReleaseGLObjects)(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                fullBarrier() );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueReleaseGLObjects(
@@ -6163,6 +6626,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueReleaseGLObjects)(
                 event);
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -6210,7 +6674,7 @@ CL_API_ENTRY void* CL_API_CALL CLIRN(clSVMAlloc) (
             alignment );
 
         CPU_PERFORMANCE_TIMING_END();
-        ADD_SVM_ALLOCATION( retVal, size );
+        ADD_SVM_ALLOCATION( retVal, size, ( flags & CL_MEM_SVM_FINE_GRAIN_BUFFER ) != 0 );
         // There is no error code returned from clSVMAlloc(), so strictly
         // speaking we have no error to "check" here.  Still, we'll invent
         // one if clSVMAlloc() returned NULL, so something will get logged
@@ -6278,6 +6742,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMFree) (
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -6292,6 +6759,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMFree) (
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                fullBarrier() );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueSVMFree(
@@ -6305,6 +6779,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMFree) (
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -6342,6 +6817,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMMemcpy) (
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, blocking_copy );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, blocking_copy );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -6359,6 +6837,14 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMMemcpy) (
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            HOST_BLOCKING_TIME_START( blocking_copy, command_queue );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                blocking_copy,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                readPtr( src_ptr, size ).writePtr( dst_ptr, size ) );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueSVMMemcpy(
@@ -6372,6 +6858,8 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMMemcpy) (
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            HOST_BLOCKING_TIME_END( blocking_copy, ( retVal == CL_SUCCESS && event ) ? event[0] : NULL );
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -6409,6 +6897,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMMemFill) (
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -6425,6 +6916,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMMemFill) (
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                writePtr( svm_ptr, size ) );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueSVMMemFill(
@@ -6438,6 +6936,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMMemFill) (
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -6475,6 +6974,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMMap) (
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, blocking_map );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, blocking_map );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -6493,6 +6995,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMMap) (
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                blocking_map,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                mapPtr( svm_ptr, size, map_flags ) );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueSVMMap(
@@ -6506,6 +7015,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMMap) (
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -6540,6 +7050,9 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMUnmap) (
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -6554,6 +7067,13 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMUnmap) (
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                writePtr( svm_ptr, 0 ) );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueSVMUnmap(
@@ -6564,6 +7084,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clEnqueueSVMUnmap) (
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -6608,7 +7129,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clSetKernelArgSVMPointer) (
             arg_value );
 
         CPU_PERFORMANCE_TIMING_END();
-        CHECK_ERROR( retVal );
+        CHECK_ERROR_KERNEL( retVal, kernel );
         CALL_LOGGING_EXIT( retVal );
 
         return retVal;
@@ -6657,7 +7178,8 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clSetKernelExecInfo) (
         }
 
         CPU_PERFORMANCE_TIMING_END();
-        CHECK_ERROR( retVal );
+        CHECK_ERROR_KERNEL( retVal, kernel );
+        AUTO_OUT_OF_ORDER_KERNEL_EXEC_INFO( kernel );
         CALL_LOGGING_EXIT( retVal );
 
         return retVal;
@@ -6783,6 +7305,7 @@ CL_API_ENTRY cl_command_queue CL_API_CALL CLIRN(clCreateCommandQueueWithProperti
             deviceInfo.c_str(),
             propsStr.c_str() );
         DUMMY_COMMAND_QUEUE( context, device );
+        AUTO_OUT_OF_ORDER_QUEUE_INIT( properties );
         CREATE_COMMAND_QUEUE_OVERRIDE_INIT( device, properties, newProperties );
         CHECK_ERROR_INIT( errcode_ret );
         CPU_PERFORMANCE_TIMING_START();
@@ -6832,6 +7355,7 @@ CL_API_ENTRY cl_command_queue CL_API_CALL CLIRN(clCreateCommandQueueWithProperti
         ADD_OBJECT_ALLOCATION( retVal );
         CALL_LOGGING_EXIT( errcode_ret[0], "returned %p", retVal );
         ADD_QUEUE( context, retVal );
+        ADD_AUTO_OUT_OF_ORDER_QUEUE( retVal );
         QUEUE_INFO_LOGGING( device, retVal );
 
         return retVal;
@@ -6879,6 +7403,7 @@ CL_API_ENTRY cl_command_queue CL_API_CALL clCreateCommandQueueWithPropertiesKHR(
                 deviceInfo.c_str(),
                 propsStr.c_str() );
             DUMMY_COMMAND_QUEUE( context, device );
+            AUTO_OUT_OF_ORDER_QUEUE_INIT( properties );
             CREATE_COMMAND_QUEUE_OVERRIDE_INIT( device, properties, newProperties );
             CHECK_ERROR_INIT( errcode_ret );
             CPU_PERFORMANCE_TIMING_START();
@@ -6928,6 +7453,7 @@ CL_API_ENTRY cl_command_queue CL_API_CALL clCreateCommandQueueWithPropertiesKHR(
             ADD_OBJECT_ALLOCATION( retVal );
             CALL_LOGGING_EXIT( errcode_ret[0], "returned %p", retVal );
             ADD_QUEUE( context, retVal );
+            ADD_AUTO_OUT_OF_ORDER_QUEUE( retVal );
             QUEUE_INFO_LOGGING( device, retVal );
 
             return retVal;
@@ -7108,6 +7634,7 @@ CL_API_ENTRY cl_program CL_API_CALL CLIRN(clCreateProgramWithIL) (
         CPU_PERFORMANCE_TIMING_END();
         CHECK_ERROR( errcode_ret[0] );
         ADD_OBJECT_ALLOCATION( retVal );
+        ADD_RECYCLED_KERNELS_PROGRAM_REF( retVal );
         CALL_LOGGING_EXIT( errcode_ret[0], "returned %p", retVal );
 
         DUMP_PROGRAM_SPIRV( retVal, length, il, hash );
@@ -7195,6 +7722,7 @@ CL_API_ENTRY cl_kernel CL_API_CALL CLIRN(clCloneKernel) (
 
         CPU_PERFORMANCE_TIMING_END();
         CHECK_ERROR( errcode_ret[0] );
+        CLONE_KERNEL_ARGS( source_kernel, retVal );
         CALL_LOGGING_EXIT( errcode_ret[0], "returned %p", retVal );
 
         return retVal;
@@ -7235,7 +7763,7 @@ CL_API_ENTRY cl_int CL_API_CALL CLIRN(clGetKernelSubGroupInfo) (
             param_value_size_ret );
 
         CPU_PERFORMANCE_TIMING_END();
-        CHECK_ERROR( retVal );
+        CHECK_ERROR_KERNEL( retVal, kernel );
         CALL_LOGGING_EXIT( retVal );
 
         return retVal;
@@ -7280,7 +7808,7 @@ CL_API_ENTRY cl_int CL_API_CALL clGetKernelSubGroupInfoKHR(
                 param_value_size_ret );
 
             CPU_PERFORMANCE_TIMING_END();
-            CHECK_ERROR( retVal );
+            CHECK_ERROR_KERNEL( retVal, kernel );
             CALL_LOGGING_EXIT( retVal );
 
             return retVal;
@@ -7311,6 +7839,9 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMigrateMem(
 
         INCREMENT_ENQUEUE_COUNTER();
         CHECK_AUBCAPTURE_START( command_queue );
+        REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+        FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
         if( pIntercept->config().NullEnqueue == false )
         {
@@ -7327,6 +7858,13 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMigrateMem(
                 eventWaitListString.c_str() );
             CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
             DEVICE_PERFORMANCE_TIMING_START( event );
+            AUTO_OUT_OF_ORDER_START(
+                command_queue,
+                CL_FALSE,
+                num_events_in_wait_list,
+                event_wait_list,
+                event,
+                fullBarrier() );
             CPU_PERFORMANCE_TIMING_START();
 
             retVal = pIntercept->dispatch().clEnqueueSVMMigrateMem(
@@ -7340,6 +7878,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMigrateMem(
                 event );
 
             CPU_PERFORMANCE_TIMING_END();
+            AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
             DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
             CHECK_ERROR( retVal );
             ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -7377,12 +7916,22 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireExternalMemObjectsKHR(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( command_queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
                 CALL_LOGGING_ENTER();
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    command_queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueAcquireExternalMemObjectsKHR(
@@ -7394,6 +7943,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireExternalMemObjectsKHR(
                     event);
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -7433,12 +7983,22 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseExternalMemObjectsKHR(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( command_queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
                 CALL_LOGGING_ENTER();
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    command_queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueReleaseExternalMemObjectsKHR(
@@ -7450,6 +8010,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseExternalMemObjectsKHR(
                     event);
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -7764,12 +8325,22 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireD3D10ObjectsKHR(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( command_queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
                 CALL_LOGGING_ENTER();
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    command_queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueAcquireD3D10ObjectsKHR(
@@ -7781,6 +8352,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireD3D10ObjectsKHR(
                     event);
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -7820,12 +8392,22 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseD3D10ObjectsKHR(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( command_queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
                 CALL_LOGGING_ENTER();
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    command_queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueReleaseD3D10ObjectsKHR(
@@ -7837,6 +8419,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseD3D10ObjectsKHR(
                     event);
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -8069,12 +8652,22 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireD3D11ObjectsKHR(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( command_queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
                 CALL_LOGGING_ENTER();
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    command_queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueAcquireD3D11ObjectsKHR(
@@ -8086,6 +8679,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireD3D11ObjectsKHR(
                     event);
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -8125,12 +8719,22 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseD3D11ObjectsKHR(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( command_queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
                 CALL_LOGGING_ENTER();
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    command_queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueReleaseD3D11ObjectsKHR(
@@ -8142,6 +8746,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseD3D11ObjectsKHR(
                     event);
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -8286,12 +8891,22 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireDX9MediaSurfacesKHR(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( command_queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
                 CALL_LOGGING_ENTER();
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    command_queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueAcquireDX9MediaSurfacesKHR(
@@ -8303,6 +8918,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireDX9MediaSurfacesKHR(
                     event);
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -8342,12 +8958,22 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseDX9MediaSurfacesKHR(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( command_queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
                 CALL_LOGGING_ENTER();
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    command_queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueReleaseDX9MediaSurfacesKHR(
@@ -8359,6 +8985,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseDX9MediaSurfacesKHR(
                     event);
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -8503,12 +9130,22 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireDX9ObjectsINTEL(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( command_queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
                 CALL_LOGGING_ENTER();
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    command_queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueAcquireDX9ObjectsINTEL(
@@ -8520,6 +9157,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireDX9ObjectsINTEL(
                     event);
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -8559,12 +9197,22 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseDX9ObjectsINTEL(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( command_queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
                 CALL_LOGGING_ENTER();
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    command_queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueReleaseDX9ObjectsINTEL(
@@ -8576,6 +9224,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseDX9ObjectsINTEL(
                     event);
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -8735,7 +9384,7 @@ CL_API_ENTRY cl_int CL_API_CALL clGetKernelSuggestedLocalWorkSizeKHR(
                 suggestedLocalWorkSize );
 
             CPU_PERFORMANCE_TIMING_END();
-            CHECK_ERROR( retVal );
+            CHECK_ERROR_KERNEL( retVal, kernel );
             CALL_LOGGING_EXIT( retVal );
 
             return retVal;
@@ -8781,7 +9430,7 @@ CL_API_ENTRY cl_int CL_API_CALL clGetKernelSuggestedLocalWorkSizeINTEL(
                 suggestedLocalWorkSize );
 
             CPU_PERFORMANCE_TIMING_END();
-            CHECK_ERROR( retVal );
+            CHECK_ERROR_KERNEL( retVal, kernel );
             CALL_LOGGING_EXIT( retVal );
 
             return retVal;
@@ -9098,12 +9747,22 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireVA_APIMediaSurfacesINTEL(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( command_queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
                 CALL_LOGGING_ENTER();
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    command_queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueAcquireVA_APIMediaSurfacesINTEL(
@@ -9115,6 +9774,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireVA_APIMediaSurfacesINTEL(
                     event);
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -9154,12 +9814,22 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseVA_APIMediaSurfacesINTEL(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( command_queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
                 CALL_LOGGING_ENTER();
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    command_queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueReleaseVA_APIMediaSurfacesINTEL(
@@ -9171,6 +9841,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseVA_APIMediaSurfacesINTEL(
                     event);
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -9477,7 +10148,7 @@ CL_API_ENTRY void* CL_API_CALL clHostMemAllocINTEL(
             }
 
             CPU_PERFORMANCE_TIMING_END();
-            ADD_USM_ALLOCATION( retVal, size );
+            ADD_USM_ALLOCATION( retVal, size, true );
             USM_ALLOC_PROPERTIES_CLEANUP( newProperties );
             CHECK_ERROR( errcode_ret[0] );
             CALL_LOGGING_EXIT( errcode_ret[0], "returned %p", retVal );
@@ -9553,7 +10224,7 @@ CL_API_ENTRY void* CL_API_CALL clDeviceMemAllocINTEL(
             }
 
             CPU_PERFORMANCE_TIMING_END();
-            ADD_USM_ALLOCATION( retVal, size );
+            ADD_USM_ALLOCATION( retVal, size, false );
             USM_ALLOC_PROPERTIES_CLEANUP( newProperties );
             CHECK_ERROR( errcode_ret[0] );
             CALL_LOGGING_EXIT( errcode_ret[0], "returned %p", retVal );
@@ -9629,7 +10300,7 @@ CL_API_ENTRY void* CL_API_CALL clSharedMemAllocINTEL(
             }
 
             CPU_PERFORMANCE_TIMING_END();
-            ADD_USM_ALLOCATION( retVal, size );
+            ADD_USM_ALLOCATION( retVal, size, true );
             USM_ALLOC_PROPERTIES_CLEANUP( newProperties );
             CHECK_ERROR( errcode_ret[0] );
             CALL_LOGGING_EXIT( errcode_ret[0], "returned %p", retVal );
@@ -9791,7 +10462,7 @@ CL_API_ENTRY cl_int CL_API_CALL clSetKernelArgMemPointerINTEL(
                 arg_value );
 
             CPU_PERFORMANCE_TIMING_END();
-            CHECK_ERROR( retVal );
+            CHECK_ERROR_KERNEL( retVal, kernel );
             CALL_LOGGING_EXIT( retVal );
 
             return retVal;
@@ -9824,6 +10495,9 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMemsetINTEL(   // Deprecated
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
@@ -9840,6 +10514,13 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMemsetINTEL(   // Deprecated
                     eventWaitListString.c_str() );
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    writePtr( dst_ptr, size ) );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueMemsetINTEL(
@@ -9852,6 +10533,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMemsetINTEL(   // Deprecated
                     event );
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -9893,6 +10575,9 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMemFillINTEL(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
@@ -9909,6 +10594,13 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMemFillINTEL(
                     eventWaitListString.c_str() );
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    writePtr( dst_ptr, size ) );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueMemFillINTEL(
@@ -9922,6 +10614,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMemFillINTEL(
                     event );
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -9963,6 +10656,9 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMemcpyINTEL(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( queue, blocking );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( queue, blocking );
+            FLUSH_COALESCED_BUFFER_WRITES( queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
@@ -9980,6 +10676,13 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMemcpyINTEL(
                     eventWaitListString.c_str() );
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    queue,
+                    blocking,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    readPtr( src_ptr, size ).writePtr( dst_ptr, size ) );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueMemcpyINTEL(
@@ -9993,6 +10696,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMemcpyINTEL(
                     event );
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -10033,6 +10737,9 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMigrateMemINTEL(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
@@ -10050,6 +10757,13 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMigrateMemINTEL(
                     eventWaitListString.c_str() );
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    readPtr( ptr, size ) );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueMigrateMemINTEL(
@@ -10062,6 +10776,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMigrateMemINTEL(
                     event );
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -10102,6 +10817,9 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMemAdviseINTEL(
 
             INCREMENT_ENQUEUE_COUNTER();
             CHECK_AUBCAPTURE_START( queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
@@ -10119,6 +10837,13 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMemAdviseINTEL(
                     eventWaitListString.c_str() );
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    readPtr( ptr, size ) );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueMemAdviseINTEL(
@@ -10131,6 +10856,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueMemAdviseINTEL(
                     event );
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -10342,6 +11068,9 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueCommandBufferKHR(
             INCREMENT_ENQUEUE_COUNTER();
             COMMAND_BUFFER_GET_QUEUE( num_queues, queues, command_buffer );
             CHECK_AUBCAPTURE_START( command_queue );
+            REDUNDANT_SYNC_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            SUBMIT_LATENCY_CHECK_ENQUEUE( command_queue, CL_FALSE );
+            FLUSH_COALESCED_BUFFER_WRITES( command_queue );
 
             if( pIntercept->config().NullEnqueue == false )
             {
@@ -10356,6 +11085,13 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueCommandBufferKHR(
                     eventWaitListString.c_str() );
                 CHECK_EVENT_LIST( num_events_in_wait_list, event_wait_list, event );
                 DEVICE_PERFORMANCE_TIMING_START( event );
+                AUTO_OUT_OF_ORDER_START(
+                    command_queue,
+                    CL_FALSE,
+                    num_events_in_wait_list,
+                    event_wait_list,
+                    event,
+                    fullBarrier() );
                 CPU_PERFORMANCE_TIMING_START();
 
                 retVal = dispatchX.clEnqueueCommandBufferKHR(
@@ -10367,6 +11103,7 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueCommandBufferKHR(
                     event);
 
                 CPU_PERFORMANCE_TIMING_END();
+                AUTO_OUT_OF_ORDER_END( retVal == CL_SUCCESS, event );
                 DEVICE_PERFORMANCE_TIMING_END( command_queue, event );
                 CHECK_ERROR( retVal );
                 ADD_OBJECT_ALLOCATION( event ? event[0] : NULL );
@@ -10868,7 +11605,7 @@ CL_API_ENTRY cl_int CL_API_CALL clCommandNDRangeKernelKHR(
                 mutable_handle );
 
             CPU_PERFORMANCE_TIMING_END();
-            CHECK_ERROR( retVal );
+            CHECK_ERROR_KERNEL( retVal, kernel );
             CALL_LOGGING_EXIT( retVal );
 
             return retVal;
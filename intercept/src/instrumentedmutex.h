@@ -0,0 +1,190 @@
+/*
+// Copyright (c) 2018-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+// This is a mutex that optionally records how often it is acquired, how
+// often it is contended, and how long threads wait to acquire it, for each
+// call site.  Call sites are identified by a string literal, usually the
+// name of the function acquiring the mutex.  Statistics are keyed by the
+// site name, so identical names from different literals are combined, and
+// each literal is interned the first time it is seen so later acquisitions
+// do not need to compare strings.  Statistics are updated after the mutex
+// is acquired, so they are protected by the mutex itself, and they may
+// only be queried while holding the mutex.
+
+class CInstrumentedMutex
+{
+public:
+    struct SStats
+    {
+        SStats() :
+            NumberOfAcquisitions(0),
+            NumberOfContendedAcquisitions(0),
+            WaitNS(0),
+            MaxWaitNS(0) {}
+
+        uint64_t    NumberOfAcquisitions;
+        uint64_t    NumberOfContendedAcquisitions;
+        uint64_t    WaitNS;
+        uint64_t    MaxWaitNS;
+    };
+
+    typedef std::map< std::string, SStats > CStatsMap;
+
+    CInstrumentedMutex() :
+        m_Enabled(false) {}
+
+    // Note: Tracking should only be enabled before the mutex is used from
+    // multiple threads.
+    void    enable( bool enabled )
+    {
+        m_Enabled = enabled;
+    }
+    bool    enabled() const
+    {
+        return m_Enabled;
+    }
+
+    void    lock( const char* site )
+    {
+        if( !m_Enabled )
+        {
+            m_Mutex.lock();
+        }
+        else if( m_Mutex.try_lock() )
+        {
+            addAcquisition( site, false, 0 );
+        }
+        else
+        {
+            clock::time_point   start = clock::now();
+            m_Mutex.lock();
+            clock::time_point   end = clock::now();
+
+            addAcquisition(
+                site,
+                true,
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() );
+        }
+    }
+    void    lock()
+    {
+        lock( "(unknown)" );
+    }
+    bool    try_lock()
+    {
+        bool    success = m_Mutex.try_lock();
+        if( success && m_Enabled )
+        {
+            addAcquisition( "(unknown)", false, 0 );
+        }
+        return success;
+    }
+    void    unlock()
+    {
+        m_Mutex.unlock();
+    }
+
+    const CStatsMap&    getStats() const
+    {
+        return m_StatsMap;
+    }
+
+    // These are the statistics accumulated since the last call to
+    // resetIntervalStats(), for periodic reporting.
+    const SStats&   getIntervalStats() const
+    {
+        return m_IntervalStats;
+    }
+    void    resetIntervalStats()
+    {
+        m_IntervalStats = SStats();
+    }
+
+private:
+    typedef std::chrono::steady_clock   clock;
+
+    void    addAcquisition( const char* site, bool contended, uint64_t waitNS )
+    {
+        // Elements of a std::map are never moved, so the interned pointer
+        // to the statistics for a site remains valid.
+        SStats*&    siteStats = m_SiteMap[site];
+        if( siteStats == NULL )
+        {
+            siteStats = &m_StatsMap[site];
+        }
+
+        SStats* stats[] = { siteStats, &m_IntervalStats };
+        for( size_t s = 0; s < 2; s++ )
+        {
+            stats[s]->NumberOfAcquisitions++;
+            if( contended )
+            {
+                stats[s]->NumberOfContendedAcquisitions++;
+                stats[s]->WaitNS += waitNS;
+                stats[s]->MaxWaitNS = waitNS > stats[s]->MaxWaitNS ?
+                    waitNS : stats[s]->MaxWaitNS;
+            }
+        }
+    }
+
+    std::mutex  m_Mutex;
+    bool        m_Enabled;
+
+    typedef std::map< const char*, SStats* >    CSiteMap;
+
+    CSiteMap    m_SiteMap;
+    CStatsMap   m_StatsMap;
+    SStats      m_IntervalStats;
+};
+
+// This acquires an instrumented mutex for the lifetime of the object,
+// similar to std::lock_guard, and records the call site.
+
+class CInstrumentedLockGuard
+{
+public:
+    CInstrumentedLockGuard( CInstrumentedMutex& mutex, const char* site ) :
+        m_Mutex( mutex )
+    {
+        m_Mutex.lock( site );
+    }
+    ~CInstrumentedLockGuard()
+    {
+        m_Mutex.unlock();
+    }
+
+private:
+    CInstrumentedMutex& m_Mutex;
+
+    CInstrumentedLockGuard( const CInstrumentedLockGuard& );
+    CInstrumentedLockGuard& operator=( const CInstrumentedLockGuard& );
+};
@@ -21,14 +21,30 @@
 */
 
 #include <algorithm>
+#include <cmath>
 #include <errno.h>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
 #include <stdarg.h>
 #include <sstream>
+#include <thread>
 #include <time.h>       // strdate
 
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#endif
+
+#if defined(__linux__)
+#include <atomic>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
 #include "common.h"
 #include "emulate.h"
 #include "intercept.h"
@@ -87,6 +103,162 @@ const char* CLIntercept::sc_ReportFileName = "clintercept_report.txt";
 const char* CLIntercept::sc_LogFileName = "clintercept_log.txt";
 const char* CLIntercept::sc_DumpPerfCountersFileNamePrefix = "clintercept_perfcounter";
 const char* CLIntercept::sc_TraceFileName = "clintercept_trace.json";
+const char* CLIntercept::sc_RollingStatsFileName = "clintercept_rolling_stats.csv";
+
+#if defined(__linux__) || defined(__APPLE__)
+static volatile sig_atomic_t s_CaptureWindowSignalCount = 0;
+
+static void CaptureWindowSignalHandler( int )
+{
+    s_CaptureWindowSignalCount = s_CaptureWindowSignalCount + 1;
+}
+#else
+static const uint64_t s_CaptureWindowSignalCount = 0;
+#endif
+
+#if defined(__linux__)
+// This is the table of protected regions for MapAccessTracking.  It is
+// searched by the SIGSEGV handler, so it is a fixed-size table of atomics
+// rather than a map protected by the mutex.  Each page state is 0 if the
+// page has not been touched, 1 if it has been read, and 2 if it has been
+// written.  The page state storage for a slot only ever grows, and storage
+// that is replaced is kept until shutdown, since a signal handler in
+// another thread may still be referencing it.  The retired range is the
+// last region that was tracked in the slot, so a fault that was in flight
+// while the region was unprotected can be retried.
+struct SMapAccessRegion
+{
+    std::atomic<uintptr_t>  Begin;
+    std::atomic<uintptr_t>  End;
+    std::atomic<uintptr_t>  RetiredBegin;
+    std::atomic<uintptr_t>  RetiredEnd;
+    std::atomic<size_t>     Capacity;
+    std::atomic<uint8_t*>   PageState;
+};
+
+static const size_t     s_cMaxMapAccessRegions = 256;
+static SMapAccessRegion s_MapAccessRegions[s_cMaxMapAccessRegions];
+static std::vector<uint8_t*>    s_MapAccessRetiredPageStates;
+static uintptr_t        s_MapAccessPageSize = 4096;
+static struct sigaction s_MapAccessOldAction;
+static std::atomic<bool>    s_MapAccessHandlerInstalled(false);
+static std::atomic<bool>    s_MapAccessHandedOff(false);
+
+static void MapAccessUnprotectRegions()
+{
+    for( size_t i = 0; i < s_cMaxMapAccessRegions; i++ )
+    {
+        SMapAccessRegion&   region = s_MapAccessRegions[i];
+        const uintptr_t     begin = region.Begin.load( std::memory_order_acquire );
+        if( begin != 0 )
+        {
+            mprotect( (void*)begin, region.End.load() - begin, PROT_READ | PROT_WRITE );
+        }
+    }
+}
+
+static void MapAccessSignalHandler( int sig, siginfo_t* info, void* )
+{
+    const uintptr_t addr = (uintptr_t)info->si_addr;
+
+    for( size_t i = 0; i < s_cMaxMapAccessRegions; i++ )
+    {
+        SMapAccessRegion&   region = s_MapAccessRegions[i];
+        const uintptr_t     begin = region.Begin.load( std::memory_order_acquire );
+        if( begin != 0 && addr >= begin && addr < region.End.load() )
+        {
+            // The first fault on a page is a read or a write.  Allow reads,
+            // and if the access was a write it will fault again.
+            const size_t    page = ( addr - begin ) / s_MapAccessPageSize;
+            const size_t    capacity = region.Capacity.load( std::memory_order_acquire );
+            uint8_t*        pageState = region.PageState.load( std::memory_order_acquire );
+            void*           pageAddr = (void*)( begin + page * s_MapAccessPageSize );
+            if( page >= capacity )
+            {
+                // The slot was reused while this fault was in flight.
+                return;
+            }
+            if( pageState[page] == 0 )
+            {
+                pageState[page] = 1;
+                mprotect( pageAddr, s_MapAccessPageSize, PROT_READ );
+            }
+            else
+            {
+                pageState[page] = 2;
+                mprotect( pageAddr, s_MapAccessPageSize, PROT_READ | PROT_WRITE );
+            }
+            return;
+        }
+    }
+
+    // The region may have been unprotected while this fault was in flight,
+    // so retry the access.
+    for( size_t i = 0; i < s_cMaxMapAccessRegions; i++ )
+    {
+        SMapAccessRegion&   region = s_MapAccessRegions[i];
+        if( info->si_code == SEGV_ACCERR &&
+            addr >= region.RetiredBegin.load() &&
+            addr < region.RetiredEnd.load() )
+        {
+            return;
+        }
+    }
+
+    // This fault is not for a tracked region, so hand it back to the
+    // previous handler.  Calling the previous handler directly would ignore
+    // its flags and signal mask, so instead stop tracking, unprotect all
+    // tracked regions, and restore the previous action.  When this handler
+    // returns, the faulting instruction will fault again, and the signal
+    // will be delivered as if this handler had never been installed.
+    s_MapAccessHandedOff.store( true );
+    MapAccessUnprotectRegions();
+    sigaction( sig, &s_MapAccessOldAction, NULL );
+}
+#endif
+
+// These functions maintain a histogram of durations with power-of-two
+// buckets, so percentiles can be estimated in constant space.  Bucket b
+// holds durations in [2^b, 2^(b+1)), and the last bucket holds all longer
+// durations.
+static void AddLog2Histogram(
+    uint32_t* histogram,
+    int numBuckets,
+    uint64_t value )
+{
+    int bucket = 0;
+    while( value > 1 && bucket < numBuckets - 1 )
+    {
+        value >>= 1;
+        bucket++;
+    }
+    histogram[bucket]++;
+}
+
+static uint64_t GetLog2HistogramPercentile(
+    const uint32_t* histogram,
+    int numBuckets,
+    uint64_t count,
+    uint64_t percent )
+{
+    if( count == 0 )
+    {
+        return 0;
+    }
+
+    // Estimate the percentile from the histogram, using the midpoint of the
+    // bucket containing the percentile.
+    uint64_t    sum = 0;
+    for( int b = 0; b < numBuckets; b++ )
+    {
+        sum += histogram[b];
+        if( sum * 100 >= count * percent )
+        {
+            return b == 0 ? 1 : ( (uint64_t)3 << b ) / 2;
+        }
+    }
+    return 0;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 //
@@ -139,11 +311,37 @@ CLIntercept::CLIntercept( void* pGlobalData )
 
     m_QueueNumber = 0;
     m_MemAllocNumber = 0;
+    m_WriteGeneration = 0;
+    m_StartupProgramBuilds = 0;
+    m_StartupKernelEnqueued = false;
+    m_StartupProfileComplete = false;
+    m_RollingStatsNextWindow = 0;
 
     m_AubCaptureStarted = false;
     m_AubCaptureKernelEnqueueSkipCounter = 0;
     m_AubCaptureKernelEnqueueCaptureCounter = 0;
 
+    m_MapAccessUntrackedMaps = 0;
+
+    m_InitializeBuffersZeroBlock = NULL;
+    m_DumpStagingBuffer = NULL;
+    m_DumpStagingBufferSize = 0;
+
+    m_OverheadBudgetIntervalNS = 0;
+    m_OverheadBudgetTotalNS = 0;
+    m_OverheadBudgetAdjustments = 0;
+    m_OverheadBudgetSampleFactor = 1;
+    m_OverheadBudgetStagesDisabled = false;
+    m_OverheadBudgetCallLoggingPaused = false;
+    m_SyncEpoch = 0;
+
+    m_CaptureWindowActive = true;
+    m_CaptureWindowTriggered = false;
+    m_CaptureWindowStartKernelCreated = false;
+    m_CaptureWindowSignalCount = 0;
+    m_CaptureWindowStartEnqueue = 0;
+    m_CaptureWindowStartNS = 0;
+
 #define CLI_CONTROL( _type, _name, _init, _desc )   m_Config . _name = _init;
 #include "controls.h"
 #undef CLI_CONTROL
@@ -168,10 +366,40 @@ CLIntercept::~CLIntercept()
     stopAubCapture( NULL );
     report();
 
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    logPendingErrorSummaries();
 
     log( "CLIntercept is shutting down...\n" );
 
+#if defined(__linux__)
+    // Restore the previous SIGSEGV action and unprotect any regions that
+    // are still tracked, since the signal handler must not outlive the
+    // intercept layer.
+    if( s_MapAccessHandlerInstalled.load() )
+    {
+        if( !s_MapAccessHandedOff.exchange( true ) )
+        {
+            sigaction( SIGSEGV, &s_MapAccessOldAction, NULL );
+        }
+        MapAccessUnprotectRegions();
+        s_MapAccessHandlerInstalled.store( false );
+
+        for( size_t i = 0; i < s_cMaxMapAccessRegions; i++ )
+        {
+            SMapAccessRegion&   region = s_MapAccessRegions[i];
+            region.Begin.store( 0 );
+            region.Capacity.store( 0 );
+            delete [] region.PageState.exchange( NULL );
+        }
+        for( size_t i = 0; i < s_MapAccessRetiredPageStates.size(); i++ )
+        {
+            delete [] s_MapAccessRetiredPageStates[i];
+        }
+        s_MapAccessRetiredPageStates.clear();
+    }
+#endif
+
     // Set the dispatch to the dummy dispatch.  The destructor is called
     // as the process is terminating.  We don't know when each DLL gets
     // unloaded, so it's not safe to call into any OpenCL functions in
@@ -253,6 +481,13 @@ CLIntercept::~CLIntercept()
         }
     }
 
+    freeHostMemory( m_InitializeBuffersZeroBlock );
+    m_InitializeBuffersZeroBlock = NULL;
+
+    freeHostMemory( m_DumpStagingBuffer );
+    m_DumpStagingBuffer = NULL;
+    m_DumpStagingBufferSize = 0;
+
     log( "... shutdown complete.\n" );
 
     m_InterceptLog.close();
@@ -322,7 +557,9 @@ static std::string GetNonDefaultString(
 //
 bool CLIntercept::init()
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    m_StartupLoadTime = clock::now();
 
     if( m_OS.Init() == false )
     {
@@ -365,6 +602,10 @@ bool CLIntercept::init()
 #include "controls.h"
 #undef CLI_CONTROL
 
+    // Note: The mutex is locked, but it is safe to enable tracking since
+    // the mutex is not yet used by any other threads.
+    m_Mutex.enable( m_Config.LockContentionTracking );
+
 #if defined(_WIN32) || defined(__linux__) || defined(__APPLE__)
     if( !m_Config.DumpDir.empty() )
     {
@@ -373,6 +614,7 @@ bool CLIntercept::init()
     }
 
     OS::Services_Common::APPEND_PID = m_Config.AppendPid;
+    OS::Services_Common::APPEND_RANK = m_Config.AppendRank;
 #endif
 
     if( m_Config.LogToFile )
@@ -385,14 +627,11 @@ bool CLIntercept::init()
 
         OS().MakeDumpDirectories( fileName );
 
-        if( m_Config.AppendFiles )
-        {
-            m_InterceptLog.open( fileName.c_str(), std::ios::out | std::ios::app );
-        }
-        else
-        {
-            m_InterceptLog.open( fileName.c_str(), std::ios::out );
-        }
+        CStreamWriter::SOptions options;
+        options.Append = m_Config.AppendFiles;
+        options.Compress = m_Config.LogToFileCompress;
+
+        m_InterceptLog.open( fileName, options );
     }
 
     if( m_Config.ChromeCallLogging ||
@@ -405,12 +644,28 @@ bool CLIntercept::init()
         fileName += sc_TraceFileName;
 
         OS().MakeDumpDirectories( fileName );
-        m_InterceptTrace.open( fileName.c_str(), std::ios::out );
-        m_InterceptTrace << "[\n";
 
         uint64_t    processId = OS().GetProcessID();
         uint64_t    threadId = OS().GetThreadID();
         std::string processName = OS().GetProcessName();
+
+        // Each trace file is a JSON array that is terminated by this record
+        // when the file is closed or rotated.
+        std::ostringstream  footer;
+        footer
+            << "{\"ph\":\"M\", \"name\":\"clintercept_trace_end\", \"pid\":" << processId
+            << ", \"tid\":" << threadId
+            << ", \"args\":{}}";
+
+        CStreamWriter::SOptions options;
+        options.Compress = m_Config.ChromeTraceCompress;
+        options.JSONArray = true;
+        options.RotateBytes = (uint64_t)m_Config.ChromeTraceRotateMB * 1024 * 1024;
+        options.RotateSeconds = m_Config.ChromeTraceRotateSeconds;
+        options.JSONFooter = footer.str();
+
+        m_InterceptTrace.open( fileName, options );
+
         m_InterceptTrace
             << "{\"ph\":\"M\", \"name\":\"process_name\", \"pid\":" << processId
             << ", \"tid\":" << threadId
@@ -422,6 +677,31 @@ bool CLIntercept::init()
         //    << ", \"args\":{\"name\":\"Host APIs\"}},\n";
     }
 
+    if( m_Config.RollingStatsWindowSeconds )
+    {
+        std::string fileName = "";
+
+        OS().GetDumpDirectoryName( sc_DumpDirectoryName, fileName );
+        fileName += "/";
+        fileName += sc_RollingStatsFileName;
+
+        OS().MakeDumpDirectories( fileName );
+
+        m_RollingStatsFile.open(
+            fileName.c_str(),
+            std::ios::out | std::ios::binary |
+                ( m_Config.AppendFiles ? std::ios::app : std::ios::trunc ) );
+        m_RollingStatsFile
+            << "Window Start (s),Device,Name,Calls,Total (ns),Min (ns),Max (ns)"
+            << std::endl;
+
+        // One slot is needed for each window that may still be updated, plus
+        // one for the current window and one for a window that begins while
+        // older windows are being written.
+        m_RollingStatsWindows.resize(
+            (size_t)m_Config.RollingStatsLateWindows + 2 );
+    }
+
     std::string name = "";
     OS().GetCLInterceptName( name );
 
@@ -559,6 +839,8 @@ bool CLIntercept::init()
 #error Unknown OS!
 #endif
 
+    m_StartupLibraryLoadedTime = clock::now();
+
 #define CLI_CONTROL( _type, _name, _init, _desc )                   \
     if ( m_Config . _name != _init ) {                              \
         log( GetNonDefaultString( #_name, m_Config . _name ) );     \
@@ -592,6 +874,7 @@ bool CLIntercept::init()
 #endif
 
     m_StartTime = clock::now();
+    m_OverheadBudgetIntervalStart = m_StartTime;
     log( "Timer Started!\n" );
 
     if( m_Config.ChromeCallLogging ||
@@ -610,6 +893,76 @@ bool CLIntercept::init()
             << "}},\n";
     }
 
+    if( captureWindowEnabled() )
+    {
+        // Call logging and Chrome call logging are paused until the
+        // capture window starts, see callLoggingPaused().  Device
+        // performance timing is limited to the capture window by
+        // checkDevicePerformanceTimingEnqueueLimits().
+        m_CaptureWindowActive = false;
+
+#if defined(__linux__) || defined(__APPLE__)
+        if( m_Config.CaptureWindowStartSignal )
+        {
+            if( signal( m_Config.CaptureWindowStartSignal, CaptureWindowSignalHandler ) == SIG_ERR )
+            {
+                logf( "Failed to install capture window signal handler for signal %d!\n",
+                    m_Config.CaptureWindowStartSignal );
+            }
+        }
+#else
+        if( m_Config.CaptureWindowStartSignal )
+        {
+            log( "CaptureWindowStartSignal is not supported on this operating system!\n" );
+        }
+#endif
+
+        log( "Capture window is enabled, waiting for capture window to start.\n" );
+    }
+
+    if( m_Config.HostAllocationBenchmark )
+    {
+        benchmarkHostAllocations();
+    }
+
+    if( m_Config.NodeReport )
+    {
+        attachNodeReport();
+    }
+
+    if( m_Config.MapAccessTracking )
+    {
+#if defined(__linux__)
+        s_MapAccessPageSize = (uintptr_t)sysconf( _SC_PAGESIZE );
+
+        struct sigaction    action;
+        memset( &action, 0, sizeof(action) );
+        action.sa_sigaction = MapAccessSignalHandler;
+        action.sa_flags = SA_SIGINFO | SA_RESTART | SA_ONSTACK;
+        sigemptyset( &action.sa_mask );
+
+        if( sigaction( SIGSEGV, &action, &s_MapAccessOldAction ) != 0 )
+        {
+            log( "Failed to install the map access tracking signal handler!\n" );
+            m_Config.MapAccessTracking = false;
+        }
+        else
+        {
+            s_MapAccessHandlerInstalled.store( true );
+        }
+#else
+        log( "MapAccessTracking is not supported on this operating system!\n" );
+        m_Config.MapAccessTracking = false;
+#endif
+    }
+
+    if( m_Config.StartupProfile )
+    {
+        addStartupMilestone( "Intercept Load", m_StartupLoadTime );
+        addStartupMilestone( "OpenCL Library Loaded", m_StartupLibraryLoadedTime );
+        addStartupMilestone( "Intercept Initialized", clock::now() );
+    }
+
     log( "... loading complete.\n" );
 
     return true;
@@ -619,7 +972,7 @@ bool CLIntercept::init()
 //
 void CLIntercept::report()
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     char    filepath[MAX_PATH] = "";
 
@@ -718,6 +1071,32 @@ void CLIntercept::report()
         CLI_SPRINTF( filepath, MAX_PATH, "%s", fileName.c_str() );
     }
 
+    if( m_RollingStatsFile.is_open() )
+    {
+        writeRollingStats();
+    }
+
+    // Flush the log and trace files, so the file writing statistics
+    // include everything that has been written so far.
+
+    if( m_InterceptLog.is_open() )
+    {
+        m_InterceptLog.flush();
+    }
+    if( m_InterceptTrace.is_open() )
+    {
+        m_InterceptTrace.flush();
+    }
+
+    // Account for the time spent writing the log and trace files, so it
+    // is included in the host performance timing results.
+
+    if( m_Config.HostPerformanceTiming )
+    {
+        addStreamWriterTimingStats( "(CLIntercept log writer)", m_InterceptLog );
+        addStreamWriterTimingStats( "(CLIntercept trace writer)", m_InterceptTrace );
+    }
+
     // Report
 
     if( m_Config.ReportToStderr )
@@ -725,6 +1104,11 @@ void CLIntercept::report()
         writeReport( std::cerr );
     }
 
+    if( m_Config.NodeReport )
+    {
+        writeNodeReport();
+    }
+
     if( m_Config.ReportToFile )
     {
         std::ofstream os;
@@ -792,59 +1176,92 @@ void CLIntercept::writeReport(
         }
     }
 
-    if( config().HostPerformanceTiming &&
-        !m_HostTimingStatsMap.empty() )
+    if( config().ErrorLogging &&
+        !m_ErrorStatsMap.empty() )
     {
-        os << std::endl << "Host Performance Timing Results:" << std::endl;
+        os << std::endl << "Errors:" << std::endl;
 
-        uint64_t    totalTotalNS = 0;
-        size_t      longestName = 32;
+        size_t  longestFunctionName = 32;
+        size_t  longestErrorName = 16;
+        size_t  longestKernelName = 16;
 
-        CHostTimingStatsMap::const_iterator i = m_HostTimingStatsMap.begin();
-        while( i != m_HostTimingStatsMap.end() )
+        CErrorStatsMap::const_iterator i = m_ErrorStatsMap.begin();
+        while( i != m_ErrorStatsMap.end() )
         {
-            const std::string& name = (*i).first;
-            const SHostTimingStats& hostTimingStats = (*i).second;
+            const SErrorStats& errorStats = (*i).second;
+            longestFunctionName = std::max< size_t >( errorStats.FunctionName.length(), longestFunctionName );
+            longestErrorName = std::max< size_t >( enumName().name( errorStats.ErrorCode ).length(), longestErrorName );
+            longestKernelName = std::max< size_t >( errorStats.KernelName.length(), longestKernelName );
+            ++i;
+        }
 
-            if( !name.empty() )
-            {
-                totalTotalNS += hostTimingStats.TotalNS;
-                longestName = std::max< size_t >( name.length(), longestName );
-            }
+        os << std::endl
+            << std::right << std::setw(longestFunctionName) << "Function Name" << ", "
+            << std::right << std::setw(longestErrorName) << "Error" << ", "
+            << std::right << std::setw(6) << "Code" << ", "
+            << std::right << std::setw(longestKernelName) << "Kernel Name" << ", "
+            << std::right << std::setw(10) << "Count" << std::endl;
+
+        i = m_ErrorStatsMap.begin();
+        while( i != m_ErrorStatsMap.end() )
+        {
+            const SErrorStats& errorStats = (*i).second;
+
+            os << std::right << std::setw(longestFunctionName) << errorStats.FunctionName << ", "
+                << std::right << std::setw(longestErrorName) << enumName().name( errorStats.ErrorCode ) << ", "
+                << std::right << std::setw(6) << errorStats.ErrorCode << ", "
+                << std::right << std::setw(longestKernelName) << errorStats.KernelName << ", "
+                << std::right << std::setw(10) << errorStats.NumberOfErrors << std::endl;
 
             ++i;
         }
 
-        os << std::endl << "Total Time (ns): " << totalTotalNS << std::endl;
+        if( config().ErrorLoggingMaxRepeats )
+        {
+            os << std::endl << "Note: Only the first " << config().ErrorLoggingMaxRepeats << " occurrences of each error were logged, and subsequent occurrences were summarized." << std::endl;
+        }
+    }
 
-        os << std::endl
-            << std::right << std::setw(longestName) << "Function Name" << ", "
-            << std::right << std::setw( 6) << "Calls" << ", "
-            << std::right << std::setw(13) << "Time (ns)" << ", "
-            << std::right << std::setw( 8) << "Time (%)" << ", "
-            << std::right << std::setw(13) << "Average (ns)" << ", "
-            << std::right << std::setw(13) << "Min (ns)" << ", "
-            << std::right << std::setw(13) << "Max (ns)" << std::endl;
+    if( config().HostPerformanceTiming &&
+        !m_HostTimingStatsMap.empty() )
+    {
+        os << std::endl << "Host Performance Timing Results:" << std::endl;
 
-        i = m_HostTimingStatsMap.begin();
-        while( i != m_HostTimingStatsMap.end() )
-        {
-            const std::string& name = (*i).first;
-            const SHostTimingStats& hostTimingStats = (*i).second;
+        writeHostTimingReport( os, m_HostTimingStatsMap );
+    }
+
+    if( config().LogToFileCompress ||
+        config().ChromeTraceCompress ||
+        config().ChromeTraceRotateMB ||
+        config().ChromeTraceRotateSeconds )
+    {
+        os << std::endl << "Log and Trace File Writing:" << std::endl;
 
-            if( !name.empty() )
+        os << std::endl
+            << std::right << std::setw(8) << "File" << ", "
+            << std::right << std::setw( 6) << "Files" << ", "
+            << std::right << std::setw(13) << "Bytes In" << ", "
+            << std::right << std::setw(13) << "Bytes Out" << ", "
+            << std::right << std::setw( 8) << "Ratio" << ", "
+            << std::right << std::setw(13) << "Time (ns)" << std::endl;
+
+        const char* names[] = { "Log", "Trace" };
+        const CStreamWriter* writers[] = { &m_InterceptLog, &m_InterceptTrace };
+        for( size_t w = 0; w < 2; w++ )
+        {
+            const CStreamWriter::SStats stats = writers[w]->getStats();
+            if( stats.NumberOfFiles )
             {
-                os << std::right << std::setw(longestName) << name << ", "
-                    << std::right << std::setw( 6) << hostTimingStats.NumberOfCalls << ", "
-                    << std::right << std::setw(13) << hostTimingStats.TotalNS << ", "
-                    << std::right << std::setw( 7) << std::fixed << std::setprecision(2) << hostTimingStats.TotalNS * 100.0f / totalTotalNS << "%, "
-                    << std::right << std::setw(13) << hostTimingStats.TotalNS / hostTimingStats.NumberOfCalls << ", "
-                    << std::right << std::setw(13) << hostTimingStats.MinNS << ", "
-                    << std::right << std::setw(13) << hostTimingStats.MaxNS << std::endl;
+                os << std::right << std::setw(8) << names[w] << ", "
+                    << std::right << std::setw( 6) << stats.NumberOfFiles << ", "
+                    << std::right << std::setw(13) << stats.BytesIn << ", "
+                    << std::right << std::setw(13) << stats.BytesOut << ", "
+                    << std::right << std::setw( 7) << std::fixed << std::setprecision(2)
+                    << ( stats.BytesOut ? (double)stats.BytesIn / stats.BytesOut : 0.0 ) << "x, "
+                    << std::right << std::setw(13) << stats.TotalNS << std::endl;
             }
-
-            ++i;
         }
+        os << std::endl << "Note: Bytes Out for a file that is still open only includes data that has been written to the file so far." << std::endl;
     }
 
     if( config().DevicePerformanceTiming &&
@@ -860,4927 +1277,10896 @@ void CLIntercept::writeReport(
 
             os << std::endl << "Device Performance Timing Results for " << deviceInfo.NameForReport << ":" << std::endl;
 
-            cl_ulong    totalTotalNS = 0;
-            size_t      longestName = 32;
+            writeDeviceTimingReport( os, dtsm );
 
-            CDeviceTimingStatsMap::const_iterator i = dtsm.begin();
-            while( i != dtsm.end() )
-            {
-                const std::string& name = (*i).first;
-                const SDeviceTimingStats& deviceTimingStats = (*i).second;
+            ++id;
+        }
+    }
 
-                if( !name.empty() )
-                {
-                    totalTotalNS += deviceTimingStats.TotalNS;
-                    longestName = std::max< size_t >( name.length(), longestName );
-                }
+    if( config().HostBlockingTimeAttribution &&
+        !m_HostBlockingStatsMap.empty() )
+    {
+        os << std::endl << "Host Blocking Time Attribution:" << std::endl;
 
-                ++i;
-            }
+        size_t  longestName = 32;
 
-            os << std::endl << "Total Time (ns): " << totalTotalNS << std::endl;
+        CHostBlockingStatsMap::const_iterator i = m_HostBlockingStatsMap.begin();
+        while( i != m_HostBlockingStatsMap.end() )
+        {
+            longestName = std::max< size_t >( (*i).first.length(), longestName );
+            ++i;
+        }
 
-            os << std::endl
-                << std::right << std::setw(longestName) << "Function Name" << ", "
-                << std::right << std::setw( 6) << "Calls" << ", "
-                << std::right << std::setw(13) << "Time (ns)" << ", "
-                << std::right << std::setw( 8) << "Time (%)" << ", "
-                << std::right << std::setw(13) << "Average (ns)" << ", "
-                << std::right << std::setw(13) << "Min (ns)" << ", "
-                << std::right << std::setw(13) << "Max (ns)" << std::endl;
-
-            i = dtsm.begin();
-            while( i != dtsm.end() )
-            {
-                const std::string& name = (*i).first;
-                const SDeviceTimingStats& deviceTimingStats = (*i).second;
+        CHostBlockingAttributionMap::const_iterator a = m_HostBlockingAttributionMap.begin();
+        while( a != m_HostBlockingAttributionMap.end() )
+        {
+            longestName = std::max< size_t >( (*a).first.length(), longestName );
+            ++a;
+        }
 
-                if( !name.empty() )
-                {
-                    os << std::right << std::setw(longestName) << name << ", "
-                        << std::right << std::setw( 6) << deviceTimingStats.NumberOfCalls << ", "
-                        << std::right << std::setw(13) << deviceTimingStats.TotalNS << ", "
-                        << std::right << std::setw( 7) << std::fixed << std::setprecision(2) << deviceTimingStats.TotalNS * 100.0f / totalTotalNS << "%, "
-                        << std::right << std::setw(13) << deviceTimingStats.TotalNS / deviceTimingStats.NumberOfCalls << ", "
-                        << std::right << std::setw(13) << deviceTimingStats.MinNS << ", "
-                        << std::right << std::setw(13) << deviceTimingStats.MaxNS << std::endl;
-                }
+        uint64_t    totalBlockingNS = 0;
 
-                ++i;
-            }
+        os << std::endl
+            << std::right << std::setw(longestName) << "Function Name" << ", "
+            << std::right << std::setw( 6) << "Calls" << ", "
+            << std::right << std::setw(13) << "Blocked (ns)" << ", "
+            << std::right << std::setw(13) << "Average (ns)" << ", "
+            << std::right << std::setw(13) << "Unattributed" << ", "
+            << std::right << std::setw(17) << "Unattributed (ns)" << std::endl;
 
-            ++id;
+        i = m_HostBlockingStatsMap.begin();
+        while( i != m_HostBlockingStatsMap.end() )
+        {
+            const std::string& name = (*i).first;
+            const SHostBlockingStats& stats = (*i).second;
+
+            totalBlockingNS += stats.TotalNS;
+
+            os << std::right << std::setw(longestName) << name << ", "
+                << std::right << std::setw( 6) << stats.NumberOfCalls << ", "
+                << std::right << std::setw(13) << stats.TotalNS << ", "
+                << std::right << std::setw(13) << stats.TotalNS / stats.NumberOfCalls << ", "
+                << std::right << std::setw(13) << stats.UnattributedCalls << ", "
+                << std::right << std::setw(17) << stats.UnattributedNS << std::endl;
+
+            ++i;
         }
-    }
 
-#if defined(USE_MDAPI)
-    if( config().DevicePerfCounterEventBasedSampling )
-    {
-        reportMDAPICounters( os );
+        os << std::endl
+            << std::right << std::setw(longestName) << "Command Name" << ", "
+            << std::right << std::setw( 6) << "Waits" << ", "
+            << std::right << std::setw(13) << "Blocked (ns)" << ", "
+            << std::right << std::setw( 8) << "Time (%)" << ", "
+            << std::right << std::setw(13) << "Average (ns)" << std::endl;
+
+        a = m_HostBlockingAttributionMap.begin();
+        while( a != m_HostBlockingAttributionMap.end() )
+        {
+            const std::string& name = (*a).first;
+            const SHostBlockingAttribution& attribution = (*a).second;
+
+            os << std::right << std::setw(longestName) << name << ", "
+                << std::right << std::setw( 6) << attribution.NumberOfCalls << ", "
+                << std::right << std::setw(13) << attribution.AttributedNS << ", "
+                << std::right << std::setw( 7) << std::fixed << std::setprecision(2)
+                << ( totalBlockingNS ? attribution.AttributedNS * 100.0 / totalBlockingNS : 0.0 ) << "%, "
+                << std::right << std::setw(13) << attribution.AttributedNS / attribution.NumberOfCalls << std::endl;
+
+            ++a;
+        }
+
+        os << std::endl << "Note: Unattributed calls are blocking calls where no device command completed while the host was waiting." << std::endl;
     }
-#endif
-}
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::addShortKernelName(
-    const std::string& kernelName )
-{
-    if( kernelName.length() > m_Config.LongKernelNameCutoff )
+    if( config().AutoOutOfOrderQueue &&
+        m_AutoOutOfOrderStats.NumberOfQueues )
     {
-        std::string shortKernelName("k_");
-        shortKernelName += std::to_string(m_KernelID);
-        m_LongKernelNameMap[ kernelName ] = shortKernelName;
+        const SAutoOutOfOrderStats& stats = m_AutoOutOfOrderStats;
 
-        logf( "Added kernel name mapping: %s to %s\n",
-            kernelName.c_str(),
-            shortKernelName.c_str() );
+        os << std::endl << "Automatic Out-of-Order Queues:" << std::endl;
 
-        m_KernelID++;
+        os << std::endl
+            << "Converted Queues: " << stats.NumberOfQueues << std::endl
+            << "Commands: " << stats.NumberOfCommands << std::endl
+            << "Commands Independent of the Previous Command: " << stats.IndependentCommands << std::endl
+            << "Dependencies Added: " << stats.DependenciesAdded << std::endl
+            << "Full Barrier Commands: " << stats.FullBarrierCommands << std::endl
+            << "Blocking Commands: " << stats.BlockingCommands << std::endl
+            << "Commands Returning Events: " << stats.EventCommands << std::endl;
+        if( stats.NumberOfCommands )
+        {
+            os << "Average Independent Commands in Flight at Enqueue: "
+                << std::fixed << std::setprecision(2)
+                << (double)stats.IndependentInFlight / stats.NumberOfCommands << std::endl;
+        }
+
+        os << std::endl << "Note: Commands independent of the previous command could execute concurrently with it, and would have been serialized by an in-order queue.  Commands returning events to the application wait for all previous commands, to preserve in-order event semantics." << std::endl;
     }
-}
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::getCallLoggingPrefix(
-    std::string& str )
-{
-    if( m_Config.CallLoggingElapsedTime )
+    if( config().CoalesceBufferWrites &&
+        m_CoalescedWriteStats.NumberOfWrites )
     {
-        using us = std::chrono::microseconds;
-        uint64_t usDelta =
-            std::chrono::duration_cast<us>(clock::now() - m_StartTime).count();
-
-        std::ostringstream  ss;
+        const SCoalescedWriteStats& stats = m_CoalescedWriteStats;
 
-        ss << "Time: ";
-        ss << usDelta;
-        ss << " ";
+        os << std::endl << "Coalesced Buffer Writes:" << std::endl;
 
-        str += ss.str();
+        os << std::endl
+            << "Buffer Writes Combined: " << stats.NumberOfWrites << std::endl
+            << "Combined Transfers Issued: " << stats.NumberOfTransfers << std::endl
+            << "Bytes Transferred: " << stats.TotalBytes << std::endl
+            << "Failed Transfers: " << stats.NumberOfErrors << std::endl;
+        if( stats.NumberOfTransfers )
+        {
+            os << "Average Writes per Transfer: "
+                << std::fixed << std::setprecision(2)
+                << (double)stats.NumberOfWrites / stats.NumberOfTransfers << std::endl;
+        }
+        if( stats.NumberOfWrites > stats.NumberOfTransfers )
+        {
+            os << "Submissions Saved: "
+                << stats.NumberOfWrites - stats.NumberOfTransfers << std::endl;
+        }
     }
 
-    if( m_Config.CallLoggingThreadId ||
-        m_Config.CallLoggingThreadNumber )
+    if( config().PinnedStagingTransfers &&
+        !m_PinnedStagingStatsMap.empty() )
     {
-        uint64_t    threadId = OS().GetThreadID();
-        std::ostringstream  ss;
+        size_t  longestName = 32;
 
-        if( m_Config.CallLoggingThreadId )
+        CPinnedStagingStatsMap::const_iterator i = m_PinnedStagingStatsMap.begin();
+        while( i != m_PinnedStagingStatsMap.end() )
         {
-            ss << "TID = ";
-            ss << threadId;
-            ss << " ";
+            longestName = std::max< size_t >( longestName, i->first.length() );
+            ++i;
         }
-        if( m_Config.CallLoggingThreadNumber )
-        {
-            unsigned int    threadNumber = getThreadNumber( threadId );
-            ss << "TNum = ";
-            ss << threadNumber;
-            ss << " ";
+
+        os << std::endl << "Pinned Staging Transfers:" << std::endl;
+
+        os << std::endl
+            << std::right << std::setw(longestName) << "Function Name" << ", "
+            << std::setw( 6) << "Calls" << ", "
+            << std::setw(13) << "Total Bytes" << ", "
+            << std::setw(13) << "Timed Bytes" << ", "
+            << std::setw(13) << "Timed ns" << ", "
+            << std::setw(10) << "GB/s"
+            << std::endl;
+
+        i = m_PinnedStagingStatsMap.begin();
+        while( i != m_PinnedStagingStatsMap.end() )
+        {
+            const SPinnedStagingStats& stats = i->second;
+
+            os << std::right << std::setw(longestName) << i->first << ", "
+                << std::setw( 6) << stats.NumberOfCalls << ", "
+                << std::setw(13) << stats.TotalBytes << ", "
+                << std::setw(13) << stats.TimedBytes << ", "
+                << std::setw(13) << stats.TimedNS << ", "
+                << std::setw(10) << std::fixed << std::setprecision(2)
+                << ( stats.TimedNS ? (double)stats.TimedBytes / stats.TimedNS : 0.0 )
+                << std::endl;
+
+            ++i;
         }
 
-        str += ss.str();
+        os << std::endl << "Note: Timed transfers are blocking transfers, measured from the call until the transfer completed.  Direct transfers are issued without staging for comparison." << std::endl;
     }
-}
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::callLoggingEnter(
-    const std::string& functionName,
-    const uint64_t enqueueCounter,
-    const cl_kernel kernel )
-{
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    if( config().ZeroCopyChecking )
+    {
+        CZeroCopyBufferInfoList buffers( m_ZeroCopyRetiredBuffers );
 
-    std::string str;
-    getCallLoggingPrefix( str );
+        CZeroCopyBufferInfoMap::const_iterator i = m_ZeroCopyBufferInfoMap.begin();
+        while( i != m_ZeroCopyBufferInfoMap.end() )
+        {
+            if( i->second.getAvoidableBytes() != 0 )
+            {
+                buffers.push_back( i->second );
+            }
+            ++i;
+        }
 
-    str += functionName;
+        if( !buffers.empty() )
+        {
+            std::sort(
+                buffers.begin(),
+                buffers.end(),
+                zeroCopyAvoidableBytesGreater );
 
-    if( kernel )
-    {
-        const std::string& kernelName = getShortKernelNameWithHash(kernel);
-        str += "( ";
-        str += kernelName;
-        str += " )";
-    }
+            const size_t    cReportedBuffers = 32;
+            if( buffers.size() > cReportedBuffers )
+            {
+                buffers.resize( cReportedBuffers );
+            }
 
-    if( m_Config.CallLoggingEnqueueCounter )
-    {
-        std::ostringstream  ss;
-        ss << "; EnqueueCounter: ";
-        ss << enqueueCounter;
-        str += ss.str();
-    }
+            os << std::endl << "Zero-Copy Advisor:" << std::endl;
 
-    log( ">>>> " + str + "\n" );
-}
-void CLIntercept::callLoggingEnter(
-    const std::string& functionName,
-    const uint64_t enqueueCounter,
-    const cl_kernel kernel,
-    const char* formatStr,
-    ... )
-{
-    va_list args;
-    va_start( args, formatStr );
+            os << std::endl
+                << std::right << std::setw(8) << "Buffer" << ", "
+                << std::setw(12) << "Size" << ", "
+                << std::setw( 8) << "Reads" << ", "
+                << std::setw( 8) << "Writes" << ", "
+                << std::setw( 8) << "Maps" << ", "
+                << std::setw(10) << "Unaligned" << ", "
+                << std::setw(16) << "Avoidable Bytes" << ", "
+                << "Issues"
+                << std::endl;
+
+            for( size_t b = 0; b < buffers.size(); b++ )
+            {
+                const SZeroCopyBufferInfo& info = buffers[b];
 
-    std::string str = functionName;
+                std::string issues;
+                if( info.Flags & CL_MEM_COPY_HOST_PTR )
+                {
+                    issues += "CL_MEM_COPY_HOST_PTR; ";
+                }
+                else if( !( info.Flags & ( CL_MEM_USE_HOST_PTR | CL_MEM_ALLOC_HOST_PTR ) ) )
+                {
+                    issues += "no CL_MEM_USE_HOST_PTR or CL_MEM_ALLOC_HOST_PTR; ";
+                }
+                if( info.HostPtrNotPageAligned )
+                {
+                    issues += info.HostPtrNotBaseAddrAligned ?
+                        "host_ptr not base address aligned; " :
+                        "host_ptr not page aligned; ";
+                }
+                if( info.SizeNotBaseAddrMultiple )
+                {
+                    issues += "size not a multiple of the base address alignment; ";
+                }
+                if( info.NumberOfReads + info.NumberOfWrites != 0 )
+                {
+                    issues += "host reads or writes could be maps; ";
+                }
+                if( !issues.empty() )
+                {
+                    issues.resize( issues.size() - 2 );
+                }
 
-    if( kernel )
-    {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+                os << std::right << std::setw(8) << info.Number << ", "
+                    << std::setw(12) << info.Size << ", "
+                    << std::setw( 8) << info.NumberOfReads << ", "
+                    << std::setw( 8) << info.NumberOfWrites << ", "
+                    << std::setw( 8) << info.NumberOfMaps << ", "
+                    << std::setw(10) << info.UnalignedTransfers << ", "
+                    << std::setw(16) << info.getAvoidableBytes() << ", "
+                    << issues
+                    << std::endl;
+            }
 
-        const std::string& kernelName = getShortKernelNameWithHash(kernel);
-        str += "( ";
-        str += kernelName;
-        str += " )";
+            os << std::endl << "Note: Buffers are numbered in memory object creation order.  Unaligned transfers use a host pointer that is not aligned to the device base address alignment.  Avoidable bytes are an estimate of the bytes copied on creation, by host reads and writes, and by maps of buffers that are not zero-copy." << std::endl;
+        }
     }
 
-    int size = CLI_VSPRINTF( m_StringBuffer, CLI_STRING_BUFFER_SIZE, formatStr, args );
-    if( size >= 0 && size < CLI_STRING_BUFFER_SIZE )
-    {
-        str += ": ";
-        str += m_StringBuffer;
-    }
-    else
+    if( config().StartupProfile &&
+        !m_StartupMilestones.empty() )
     {
-        str += ": too long";
-    }
-    callLoggingEnter( str, enqueueCounter, NULL );
+        os << std::endl << "Startup Profile:" << std::endl;
 
-    va_end( args );
-}
+        os << std::endl
+            << std::right << std::setw(12) << "Time (ms)" << ", "
+            << std::right << std::setw(12) << "Gap (ms)" << ", "
+            << "Milestone" << std::endl;
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::callLoggingInfo(
-    const std::string& str )
-{
-    std::lock_guard<std::mutex> lock(m_Mutex);
+        using us = std::chrono::microseconds;
 
-    log( "---- " + str + "\n" );
-}
+        for( size_t m = 0; m <= m_StartupMilestones.size(); m++ )
+        {
+            // After the last milestone, report any calls that were made
+            // after the last milestone if the startup profile is incomplete.
+            const bool  incomplete = ( m == m_StartupMilestones.size() );
+            if( incomplete && m_StartupCalls.empty() )
+            {
+                break;
+            }
 
-void CLIntercept::callLoggingInfo(
-    const char* formatStr,
-    ... )
-{
-    va_list args;
-    va_start( args, formatStr );
+            const std::string&  name =
+                incomplete ? "(Incomplete)" : m_StartupMilestones[m].Name;
+            const clock::time_point time =
+                incomplete ? m_StartupMilestones.back().Time : m_StartupMilestones[m].Time;
+            const CStartupCallStatsMap& calls =
+                incomplete ? m_StartupCalls : m_StartupMilestones[m].Calls;
+
+            const uint64_t  usTime =
+                std::chrono::duration_cast<us>(time - m_StartupLoadTime).count();
+            const uint64_t  usGap = ( m == 0 || incomplete ) ? 0 :
+                std::chrono::duration_cast<us>(time - m_StartupMilestones[m - 1].Time).count();
+
+            os << std::right << std::setw(12) << std::fixed << std::setprecision(3) << usTime / 1000.0 << ", "
+                << std::right << std::setw(12) << usGap / 1000.0 << ", "
+                << name << std::endl;
+
+            // List the calls in this gap from most to least host time.
+            std::vector< std::pair< uint64_t, std::string > >   sorted;
+            CStartupCallStatsMap::const_iterator i = calls.begin();
+            while( i != calls.end() )
+            {
+                sorted.push_back( std::make_pair( i->second.TotalNS, i->first ) );
+                ++i;
+            }
+            std::sort( sorted.rbegin(), sorted.rend() );
 
-    int size = CLI_VSPRINTF( m_StringBuffer, CLI_STRING_BUFFER_SIZE, formatStr, args );
-    if( size >= 0 && size < CLI_STRING_BUFFER_SIZE )
-    {
-        callLoggingInfo( std::string( m_StringBuffer ) );
+            for( size_t c = 0; c < sorted.size(); c++ )
+            {
+                const SStartupCallStats&    stats = calls.find( sorted[c].second )->second;
+                os << std::setw(28) << "" << "- " << sorted[c].second
+                    << ": " << stats.NumberOfCalls << " call(s), "
+                    << std::setprecision(3) << stats.TotalNS / 1000000.0 << " ms" << std::endl;
+            }
+        }
+
+        os << std::endl << "Note: Times are relative to when the Intercept Layer for OpenCL Applications was loaded.  Each milestone is recorded when the corresponding call returns, and the calls listed below a milestone were made since the previous milestone.  Kernel completion is observed using an event callback on a marker." << std::endl;
     }
-    else
+
+    if( config().BottleneckAnalysis &&
+        !m_BottleneckWindowMap.empty() )
     {
-        callLoggingInfo( std::string( "too long" ) );
-    }
+        os << std::endl << "Bottleneck Analysis:" << std::endl;
 
-    va_end( args );
-}
+        const uint64_t  windowNS =
+            std::max< uint64_t >( config().BottleneckAnalysisPhaseMilliseconds, 1 ) * 1000000;
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::callLoggingExit(
-    const std::string& functionName,
-    const cl_int errorCode,
-    const cl_event* event )
-{
-    std::lock_guard<std::mutex> lock(m_Mutex);
+        // Include intervals with no device activity between the first and
+        // last intervals with device activity.
+        const uint64_t  firstWindow = m_BottleneckWindowMap.begin()->first;
+        const uint64_t  lastWindow = m_BottleneckWindowMap.rbegin()->first;
 
-    std::string str;
-    getCallLoggingPrefix( str );
+        SBottleneckWindow   total;
+        for( uint64_t w = firstWindow; w <= lastWindow; w++ )
+        {
+            CBottleneckWindowMap::const_iterator i = m_BottleneckWindowMap.find( w );
+            if( i != m_BottleneckWindowMap.end() )
+            {
+                const SBottleneckWindow& window = i->second;
+                total.NumberOfEnqueues += window.NumberOfEnqueues;
+                total.NumberOfKernels += window.NumberOfKernels;
+                total.KernelNS += window.KernelNS;
+                total.TransferNS += window.TransferNS;
+                total.OtherNS += window.OtherNS;
+                for( int b = 0; b < BOTTLENECK_HISTOGRAM_BUCKETS; b++ )
+                {
+                    total.KernelHistogram[b] += window.KernelHistogram[b];
+                }
+            }
+        }
 
-    str += functionName;
+        std::string evidence;
+        const char* classification = classifyBottleneck(
+            total,
+            ( lastWindow - firstWindow + 1 ) * windowNS,
+            evidence );
 
-    if( event )
-    {
-        CLI_SPRINTF( m_StringBuffer, CLI_STRING_BUFFER_SIZE, " created event = %p", *event );
-        str += m_StringBuffer;
-    }
+        os << std::endl << "Application: " << classification << " (" << evidence << ")" << std::endl;
 
-    str += " -> ";
-    str += m_EnumNameMap.name( errorCode );
+        os << std::endl
+            << std::right << std::setw(12) << "Start (ms)" << ", "
+            << std::right << std::setw(12) << "End (ms)" << ", "
+            << std::right << std::setw(15) << "Classification" << ", "
+            << "Evidence" << std::endl;
+
+        const size_t    cMaxPhases = 256;
+        size_t  numPhases = 0;
+
+        uint64_t    phaseStart = firstWindow;
+        while( phaseStart <= lastWindow && numPhases < cMaxPhases )
+        {
+            // Extend the phase while the classification is unchanged.
+            SBottleneckWindow   phase;
+            const char* phaseClassification = NULL;
+            uint64_t    phaseEnd = phaseStart;
+            for( uint64_t w = phaseStart; w <= lastWindow; w++ )
+            {
+                SBottleneckWindow   window;
+                CBottleneckWindowMap::const_iterator i = m_BottleneckWindowMap.find( w );
+                if( i != m_BottleneckWindowMap.end() )
+                {
+                    window = i->second;
+                }
 
-    log( "<<<< " + str + "\n" );
-}
-void CLIntercept::callLoggingExit(
-    const std::string& functionName,
-    const cl_int errorCode,
-    const cl_event* event,
-    const char* formatStr,
-    ... )
-{
-    va_list args;
-    va_start( args, formatStr );
+                std::string unused;
+                const char* windowClassification =
+                    classifyBottleneck( window, windowNS, unused );
+                if( phaseClassification != NULL &&
+                    strcmp( phaseClassification, windowClassification ) != 0 )
+                {
+                    break;
+                }
+                phaseClassification = windowClassification;
+                phaseEnd = w;
+
+                phase.NumberOfEnqueues += window.NumberOfEnqueues;
+                phase.NumberOfKernels += window.NumberOfKernels;
+                phase.KernelNS += window.KernelNS;
+                phase.TransferNS += window.TransferNS;
+                phase.OtherNS += window.OtherNS;
+                for( int b = 0; b < BOTTLENECK_HISTOGRAM_BUCKETS; b++ )
+                {
+                    phase.KernelHistogram[b] += window.KernelHistogram[b];
+                }
+            }
 
-    std::string str = functionName;
+            std::string phaseEvidence;
+            classifyBottleneck(
+                phase,
+                ( phaseEnd - phaseStart + 1 ) * windowNS,
+                phaseEvidence );
 
-    if( event )
-    {
-        CLI_SPRINTF( m_StringBuffer, CLI_STRING_BUFFER_SIZE, " created event = %p", *event );
-        str += m_StringBuffer;
+            os << std::right << std::setw(12) << phaseStart * windowNS / 1000000 << ", "
+                << std::right << std::setw(12) << ( phaseEnd + 1 ) * windowNS / 1000000 << ", "
+                << std::right << std::setw(15) << phaseClassification << ", "
+                << phaseEvidence << std::endl;
+
+            numPhases++;
+            phaseStart = phaseEnd + 1;
+        }
+        if( phaseStart <= lastWindow )
+        {
+            os << "(Only the first " << cMaxPhases << " phases are reported.)" << std::endl;
+        }
+
+        os << std::endl << "Note: Times are relative to when the Intercept Layer for OpenCL Applications was loaded.  Device utilization is the device time of all commands in the phase divided by the length of the phase, and may be overestimated when commands execute concurrently.  Median kernel durations are estimated to within a factor of two." << std::endl;
     }
 
-    int size = CLI_VSPRINTF( m_StringBuffer, CLI_STRING_BUFFER_SIZE, formatStr, args );
-    if( size >= 0 && size < CLI_STRING_BUFFER_SIZE )
+    if( config().RecycleKernels &&
+        !m_KernelRecyclingStatsMap.empty() )
     {
-        str += ": ";
-        str += m_StringBuffer;
+        os << std::endl << "Kernel Recycling:" << std::endl;
+
+        size_t  longestName = 32;
+
+        CKernelRecyclingStatsMap::const_iterator i = m_KernelRecyclingStatsMap.begin();
+        while( i != m_KernelRecyclingStatsMap.end() )
+        {
+            longestName = std::max< size_t >( (*i).first.length(), longestName );
+            ++i;
+        }
+
+        os << std::endl
+            << std::right << std::setw(longestName) << "Kernel Name" << ", "
+            << std::right << std::setw(10) << "Creates" << ", "
+            << std::right << std::setw(10) << "Recycled" << ", "
+            << std::right << std::setw( 9) << "Hit Rate" << ", "
+            << std::right << std::setw(16) << "Avg Create (ns)" << ", "
+            << std::right << std::setw(16) << "Saved (ns)" << std::endl;
+
+        i = m_KernelRecyclingStatsMap.begin();
+        while( i != m_KernelRecyclingStatsMap.end() )
+        {
+            const std::string& name = (*i).first;
+            const SKernelRecyclingStats& stats = (*i).second;
+
+            const uint64_t  numberOfCalls =
+                stats.NumberOfCreates + stats.NumberOfRecycled;
+            const uint64_t  averageCreateNS =
+                stats.NumberOfCreates ?
+                stats.CreateNS / stats.NumberOfCreates :
+                0;
+
+            // The saved time is the estimated time to create the recycled
+            // kernels, minus the time spent creating and pooling clones.
+            const uint64_t  estimatedNS =
+                averageCreateNS * stats.NumberOfRecycled;
+            const int64_t   savedNS =
+                (int64_t)estimatedNS - (int64_t)stats.RecycleNS;
+
+            os << std::right << std::setw(longestName) << name << ", "
+                << std::right << std::setw(10) << stats.NumberOfCreates << ", "
+                << std::right << std::setw(10) << stats.NumberOfRecycled << ", "
+                << std::right << std::setw( 8) << std::fixed << std::setprecision(2)
+                << ( numberOfCalls ? 100.0 * stats.NumberOfRecycled / numberOfCalls : 0.0 ) << "%, "
+                << std::right << std::setw(16) << averageCreateNS << ", "
+                << std::right << std::setw(16) << savedNS << std::endl;
+
+            ++i;
+        }
+
+        os << std::endl << "Note: Saved time is estimated from the average time to create a kernel, and includes the time spent cloning the template kernels." << std::endl;
     }
-    else
+
+    if( config().RedundantKernelChecking &&
+        !m_RedundantKernelStatsMap.empty() )
     {
-        str += ": too long";
-    }
+        os << std::endl << "Redundant Kernel Enqueues:" << std::endl;
 
-    callLoggingExit( str, errorCode, NULL );
+        size_t  longestName = 32;
 
-    va_end( args );
-}
+        CRedundantKernelStatsMap::const_iterator i = m_RedundantKernelStatsMap.begin();
+        while( i != m_RedundantKernelStatsMap.end() )
+        {
+            longestName = std::max< size_t >( (*i).first.length(), longestName );
+            ++i;
+        }
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::cacheDeviceInfo(
-    cl_device_id device )
-{
-    if( device && m_DeviceInfoMap.find(device) == m_DeviceInfoMap.end() )
-    {
-        SDeviceInfo&    deviceInfo = m_DeviceInfoMap[device];
+        os << std::endl
+            << std::right << std::setw(longestName) << "Kernel Name" << ", "
+            << std::right << std::setw(10) << "Enqueues" << ", "
+            << std::right << std::setw(10) << "Redundant" << ", "
+            << std::right << std::setw(16) << "Redundant (ns)" << std::endl;
 
-        char*   deviceName = NULL;
-        cl_uint deviceComputeUnits = 0;
-        cl_uint deviceMaxClockFrequency = 0;
+        i = m_RedundantKernelStatsMap.begin();
+        while( i != m_RedundantKernelStatsMap.end() )
+        {
+            const std::string& name = (*i).first;
+            const SRedundantKernelStats& stats = (*i).second;
 
-        allocateAndGetDeviceInfoString(
-            device,
-            CL_DEVICE_NAME,
-            deviceName );
-        dispatch().clGetDeviceInfo(
-            device,
-            CL_DEVICE_MAX_COMPUTE_UNITS,
-            sizeof(deviceComputeUnits),
-            &deviceComputeUnits,
-            NULL );
-        dispatch().clGetDeviceInfo(
-            device,
-            CL_DEVICE_MAX_CLOCK_FREQUENCY,
-            sizeof(deviceMaxClockFrequency),
-            &deviceMaxClockFrequency,
-            NULL );
-        if( deviceName )
-        {
-            std::ostringstream  ss;
-            ss << deviceName << " ("
-                << deviceComputeUnits << "CUs, "
-                << deviceMaxClockFrequency << "MHz)";
+            if( stats.NumberOfRedundantEnqueues != 0 )
+            {
+                os << std::right << std::setw(longestName) << name << ", "
+                    << std::right << std::setw(10) << stats.NumberOfEnqueues << ", "
+                    << std::right << std::setw(10) << stats.NumberOfRedundantEnqueues << ", ";
+                if( stats.NumberOfTimedEnqueues != 0 )
+                {
+                    os << std::right << std::setw(16) << stats.RedundantNS << std::endl;
+                }
+                else
+                {
+                    os << std::right << std::setw(16) << "-" << std::endl;
+                }
+            }
 
-            deviceInfo.Name = deviceName;
-            deviceInfo.NameForReport = ss.str();
+            ++i;
         }
 
-        size_t majorVersion = 0;
-        size_t minorVersion = 0;
-        getDeviceMajorMinorVersion(
-            device,
-            majorVersion,
-            minorVersion );
-        deviceInfo.NumericVersion =
-            CL_MAKE_VERSION_KHR( majorVersion, minorVersion, 0 );
+        os << std::endl << "Note: A kernel enqueue is redundant if a previous enqueue of the same kernel had the same argument values and work sizes, the memory the kernel may read is unchanged since the previous enqueue read it, and the memory the kernel may write is unchanged since the previous enqueue wrote it.  Kernels that may read and write the same memory are never redundant.  Redundant device time requires DevicePerformanceTiming." << std::endl;
+    }
 
-        deviceInfo.NumComputeUnits = deviceComputeUnits;
-        deviceInfo.MaxClockFrequency = deviceMaxClockFrequency;
+    if( config().MapAccessTracking &&
+        ( !m_MapAccessStatsMap.empty() || m_MapAccessUntrackedMaps ) )
+    {
+        os << std::endl << "Map Access Tracking:" << std::endl;
 
-        deviceInfo.Supports_cl_khr_create_command_queue =
-            checkDeviceForExtension( device, "cl_khr_create_command_queue" );
-        deviceInfo.Supports_cl_khr_subgroups =
-            checkDeviceForExtension( device, "cl_khr_subgroups" );
+        size_t  longestName = 32;
 
-        delete [] deviceName;
-    }
-}
+        CMapAccessStatsMap::const_iterator i = m_MapAccessStatsMap.begin();
+        while( i != m_MapAccessStatsMap.end() )
+        {
+            longestName = std::max< size_t >( (*i).first.length(), longestName );
+            ++i;
+        }
 
-///////////////////////////////////////////////////////////////////////////////
-//
-cl_int CLIntercept::getDeviceMajorMinorVersion(
-    cl_device_id device,
-    size_t& majorVersion,
-    size_t& minorVersion ) const
-{
-    char*   deviceVersion = NULL;
+        os << std::endl
+            << std::right << std::setw(longestName) << "Buffer (Map Flags)" << ", "
+            << std::right << std::setw(8) << "Maps" << ", "
+            << std::right << std::setw(10) << "Low Touch" << ", "
+            << std::right << std::setw(16) << "Mapped Bytes" << ", "
+            << std::right << std::setw(8) << "Read %" << ", "
+            << std::right << std::setw(9) << "Written %" << ", "
+            << std::right << std::setw(16) << "Needless Bytes" << std::endl;
 
-    cl_int  errorCode = allocateAndGetDeviceInfoString(
-        device,
-        CL_DEVICE_VERSION,
-        deviceVersion );
-    if( errorCode == CL_SUCCESS && deviceVersion )
-    {
-        // According to the spec, the device version string should have the form:
-        //   OpenCL <Major>.<Minor> <Vendor Specific Info>
-        getMajorMinorVersionFromString(
-            "OpenCL ",
-            deviceVersion,
-            majorVersion,
-            minorVersion );
-    }
+        i = m_MapAccessStatsMap.begin();
+        while( i != m_MapAccessStatsMap.end() )
+        {
+            const std::string& name = (*i).first;
+            const SMapAccessStats& stats = (*i).second;
 
-    delete [] deviceVersion;
-    deviceVersion = NULL;
+            const double    tracked = stats.TrackedBytes ? (double)stats.TrackedBytes : 1.0;
 
-    return errorCode;
-}
+            os << std::right << std::setw(longestName) << name << ", "
+                << std::right << std::setw(8) << stats.NumberOfMaps << ", "
+                << std::right << std::setw(10) << stats.NumberOfLowTouchMaps << ", "
+                << std::right << std::setw(16) << stats.MappedBytes << ", "
+                << std::fixed << std::setprecision(2)
+                << std::right << std::setw(7) << 100.0 * stats.ReadBytes / tracked << "%, "
+                << std::right << std::setw(8) << 100.0 * stats.WrittenBytes / tracked << "%, "
+                << std::right << std::setw(16) << stats.NeedlessBytes << std::endl;
 
-///////////////////////////////////////////////////////////////////////////////
-//
-bool CLIntercept::getMajorMinorVersionFromString(
-    const char* prefix,
-    const char* str,
-    size_t& major,
-    size_t& minor ) const
-{
-    major = 0;
-    minor = 0;
+            ++i;
+        }
 
-    if( str && prefix )
+        if( m_MapAccessUntrackedMaps )
+        {
+            os << std::endl << "Untracked Maps: " << m_MapAccessUntrackedMaps << std::endl;
+        }
+
+        os << std::endl << "Note: A low-touch map is a map where the host touched less than " << config().MapAccessTrackingThreshold << "% of the tracked pages before unmapping.  Needless bytes are the untouched part of low-touch maps, which could be avoided by mapping a smaller region or by using a read or write instead.  Maps smaller than a page and non-blocking maps are not tracked." << std::endl;
+    }
+
+    if( config().KernelFootprintAnalysis &&
+        !m_KernelFootprintStatsMap.empty() )
     {
-        if( strncmp(str, prefix, strlen(prefix)) == 0 )
+        os << std::endl << "Kernel Footprints:" << std::endl;
+
+        size_t  longestName = 32;
+
+        CKernelFootprintStatsMap::const_iterator i = m_KernelFootprintStatsMap.begin();
+        while( i != m_KernelFootprintStatsMap.end() )
         {
-            str += strlen(prefix);
-            while( isdigit(str[0]) )
-            {
-                major *= 10;
-                major += str[0] - '0';
-                str++;
-            }
-            if( str[0] == '.' )
+            longestName = std::max< size_t >( (*i).first.length(), longestName );
+            ++i;
+        }
+
+        os << std::endl
+            << std::right << std::setw(longestName) << "Kernel Name" << ", "
+            << std::right << std::setw(10) << "Enqueues" << ", "
+            << std::right << std::setw(16) << "Max Bytes" << ", "
+            << std::right << std::setw(16) << "Average Bytes" << ", "
+            << std::right << std::setw(16) << "Device Time (ns)" << ", "
+            << std::right << std::setw(12) << "GB/s" << std::endl;
+
+        i = m_KernelFootprintStatsMap.begin();
+        while( i != m_KernelFootprintStatsMap.end() )
+        {
+            const std::string& name = (*i).first;
+            const SKernelFootprintStats& stats = (*i).second;
+
+            os << std::right << std::setw(longestName) << name << ", "
+                << std::right << std::setw(10) << stats.NumberOfEnqueues << ", "
+                << std::right << std::setw(16) << stats.MaxBytes << ", "
+                << std::right << std::setw(16) << stats.TotalBytes / stats.NumberOfEnqueues << ", ";
+            if( stats.NumberOfTimedEnqueues != 0 && stats.TimedNS != 0 )
             {
-                str++;
+                // Bytes per nanosecond is equivalent to GB/s.
+                os << std::right << std::setw(16) << stats.TimedNS << ", "
+                    << std::right << std::setw(12) << std::fixed << std::setprecision(2)
+                    << (double)stats.TimedBytes / (double)stats.TimedNS << std::endl;
             }
             else
             {
-                CLI_ASSERT( 0 );
-            }
-            while( isdigit(str[0]) )
-            {
-                minor *= 10;
-                minor += str[0] - '0';
-                str++;
+                os << std::right << std::setw(16) << "-" << ", "
+                    << std::right << std::setw(12) << "-" << std::endl;
             }
-        }
-    }
-
-    return true;
-}
 
-///////////////////////////////////////////////////////////////////////////////
-//
-bool CLIntercept::checkDeviceForExtension(
-    cl_device_id device,
-    const char* extensionName ) const
-{
-    bool    supported = false;
+            ++i;
+        }
 
-    // Sanity check: Be sure the extension name is not NULL and doesn't
-    // contain a space.
-    if( !extensionName || strchr( extensionName, ' ' ) )
-    {
-        CLI_ASSERT( 0 );
+        os << std::endl << "Note: The footprint is the total size of the memory passed as kernel arguments, which is an upper bound on the memory touched by the kernel.  GB/s assumes each byte is touched once, so kernels with a high GB/s relative to the device memory bandwidth are likely memory-bound.  Device time requires DevicePerformanceTiming." << std::endl;
     }
-    else
+
+    if( config().DeviceConcurrencyAnalysis &&
+        !m_ConcurrencyRecordMap.empty() )
     {
-        char*   deviceExtensions = NULL;
+        os << std::endl << "Device Concurrency:" << std::endl;
 
-        cl_int  errorCode = allocateAndGetDeviceInfoString(
-            device,
-            CL_DEVICE_EXTENSIONS,
-            deviceExtensions );
-        if( errorCode == CL_SUCCESS && deviceExtensions )
+        CConcurrencyRecordMap::const_iterator i = m_ConcurrencyRecordMap.begin();
+        while( i != m_ConcurrencyRecordMap.end() )
         {
-            const char* start = deviceExtensions;
-            while( true )
-            {
-                const char* where = strstr( start, extensionName );
-                if( !where )
-                {
-                    break;
-                }
-                const char* terminator = where + strlen( extensionName );
-                if( where == start || *(where - 1) == ' ' )
-                {
-                    if( *terminator == ' ' || *terminator == '\0' )
-                    {
-                        supported = true;
-                        break;
-                    }
-                }
-                start = terminator;
-            }
+            const SDeviceInfo&  deviceInfo = m_DeviceInfoMap[ i->first ];
+
+            os << std::endl << "Device " << deviceInfo.NameForReport << ":" << std::endl;
+            writeConcurrencyReport( os, i->second );
+
+            ++i;
         }
 
-        delete [] deviceExtensions;
+        os << std::endl << "Note: Concurrency is computed from device timestamps for commands from all command queues on each device.  Times are between the start of the first command and the end of the last command, so a concurrency level of 0 is device idle time." << std::endl;
     }
 
-    return supported;
-}
+    if( config().LockContentionTracking &&
+        !m_Mutex.getStats().empty() )
+    {
+        os << std::endl << "Lock Contention:" << std::endl;
 
-///////////////////////////////////////////////////////////////////////////////
-//
-cl_int CLIntercept::allocateAndGetPlatformInfoString(
-    cl_platform_id platform,
-    cl_platform_info param_name,
-    char*& param_value ) const
-{
-    cl_int  errorCode = CL_SUCCESS;
-    size_t  size = 0;
+        // Sort by wait time.
+        const CInstrumentedMutex::CStatsMap& lockStatsMap = m_Mutex.getStats();
 
-    if( errorCode == CL_SUCCESS )
-    {
-        if( param_value != NULL )
+        size_t  longestName = 32;
+
+        std::vector< std::pair< uint64_t, std::string > > sortedNames;
+        CInstrumentedMutex::CStatsMap::const_iterator i = lockStatsMap.begin();
+        while( i != lockStatsMap.end() )
         {
-            CLI_ASSERT( 0 );
-            delete [] param_value;
-            param_value = NULL;
+            sortedNames.push_back( std::make_pair( (*i).second.WaitNS, (*i).first ) );
+            longestName = std::max< size_t >( (*i).first.length(), longestName );
+            ++i;
+        }
+        std::sort( sortedNames.rbegin(), sortedNames.rend() );
+
+        os << std::endl
+            << std::right << std::setw(longestName) << "Function Name" << ", "
+            << std::right << std::setw(13) << "Acquisitions" << ", "
+            << std::right << std::setw(13) << "Contended" << ", "
+            << std::right << std::setw(12) << "Contended %" << ", "
+            << std::right << std::setw(16) << "Total Wait (ns)" << ", "
+            << std::right << std::setw(14) << "Avg Wait (ns)" << ", "
+            << std::right << std::setw(14) << "Max Wait (ns)" << std::endl;
+
+        for( size_t s = 0; s < sortedNames.size(); s++ )
+        {
+            const std::string& name = sortedNames[s].second;
+            const CInstrumentedMutex::SStats& lockStats = lockStatsMap.at( name );
+
+            os << std::right << std::setw(longestName) << name << ", "
+                << std::right << std::setw(13) << lockStats.NumberOfAcquisitions << ", "
+                << std::right << std::setw(13) << lockStats.NumberOfContendedAcquisitions << ", "
+                << std::fixed << std::setprecision(2)
+                << std::right << std::setw(11) << 100.0 * lockStats.NumberOfContendedAcquisitions / lockStats.NumberOfAcquisitions << "%, "
+                << std::right << std::setw(16) << lockStats.WaitNS << ", "
+                << std::right << std::setw(14) << ( lockStats.NumberOfContendedAcquisitions ? lockStats.WaitNS / lockStats.NumberOfContendedAcquisitions : 0 ) << ", "
+                << std::right << std::setw(14) << lockStats.MaxWaitNS << std::endl;
         }
+
+        os << std::endl << "Note: Functions are sorted by total wait time.  An acquisition is contended if the lock was held by another thread, and wait times only include contended acquisitions." << std::endl;
     }
 
-    if( errorCode == CL_SUCCESS )
+    if( config().OverheadBudgetPercent )
     {
-        errorCode = dispatch().clGetPlatformInfo(
-            platform,
-            param_name,
-            0,
-            NULL,
-            &size );
+        const uint64_t  elapsedNS =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_StartTime).count();
+
+        os << std::endl << "Overhead Budget:" << std::endl;
+        os << "  Budget: " << config().OverheadBudgetPercent << "% of host time" << std::endl;
+        os << "  Measured Overhead: " << m_OverheadBudgetTotalNS << " ns ("
+            << std::fixed << std::setprecision(2)
+            << ( elapsedNS ? 100.0 * (double)m_OverheadBudgetTotalNS / (double)elapsedNS : 0.0 )
+            << "% of host time)" << std::endl;
+        os << "  Adjustments: " << m_OverheadBudgetAdjustments << std::endl;
+        os << "  Final Device Timing Sampling Factor: " << m_OverheadBudgetSampleFactor.load() << std::endl;
+        os << "  ChromePerformanceTimingInStages Disabled: " << ( m_OverheadBudgetStagesDisabled.load() ? "yes" : "no" ) << std::endl;
+        os << "  Call Logging Paused: " << ( m_OverheadBudgetCallLoggingPaused.load() ? "yes" : "no" ) << std::endl;
+
+        os << std::endl << "Note: With a device timing sampling factor of N, only one of every N enqueues is timed, so device timing counts are reduced accordingly." << std::endl;
     }
 
-    if( errorCode == CL_SUCCESS )
+    if( config().KernelAnomalyDetection &&
+        !m_KernelAnomalyStatsMap.empty() )
     {
-        if( size != 0 )
+        os << std::endl << "Kernel Anomalies:" << std::endl;
+
+        CDeviceKernelAnomalyStatsMap::const_iterator id = m_KernelAnomalyStatsMap.begin();
+        while( id != m_KernelAnomalyStatsMap.end() )
         {
-            param_value = new char[ size ];
-            if( param_value == NULL )
+            const SDeviceInfo&  deviceInfo = m_DeviceInfoMap[ id->first ];
+            const CKernelAnomalyStatsMap&   kasm = id->second;
+
+            size_t  longestName = 32;
+
+            CKernelAnomalyStatsMap::const_iterator i = kasm.begin();
+            while( i != kasm.end() )
             {
-                errorCode = CL_OUT_OF_HOST_MEMORY;
+                longestName = std::max< size_t >( i->first.length(), longestName );
+                ++i;
+            }
+
+            os << std::endl << "Device " << deviceInfo.NameForReport << ":" << std::endl
+                << std::right << std::setw(longestName) << "Kernel Name" << ", "
+                << std::setw(10) << "Executions" << ", "
+                << std::setw(10) << "Anomalies" << ", "
+                << std::setw(13) << "Mean (ns)" << ", "
+                << std::setw(13) << "StdDev (ns)" << ", "
+                << std::setw(13) << "Max Anom (ns)" << std::endl;
+
+            i = kasm.begin();
+            while( i != kasm.end() )
+            {
+                const SKernelAnomalyStats&  stats = i->second;
+                const double    stddev = stats.NumberOfExecutions > 1 ?
+                    std::sqrt( stats.M2 / (double)( stats.NumberOfExecutions - 1 ) ) :
+                    0.0;
+
+                os << std::right << std::setw(longestName) << i->first << ", "
+                    << std::setw(10) << stats.NumberOfExecutions << ", "
+                    << std::setw(10) << stats.NumberOfAnomalies << ", "
+                    << std::setw(13) << std::fixed << std::setprecision(0) << stats.Mean << ", "
+                    << std::setw(13) << stddev << ", "
+                    << std::setw(13) << stats.MaxAnomalyNS << std::endl;
+
+                ++i;
             }
+
+            ++id;
         }
-    }
 
-    if( errorCode == CL_SUCCESS )
-    {
-        errorCode = dispatch().clGetPlatformInfo(
-            platform,
-            param_name,
-            size,
-            param_value,
-            NULL );
+        os << std::endl << "Note: The mean and standard deviation include all executions, including anomalies.  Each anomaly is logged with its enqueue counter and the conditions when the kernel was enqueued." << std::endl;
     }
 
-    if( errorCode != CL_SUCCESS )
+    if( config().SubmitLatencyAnalysis &&
+        !m_SubmitLatencyPatternStatsMap.empty() )
     {
-        delete [] param_value;
-        param_value = NULL;
-    }
+        os << std::endl << "Submission Latency:" << std::endl;
 
-    return errorCode;
-}
+        writeSubmitLatencyStats( os, "Queue", m_SubmitLatencyQueueStatsMap );
+        writeSubmitLatencyStats( os, "Command Type", m_SubmitLatencyCommandStatsMap );
+        writeSubmitLatencyStats( os, "Flush Pattern", m_SubmitLatencyPatternStatsMap );
 
-///////////////////////////////////////////////////////////////////////////////
-//
-cl_int CLIntercept::allocateAndGetDeviceInfoString(
-    cl_device_id device,
-    cl_device_info param_name,
-    char*& param_value ) const
-{
-    cl_int  errorCode = CL_SUCCESS;
-    size_t  size = 0;
+        os << std::endl << "Note: Queued is the time from when a command is queued to when it is submitted to the device, and Submit is the time from when a command is submitted to when it starts executing.  Latency % is the share of queued and submit time in the total time for the command, including execution.  The flush pattern is the call that submitted the command and the number of commands it submitted; Implicit commands were submitted by the OpenCL implementation without an explicit flush." << std::endl;
+    }
 
-    if( errorCode == CL_SUCCESS )
+    if( config().RedundantSyncChecking &&
+        !m_RedundantSyncStatsMap.empty() )
     {
-        if( param_value != NULL )
+        os << std::endl << "Redundant Synchronization:" << std::endl;
+
+        size_t  longestName = 32;
+
+        CRedundantSyncStatsMap::const_iterator i = m_RedundantSyncStatsMap.begin();
+        while( i != m_RedundantSyncStatsMap.end() )
         {
-            CLI_ASSERT( 0 );
-            delete [] param_value;
-            param_value = NULL;
+            longestName = std::max< size_t >( (*i).first.length(), longestName );
+            ++i;
         }
-    }
 
-    if( errorCode == CL_SUCCESS )
-    {
-        errorCode = dispatch().clGetDeviceInfo(
-            device,
-            param_name,
-            0,
-            NULL,
-            &size );
-    }
+        os << std::endl
+            << std::right << std::setw(longestName) << "Finding" << ", "
+            << std::right << std::setw( 6) << "Calls" << ", "
+            << std::right << std::setw(13) << "Time (ns)" << ", "
+            << std::right << std::setw(13) << "Average (ns)" << std::endl;
 
-    if( errorCode == CL_SUCCESS )
-    {
-        if( size != 0 )
+        i = m_RedundantSyncStatsMap.begin();
+        while( i != m_RedundantSyncStatsMap.end() )
         {
-            param_value = new char[ size ];
-            if( param_value == NULL )
-            {
-                errorCode = CL_OUT_OF_HOST_MEMORY;
-            }
+            const std::string& name = (*i).first;
+            const SRedundantSyncStats& stats = (*i).second;
+
+            os << std::right << std::setw(longestName) << name << ", "
+                << std::right << std::setw( 6) << stats.NumberOfCalls << ", "
+                << std::right << std::setw(13) << stats.HostNS << ", "
+                << std::right << std::setw(13) << stats.HostNS / stats.NumberOfCalls << std::endl;
+
+            ++i;
         }
-    }
 
-    if( errorCode == CL_SUCCESS )
-    {
-        errorCode = dispatch().clGetDeviceInfo(
-            device,
-            param_name,
-            size,
-            param_value,
-            NULL );
+        os << std::endl << "Note: Time is the host time spent in the unnecessary calls.  For clFlush findings this is the time in clFlush, and for blocking reads this is the time the host was blocked.  The blocking read finding is a heuristic: it reports blocking reads that were quickly followed by another enqueue from the same thread, and cannot tell whether the host used the results of the read." << std::endl;
     }
 
-    if( errorCode != CL_SUCCESS )
+#if defined(USE_MDAPI)
+    if( config().DevicePerfCounterEventBasedSampling )
     {
-        delete [] param_value;
-        param_value = NULL;
+        reportMDAPICounters( os );
     }
-
-    return errorCode;
+#endif
 }
 
-///////////////////////////////////////////////////////////////////////////////
-//
-cl_int CLIntercept::allocateAndGetKernelInfoString(
-    cl_kernel kernel,
-    cl_kernel_info param_name,
-    char*& param_value ) const
+#if defined(__linux__) || defined(__APPLE__)
+// This is the layout of the shared memory segment that is used to merge
+// the timing results for all processes on a node for NodeReport.
+struct SNodeReportEntry
 {
-    cl_int  errorCode = CL_SUCCESS;
-    size_t  size = 0;
-
-    if( errorCode == CL_SUCCESS )
+    char        DeviceName[64];     // empty for host timing results
+    char        Name[192];
+    uint64_t    NumberOfCalls;
+    uint64_t    MinNS;
+    uint64_t    MaxNS;
+    uint64_t    TotalNS;
+};
+
+struct SNodeReportSegment
+{
+    uint32_t    Magic;
+    uint32_t    NumAttached;
+    uint32_t    NumProcesses;
+    uint32_t    NumEntries;
+    uint32_t    NumDroppedEntries;
+    uint64_t    TotalEnqueues;
+    SNodeReportEntry    Entries[ 4096 ];
+};
+
+static const uint32_t sc_NodeReportMagic = 0x524E4C44;  // "DLNR"
+
+// Opens and locks the node report segment.  The lock serializes attaching,
+// merging, and writing the report across processes.
+static SNodeReportSegment* OpenNodeReportSegment(
+    const std::string& segmentName,
+    int& fd )
+{
+    // The last process to detach unlinks the segment while it holds the
+    // lock.  If another process opened the segment before it was unlinked,
+    // it will acquire the lock on the unlinked file, so check that the
+    // locked file is still the one with this name, and if it is not, open
+    // the segment again.
+    while( true )
     {
-        if( param_value != NULL )
+        fd = open( segmentName.c_str(), O_RDWR | O_CREAT, 0600 );
+        if( fd < 0 )
         {
-            CLI_ASSERT( 0 );
-            delete [] param_value;
-            param_value = NULL;
+            return NULL;
         }
-    }
 
-    if( errorCode == CL_SUCCESS )
-    {
-        errorCode = dispatch().clGetKernelInfo(
-            kernel,
-            param_name,
-            0,
-            NULL,
-            &size );
+        flock( fd, LOCK_EX );
+
+        struct stat lockedStat;
+        struct stat namedStat;
+        if( fstat( fd, &lockedStat ) == 0 &&
+            stat( segmentName.c_str(), &namedStat ) == 0 &&
+            lockedStat.st_dev == namedStat.st_dev &&
+            lockedStat.st_ino == namedStat.st_ino )
+        {
+            break;
+        }
+
+        flock( fd, LOCK_UN );
+        close( fd );
     }
 
-    if( errorCode == CL_SUCCESS )
+    SNodeReportSegment* pSegment = NULL;
+    if( ftruncate( fd, sizeof(SNodeReportSegment) ) == 0 )
     {
-        if( size != 0 )
+        void*   pMapped = mmap(
+            NULL,
+            sizeof(SNodeReportSegment),
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED,
+            fd,
+            0 );
+        if( pMapped != MAP_FAILED )
         {
-            param_value = new char[ size ];
-            if( param_value == NULL )
-            {
-                errorCode = CL_OUT_OF_HOST_MEMORY;
-            }
+            pSegment = (SNodeReportSegment*)pMapped;
         }
     }
 
-    if( errorCode == CL_SUCCESS )
+    if( pSegment == NULL )
     {
-        errorCode = dispatch().clGetKernelInfo(
-            kernel,
-            param_name,
-            size,
-            param_value,
-            NULL );
+        flock( fd, LOCK_UN );
+        close( fd );
+        fd = -1;
+        return NULL;
     }
 
-    if( errorCode != CL_SUCCESS )
+    if( pSegment->Magic != sc_NodeReportMagic )
     {
-        delete [] param_value;
-        param_value = NULL;
+        memset( pSegment, 0, sizeof(SNodeReportSegment) );
+        pSegment->Magic = sc_NodeReportMagic;
     }
 
-    return errorCode;
+    return pSegment;
 }
 
-///////////////////////////////////////////////////////////////////////////////
-//
-cl_int CLIntercept::allocateAndGetProgramDeviceList(
-    cl_program program,
-    cl_uint& numDevices,
-    cl_device_id*& deviceList ) const
+static void CloseNodeReportSegment(
+    SNodeReportSegment* pSegment,
+    int fd )
 {
-    cl_int  errorCode = CL_SUCCESS;
+    munmap( pSegment, sizeof(SNodeReportSegment) );
+    flock( fd, LOCK_UN );
+    close( fd );
+}
 
-    if( errorCode == CL_SUCCESS )
+static void MergeNodeReportEntry(
+    SNodeReportSegment* pSegment,
+    const std::string& deviceName,
+    const std::string& name,
+    uint64_t numberOfCalls,
+    uint64_t minNS,
+    uint64_t maxNS,
+    uint64_t totalNS )
+{
+    SNodeReportEntry    key;
+    memset( &key, 0, sizeof(key) );
+    strncpy( key.DeviceName, deviceName.c_str(), sizeof(key.DeviceName) - 1 );
+    strncpy( key.Name, name.c_str(), sizeof(key.Name) - 1 );
+
+    SNodeReportEntry*   pEntry = NULL;
+    for( uint32_t e = 0; e < pSegment->NumEntries; e++ )
     {
-        if( deviceList != NULL )
+        if( strcmp( pSegment->Entries[e].DeviceName, key.DeviceName ) == 0 &&
+            strcmp( pSegment->Entries[e].Name, key.Name ) == 0 )
         {
-            CLI_ASSERT( 0 );
-            delete [] deviceList;
-            deviceList = NULL;
+            pEntry = &pSegment->Entries[e];
+            break;
         }
     }
-
-    if( errorCode == CL_SUCCESS )
+    if( pEntry == NULL )
     {
-        errorCode = dispatch().clGetProgramInfo(
-            program,
-            CL_PROGRAM_NUM_DEVICES,
-            sizeof( numDevices ),
-            &numDevices,
-            NULL );
+        const uint32_t  maxEntries =
+            sizeof(pSegment->Entries) / sizeof(pSegment->Entries[0]);
+        if( pSegment->NumEntries >= maxEntries )
+        {
+            pSegment->NumDroppedEntries++;
+            return;
+        }
+
+        pEntry = &pSegment->Entries[ pSegment->NumEntries++ ];
+        *pEntry = key;
+        pEntry->MinNS = UINT64_MAX;
     }
 
-    if( errorCode == CL_SUCCESS )
+    pEntry->NumberOfCalls += numberOfCalls;
+    pEntry->TotalNS += totalNS;
+    pEntry->MinNS = std::min<uint64_t>( pEntry->MinNS, minNS );
+    pEntry->MaxNS = std::max<uint64_t>( pEntry->MaxNS, maxNS );
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::attachNodeReport()
+{
+#if defined(__linux__) || defined(__APPLE__)
+    // All processes from the same launch share the segment.  Use the job
+    // step or namespace from the process manager if there is one.
+    // Otherwise, if this is an MPI process use the parent process ID, which
+    // is the launcher process for the node, and if this is not an MPI
+    // process use this process ID, so repeated runs never share a segment.
+    std::string launchKey;
+    const char* envVal = NULL;
+    int     localRank = 0;
+    int     localSize = 0;
+    if( ( envVal = getenv("SLURM_JOB_ID") ) != NULL ||
+        ( envVal = getenv("PMIX_NAMESPACE") ) != NULL ||
+        ( envVal = getenv("OMPI_MCA_ess_base_jobid") ) != NULL )
     {
-        if( numDevices != 0 )
+        launchKey = envVal;
+        if( ( envVal = getenv("SLURM_STEP_ID") ) != NULL )
         {
-            deviceList = new cl_device_id[ numDevices ];
-            if( deviceList == NULL )
-            {
-                errorCode = CL_OUT_OF_HOST_MEMORY;
-            }
+            launchKey += ".";
+            launchKey += envVal;
         }
+        std::replace( launchKey.begin(), launchKey.end(), '/', '_' );
     }
-
-    if( errorCode == CL_SUCCESS )
+    else if( OS().GetMPILocalRank( localRank, localSize ) )
     {
-        errorCode = dispatch().clGetProgramInfo(
-            program,
-            CL_PROGRAM_DEVICES,
-            numDevices * sizeof( cl_device_id ),
-            deviceList,
-            NULL );
+        launchKey = "ppid" + std::to_string( getppid() );
     }
-
-    if( errorCode != CL_SUCCESS )
+    else
     {
-        numDevices = 0;
+        launchKey = "pid" + std::to_string( getpid() );
+    }
 
-        delete [] deviceList;
-        deviceList = NULL;
+    std::string segmentName =
+        ( access( "/dev/shm", W_OK ) == 0 ) ? "/dev/shm" : "/tmp";
+    segmentName += "/clintercept_node_report.";
+    segmentName += std::to_string( getuid() );
+    segmentName += ".";
+    segmentName += launchKey;
+    segmentName += ".";
+    segmentName += OS().GetProcessName();
+
+    // Each process attaches when it starts and detaches when it writes the
+    // node report, and the last process to detach removes the segment.
+    int fd = -1;
+    SNodeReportSegment* pSegment = OpenNodeReportSegment( segmentName, fd );
+    if( pSegment == NULL )
+    {
+        logf( "Failed to attach to node report segment: %s\n", segmentName.c_str() );
+        return;
     }
 
-    return errorCode;
+    pSegment->NumAttached++;
+    m_NodeReportSegmentName = segmentName;
+
+    CloseNodeReportSegment( pSegment, fd );
+#else
+    log( "NodeReport is not supported on this operating system!\n" );
+#endif
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-cl_int CLIntercept::allocateAndGetKernelISABinary(
-    cl_kernel kernel,
-    cl_device_id device,
-    size_t& kernelISABinarySize,
-    char*& kernelISABinary ) const
+void CLIntercept::writeNodeReport()
 {
-    cl_int  errorCode = CL_SUCCESS;
+#if defined(__linux__) || defined(__APPLE__)
+    if( m_NodeReportSegmentName.empty() )
+    {
+        return;
+    }
 
-    if( errorCode == CL_SUCCESS )
+    const std::string&  segmentName = m_NodeReportSegmentName;
+
+    int fd = -1;
+    SNodeReportSegment* pSegment = OpenNodeReportSegment( segmentName, fd );
+    if( pSegment == NULL )
     {
-        if( kernelISABinary != NULL )
-        {
-            CLI_ASSERT( 0 );
-            delete [] kernelISABinary;
-            kernelISABinary = NULL;
-        }
+        logf( "Failed to map node report segment: %s\n", segmentName.c_str() );
+        return;
     }
 
-    // Prefer to query for the kernel ISA binary using
-    // clGetKernelWorkGroupInfo, which queries for a
-    // specific device.
-    if( errorCode == CL_SUCCESS )
+    // Merge this process' results.
+
+    pSegment->NumProcesses++;
+    pSegment->TotalEnqueues += m_EnqueueCounter;
+
     {
-        errorCode = dispatch().clGetKernelWorkGroupInfo(
-            kernel,
-            device,
-            CL_KERNEL_BINARY_PROGRAM_INTEL,
-            0,
-            NULL,
-            &kernelISABinarySize );
-        if( errorCode == CL_SUCCESS )
+        CHostTimingStatsMap::const_iterator i = m_HostTimingStatsMap.begin();
+        while( i != m_HostTimingStatsMap.end() )
         {
-            if( kernelISABinarySize != 0 )
-            {
-                kernelISABinary = new char[ kernelISABinarySize ];
-            }
-            if( kernelISABinary )
+            const SHostTimingStats& hostTimingStats = (*i).second;
+            if( !(*i).first.empty() )
             {
-                errorCode = dispatch().clGetKernelWorkGroupInfo(
-                    kernel,
-                    device,
-                    CL_KERNEL_BINARY_PROGRAM_INTEL,
-                    kernelISABinarySize,
-                    kernelISABinary,
-                    NULL );
-                if( errorCode != CL_SUCCESS )
-                {
-                    delete [] kernelISABinary;
-                    kernelISABinary = NULL;
-                }
+                MergeNodeReportEntry(
+                    pSegment,
+                    "",
+                    (*i).first,
+                    hostTimingStats.NumberOfCalls,
+                    hostTimingStats.MinNS,
+                    hostTimingStats.MaxNS,
+                    hostTimingStats.TotalNS );
             }
+            ++i;
         }
     }
 
-    // If we weren't successful querying for the kernel ISA
-    // binary using cletKernelWorkGroupInfo, try clGetKernelInfo,
-    // which was supported by some earlier drivers but cannot query
-    // for a specific device.
-    if( errorCode != CL_SUCCESS )
     {
-        errorCode = dispatch().clGetKernelInfo(
-            kernel,
-            CL_KERNEL_BINARY_PROGRAM_INTEL,
-            0,
-            NULL,
-            &kernelISABinarySize );
-        if( errorCode == CL_SUCCESS )
+        CDeviceDeviceTimingStatsMap::const_iterator id = m_DeviceTimingStatsMap.begin();
+        while( id != m_DeviceTimingStatsMap.end() )
         {
-            if( kernelISABinarySize != 0 )
-            {
-                kernelISABinary = new char[ kernelISABinarySize ];
-            }
-            if( kernelISABinary )
+            const SDeviceInfo&  deviceInfo = m_DeviceInfoMap[ (*id).first ];
+
+            CDeviceTimingStatsMap::const_iterator i = (*id).second.begin();
+            while( i != (*id).second.end() )
             {
-                errorCode = dispatch().clGetKernelInfo(
-                    kernel,
-                    CL_KERNEL_BINARY_PROGRAM_INTEL,
-                    kernelISABinarySize,
-                    kernelISABinary,
-                    NULL );
-                if( errorCode != CL_SUCCESS )
+                const SDeviceTimingStats& deviceTimingStats = (*i).second;
+                if( !(*i).first.empty() )
                 {
-                    delete [] kernelISABinary;
-                    kernelISABinary = NULL;
+                    MergeNodeReportEntry(
+                        pSegment,
+                        deviceInfo.NameForReport,
+                        (*i).first,
+                        deviceTimingStats.NumberOfCalls,
+                        deviceTimingStats.MinNS,
+                        deviceTimingStats.MaxNS,
+                        deviceTimingStats.TotalNS );
                 }
+                ++i;
             }
+            ++id;
         }
     }
 
-    if( errorCode != CL_SUCCESS )
-    {
-        kernelISABinarySize = 0;
+    // Rewrite the node report with the merged results.
 
-        delete [] kernelISABinary;
-        kernelISABinary = NULL;
+    CHostTimingStatsMap hostTimingStatsMap;
+    std::map< std::string, CDeviceTimingStatsMap >  deviceTimingStatsMaps;
+    for( uint32_t e = 0; e < pSegment->NumEntries; e++ )
+    {
+        const SNodeReportEntry& entry = pSegment->Entries[e];
+        if( entry.DeviceName[0] == 0 )
+        {
+            SHostTimingStats& hostTimingStats = hostTimingStatsMap[ entry.Name ];
+            hostTimingStats.NumberOfCalls = entry.NumberOfCalls;
+            hostTimingStats.MinNS = entry.MinNS;
+            hostTimingStats.MaxNS = entry.MaxNS;
+            hostTimingStats.TotalNS = entry.TotalNS;
+        }
+        else
+        {
+            SDeviceTimingStats& deviceTimingStats =
+                deviceTimingStatsMaps[ entry.DeviceName ][ entry.Name ];
+            deviceTimingStats.NumberOfCalls = entry.NumberOfCalls;
+            deviceTimingStats.MinNS = entry.MinNS;
+            deviceTimingStats.MaxNS = entry.MaxNS;
+            deviceTimingStats.TotalNS = entry.TotalNS;
+        }
     }
 
-    return errorCode;
-}
-
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::getPlatformInfoString(
-    const cl_platform_id platform,
-    std::string& str ) const
-{
-    str = "";
-
-    cl_int  errorCode = CL_SUCCESS;
+    std::string hostName = OS().GetHostName();
 
-    char*   platformName = NULL;
+    std::string fileName = "";
+    OS().GetDumpDirectoryNameWithoutPid( sc_DumpDirectoryName, fileName );
+    fileName += "/clintercept_node_report.";
+    fileName += hostName;
+    fileName += ".txt";
 
-    errorCode |= allocateAndGetPlatformInfoString(
-        platform,
-        CL_PLATFORM_NAME,
-        platformName );
+    OS().MakeDumpDirectories( fileName );
 
-    if( errorCode != CL_SUCCESS )
-    {
-        CLI_ASSERT( 0 );
-        str += "ERROR";
-    }
-    else
+    std::ofstream os;
+    os.open( fileName.c_str(), std::ios::out | std::ios::binary );
+    if( os.good() )
     {
-        if( platformName )
+        os << "Node Report for " << hostName << ":" << std::endl << std::endl;
+        os << "Processes: " << pSegment->NumProcesses << std::endl;
+        os << "Total Enqueues: " << pSegment->TotalEnqueues << std::endl;
+        if( pSegment->NumDroppedEntries )
         {
-            str += platformName;
+            os << "*** WARNING *** " << pSegment->NumDroppedEntries
+                << " results were dropped because the node report segment is full!" << std::endl;
         }
+
+        if( !hostTimingStatsMap.empty() )
         {
-            char    s[256];
-            CLI_SPRINTF( s, 256, " (%p)",
-                platform );
-            str += s;
+            os << std::endl << "Host Performance Timing Results:" << std::endl;
+            writeHostTimingReport( os, hostTimingStatsMap );
+        }
+
+        std::map< std::string, CDeviceTimingStatsMap >::const_iterator id =
+            deviceTimingStatsMaps.begin();
+        while( id != deviceTimingStatsMaps.end() )
+        {
+            os << std::endl << "Device Performance Timing Results for " << (*id).first << ":" << std::endl;
+            writeDeviceTimingReport( os, (*id).second );
+            ++id;
         }
+
+        os.close();
+    }
+    else
+    {
+        logf( "Failed to open node report file for writing: %s\n", fileName.c_str() );
     }
 
-    delete [] platformName;
-    platformName = NULL;
+    logf( "Merged results into node report (%u processes): %s\n",
+        pSegment->NumProcesses,
+        fileName.c_str() );
+
+    // The last process to detach removes the segment.  The segment is
+    // removed while it is still locked, so a process that attaches later
+    // creates a new segment, and a process that is waiting for the lock
+    // opens the segment again when it sees that it was removed.
+    if( pSegment->NumAttached > 0 )
+    {
+        pSegment->NumAttached--;
+    }
+    if( pSegment->NumAttached == 0 )
+    {
+        unlink( segmentName.c_str() );
+    }
+
+    CloseNodeReportSegment( pSegment, fd );
+    m_NodeReportSegmentName.clear();
+#endif
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::getDeviceInfoString(
-    cl_uint numDevices,
-    const cl_device_id* devices,
-    std::string& str ) const
+void CLIntercept::writeHostTimingReport(
+    std::ostream& os,
+    const CHostTimingStatsMap& hostTimingStatsMap ) const
 {
-    str = "";
+    uint64_t    totalTotalNS = 0;
+    size_t      longestName = 32;
 
-    for( cl_uint i = 0; i < numDevices; i++ )
+    CHostTimingStatsMap::const_iterator i = hostTimingStatsMap.begin();
+    while( i != hostTimingStatsMap.end() )
     {
-        cl_int  errorCode = CL_SUCCESS;
-
-        cl_device_type  deviceType = CL_DEVICE_TYPE_DEFAULT;
-        char*           deviceName = NULL;
-
-        errorCode |= dispatch().clGetDeviceInfo(
-            devices[i],
-            CL_DEVICE_TYPE,
-            sizeof( deviceType ),
-            &deviceType,
-            NULL );
-        errorCode |= allocateAndGetDeviceInfoString(
-            devices[i],
-            CL_DEVICE_NAME,
-            deviceName );
+        const std::string& name = (*i).first;
+        const SHostTimingStats& hostTimingStats = (*i).second;
 
-        if( errorCode != CL_SUCCESS )
+        if( !name.empty() )
         {
-            CLI_ASSERT( 0 );
-            str += "ERROR";
+            totalTotalNS += hostTimingStats.TotalNS;
+            longestName = std::max< size_t >( name.length(), longestName );
         }
-        else
-        {
-            if( i != 0 )
-            {
-                str += ", ";
-            }
 
-            if( deviceName )
-            {
-                str += deviceName;
-            }
-            {
-                char    s[256];
-                CLI_SPRINTF( s, 256, " (%s) (%p)",
-                    enumName().name_device_type( deviceType ).c_str(),
-                    devices[i] );
-                str += s;
-            }
+        ++i;
+    }
+
+    os << std::endl << "Total Time (ns): " << totalTotalNS << std::endl;
+
+    os << std::endl
+        << std::right << std::setw(longestName) << "Function Name" << ", "
+        << std::right << std::setw( 6) << "Calls" << ", "
+        << std::right << std::setw(13) << "Time (ns)" << ", "
+        << std::right << std::setw( 8) << "Time (%)" << ", "
+        << std::right << std::setw(13) << "Average (ns)" << ", "
+        << std::right << std::setw(13) << "Min (ns)" << ", "
+        << std::right << std::setw(13) << "Max (ns)" << std::endl;
+
+    i = hostTimingStatsMap.begin();
+    while( i != hostTimingStatsMap.end() )
+    {
+        const std::string& name = (*i).first;
+        const SHostTimingStats& hostTimingStats = (*i).second;
+
+        if( !name.empty() )
+        {
+            os << std::right << std::setw(longestName) << name << ", "
+                << std::right << std::setw( 6) << hostTimingStats.NumberOfCalls << ", "
+                << std::right << std::setw(13) << hostTimingStats.TotalNS << ", "
+                << std::right << std::setw( 7) << std::fixed << std::setprecision(2) << hostTimingStats.TotalNS * 100.0f / totalTotalNS << "%, "
+                << std::right << std::setw(13) << hostTimingStats.TotalNS / hostTimingStats.NumberOfCalls << ", "
+                << std::right << std::setw(13) << hostTimingStats.MinNS << ", "
+                << std::right << std::setw(13) << hostTimingStats.MaxNS << std::endl;
         }
 
-        delete [] deviceName;
-        deviceName = NULL;
+        ++i;
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::getDevicePartitionPropertiesString(
-    const cl_device_partition_property* properties,
-    std::string& str ) const
+void CLIntercept::writeDeviceTimingReport(
+    std::ostream& os,
+    const CDeviceTimingStatsMap& deviceTimingStatsMap ) const
 {
-    str = "";
+    cl_ulong    totalTotalNS = 0;
+    size_t      longestName = 32;
 
-    if( properties )
+    CDeviceTimingStatsMap::const_iterator i = deviceTimingStatsMap.begin();
+    while( i != deviceTimingStatsMap.end() )
     {
-        char    s[256];
+        const std::string& name = (*i).first;
+        const SDeviceTimingStats& deviceTimingStats = (*i).second;
 
-        while( properties[0] != 0 )
+        if( !name.empty() )
         {
-            cl_int  property = (cl_int)properties[0];
-            str += enumName().name( property ) + " = ";
+            totalTotalNS += deviceTimingStats.TotalNS;
+            longestName = std::max< size_t >( name.length(), longestName );
+        }
 
-            switch( property )
-            {
-            case CL_DEVICE_PARTITION_EQUALLY:
-            case CL_DEVICE_PARTITION_EQUALLY_EXT:
-                {
-                    auto pu = (const cl_uint*)( properties + 1 );
-                    CLI_SPRINTF( s, 256, "%u", pu[0] );
-                    str += s;
+        ++i;
+    }
 
-                    properties += 2;
-                }
-                break;
-            case CL_DEVICE_PARTITION_BY_COUNTS:
-            case CL_DEVICE_PARTITION_BY_COUNTS_EXT:
-                {
-                    ++properties;
-                    str += "{ ";
-                    do
-                    {
-                        if( *properties == CL_DEVICE_PARTITION_BY_COUNTS_LIST_END )
-                        {
-                            str += "CL_DEVICE_PARTITION_BY_COUNTS_LIST_END";
-                        }
-                        else
-                        {
-                            auto pu = (const cl_uint*)properties;
-                            CLI_SPRINTF( s, 256, "%u, ", pu[0] );
-                            str += s;
-                        }
-                    }
-                    while( *properties++ != CL_DEVICE_PARTITION_BY_COUNTS_LIST_END );
-                    str += " }";
-                }
-                break;
-            case CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN:
-                {
-                    auto pd = (const cl_device_affinity_domain*)( properties + 1 );
-                    str += enumName().name_device_affinity_domain(pd[0]);
+    os << std::endl << "Total Time (ns): " << totalTotalNS << std::endl;
 
-                    properties += 2;
-                }
-                break;
-            case CL_DEVICE_PARTITION_BY_NAMES_EXT:
-                {
-                    ++properties;
-                    str += "{ ";
-                    do
-                    {
-                        if( *properties == CL_PARTITION_BY_NAMES_LIST_END_EXT )
-                        {
-                            str += "CL_PARTITION_BY_NAMES_LIST_END_EXT";
-                        }
-                        else
-                        {
-                            auto pu = (const cl_uint*)properties;
-                            CLI_SPRINTF( s, 256, "%u, ", pu[0] );
-                            str += s;
-                        }
-                    }
-                    while( *properties++ != CL_PARTITION_BY_NAMES_LIST_END_EXT );
-                    str += " }";
-                }
-                break;
-            case CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN_EXT:
-                // The extension uses different enums than the OpenCL 1.2
-                // feature, and we don't have an enum map for them (yet).
-                {
-                    CLI_SPRINTF( s, 256, "%04X", (cl_uint)properties[1] );
-                    str += s;
+    os << std::endl
+        << std::right << std::setw(longestName) << "Function Name" << ", "
+        << std::right << std::setw( 6) << "Calls" << ", "
+        << std::right << std::setw(13) << "Time (ns)" << ", "
+        << std::right << std::setw( 8) << "Time (%)" << ", "
+        << std::right << std::setw(13) << "Average (ns)" << ", "
+        << std::right << std::setw(13) << "Min (ns)" << ", "
+        << std::right << std::setw(13) << "Max (ns)" << std::endl;
 
-                    properties += 2;
-                }
-                break;
-            default:
-                {
-                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
-                    str += s;
-                    // Advance by two properties.  This may not be correct,
-                    // but it's the best we can do when the property is
-                    // unknown.
-                    properties += 2;
-                }
-                break;
-            }
+    i = deviceTimingStatsMap.begin();
+    while( i != deviceTimingStatsMap.end() )
+    {
+        const std::string& name = (*i).first;
+        const SDeviceTimingStats& deviceTimingStats = (*i).second;
 
-            if( properties[0] != 0 )
-            {
-                str += ", ";
-            }
+        if( !name.empty() )
+        {
+            os << std::right << std::setw(longestName) << name << ", "
+                << std::right << std::setw( 6) << deviceTimingStats.NumberOfCalls << ", "
+                << std::right << std::setw(13) << deviceTimingStats.TotalNS << ", "
+                << std::right << std::setw( 7) << std::fixed << std::setprecision(2) << deviceTimingStats.TotalNS * 100.0f / totalTotalNS << "%, "
+                << std::right << std::setw(13) << deviceTimingStats.TotalNS / deviceTimingStats.NumberOfCalls << ", "
+                << std::right << std::setw(13) << deviceTimingStats.MinNS << ", "
+                << std::right << std::setw(13) << deviceTimingStats.MaxNS << std::endl;
         }
+
+        ++i;
     }
 }
 
-
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::getEventListString(
-    cl_uint numEvents,
-    const cl_event* eventList,
-    std::string& str ) const
+void CLIntercept::addShortKernelName(
+    const std::string& kernelName )
 {
+    if( kernelName.length() > m_Config.LongKernelNameCutoff )
     {
-        std::ostringstream  ss;
-        ss << "( size = ";
-        ss << numEvents;
-        ss << " )[ ";
-        str += ss.str();
-    }
-    if( eventList )
-    {
-        for( cl_uint i = 0; i < numEvents; i++ )
-        {
-            if( i > 0 )
-            {
-                str += ", ";
-            }
-            {
-                char    s[256];
-                CLI_SPRINTF( s, 256, "%p", eventList[i] );
-                str += s;
-            }
-        }
+        std::string shortKernelName("k_");
+        shortKernelName += std::to_string(m_KernelID);
+        m_LongKernelNameMap[ kernelName ] = shortKernelName;
+
+        logf( "Added kernel name mapping: %s to %s\n",
+            kernelName.c_str(),
+            shortKernelName.c_str() );
+
+        m_KernelID++;
     }
-    str += " ]";
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::getContextPropertiesString(
-    const cl_context_properties* properties,
-    std::string& str ) const
+void CLIntercept::getCallLoggingPrefix(
+    std::string& str )
 {
-    str = "";
-
-    if( properties )
+    if( m_Config.CallLoggingElapsedTime )
     {
-        char    s[256];
+        using us = std::chrono::microseconds;
+        uint64_t usDelta =
+            std::chrono::duration_cast<us>(clock::now() - m_StartTime).count();
 
-        while( properties[0] != 0 )
-        {
-            cl_int  property = (cl_int)properties[0];
-            str += enumName().name( property ) + " = ";
+        std::ostringstream  ss;
 
-            switch( property )
-            {
-            case CL_CONTEXT_PLATFORM:
-                {
-                    const cl_platform_id* pp = (const cl_platform_id*)( properties + 1 );
-                    const cl_platform_id  platform = pp[0];
-                    std::string platformInfo;
-                    getPlatformInfoString( platform, platformInfo );
-                    str += platformInfo;
-                }
-                break;
-            case CL_GL_CONTEXT_KHR:
-            case CL_EGL_DISPLAY_KHR:
-            case CL_GLX_DISPLAY_KHR:
-            case CL_WGL_HDC_KHR:
-            case CL_CGL_SHAREGROUP_KHR:
-#if defined(_WIN32)
-            case CL_CONTEXT_D3D10_DEVICE_KHR:
-            case CL_CONTEXT_D3D11_DEVICE_KHR:
-            case CL_CONTEXT_ADAPTER_D3D9_KHR:
-            case CL_CONTEXT_ADAPTER_D3D9EX_KHR:
-            case CL_CONTEXT_ADAPTER_DXVA_KHR:
-#endif
-                {
-                    const void** pp = (const void**)( properties + 1 );
-                    const void*  value = pp[0];
-                    CLI_SPRINTF( s, 256, "%p", value );
-                    str += s;
-                }
-                break;
-            case CL_CONTEXT_INTEROP_USER_SYNC:
-            case CL_CONTEXT_TERMINATE_KHR:
-                {
-                    const cl_bool*  pb = (const cl_bool*)( properties + 1);
-                    cl_bool value = pb[0];
-                    str += enumName().name_bool( value );
-                }
-                break;
-            case CL_CONTEXT_MEMORY_INITIALIZE_KHR:
-                // TODO: this is a cl_context_memory_initialize_khr bitfield.
-                // Fall through for now.
-            default:
-                {
-                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
-                    str += s;
-                }
-                break;
-            }
+        ss << "Time: ";
+        ss << usDelta;
+        ss << " ";
 
-            properties += 2;
-            if( properties[0] != 0 )
-            {
-                str += ", ";
-            }
-        }
+        str += ss.str();
     }
-    else
+
+    if( m_Config.CallLoggingThreadId ||
+        m_Config.CallLoggingThreadNumber )
     {
-        str = "NULL";
+        uint64_t    threadId = OS().GetThreadID();
+        std::ostringstream  ss;
+
+        if( m_Config.CallLoggingThreadId )
+        {
+            ss << "TID = ";
+            ss << threadId;
+            ss << " ";
+        }
+        if( m_Config.CallLoggingThreadNumber )
+        {
+            unsigned int    threadNumber = getThreadNumber( threadId );
+            ss << "TNum = ";
+            ss << threadNumber;
+            ss << " ";
+        }
+
+        str += ss.str();
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::getSamplerPropertiesString(
-    const cl_sampler_properties* properties,
-    std::string& str ) const
+void CLIntercept::callLoggingEnter(
+    const std::string& functionName,
+    const uint64_t enqueueCounter,
+    const cl_kernel kernel )
 {
-    str = "";
-
-    if( properties )
-    {
-        char    s[256];
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-        while( properties[0] != 0 )
-        {
-            cl_int  property = (cl_int)properties[0];
-            str += enumName().name( property ) + " = ";
+    const clock::time_point overheadStart =
+        m_Config.OverheadBudgetPercent ? clock::now() : clock::time_point();
 
-            switch( property )
-            {
-            case CL_SAMPLER_NORMALIZED_COORDS:
-                {
-                    const cl_bool*  pb = (const cl_bool*)( properties + 1);
-                    cl_bool value = pb[0];
-                    str += enumName().name_bool( value );
-                }
-                break;
-            case CL_SAMPLER_ADDRESSING_MODE:
-            case CL_SAMPLER_FILTER_MODE:
-            case CL_SAMPLER_MIP_FILTER_MODE:
-                {
-                    const cl_int*   pi = (const cl_int*)( properties + 1);
-                    cl_int  value = pi[0];
-                    str += enumName().name( value );
-                }
-                break;
-            case CL_SAMPLER_LOD_MIN:
-            case CL_SAMPLER_LOD_MAX:
-                {
-                    const cl_float* pf = (const cl_float*)( properties + 1 );
+    std::string str;
+    getCallLoggingPrefix( str );
 
-                    cl_float    value = pf[0];
+    str += functionName;
 
-                    CLI_SPRINTF( s, 256, "%.2f", value );
-                    str += s;
-                }
-                break;
-            default:
-                {
-                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
-                    str += s;
-                }
-                break;
-            }
+    if( kernel )
+    {
+        const std::string& kernelName = getShortKernelNameWithHash(kernel);
+        str += "( ";
+        str += kernelName;
+        str += " )";
+    }
 
-            properties += 2;
-            if( properties[0] != 0 )
-            {
-                str += ", ";
-            }
-        }
+    if( m_Config.CallLoggingEnqueueCounter )
+    {
+        std::ostringstream  ss;
+        ss << "; EnqueueCounter: ";
+        ss << enqueueCounter;
+        str += ss.str();
     }
-    else
+
+    log( ">>>> " + str + "\n" );
+
+    if( m_Config.OverheadBudgetPercent )
     {
-        str = "NULL";
+        addOverheadBudgetTime( overheadStart );
     }
 }
-
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::getCommandQueuePropertiesString(
-    const cl_queue_properties* properties,
-    std::string& str ) const
+void CLIntercept::callLoggingEnter(
+    const std::string& functionName,
+    const uint64_t enqueueCounter,
+    const cl_kernel kernel,
+    const char* formatStr,
+    ... )
 {
-    str = "";
+    va_list args;
+    va_start( args, formatStr );
 
-    if( properties )
-    {
-        char    s[256];
+    std::string str = functionName;
 
-        while( properties[0] != 0 )
-        {
-            cl_int  property = (cl_int)properties[0];
-            str += enumName().name( property ) + " = ";
+    if( kernel )
+    {
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-            switch( property )
-            {
-            case CL_QUEUE_PROPERTIES:
-                {
-                    const cl_command_queue_properties*  pp =
-                        (const cl_command_queue_properties*)( properties + 1);
-                    str += enumName().name_command_queue_properties( pp[0] );
-                }
-                break;
-            case CL_QUEUE_SIZE:
-            case CL_QUEUE_FAMILY_INTEL:
-            case CL_QUEUE_INDEX_INTEL:
-                {
-                    const cl_uint*  pu = (const cl_uint*)( properties + 1);
-                    CLI_SPRINTF( s, 256, "%u", pu[0] );
-                    str += s;
-                }
-                break;
-            case CL_QUEUE_PRIORITY_KHR:
-            case CL_QUEUE_THROTTLE_KHR:
-                {
-                    const cl_uint*  pu = (const cl_uint*)( properties + 1);
-                    switch( pu[0] )
-                    {
-                    case CL_QUEUE_PRIORITY_HIGH_KHR: // and CL_QUEUE_THROTTLE_HIGH_KHR:
-                        str += "HIGH";
-                        break;
-                    case CL_QUEUE_PRIORITY_MED_KHR: // and CL_QUEUE_THROTTLE_MED_KHR:
-                        str += "MED";
-                        break;
-                    case CL_QUEUE_PRIORITY_LOW_KHR: // and CL_QUEUE_THROTTLE_LOW_KHR:
-                        str += "LOW";
-                        break;
-                    default:
-                        str += "<Unexpected!>";
-                        break;
-                    }
-                }
-                break;
-            default:
-                {
-                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
-                    str += s;
-                }
-                break;
-            }
+        const std::string& kernelName = getShortKernelNameWithHash(kernel);
+        str += "( ";
+        str += kernelName;
+        str += " )";
+    }
 
-            properties += 2;
-            if( properties[0] != 0 )
-            {
-                str += ", ";
-            }
-        }
+    int size = CLI_VSPRINTF( m_StringBuffer, CLI_STRING_BUFFER_SIZE, formatStr, args );
+    if( size >= 0 && size < CLI_STRING_BUFFER_SIZE )
+    {
+        str += ": ";
+        str += m_StringBuffer;
     }
     else
     {
-        str = "NULL";
+        str += ": too long";
     }
+    callLoggingEnter( str, enqueueCounter, NULL );
+
+    va_end( args );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::getMemPropertiesString(
-    const cl_mem_properties* properties,
-    std::string& str ) const
-{
-    str = "";
-
-    if( properties )
-    {
-        char    s[256];
-
-        while( properties[0] != 0 )
-        {
-            cl_int  property = (cl_int)properties[0];
-            str += enumName().name( property ) + " = ";
+void CLIntercept::callLoggingInfo(
+    const std::string& str )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-            switch( property )
-            {
-            case CL_DEVICE_HANDLE_LIST_KHR:
-                {
-                    ++properties;
-                    str += "{ ";
-                    do
-                    {
-                        if( *properties == CL_DEVICE_HANDLE_LIST_END_KHR )
-                        {
-                            str += "CL_DEVICE_HANDLE_LIST_END_KHR";
-                        }
-                        else
-                        {
-                            auto pDevice = (const cl_device_id*)properties;
-                            std::string deviceInfo;
-                            getDeviceInfoString(
-                                1,
-                                pDevice,
-                                deviceInfo );
-                            str += deviceInfo;
-                            str += ", ";
+    log( "---- " + str + "\n" );
+}
 
-                        }
-                    }
-                    while( *properties++ != CL_DEVICE_HANDLE_LIST_END_KHR );
-                    str += " }";
-                }
-                break;
-            case CL_EXTERNAL_MEMORY_HANDLE_DMA_BUF_KHR:
-            case CL_EXTERNAL_MEMORY_HANDLE_OPAQUE_FD_KHR:
-                {
-                    auto pfd = (const int*)( properties + 1);
-                    CLI_SPRINTF( s, 256, "%d", pfd[0] );
-                    str += s;
-                    properties += 2;
-                }
-                break;
-            case CL_EXTERNAL_MEMORY_HANDLE_OPAQUE_WIN32_KHR:
-            case CL_EXTERNAL_MEMORY_HANDLE_OPAQUE_WIN32_KMT_KHR:
-            case CL_EXTERNAL_MEMORY_HANDLE_D3D11_TEXTURE_KHR:
-            case CL_EXTERNAL_MEMORY_HANDLE_D3D11_TEXTURE_KMT_KHR:
-            case CL_EXTERNAL_MEMORY_HANDLE_D3D12_HEAP_KHR:
-            case CL_EXTERNAL_MEMORY_HANDLE_D3D12_RESOURCE_KHR:
-                {
-                    auto pfd = (const void**)( properties + 1);
-                    CLI_SPRINTF( s, 256, "%p", pfd[0] );
-                    str += s;
-                    properties += 2;
-                }
-                break;
-            default:
-                {
-                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
-                    str += s;
-                    // Advance by two properties.  This may not be correct,
-                    // but it's the best we can do when the property is
-                    // unknown.
-                    properties += 2;
-                }
-                break;
-            }
+void CLIntercept::callLoggingInfo(
+    const char* formatStr,
+    ... )
+{
+    va_list args;
+    va_start( args, formatStr );
 
-            if( properties[0] != 0 )
-            {
-                str += ", ";
-            }
-        }
+    int size = CLI_VSPRINTF( m_StringBuffer, CLI_STRING_BUFFER_SIZE, formatStr, args );
+    if( size >= 0 && size < CLI_STRING_BUFFER_SIZE )
+    {
+        callLoggingInfo( std::string( m_StringBuffer ) );
     }
     else
     {
-        str = "NULL";
+        callLoggingInfo( std::string( "too long" ) );
     }
+
+    va_end( args );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::getSemaphorePropertiesString(
-    const cl_semaphore_properties_khr* properties,
-    std::string& str ) const
+void CLIntercept::callLoggingExit(
+    const std::string& functionName,
+    const cl_int errorCode,
+    const cl_event* event )
 {
-    str = "";
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-    if( properties )
+    const clock::time_point overheadStart =
+        m_Config.OverheadBudgetPercent ? clock::now() : clock::time_point();
+
+    std::string str;
+    getCallLoggingPrefix( str );
+
+    str += functionName;
+
+    if( event )
     {
-        char    s[256];
+        CLI_SPRINTF( m_StringBuffer, CLI_STRING_BUFFER_SIZE, " created event = %p", *event );
+        str += m_StringBuffer;
+    }
 
-        while( properties[0] != 0 )
-        {
-            cl_int  property = (cl_int)properties[0];
-            str += enumName().name( property ) + " = ";
+    str += " -> ";
+    str += m_EnumNameMap.name( errorCode );
 
-            switch( property )
-            {
-            case CL_SEMAPHORE_TYPE_KHR:
-                {
-                    auto pt = (const cl_semaphore_type_khr*)( properties + 1 );
-                    str += enumName().name_semaphore_type( pt[0] );
-                    properties += 2;
-                }
-                break;
-            case CL_DEVICE_HANDLE_LIST_KHR:
-                {
-                    ++properties;
-                    str += "{ ";
-                    do
-                    {
-                        if( *properties == CL_DEVICE_HANDLE_LIST_END_KHR )
-                        {
-                            str += "CL_DEVICE_HANDLE_LIST_END_KHR";
-                        }
-                        else
-                        {
-                            auto pDevice = (const cl_device_id*)properties;
-                            std::string deviceInfo;
-                            getDeviceInfoString(
-                                1,
-                                pDevice,
-                                deviceInfo );
-                            str += deviceInfo;
-                            str += ", ";
+    log( "<<<< " + str + "\n" );
 
-                        }
-                    }
-                    while( *properties++ != CL_DEVICE_HANDLE_LIST_END_KHR );
-                    str += " }";
-                }
-                break;
-            case CL_SEMAPHORE_HANDLE_OPAQUE_FD_KHR:
-            case CL_SEMAPHORE_HANDLE_SYNC_FD_KHR:
-                {
-                    auto pfd = (const int*)( properties + 1);
-                    CLI_SPRINTF( s, 256, "%d", pfd[0] );
-                    str += s;
-                    properties += 2;
-                }
-                break;
-            case CL_SEMAPHORE_HANDLE_D3D12_FENCE_KHR:
-            case CL_SEMAPHORE_HANDLE_OPAQUE_WIN32_KHR:
-            case CL_SEMAPHORE_HANDLE_OPAQUE_WIN32_KMT_KHR:
-                {
-                    auto pfd = (const void**)( properties + 1);
-                    CLI_SPRINTF( s, 256, "%p", pfd[0] );
-                    str += s;
-                    properties += 2;
-                }
-                break;
-            default:
-                {
-                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
-                    str += s;
-                    // Advance by two properties.  This may not be correct,
-                    // but it's the best we can do when the property is
-                    // unknown.
-                    properties += 2;
-                }
-                break;
-            }
+    if( m_Config.OverheadBudgetPercent )
+    {
+        addOverheadBudgetTime( overheadStart );
+    }
+}
+void CLIntercept::callLoggingExit(
+    const std::string& functionName,
+    const cl_int errorCode,
+    const cl_event* event,
+    const char* formatStr,
+    ... )
+{
+    va_list args;
+    va_start( args, formatStr );
 
-            if( properties[0] != 0 )
-            {
-                str += ", ";
-            }
-        }
+    std::string str = functionName;
+
+    if( event )
+    {
+        CLI_SPRINTF( m_StringBuffer, CLI_STRING_BUFFER_SIZE, " created event = %p", *event );
+        str += m_StringBuffer;
+    }
+
+    int size = CLI_VSPRINTF( m_StringBuffer, CLI_STRING_BUFFER_SIZE, formatStr, args );
+    if( size >= 0 && size < CLI_STRING_BUFFER_SIZE )
+    {
+        str += ": ";
+        str += m_StringBuffer;
     }
     else
     {
-        str = "NULL";
+        str += ": too long";
     }
+
+    callLoggingExit( str, errorCode, NULL );
+
+    va_end( args );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::getCommandBufferPropertiesString(
-    const cl_command_buffer_properties_khr* properties,
-    std::string& str ) const
+void CLIntercept::cacheDeviceInfo(
+    cl_device_id device )
 {
-    str = "";
-
-    if( properties )
+    if( device && m_DeviceInfoMap.find(device) == m_DeviceInfoMap.end() )
     {
-        char    s[256];
+        SDeviceInfo&    deviceInfo = m_DeviceInfoMap[device];
 
-        while( properties[0] != 0 )
-        {
-            cl_int  property = (cl_int)properties[0];
-            str += enumName().name( property ) + " = ";
+        char*   deviceName = NULL;
+        cl_uint deviceComputeUnits = 0;
+        cl_uint deviceMaxClockFrequency = 0;
 
-            switch( property )
-            {
-            case CL_COMMAND_BUFFER_FLAGS_KHR:
-                {
-                    auto pt = (const cl_command_buffer_flags_khr*)( properties + 1 );
-                    str += enumName().name_command_buffer_flags( pt[0] );
-                    properties += 2;
-                }
-                break;
-            default:
-                {
-                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
-                    str += s;
-                    // Advance by two properties.  This may not be correct,
-                    // but it's the best we can do when the property is
-                    // unknown.
-                    properties += 2;
-                }
-                break;
-            }
+        allocateAndGetDeviceInfoString(
+            device,
+            CL_DEVICE_NAME,
+            deviceName );
+        dispatch().clGetDeviceInfo(
+            device,
+            CL_DEVICE_MAX_COMPUTE_UNITS,
+            sizeof(deviceComputeUnits),
+            &deviceComputeUnits,
+            NULL );
+        dispatch().clGetDeviceInfo(
+            device,
+            CL_DEVICE_MAX_CLOCK_FREQUENCY,
+            sizeof(deviceMaxClockFrequency),
+            &deviceMaxClockFrequency,
+            NULL );
+        if( deviceName )
+        {
+            std::ostringstream  ss;
+            ss << deviceName << " ("
+                << deviceComputeUnits << "CUs, "
+                << deviceMaxClockFrequency << "MHz)";
 
-            if( properties[0] != 0 )
-            {
-                str += ", ";
-            }
+            deviceInfo.Name = deviceName;
+            deviceInfo.NameForReport = ss.str();
         }
-    }
-    else
-    {
-        str = "NULL";
-    }
-}
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::getCreateKernelsInProgramRetString(
-    cl_int retVal,
-    cl_kernel* kernels,
-    cl_uint* num_kernels_ret,
-    std::string& str ) const
-{
-    if( kernels &&
-        num_kernels_ret &&
-        ( num_kernels_ret[0] != 0 ) )
-    {
-        char    s[256];
+        size_t majorVersion = 0;
+        size_t minorVersion = 0;
+        getDeviceMajorMinorVersion(
+            device,
+            majorVersion,
+            minorVersion );
+        deviceInfo.NumericVersion =
+            CL_MAKE_VERSION_KHR( majorVersion, minorVersion, 0 );
 
-        cl_uint numKernels = num_kernels_ret[0];
+        deviceInfo.NumComputeUnits = deviceComputeUnits;
+        deviceInfo.MaxClockFrequency = deviceMaxClockFrequency;
 
-        str += "kernels = [ ";
-        for( cl_uint i = 0; i < numKernels; i++ )
-        {
-            CLI_SPRINTF( s, 256, "%p", kernels[i] );
-            str += s;
+        cl_uint deviceMemBaseAddrAlign = 0;
+        dispatch().clGetDeviceInfo(
+            device,
+            CL_DEVICE_MEM_BASE_ADDR_ALIGN,
+            sizeof(deviceMemBaseAddrAlign),
+            &deviceMemBaseAddrAlign,
+            NULL );
+        deviceInfo.MemBaseAddrAlign = deviceMemBaseAddrAlign / 8;
 
-            if( i < numKernels - 1 )
-            {
-                str += ", ";
-            }
-        }
-        str += " ]";
+        deviceInfo.Supports_cl_khr_create_command_queue =
+            checkDeviceForExtension( device, "cl_khr_create_command_queue" );
+        deviceInfo.Supports_cl_khr_subgroups =
+            checkDeviceForExtension( device, "cl_khr_subgroups" );
+
+        delete [] deviceName;
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::getKernelArgString(
-    cl_uint arg_index,
-    size_t arg_size,
-    const void* arg_value,
-    std::string& str ) const
+cl_int CLIntercept::getDeviceMajorMinorVersion(
+    cl_device_id device,
+    size_t& majorVersion,
+    size_t& minorVersion ) const
 {
-    char    s[256];
+    char*   deviceVersion = NULL;
 
-    if( checkGetSamplerString(
-            arg_size,
-            arg_value,
-            str ) )
-    {
-        CLI_SPRINTF( s, 256, "index = %u, size = %zu, value = %s\n",
-            arg_index,
-            arg_size,
-            str.c_str() );
-    }
-    else if( ( arg_value != NULL ) &&
-             ( arg_size == sizeof(cl_mem) ) )
-    {
-        cl_mem* pMem = (cl_mem*)arg_value;
-        CLI_SPRINTF( s, 256, "index = %u, size = %zu, value = %p",
-            arg_index,
-            arg_size,
-            pMem[0] );
-    }
-    else if( ( arg_value != NULL ) &&
-             ( arg_size == sizeof(cl_uint) ) )
-    {
-        cl_uint*    pData = (cl_uint*)arg_value;
-        CLI_SPRINTF( s, 256, "index = %u, size = %zu, value = 0x%x",
-            arg_index,
-            arg_size,
-            pData[0] );
-    }
-    else if( ( arg_value != NULL ) &&
-             ( arg_size == sizeof(cl_ulong) ) )
-    {
-        cl_ulong*   pData = (cl_ulong*)arg_value;
-        CLI_SPRINTF( s, 256, "index = %u, size = %zu, value = 0x%jx",
-            arg_index,
-            arg_size,
-            pData[0] );
-    }
-    else if( ( arg_value != NULL ) &&
-             ( arg_size == sizeof(cl_int4) ) )
-    {
-        cl_int4*   pData = (cl_int4*)arg_value;
-        CLI_SPRINTF( s, 256, "index = %u, size = %zu, valueX = 0x%0x, valueY = 0x%0x, valueZ = 0x%0x, valueW = 0x%0x",
-            arg_index,
-            arg_size,
-            pData->s[0],
-            pData->s[1],
-            pData->s[2],
-            pData->s[3]);
-    }
-    else
+    cl_int  errorCode = allocateAndGetDeviceInfoString(
+        device,
+        CL_DEVICE_VERSION,
+        deviceVersion );
+    if( errorCode == CL_SUCCESS && deviceVersion )
     {
-        CLI_SPRINTF( s, 256, "index = %u, size = %zu",
-            arg_index,
-            arg_size );
+        // According to the spec, the device version string should have the form:
+        //   OpenCL <Major>.<Minor> <Vendor Specific Info>
+        getMajorMinorVersionFromString(
+            "OpenCL ",
+            deviceVersion,
+            majorVersion,
+            minorVersion );
     }
 
-    str = s;
+    delete [] deviceVersion;
+    deviceVersion = NULL;
+
+    return errorCode;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::getEnqueueNDRangeKernelArgsString(
-    cl_uint work_dim,
-    const size_t* global_work_offset,
-    const size_t* global_work_size,
-    const size_t* local_work_size,
-    std::string& str ) const
+bool CLIntercept::getMajorMinorVersionFromString(
+    const char* prefix,
+    const char* str,
+    size_t& major,
+    size_t& minor ) const
 {
-    std::ostringstream  ss;
+    major = 0;
+    minor = 0;
 
-    if( global_work_offset )
+    if( str && prefix )
     {
-        ss << "global_work_offset = < ";
-        for( cl_uint i = 0; i < work_dim; i++ )
+        if( strncmp(str, prefix, strlen(prefix)) == 0 )
         {
-            ss << global_work_offset[i];
-            if( i < work_dim - 1 )
+            str += strlen(prefix);
+            while( isdigit(str[0]) )
             {
-                ss << ", ";
+                major *= 10;
+                major += str[0] - '0';
+                str++;
             }
-        }
-        ss << " >, ";
-    }
-
-    ss << "global_work_size = < ";
-    if( global_work_size )
-    {
-        for( cl_uint i = 0; i < work_dim; i++ )
-        {
-            ss << global_work_size[i];
-            if( i < work_dim - 1 )
+            if( str[0] == '.' )
             {
-                ss << " x ";
+                str++;
             }
-        }
-    }
-    else
-    {
-        ss << "NULL?";
-    }
-    ss << " >, ";
-
-    ss << "local_work_size = < ";
-    if( local_work_size )
-    {
-        for( cl_uint i = 0; i < work_dim; i++ )
-        {
-            ss << local_work_size[i];
-            if( i < work_dim - 1 )
+            else
             {
-                ss << " x ";
+                CLI_ASSERT( 0 );
+            }
+            while( isdigit(str[0]) )
+            {
+                minor *= 10;
+                minor += str[0] - '0';
+                str++;
             }
         }
     }
-    else
-    {
-        ss << "NULL";
-    }
-    ss << " >";
 
-    str = ss.str();
+    return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::getCreateSubBufferArgsString(
-    cl_buffer_create_type createType,
-    const void *createInfo,
-    std::string& str ) const
+bool CLIntercept::checkDeviceForExtension(
+    cl_device_id device,
+    const char* extensionName ) const
 {
-    std::ostringstream  ss;
+    bool    supported = false;
 
-    switch( createType )
+    // Sanity check: Be sure the extension name is not NULL and doesn't
+    // contain a space.
+    if( !extensionName || strchr( extensionName, ' ' ) )
     {
-    case CL_BUFFER_CREATE_TYPE_REGION:
-        ss << "region = ";
-        if( createInfo != NULL )
-        {
-            cl_buffer_region*   pRegion = (cl_buffer_region*)createInfo;
-            ss << "{ origin = "
-                << pRegion->origin
-                << ", size = "
-                << pRegion->size
-                << " }";
-        }
-        else
-        {
-            ss << "(NULL)";
-        }
-        break;
-    default:
-        ss << "<Unexpected!>";
-        break;
+        CLI_ASSERT( 0 );
     }
-
-    str = ss.str();
-}
-
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::logCLInfo()
-{
-    if( m_LoggedCLInfo == false )
+    else
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        char*   deviceExtensions = NULL;
 
-        if( m_LoggedCLInfo == false )
+        cl_int  errorCode = allocateAndGetDeviceInfoString(
+            device,
+            CL_DEVICE_EXTENSIONS,
+            deviceExtensions );
+        if( errorCode == CL_SUCCESS && deviceExtensions )
         {
-            m_LoggedCLInfo = true;
-
-            cl_int  errorCode = CL_SUCCESS;
-            cl_uint numPlatforms = 0;
-
-            if( errorCode == CL_SUCCESS )
-            {
-                errorCode = dispatch().clGetPlatformIDs(
-                    0,
-                    NULL,
-                    &numPlatforms );
-            }
-
-            if( errorCode == CL_SUCCESS && numPlatforms != 0 )
+            const char* start = deviceExtensions;
+            while( true )
             {
-                logf( "\nEnumerated %u platform%s.\n\n",
-                    numPlatforms,
-                    numPlatforms > 1 ? "s" : "" );
-
-                cl_platform_id* platforms = new cl_platform_id[numPlatforms];
-                if( platforms )
-                {
-                    errorCode = dispatch().clGetPlatformIDs(
-                        numPlatforms,
-                        platforms,
-                        NULL );
-                }
-                else
+                const char* where = strstr( start, extensionName );
+                if( !where )
                 {
-                    errorCode = CL_OUT_OF_HOST_MEMORY;
+                    break;
                 }
-
-                for( cl_uint p = 0; p < numPlatforms; p++ )
+                const char* terminator = where + strlen( extensionName );
+                if( where == start || *(where - 1) == ' ' )
                 {
-                    if( errorCode == CL_SUCCESS )
-                    {
-                        logf( "Platform %u:\n", p );
-                        logPlatformInfo( platforms[p] );
-                    }
-
-                    cl_uint numDevices = 0;
-
-                    if( errorCode == CL_SUCCESS )
-                    {
-                        errorCode = dispatch().clGetDeviceIDs(
-                            platforms[p],
-                            CL_DEVICE_TYPE_ALL,
-                            0,
-                            NULL,
-                            &numDevices );
-                    }
-                    if( errorCode == CL_SUCCESS && numDevices != 0 )
+                    if( *terminator == ' ' || *terminator == '\0' )
                     {
-                        logf( "\tPlatform has %u device%s.\n\n",
-                            numDevices,
-                            numDevices > 1 ? "s" : "" );
-
-                        cl_device_id*   devices = new cl_device_id[numDevices];
-                        if( devices )
-                        {
-                            errorCode = dispatch().clGetDeviceIDs(
-                                platforms[p],
-                                CL_DEVICE_TYPE_ALL,
-                                numDevices,
-                                devices,
-                                NULL );
-                        }
-                        else
-                        {
-                            errorCode = CL_OUT_OF_HOST_MEMORY;
-                        }
-
-                        for( cl_uint d = 0; d < numDevices; d++ )
-                        {
-                            if( errorCode == CL_SUCCESS )
-                            {
-                                logf( "Device %u:\n", d );
-                                logDeviceInfo( devices[d] );
-                                log( "\n" );
-                            }
-                        }
-
-                        delete [] devices;
+                        supported = true;
+                        break;
                     }
                 }
-
-                delete [] platforms;
+                start = terminator;
             }
         }
+
+        delete [] deviceExtensions;
     }
+
+    return supported;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::logBuild(
-    clock::time_point buildTimeStart,
-    const cl_program program,
-    cl_uint numDevices,
-    const cl_device_id* deviceList )
+cl_int CLIntercept::allocateAndGetPlatformInfoString(
+    cl_platform_id platform,
+    cl_platform_info param_name,
+    char*& param_value ) const
 {
-    std::chrono::duration<float, std::milli>    buildDuration =
-        clock::now() - buildTimeStart;
-
-    std::lock_guard<std::mutex> lock(m_Mutex);
-
-    cl_device_id*   localDeviceList = NULL;
-
     cl_int  errorCode = CL_SUCCESS;
+    size_t  size = 0;
 
-    // There are two possibilities.  Either the device_list is NULL, in which
-    // case we need to get the build log for all devices, or it's non-NULL,
-    // in which case we only need to get the build log for all devices in
-    // the device list.
-
-    if( ( errorCode == CL_SUCCESS ) &&
-        ( deviceList == NULL ) )
+    if( errorCode == CL_SUCCESS )
     {
-        errorCode = allocateAndGetProgramDeviceList(
-            program,
-            numDevices,
-            localDeviceList );
-        if( errorCode == CL_SUCCESS )
+        if( param_value != NULL )
         {
-            deviceList = localDeviceList;
+            CLI_ASSERT( 0 );
+            delete [] param_value;
+            param_value = NULL;
         }
     }
 
-    if( m_Config.BuildLogging &&
-        errorCode == CL_SUCCESS )
+    if( errorCode == CL_SUCCESS )
     {
-        const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
+        errorCode = dispatch().clGetPlatformInfo(
+            platform,
+            param_name,
+            0,
+            NULL,
+            &size );
+    }
 
-        char    numberString[256] = "";
-        if( config().OmitProgramNumber )
+    if( errorCode == CL_SUCCESS )
+    {
+        if( size != 0 )
         {
-            CLI_SPRINTF( numberString, 256, "%08X_%04u_%08X",
-                (unsigned int)programInfo.ProgramHash,
-                programInfo.CompileCount,
-                (unsigned int)programInfo.OptionsHash );
+            param_value = new char[ size ];
+            if( param_value == NULL )
+            {
+                errorCode = CL_OUT_OF_HOST_MEMORY;
+            }
         }
-        else
+    }
+
+    if( errorCode == CL_SUCCESS )
+    {
+        errorCode = dispatch().clGetPlatformInfo(
+            platform,
+            param_name,
+            size,
+            param_value,
+            NULL );
+    }
+
+    if( errorCode != CL_SUCCESS )
+    {
+        delete [] param_value;
+        param_value = NULL;
+    }
+
+    return errorCode;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+cl_int CLIntercept::allocateAndGetDeviceInfoString(
+    cl_device_id device,
+    cl_device_info param_name,
+    char*& param_value ) const
+{
+    cl_int  errorCode = CL_SUCCESS;
+    size_t  size = 0;
+
+    if( errorCode == CL_SUCCESS )
+    {
+        if( param_value != NULL )
         {
-            CLI_SPRINTF( numberString, 256, "%04u_%08X_%04u_%08X",
-                programInfo.ProgramNumber,
-                (unsigned int)programInfo.ProgramHash,
-                programInfo.CompileCount,
-                (unsigned int)programInfo.OptionsHash );
+            CLI_ASSERT( 0 );
+            delete [] param_value;
+            param_value = NULL;
         }
+    }
 
-        logf( "Build Info for program %p (%s) for %u device(s):\n",
-            program,
-            numberString,
-            numDevices );
-
-        float   buildTimeMS = buildDuration.count();
-        logf( "    Build finished in %.2f ms.\n", buildTimeMS );
+    if( errorCode == CL_SUCCESS )
+    {
+        errorCode = dispatch().clGetDeviceInfo(
+            device,
+            param_name,
+            0,
+            NULL,
+            &size );
     }
 
     if( errorCode == CL_SUCCESS )
     {
-        for( cl_uint i = 0; i < numDevices; i++ )
+        if( size != 0 )
         {
-            if( m_Config.BuildLogging )
+            param_value = new char[ size ];
+            if( param_value == NULL )
             {
-                cl_build_status buildStatus = CL_BUILD_NONE;
-                errorCode = dispatch().clGetProgramBuildInfo(
-                    program,
-                    deviceList[ i ],
-                    CL_PROGRAM_BUILD_STATUS,
-                    sizeof( buildStatus ),
-                    &buildStatus,
-                    NULL );
+                errorCode = CL_OUT_OF_HOST_MEMORY;
+            }
+        }
+    }
 
-                if( errorCode == CL_SUCCESS )
-                {
-                    char*   deviceName = NULL;
-                    char*   deviceOpenCLCVersion = NULL;
-                    errorCode = allocateAndGetDeviceInfoString(
-                        deviceList[i],
-                        CL_DEVICE_NAME,
-                        deviceName );
-                    errorCode |= allocateAndGetDeviceInfoString(
-                        deviceList[i],
-                        CL_DEVICE_OPENCL_C_VERSION,
-                        deviceOpenCLCVersion );
+    if( errorCode == CL_SUCCESS )
+    {
+        errorCode = dispatch().clGetDeviceInfo(
+            device,
+            param_name,
+            size,
+            param_value,
+            NULL );
+    }
 
-                    char    str[256] = "";
+    if( errorCode != CL_SUCCESS )
+    {
+        delete [] param_value;
+        param_value = NULL;
+    }
 
-                    CLI_SPRINTF( str, 256, "Build Status for device %u = ", i );
+    return errorCode;
+}
 
-                    std::string message = str;
+///////////////////////////////////////////////////////////////////////////////
+//
+cl_int CLIntercept::allocateAndGetKernelInfoString(
+    cl_kernel kernel,
+    cl_kernel_info param_name,
+    char*& param_value ) const
+{
+    cl_int  errorCode = CL_SUCCESS;
+    size_t  size = 0;
 
-                    if( errorCode == CL_SUCCESS )
-                    {
-                        message += deviceName;
-                        message += " (";
-                        message += deviceOpenCLCVersion;
-                        message += "): ";
-                    }
+    if( errorCode == CL_SUCCESS )
+    {
+        if( param_value != NULL )
+        {
+            CLI_ASSERT( 0 );
+            delete [] param_value;
+            param_value = NULL;
+        }
+    }
 
-                    message += enumName().name_build_status( buildStatus );
-                    message += "\n";
+    if( errorCode == CL_SUCCESS )
+    {
+        errorCode = dispatch().clGetKernelInfo(
+            kernel,
+            param_name,
+            0,
+            NULL,
+            &size );
+    }
 
-                    log( message );
+    if( errorCode == CL_SUCCESS )
+    {
+        if( size != 0 )
+        {
+            param_value = new char[ size ];
+            if( param_value == NULL )
+            {
+                errorCode = CL_OUT_OF_HOST_MEMORY;
+            }
+        }
+    }
 
-                    delete [] deviceName;
-                    deviceName = NULL;
+    if( errorCode == CL_SUCCESS )
+    {
+        errorCode = dispatch().clGetKernelInfo(
+            kernel,
+            param_name,
+            size,
+            param_value,
+            NULL );
+    }
 
-                    delete [] deviceOpenCLCVersion;
-                    deviceOpenCLCVersion = NULL;
-                }
-            }
+    if( errorCode != CL_SUCCESS )
+    {
+        delete [] param_value;
+        param_value = NULL;
+    }
 
-            size_t  buildLogSize = 0;
-            errorCode = dispatch().clGetProgramBuildInfo(
-                program,
-                deviceList[ i ],
-                CL_PROGRAM_BUILD_LOG,
-                0,
-                NULL,
-                &buildLogSize );
+    return errorCode;
+}
 
-            if( errorCode == CL_SUCCESS )
-            {
-                char*   buildLog = new char[ buildLogSize + 1 ];
-                if( buildLog )
-                {
-                    dispatch().clGetProgramBuildInfo(
-                        program,
-                        deviceList[ i ],
-                        CL_PROGRAM_BUILD_LOG,
-                        buildLogSize,
-                        buildLog,
-                        NULL );
+///////////////////////////////////////////////////////////////////////////////
+//
+cl_int CLIntercept::allocateAndGetProgramDeviceList(
+    cl_program program,
+    cl_uint& numDevices,
+    cl_device_id*& deviceList ) const
+{
+    cl_int  errorCode = CL_SUCCESS;
 
-                    // Check if the build log is already null-terminated.
-                    // If it is, we're good, otherwise null terminate it.
-                    if( buildLog[ buildLogSize - 1 ] == '\0' )
-                    {
-                        buildLogSize--;
-                    }
-                    else
-                    {
-                        buildLog[ buildLogSize ] = '\0';
-                    }
+    if( errorCode == CL_SUCCESS )
+    {
+        if( deviceList != NULL )
+        {
+            CLI_ASSERT( 0 );
+            delete [] deviceList;
+            deviceList = NULL;
+        }
+    }
 
-                    if( m_Config.BuildLogging )
-                    {
-                        log( "-------> Start of Build Log:\n" );
-                        log( std::string(buildLog) );
-                        log( "<------- End of Build Log\n\n" );
-                    }
-                    if( m_Config.DumpProgramBuildLogs )
-                    {
-                        dumpProgramBuildLog(
-                            program,
-                            deviceList[ i ],
-                            buildLog,
-                            buildLogSize );
-                    }
+    if( errorCode == CL_SUCCESS )
+    {
+        errorCode = dispatch().clGetProgramInfo(
+            program,
+            CL_PROGRAM_NUM_DEVICES,
+            sizeof( numDevices ),
+            &numDevices,
+            NULL );
+    }
 
-                    delete [] buildLog;
-                }
+    if( errorCode == CL_SUCCESS )
+    {
+        if( numDevices != 0 )
+        {
+            deviceList = new cl_device_id[ numDevices ];
+            if( deviceList == NULL )
+            {
+                errorCode = CL_OUT_OF_HOST_MEMORY;
             }
         }
     }
 
-    delete [] localDeviceList;
-}
+    if( errorCode == CL_SUCCESS )
+    {
+        errorCode = dispatch().clGetProgramInfo(
+            program,
+            CL_PROGRAM_DEVICES,
+            numDevices * sizeof( cl_device_id ),
+            deviceList,
+            NULL );
+    }
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::logError(
-    const std::string& functionName,
-    cl_int errorCode )
-{
-    std::ostringstream  ss;
-    ss << "ERROR! " << functionName << " returned " << enumName().name(errorCode) << " (" << errorCode << ")\n";
+    if( errorCode != CL_SUCCESS )
+    {
+        numDevices = 0;
 
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    log( ss.str() );
-}
+        delete [] deviceList;
+        deviceList = NULL;
+    }
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::logFlushOrFinishAfterEnqueueStart(
-    const std::string& flushOrFinish,
-    const std::string& functionName )
-{
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    log( "Calling " + flushOrFinish + " after " + functionName + "...\n" );
+    return errorCode;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::logFlushOrFinishAfterEnqueueEnd(
-    const std::string& flushOrFinish,
-    const std::string& functionName,
-    cl_int errorCode )
+cl_int CLIntercept::allocateAndGetKernelISABinary(
+    cl_kernel kernel,
+    cl_device_id device,
+    size_t& kernelISABinarySize,
+    char*& kernelISABinary ) const
 {
-    std::ostringstream  ss;
-    ss << "... " << flushOrFinish << " after " << functionName << " returned " << enumName().name( errorCode ) << " (" << errorCode << ")\n";
-
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    log( ss.str() );
-}
+    cl_int  errorCode = CL_SUCCESS;
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::logKernelInfo(
-    const cl_kernel* kernels,
-    cl_uint numKernels )
-{
-    if( numKernels > 0 )
+    if( errorCode == CL_SUCCESS )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
-
-        cl_int  errorCode = CL_SUCCESS;
-
-        // We can share the program and device list for all kernels.
-
-        cl_kernel   queryKernel = kernels[0];
-
-        // First, get the program for this kernel.
-        cl_program  program = NULL;
-        if( errorCode == CL_SUCCESS )
+        if( kernelISABinary != NULL )
         {
-            errorCode = dispatch().clGetKernelInfo(
-                queryKernel,
-                CL_KERNEL_PROGRAM,
-                sizeof(program),
-                &program,
-                NULL );
+            CLI_ASSERT( 0 );
+            delete [] kernelISABinary;
+            kernelISABinary = NULL;
         }
+    }
 
-        // Next, get the list of devices for the program.
-        cl_uint         numDevices = 0;
-        cl_device_id*   deviceList = NULL;
+    // Prefer to query for the kernel ISA binary using
+    // clGetKernelWorkGroupInfo, which queries for a
+    // specific device.
+    if( errorCode == CL_SUCCESS )
+    {
+        errorCode = dispatch().clGetKernelWorkGroupInfo(
+            kernel,
+            device,
+            CL_KERNEL_BINARY_PROGRAM_INTEL,
+            0,
+            NULL,
+            &kernelISABinarySize );
         if( errorCode == CL_SUCCESS )
         {
-            errorCode = allocateAndGetProgramDeviceList(
-                program,
-                numDevices,
-                deviceList );
-        }
-
-        // Log the preferred work group size multiple for each kernel,
-        // for each device.
-        while( numDevices && numKernels-- )
-        {
-            cl_kernel   kernel = kernels[ numKernels ];
-
-            const std::string& kernelName = getShortKernelNameWithHash(kernel);
-            log( "Kernel Info for: " + kernelName + "\n" );
-
-            for( cl_uint i = 0; i < numDevices; i++ )
+            if( kernelISABinarySize != 0 )
             {
-                char*   deviceName = NULL;
-                errorCode = allocateAndGetDeviceInfoString(
-                    deviceList[i],
-                    CL_DEVICE_NAME,
-                    deviceName );
-
-                cl_uint args = 0;
-                errorCode |= dispatch().clGetKernelInfo(
+                kernelISABinary = new char[ kernelISABinarySize ];
+            }
+            if( kernelISABinary )
+            {
+                errorCode = dispatch().clGetKernelWorkGroupInfo(
                     kernel,
-                    CL_KERNEL_NUM_ARGS,
-                    sizeof(args),
-                    &args,
+                    device,
+                    CL_KERNEL_BINARY_PROGRAM_INTEL,
+                    kernelISABinarySize,
+                    kernelISABinary,
                     NULL );
+                if( errorCode != CL_SUCCESS )
+                {
+                    delete [] kernelISABinary;
+                    kernelISABinary = NULL;
+                }
+            }
+        }
+    }
 
-                size_t  pwgsm = 0;
-                errorCode |= dispatch().clGetKernelWorkGroupInfo(
-                    kernel,
-                    deviceList[i],
-                    CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE,
-                    sizeof(pwgsm),
-                    &pwgsm,
-                    NULL );
-                size_t  wgs = 0;
-                errorCode |= dispatch().clGetKernelWorkGroupInfo(
-                    kernel,
-                    deviceList[i],
-                    CL_KERNEL_WORK_GROUP_SIZE,
-                    sizeof(wgs),
-                    &wgs,
-                    NULL );
-                cl_ulong pms = 0;
-                errorCode |= dispatch().clGetKernelWorkGroupInfo(
-                    kernel,
-                    deviceList[i],
-                    CL_KERNEL_PRIVATE_MEM_SIZE,
-                    sizeof(pms),
-                    &pms,
-                    NULL );
-                cl_ulong lms = 0;
-                errorCode |= dispatch().clGetKernelWorkGroupInfo(
-                    kernel,
-                    deviceList[i],
-                    CL_KERNEL_LOCAL_MEM_SIZE,
-                    sizeof(lms),
-                    &lms,
-                    NULL );
-                cl_ulong sms = 0;
-                cl_int errorCode_sms =dispatch().clGetKernelWorkGroupInfo(
+    // If we weren't successful querying for the kernel ISA
+    // binary using cletKernelWorkGroupInfo, try clGetKernelInfo,
+    // which was supported by some earlier drivers but cannot query
+    // for a specific device.
+    if( errorCode != CL_SUCCESS )
+    {
+        errorCode = dispatch().clGetKernelInfo(
+            kernel,
+            CL_KERNEL_BINARY_PROGRAM_INTEL,
+            0,
+            NULL,
+            &kernelISABinarySize );
+        if( errorCode == CL_SUCCESS )
+        {
+            if( kernelISABinarySize != 0 )
+            {
+                kernelISABinary = new char[ kernelISABinarySize ];
+            }
+            if( kernelISABinary )
+            {
+                errorCode = dispatch().clGetKernelInfo(
                     kernel,
-                    deviceList[i],
-                    CL_KERNEL_SPILL_MEM_SIZE_INTEL,
-                    sizeof(sms),
-                    &sms,
+                    CL_KERNEL_BINARY_PROGRAM_INTEL,
+                    kernelISABinarySize,
+                    kernelISABinary,
                     NULL );
-                if( errorCode == CL_SUCCESS )
-                {
-                    logf( "    For device: %s\n",
-                        deviceName );
-                    if( config().KernelInfoLogging )
-                    {
-                        logf( "        Num Args: %u\n", args);
-                    }
-                    if( config().KernelInfoLogging ||
-                        config().PreferredWorkGroupSizeMultipleLogging )
-                    {
-                        logf( "        Preferred Work Group Size Multiple: %zu\n", pwgsm);
-                    }
-                    if( config().KernelInfoLogging )
-                    {
-                        logf( "        Work Group Size: %zu\n", wgs);
-                        logf( "        Private Mem Size: %u\n", (cl_uint)pms);
-                        logf( "        Local Mem Size: %u\n", (cl_uint)lms);
-                        if( errorCode_sms == CL_SUCCESS )
-                        {
-                            logf( "        Spill Mem Size: %u\n", (cl_uint)sms);
-                        }
-                    }
-                }
-                else if( deviceName )
-                {
-                    logf( "Error querying kernel info for device %s!\n", deviceName );
-                }
-                else
+                if( errorCode != CL_SUCCESS )
                 {
-                    logf( "Error querying kernel info!\n" );
+                    delete [] kernelISABinary;
+                    kernelISABinary = NULL;
                 }
-
-                delete [] deviceName;
             }
         }
+    }
 
-        delete [] deviceList;
+    if( errorCode != CL_SUCCESS )
+    {
+        kernelISABinarySize = 0;
+
+        delete [] kernelISABinary;
+        kernelISABinary = NULL;
     }
+
+    return errorCode;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::logQueueInfo(
-    const cl_device_id device,
-    const cl_command_queue queue )
+void CLIntercept::getPlatformInfoString(
+    const cl_platform_id platform,
+    std::string& str ) const
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    str = "";
 
     cl_int  errorCode = CL_SUCCESS;
 
-    logf( "Queue Info for %p:\n", queue );
+    char*   platformName = NULL;
 
-    char*   deviceName = NULL;
-    errorCode |= allocateAndGetDeviceInfoString(
-        device,
-        CL_DEVICE_NAME,
-        deviceName );
-    cl_command_queue_properties props = 0;
-    errorCode |= dispatch().clGetCommandQueueInfo(
-        queue,
-        CL_QUEUE_PROPERTIES,
-        sizeof(props),
-        &props,
-        NULL );
-    if( errorCode == CL_SUCCESS )
+    errorCode |= allocateAndGetPlatformInfoString(
+        platform,
+        CL_PLATFORM_NAME,
+        platformName );
+
+    if( errorCode != CL_SUCCESS )
     {
-        logf( "    For device: %s\n", deviceName );
-        logf( "    Queue properties: %s\n",
-            props == 0 ?
-            "(None)" :
-            enumName().name_command_queue_properties(props).c_str() );
+        CLI_ASSERT( 0 );
+        str += "ERROR";
     }
-
-    // Queue family information, may not be supported for all devices.
-    cl_uint queueFamily = 0;
-    cl_int errorCode_qf = dispatch().clGetCommandQueueInfo(
-        queue,
-        CL_QUEUE_FAMILY_INTEL,
-        sizeof(queueFamily),
-        &queueFamily,
-        NULL );
-    cl_uint queueIndex = 0;
-    errorCode_qf |= dispatch().clGetCommandQueueInfo(
-        queue,
-        CL_QUEUE_INDEX_INTEL,
-        sizeof(queueIndex),
-        &queueIndex,
-        NULL );
-    if( errorCode_qf == CL_SUCCESS )
+    else
     {
-        logf( "    Queue family: %u\n", queueFamily );
-        logf( "    Queue index: %u\n", queueIndex );
+        if( platformName )
+        {
+            str += platformName;
+        }
+        {
+            char    s[256];
+            CLI_SPRINTF( s, 256, " (%p)",
+                platform );
+            str += s;
+        }
     }
 
-    delete [] deviceName;
+    delete [] platformName;
+    platformName = NULL;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-cl_int CLIntercept::autoPartitionGetDeviceIDs(
-    cl_platform_id platform,
-    cl_device_type device_type,
-    cl_uint num_entries,
-    cl_device_id* devices,
-    cl_uint* num_devices )
+void CLIntercept::getDeviceInfoString(
+    cl_uint numDevices,
+    const cl_device_id* devices,
+    std::string& str ) const
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    str = "";
 
-    CLI_ASSERT( config().AutoPartitionAllDevices ||
-                config().AutoPartitionAllSubDevices ||
-                config().AutoPartitionSingleSubDevice );
-
-    cl_int  errorCode = CL_SUCCESS;
-    std::vector<cl_device_id>   parentDevices;
-    std::vector<cl_device_id>   returnedDevices;
-
-    cl_uint numDevices = 0;
-    errorCode = dispatch().clGetDeviceIDs(
-        platform,
-        device_type,
-        0,
-        NULL,
-        &numDevices );
-    if( errorCode == CL_SUCCESS && numDevices != 0 )
-    {
-        parentDevices.resize(numDevices);
-        errorCode = dispatch().clGetDeviceIDs(
-            platform,
-            device_type,
-            numDevices,
-            parentDevices.data(),
-            NULL );
-    }
-
-    for( auto parent : parentDevices )
+    for( cl_uint i = 0; i < numDevices; i++ )
     {
-        std::vector<cl_device_id>&  subDevices = m_SubDeviceCacheMap[parent];
-
-        if( subDevices.empty() )
-        {
-            std::string deviceInfo;
-            getDeviceInfoString(
-                1,
-                &parent,
-                deviceInfo );
-
-            if( subDevices.size() == 0 &&
-                config().AutoPartitionByAffinityDomain )
-            {
-                const cl_device_partition_property props[] = {
-                    CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN,
-                    CL_DEVICE_AFFINITY_DOMAIN_NEXT_PARTITIONABLE,
-                    0
-                };
-
-                cl_uint numSubDevices = 0;
-                dispatch().clCreateSubDevices(
-                    parent,
-                    props,
-                    0,
-                    NULL,
-                    &numSubDevices );
-                if( numSubDevices > 1 )
-                {
-                    logf("Partitioned device %s by affinity domain into %u sub-devices.\n",
-                        deviceInfo.c_str(),
-                        numSubDevices );
-
-                    subDevices.resize(numSubDevices);
-                    dispatch().clCreateSubDevices(
-                        parent,
-                        props,
-                        numSubDevices,
-                        subDevices.data(),
-                        NULL );
-                }
-            }
-
-            if( subDevices.size() == 0 &&
-                config().AutoPartitionEqually )
-            {
-                const cl_device_partition_property props[] = {
-                    CL_DEVICE_PARTITION_EQUALLY,
-                    (cl_device_partition_property)config().AutoPartitionEqually,
-                    0
-                };
-
-                cl_uint numSubDevices = 0;
-                dispatch().clCreateSubDevices(
-                    parent,
-                    props,
-                    0,
-                    NULL,
-                    &numSubDevices );
-                if( numSubDevices > 1 )
-                {
-                    logf("Partitioned device %s equally into %u sub-devices with %u compute unit%s.\n",
-                        deviceInfo.c_str(),
-                        numSubDevices,
-                        config().AutoPartitionEqually,
-                        config().AutoPartitionEqually > 1 ? "s" : "" );
+        cl_int  errorCode = CL_SUCCESS;
 
-                    subDevices.resize(numSubDevices);
-                    dispatch().clCreateSubDevices(
-                        parent,
-                        props,
-                        numSubDevices,
-                        subDevices.data(),
-                        NULL );
-                }
-            }
+        cl_device_type  deviceType = CL_DEVICE_TYPE_DEFAULT;
+        char*           deviceName = NULL;
 
-            if( subDevices.size() == 0 )
-            {
-                logf("Couldn't partition device %s.\n",
-                    deviceInfo.c_str() );
-            }
-        }
+        errorCode |= dispatch().clGetDeviceInfo(
+            devices[i],
+            CL_DEVICE_TYPE,
+            sizeof( deviceType ),
+            &deviceType,
+            NULL );
+        errorCode |= allocateAndGetDeviceInfoString(
+            devices[i],
+            CL_DEVICE_NAME,
+            deviceName );
 
-        if( subDevices.size() == 0 )
+        if( errorCode != CL_SUCCESS )
         {
-            returnedDevices.push_back(parent);
+            CLI_ASSERT( 0 );
+            str += "ERROR";
         }
         else
         {
-            if( config().AutoPartitionAllDevices )
-            {
-                returnedDevices.push_back(parent);
-            }
-            if( config().AutoPartitionAllDevices ||
-                config().AutoPartitionAllSubDevices )
-            {
-                returnedDevices.insert(
-                    returnedDevices.end(),
-                    subDevices.begin(),
-                    subDevices.end() );
-            }
-            else if( config().AutoPartitionSingleSubDevice )
+            if( i != 0 )
             {
-                returnedDevices.push_back( subDevices.front() );
+                str += ", ";
             }
-            else
+
+            if( deviceName )
             {
-                CLI_ASSERT( 0 );
-                returnedDevices.push_back( parent );
+                str += deviceName;
             }
-        }
-    }
-
-    if( errorCode == CL_SUCCESS )
-    {
-        for( cl_uint d = 0; d < returnedDevices.size(); d++ )
-        {
-            if( d < num_entries )
             {
-                devices[d] = returnedDevices[d];
+                char    s[256];
+                CLI_SPRINTF( s, 256, " (%s) (%p)",
+                    enumName().name_device_type( deviceType ).c_str(),
+                    devices[i] );
+                str += s;
             }
         }
 
-        if( num_devices )
-        {
-            num_devices[0] = (cl_uint)returnedDevices.size();
-        }
+        delete [] deviceName;
+        deviceName = NULL;
     }
-
-    return errorCode;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::contextCallbackCaller(
-    const char* errinfo,
-    const void* private_info,
-    size_t cb,
-    void* user_data )
+void CLIntercept::getDevicePartitionPropertiesString(
+    const cl_device_partition_property* properties,
+    std::string& str ) const
 {
-    SContextCallbackInfo*   pContextCallbackInfo =
-        (SContextCallbackInfo*)user_data;
+    str = "";
 
-    pContextCallbackInfo->pIntercept->contextCallback(
-        errinfo,
-        private_info,
-        cb );
-    if( pContextCallbackInfo->pApplicationCallback )
+    if( properties )
     {
-        pContextCallbackInfo->pApplicationCallback(
-            errinfo,
-            private_info,
-            cb,
-            pContextCallbackInfo->pUserData );
-    }
-}
-
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::contextCallback(
-    const std::string& errinfo,
-    const void* private_info,
-    size_t cb )
-{
-    char    str[256] = "";
-    CLI_SPRINTF( str, 256, "=======> Context Callback (private_info = %p, cb = %zu):\n",
-        private_info,
-        cb );
-
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    log( str + errinfo + "\n" + "<======= End of Context Callback\n" );
-}
+        char    s[256];
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::contextCallbackOverrideInit(
-    const cl_context_properties* properties,
-    void (CL_CALLBACK*& pCallback)( const char*, const void*, size_t, void* ),
-    void*& pUserData,
-    SContextCallbackInfo*& pContextCallbackInfo,
-    cl_context_properties*& pLocalContextProperties )
-{
-    if( m_Config.ContextCallbackLogging )
-    {
-        pContextCallbackInfo = new SContextCallbackInfo;
-        if( pContextCallbackInfo )
+        while( properties[0] != 0 )
         {
-            pContextCallbackInfo->pIntercept = this;
-            pContextCallbackInfo->pApplicationCallback = pCallback;
-            pContextCallbackInfo->pUserData = pUserData;
-
-            pCallback = CLIntercept::contextCallbackCaller;
-            pUserData = pContextCallbackInfo;
-        }
-    }
+            cl_int  property = (cl_int)properties[0];
+            str += enumName().name( property ) + " = ";
 
-    if( m_Config.ContextHintLevel )
-    {
-        // We want to add a context hints to the context properties, unless
-        // the context properties already requests performance hints
-        // (requesting the same property twice is an error).  So, look through
-        // the context properties for the performance hint enum.  We need to
-        // do this anyways to count the number of property pairs.
-        bool    foundPerformanceHintEnum = false;
-        int     numProperties = 0;
-        if( properties )
-        {
-            while( properties[ numProperties ] != 0 )
+            switch( property )
             {
-                if( properties[ numProperties ] == CL_CONTEXT_SHOW_DIAGNOSTICS_INTEL )
+            case CL_DEVICE_PARTITION_EQUALLY:
+            case CL_DEVICE_PARTITION_EQUALLY_EXT:
                 {
-                    foundPerformanceHintEnum = true;
-                }
-                numProperties += 2;
-            }
-        }
+                    auto pu = (const cl_uint*)( properties + 1 );
+                    CLI_SPRINTF( s, 256, "%u", pu[0] );
+                    str += s;
 
-        if( foundPerformanceHintEnum == false )
-        {
-            // The performance hint property isn't already set, so we'll
-            // need to allocate an extra pair of properties for it.
-            numProperties += 2;
-        }
-
-        // Allocate a new array of properties.  We need to allocate two
-        // properties for each pair, plus one property for the terminating
-        // zero.
-        pLocalContextProperties = new cl_context_properties[ numProperties + 1 ];
-        if( pLocalContextProperties )
-        {
-            // Copy the old properties array to the new properties array,
-            // if the new properties array exists.
-            numProperties = 0;
-            if( properties )
-            {
-                while( properties[ numProperties ] != 0 )
+                    properties += 2;
+                }
+                break;
+            case CL_DEVICE_PARTITION_BY_COUNTS:
+            case CL_DEVICE_PARTITION_BY_COUNTS_EXT:
                 {
-                    pLocalContextProperties[ numProperties ] = properties[ numProperties ];
-                    if( properties[ numProperties ] == CL_CONTEXT_SHOW_DIAGNOSTICS_INTEL )
+                    ++properties;
+                    str += "{ ";
+                    do
                     {
-                        CLI_ASSERT( foundPerformanceHintEnum );
-                        pLocalContextProperties[ numProperties + 1 ] = m_Config.ContextHintLevel;
+                        if( *properties == CL_DEVICE_PARTITION_BY_COUNTS_LIST_END )
+                        {
+                            str += "CL_DEVICE_PARTITION_BY_COUNTS_LIST_END";
+                        }
+                        else
+                        {
+                            auto pu = (const cl_uint*)properties;
+                            CLI_SPRINTF( s, 256, "%u, ", pu[0] );
+                            str += s;
+                        }
                     }
-                    else
+                    while( *properties++ != CL_DEVICE_PARTITION_BY_COUNTS_LIST_END );
+                    str += " }";
+                }
+                break;
+            case CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN:
+                {
+                    auto pd = (const cl_device_affinity_domain*)( properties + 1 );
+                    str += enumName().name_device_affinity_domain(pd[0]);
+
+                    properties += 2;
+                }
+                break;
+            case CL_DEVICE_PARTITION_BY_NAMES_EXT:
+                {
+                    ++properties;
+                    str += "{ ";
+                    do
                     {
-                        pLocalContextProperties[ numProperties + 1 ] = properties[ numProperties + 1 ];
+                        if( *properties == CL_PARTITION_BY_NAMES_LIST_END_EXT )
+                        {
+                            str += "CL_PARTITION_BY_NAMES_LIST_END_EXT";
+                        }
+                        else
+                        {
+                            auto pu = (const cl_uint*)properties;
+                            CLI_SPRINTF( s, 256, "%u, ", pu[0] );
+                            str += s;
+                        }
                     }
-                    numProperties += 2;
+                    while( *properties++ != CL_PARTITION_BY_NAMES_LIST_END_EXT );
+                    str += " }";
+                }
+                break;
+            case CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN_EXT:
+                // The extension uses different enums than the OpenCL 1.2
+                // feature, and we don't have an enum map for them (yet).
+                {
+                    CLI_SPRINTF( s, 256, "%04X", (cl_uint)properties[1] );
+                    str += s;
+
+                    properties += 2;
+                }
+                break;
+            default:
+                {
+                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
+                    str += s;
+                    // Advance by two properties.  This may not be correct,
+                    // but it's the best we can do when the property is
+                    // unknown.
+                    properties += 2;
                 }
+                break;
             }
-            // Add the performance hint property if it wasn't already set.
-            if( foundPerformanceHintEnum == false )
+
+            if( properties[0] != 0 )
             {
-                pLocalContextProperties[ numProperties ] = CL_CONTEXT_SHOW_DIAGNOSTICS_INTEL;
-                pLocalContextProperties[ numProperties + 1 ] = m_Config.ContextHintLevel;
-                numProperties += 2;
+                str += ", ";
             }
-            // Add the terminating zero.
-            pLocalContextProperties[ numProperties ] = 0;
         }
     }
 }
 
+
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::contextCallbackOverrideCleanup(
-    const cl_context context,
-    SContextCallbackInfo*& pContextCallbackInfo,
-    cl_context_properties*& pLocalContextProperties )
+void CLIntercept::getEventListString(
+    cl_uint numEvents,
+    const cl_event* eventList,
+    std::string& str ) const
 {
-    if( context && pContextCallbackInfo )
-    {
-        std::lock_guard<std::mutex> lock(m_Mutex);
-
-        // Check if we already have a context callback info for this context.  If
-        // we do, free it.
-        SContextCallbackInfo* pOldContextCallbackInfo =
-            m_ContextCallbackInfoMap[ context ];
-        if( pOldContextCallbackInfo )
-        {
-            delete pOldContextCallbackInfo;
-            pOldContextCallbackInfo = NULL;
-        }
-
-        m_ContextCallbackInfoMap[ context ]  = pContextCallbackInfo;
-    }
-    else
     {
-        delete pContextCallbackInfo;
-        pContextCallbackInfo = NULL;
+        std::ostringstream  ss;
+        ss << "( size = ";
+        ss << numEvents;
+        ss << " )[ ";
+        str += ss.str();
     }
-
-    if( pLocalContextProperties )
+    if( eventList )
     {
-        delete pLocalContextProperties;
-        pLocalContextProperties = NULL;
+        for( cl_uint i = 0; i < numEvents; i++ )
+        {
+            if( i > 0 )
+            {
+                str += ", ";
+            }
+            {
+                char    s[256];
+                CLI_SPRINTF( s, 256, "%p", eventList[i] );
+                str += s;
+            }
+        }
     }
+    str += " ]";
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::eventCallbackCaller(
-    cl_event event,
-    cl_int status,
-    void* user_data )
+void CLIntercept::getContextPropertiesString(
+    const cl_context_properties* properties,
+    std::string& str ) const
 {
-    SEventCallbackInfo* pEventCallbackInfo =
-        (SEventCallbackInfo*)user_data;
+    str = "";
 
-    CLIntercept*    pIntercept = pEventCallbackInfo->pIntercept;
+    if( properties )
+    {
+        char    s[256];
 
-    GET_ENQUEUE_COUNTER();
-    CALL_LOGGING_ENTER( "event = %p, status = %s (%d)",
-        event,
-        pIntercept->enumName().name_command_exec_status( status ).c_str(),
-        status );
+        while( properties[0] != 0 )
+        {
+            cl_int  property = (cl_int)properties[0];
+            str += enumName().name( property ) + " = ";
 
-    clock::time_point   cpuStart = clock::now();
+            switch( property )
+            {
+            case CL_CONTEXT_PLATFORM:
+                {
+                    const cl_platform_id* pp = (const cl_platform_id*)( properties + 1 );
+                    const cl_platform_id  platform = pp[0];
+                    std::string platformInfo;
+                    getPlatformInfoString( platform, platformInfo );
+                    str += platformInfo;
+                }
+                break;
+            case CL_GL_CONTEXT_KHR:
+            case CL_EGL_DISPLAY_KHR:
+            case CL_GLX_DISPLAY_KHR:
+            case CL_WGL_HDC_KHR:
+            case CL_CGL_SHAREGROUP_KHR:
+#if defined(_WIN32)
+            case CL_CONTEXT_D3D10_DEVICE_KHR:
+            case CL_CONTEXT_D3D11_DEVICE_KHR:
+            case CL_CONTEXT_ADAPTER_D3D9_KHR:
+            case CL_CONTEXT_ADAPTER_D3D9EX_KHR:
+            case CL_CONTEXT_ADAPTER_DXVA_KHR:
+#endif
+                {
+                    const void** pp = (const void**)( properties + 1 );
+                    const void*  value = pp[0];
+                    CLI_SPRINTF( s, 256, "%p", value );
+                    str += s;
+                }
+                break;
+            case CL_CONTEXT_INTEROP_USER_SYNC:
+            case CL_CONTEXT_TERMINATE_KHR:
+                {
+                    const cl_bool*  pb = (const cl_bool*)( properties + 1);
+                    cl_bool value = pb[0];
+                    str += enumName().name_bool( value );
+                }
+                break;
+            case CL_CONTEXT_MEMORY_INITIALIZE_KHR:
+                // TODO: this is a cl_context_memory_initialize_khr bitfield.
+                // Fall through for now.
+            default:
+                {
+                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
+                    str += s;
+                }
+                break;
+            }
 
-    pIntercept->eventCallback(
-        event,
-        status );
-    if( pEventCallbackInfo->pApplicationCallback )
+            properties += 2;
+            if( properties[0] != 0 )
+            {
+                str += ", ";
+            }
+        }
+    }
+    else
     {
-        pEventCallbackInfo->pApplicationCallback(
-            event,
-            status,
-            pEventCallbackInfo->pUserData );
+        str = "NULL";
     }
-
-    clock::time_point   cpuEnd = clock::now();
-
-    CALL_LOGGING_EXIT( CL_SUCCESS );
-
-    delete pEventCallbackInfo;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::eventCallback(
-    cl_event event,
-    cl_int status )
+void CLIntercept::getSamplerPropertiesString(
+    const cl_sampler_properties* properties,
+    std::string& str ) const
 {
-    // TODO: Since we call log the eventCallbackCaller, do we need to do
-    //       anything here?
-}
+    str = "";
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::overrideNullLocalWorkSize(
-    const cl_uint work_dim,
-    const size_t* global_work_size,
-    const size_t*& local_work_size )
-{
-    if( local_work_size == NULL )
+    if( properties )
     {
-        switch( work_dim )
+        char    s[256];
+
+        while( properties[0] != 0 )
         {
-        case 1:
-            if( m_Config.NullLocalWorkSizeX != 0 )
+            cl_int  property = (cl_int)properties[0];
+            str += enumName().name( property ) + " = ";
+
+            switch( property )
             {
-                if( global_work_size[0] % m_Config.NullLocalWorkSizeX == 0 )
+            case CL_SAMPLER_NORMALIZED_COORDS:
                 {
-                    local_work_size = &m_Config.NullLocalWorkSizeX;
+                    const cl_bool*  pb = (const cl_bool*)( properties + 1);
+                    cl_bool value = pb[0];
+                    str += enumName().name_bool( value );
                 }
-                else
+                break;
+            case CL_SAMPLER_ADDRESSING_MODE:
+            case CL_SAMPLER_FILTER_MODE:
+            case CL_SAMPLER_MIP_FILTER_MODE:
                 {
-                    std::lock_guard<std::mutex> lock(m_Mutex);
-                    logf( "Couldn't override NULL local work size: < %zu > %% < %zu > != 0!\n",
-                        global_work_size[0],
-                        m_Config.NullLocalWorkSizeX );
+                    const cl_int*   pi = (const cl_int*)( properties + 1);
+                    cl_int  value = pi[0];
+                    str += enumName().name( value );
                 }
-            }
-            break;
-        case 2:
-            if( ( m_Config.NullLocalWorkSizeX != 0 ) &&
-                ( m_Config.NullLocalWorkSizeY != 0 ) )
-            {
-                if( ( global_work_size[0] % m_Config.NullLocalWorkSizeX == 0 ) &&
-                    ( global_work_size[1] % m_Config.NullLocalWorkSizeY == 0 ) )
+                break;
+            case CL_SAMPLER_LOD_MIN:
+            case CL_SAMPLER_LOD_MAX:
                 {
-                    local_work_size = &m_Config.NullLocalWorkSizeX;
+                    const cl_float* pf = (const cl_float*)( properties + 1 );
+
+                    cl_float    value = pf[0];
+
+                    CLI_SPRINTF( s, 256, "%.2f", value );
+                    str += s;
                 }
-                else
+                break;
+            default:
                 {
-                    std::lock_guard<std::mutex> lock(m_Mutex);
-                    logf( "Couldn't override NULL local work size: < %zu x %zu > %% < %zu x %zu > != 0!\n",
-                        global_work_size[0],
-                        global_work_size[1],
-                        m_Config.NullLocalWorkSizeX,
-                        m_Config.NullLocalWorkSizeY );
+                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
+                    str += s;
                 }
+                break;
             }
-            break;
-        case 3:
-            if( ( m_Config.NullLocalWorkSizeX != 0 ) &&
-                ( m_Config.NullLocalWorkSizeY != 0 ) &&
-                ( m_Config.NullLocalWorkSizeZ != 0 ) )
+
+            properties += 2;
+            if( properties[0] != 0 )
             {
-                if( ( global_work_size[0] % m_Config.NullLocalWorkSizeX == 0 ) &&
-                    ( global_work_size[1] % m_Config.NullLocalWorkSizeY == 0 ) &&
-                    ( global_work_size[2] % m_Config.NullLocalWorkSizeZ == 0 ) )
-                {
-                    local_work_size = &m_Config.NullLocalWorkSizeX;
-                }
-                else
-                {
-                    std::lock_guard<std::mutex> lock(m_Mutex);
-                    logf( "Couldn't override NULL local work size: < %zu x %zu x %zu > %% < %zu x %zu x %zu > != 0!\n",
-                        global_work_size[0],
-                        global_work_size[1],
-                        global_work_size[2],
-                        m_Config.NullLocalWorkSizeX,
-                        m_Config.NullLocalWorkSizeY,
-                        m_Config.NullLocalWorkSizeZ );
-                }
+                str += ", ";
             }
-            break;
-        default:
-            // Nothing.
-            break;
         }
     }
+    else
+    {
+        str = "NULL";
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::combineProgramStrings(
-    cl_uint& count,
-    const char**& strings,
-    const size_t*& lengths,
-    char*& singleString ) const
+void CLIntercept::getCommandQueuePropertiesString(
+    const cl_queue_properties* properties,
+    std::string& str ) const
 {
-    size_t  allocSize = 0;
-    cl_uint i = 0;
-
-    for( i = 0; i < count; i++ )
-    {
-        size_t  length = 0;
-        if( ( lengths == NULL ) ||
-            ( lengths[i] == 0 ) )
-        {
-            if( strings != NULL && strings[i] != NULL )
-            {
-                length = strlen( strings[i] );
-            }
-        }
-        else
-        {
-            length = lengths[i];
-        }
-        allocSize += length;
-    }
-
-    // Allocate a multiple of four bytes.
-    // Allocate some extra to make sure we're null terminated.
-    allocSize = ( allocSize + ( 4 + 4 - 1 ) ) & ~( 4 - 1 );
+    str = "";
 
-    singleString = new char[ allocSize ];
-    if( singleString )
+    if( properties )
     {
-        memset( singleString, 0, allocSize );
+        char    s[256];
 
-        char*   pDst = singleString;
-        size_t  remaining = allocSize;
-        for( i = 0; i < count; i++ )
+        while( properties[0] != 0 )
         {
-            size_t  length = 0;
-            if( ( lengths == NULL ) ||
-                ( lengths[i] == 0 ) )
+            cl_int  property = (cl_int)properties[0];
+            str += enumName().name( property ) + " = ";
+
+            switch( property )
             {
-                if( strings != NULL && strings[i] != NULL )
+            case CL_QUEUE_PROPERTIES:
                 {
-                    length = strlen( strings[i] );
+                    const cl_command_queue_properties*  pp =
+                        (const cl_command_queue_properties*)( properties + 1);
+                    str += enumName().name_command_queue_properties( pp[0] );
                 }
+                break;
+            case CL_QUEUE_SIZE:
+            case CL_QUEUE_FAMILY_INTEL:
+            case CL_QUEUE_INDEX_INTEL:
+                {
+                    const cl_uint*  pu = (const cl_uint*)( properties + 1);
+                    CLI_SPRINTF( s, 256, "%u", pu[0] );
+                    str += s;
+                }
+                break;
+            case CL_QUEUE_PRIORITY_KHR:
+            case CL_QUEUE_THROTTLE_KHR:
+                {
+                    const cl_uint*  pu = (const cl_uint*)( properties + 1);
+                    switch( pu[0] )
+                    {
+                    case CL_QUEUE_PRIORITY_HIGH_KHR: // and CL_QUEUE_THROTTLE_HIGH_KHR:
+                        str += "HIGH";
+                        break;
+                    case CL_QUEUE_PRIORITY_MED_KHR: // and CL_QUEUE_THROTTLE_MED_KHR:
+                        str += "MED";
+                        break;
+                    case CL_QUEUE_PRIORITY_LOW_KHR: // and CL_QUEUE_THROTTLE_LOW_KHR:
+                        str += "LOW";
+                        break;
+                    default:
+                        str += "<Unexpected!>";
+                        break;
+                    }
+                }
+                break;
+            default:
+                {
+                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
+                    str += s;
+                }
+                break;
             }
-            else
-            {
-                length = lengths[i];
-            }
-            if( length )
-            {
-                CLI_MEMCPY(
-                    pDst,
-                    remaining,
-                    strings[i],
-                    length );
-                pDst += length;
-                remaining -= length;
-            }
-        }
 
-        // Replace any NULL chars between kernels with spaces.
-        if( count > 1 )
-        {
-            for( char* pStr = singleString; pStr < pDst - 1; pStr++ )
+            properties += 2;
+            if( properties[0] != 0 )
             {
-                if( *pStr == 0x0 )
-                {
-                    *pStr = 0x20;
-                }
+                str += ", ";
             }
         }
-
-        count = 1;
-        strings = ( const char** )&singleString;
-        lengths = NULL;
+    }
+    else
+    {
+        str = "NULL";
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::incrementProgramCompileCount(
-    const cl_program program )
-{
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    m_ProgramInfoMap[ program ].CompileCount++;
-}
-
-///////////////////////////////////////////////////////////////////////////////
-//
-uint64_t CLIntercept::hashString(
-    const char* singleString,
-    size_t length )
+void CLIntercept::getMemPropertiesString(
+    const cl_mem_properties* properties,
+    std::string& str ) const
 {
-    uint64_t    hash = 0;
+    str = "";
 
-    if( singleString != NULL )
+    if( properties )
     {
-        const unsigned int* dwProgramSource = (const unsigned int*)singleString;
-        size_t  dwProgramSize = length;
+        char    s[256];
 
-        dwProgramSize = ( dwProgramSize + ( 4 - 1 ) ) & ~( 4 - 1 );
-        dwProgramSize /= 4;
+        while( properties[0] != 0 )
+        {
+            cl_int  property = (cl_int)properties[0];
+            str += enumName().name( property ) + " = ";
 
-        hash = Hash(
-            dwProgramSource,
-            dwProgramSize );
-    }
+            switch( property )
+            {
+            case CL_DEVICE_HANDLE_LIST_KHR:
+                {
+                    ++properties;
+                    str += "{ ";
+                    do
+                    {
+                        if( *properties == CL_DEVICE_HANDLE_LIST_END_KHR )
+                        {
+                            str += "CL_DEVICE_HANDLE_LIST_END_KHR";
+                        }
+                        else
+                        {
+                            auto pDevice = (const cl_device_id*)properties;
+                            std::string deviceInfo;
+                            getDeviceInfoString(
+                                1,
+                                pDevice,
+                                deviceInfo );
+                            str += deviceInfo;
+                            str += ", ";
 
-    return hash;
-}
+                        }
+                    }
+                    while( *properties++ != CL_DEVICE_HANDLE_LIST_END_KHR );
+                    str += " }";
+                }
+                break;
+            case CL_EXTERNAL_MEMORY_HANDLE_DMA_BUF_KHR:
+            case CL_EXTERNAL_MEMORY_HANDLE_OPAQUE_FD_KHR:
+                {
+                    auto pfd = (const int*)( properties + 1);
+                    CLI_SPRINTF( s, 256, "%d", pfd[0] );
+                    str += s;
+                    properties += 2;
+                }
+                break;
+            case CL_EXTERNAL_MEMORY_HANDLE_OPAQUE_WIN32_KHR:
+            case CL_EXTERNAL_MEMORY_HANDLE_OPAQUE_WIN32_KMT_KHR:
+            case CL_EXTERNAL_MEMORY_HANDLE_D3D11_TEXTURE_KHR:
+            case CL_EXTERNAL_MEMORY_HANDLE_D3D11_TEXTURE_KMT_KHR:
+            case CL_EXTERNAL_MEMORY_HANDLE_D3D12_HEAP_KHR:
+            case CL_EXTERNAL_MEMORY_HANDLE_D3D12_RESOURCE_KHR:
+                {
+                    auto pfd = (const void**)( properties + 1);
+                    CLI_SPRINTF( s, 256, "%p", pfd[0] );
+                    str += s;
+                    properties += 2;
+                }
+                break;
+            default:
+                {
+                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
+                    str += s;
+                    // Advance by two properties.  This may not be correct,
+                    // but it's the best we can do when the property is
+                    // unknown.
+                    properties += 2;
+                }
+                break;
+            }
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::saveProgramHash(
-    const cl_program program,
-    uint64_t hash )
-{
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    if( program != NULL )
+            if( properties[0] != 0 )
+            {
+                str += ", ";
+            }
+        }
+    }
+    else
     {
-        m_ProgramInfoMap[ program ].ProgramHash = hash;
+        str = "NULL";
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::saveProgramOptionsHash(
-    const cl_program program,
-    const char* options )
+void CLIntercept::getSemaphorePropertiesString(
+    const cl_semaphore_properties_khr* properties,
+    std::string& str ) const
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    str = "";
 
-    if( program != NULL && options != NULL )
+    if( properties )
     {
-        // First: Create a copy of the options string that's padded to a
-        // multiple of four bytes.
+        char    s[256];
 
-        cl_uint count = 1;
-        const char** strings = &options;
-        const size_t* lengths = NULL;
-        char* singleString = NULL;
-        combineProgramStrings(
-            count,
-            strings,
-            lengths,
-            singleString );
+        while( properties[0] != 0 )
+        {
+            cl_int  property = (cl_int)properties[0];
+            str += enumName().name( property ) + " = ";
 
-        uint64_t hash = hashString(
-            singleString,
-            strlen( singleString ) );
+            switch( property )
+            {
+            case CL_SEMAPHORE_TYPE_KHR:
+                {
+                    auto pt = (const cl_semaphore_type_khr*)( properties + 1 );
+                    str += enumName().name_semaphore_type( pt[0] );
+                    properties += 2;
+                }
+                break;
+            case CL_DEVICE_HANDLE_LIST_KHR:
+                {
+                    ++properties;
+                    str += "{ ";
+                    do
+                    {
+                        if( *properties == CL_DEVICE_HANDLE_LIST_END_KHR )
+                        {
+                            str += "CL_DEVICE_HANDLE_LIST_END_KHR";
+                        }
+                        else
+                        {
+                            auto pDevice = (const cl_device_id*)properties;
+                            std::string deviceInfo;
+                            getDeviceInfoString(
+                                1,
+                                pDevice,
+                                deviceInfo );
+                            str += deviceInfo;
+                            str += ", ";
 
-        m_ProgramInfoMap[ program ].OptionsHash = hash;
+                        }
+                    }
+                    while( *properties++ != CL_DEVICE_HANDLE_LIST_END_KHR );
+                    str += " }";
+                }
+                break;
+            case CL_SEMAPHORE_HANDLE_OPAQUE_FD_KHR:
+            case CL_SEMAPHORE_HANDLE_SYNC_FD_KHR:
+                {
+                    auto pfd = (const int*)( properties + 1);
+                    CLI_SPRINTF( s, 256, "%d", pfd[0] );
+                    str += s;
+                    properties += 2;
+                }
+                break;
+            case CL_SEMAPHORE_HANDLE_D3D12_FENCE_KHR:
+            case CL_SEMAPHORE_HANDLE_OPAQUE_WIN32_KHR:
+            case CL_SEMAPHORE_HANDLE_OPAQUE_WIN32_KMT_KHR:
+                {
+                    auto pfd = (const void**)( properties + 1);
+                    CLI_SPRINTF( s, 256, "%p", pfd[0] );
+                    str += s;
+                    properties += 2;
+                }
+                break;
+            default:
+                {
+                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
+                    str += s;
+                    // Advance by two properties.  This may not be correct,
+                    // but it's the best we can do when the property is
+                    // unknown.
+                    properties += 2;
+                }
+                break;
+            }
 
-        delete [] singleString;
-        singleString = NULL;
+            if( properties[0] != 0 )
+            {
+                str += ", ";
+            }
+        }
+    }
+    else
+    {
+        str = "NULL";
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-bool CLIntercept::injectProgramSource(
-    const uint64_t hash,
-    cl_uint& count,
-    const char**& strings,
-    const size_t*& lengths,
-    char*& singleString )
+void CLIntercept::getCommandBufferPropertiesString(
+    const cl_command_buffer_properties_khr* properties,
+    std::string& str ) const
 {
-    // We don't expect to get here unless we've combined the app's string(s)
-    // into a single string and computed a hash from it.
-    CLI_ASSERT( singleString );
+    str = "";
 
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    if( properties )
+    {
+        char    s[256];
 
-    bool    injected = false;
+        while( properties[0] != 0 )
+        {
+            cl_int  property = (cl_int)properties[0];
+            str += enumName().name( property ) + " = ";
 
-    std::string fileName;
+            switch( property )
+            {
+            case CL_COMMAND_BUFFER_FLAGS_KHR:
+                {
+                    auto pt = (const cl_command_buffer_flags_khr*)( properties + 1 );
+                    str += enumName().name_command_buffer_flags( pt[0] );
+                    properties += 2;
+                }
+                break;
+            default:
+                {
+                    CLI_SPRINTF( s, 256, "<Unknown %08X!>", (cl_uint)property );
+                    str += s;
+                    // Advance by two properties.  This may not be correct,
+                    // but it's the best we can do when the property is
+                    // unknown.
+                    properties += 2;
+                }
+                break;
+            }
 
-    // Get the dump directory name.
+            if( properties[0] != 0 )
+            {
+                str += ", ";
+            }
+        }
+    }
+    else
     {
-        OS().GetDumpDirectoryNameWithoutPid( sc_DumpDirectoryName, fileName );
-        fileName += "/Inject";
+        str = "NULL";
     }
+}
 
-    // Make two candidate filenames.  They will have the form:
-    //   CLI_<program number>_<hash>_source.cl, or
-    //   CLI_<hash>_source.cl
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::getCreateKernelsInProgramRetString(
+    cl_int retVal,
+    cl_kernel* kernels,
+    cl_uint* num_kernels_ret,
+    std::string& str ) const
+{
+    if( kernels &&
+        num_kernels_ret &&
+        ( num_kernels_ret[0] != 0 ) )
     {
-        char    numberString1[256] = "";
-        CLI_SPRINTF( numberString1, 256, "%04u_%08X",
-            m_ProgramNumber,
-            (unsigned int)hash );
-
-        char    numberString2[256] = "";
-        CLI_SPRINTF( numberString2, 256, "%08X",
-            (unsigned int)hash );
-
-        std::string fileName1;
-        fileName1 = fileName;
-        fileName1 += "/CLI_";
-        fileName1 += numberString1;
-        fileName1 += "_source.cl";
-
-        std::string fileName2;
-        fileName2 = fileName;
-        fileName2 += "/CLI_";
-        fileName2 += numberString2;
-        fileName2 += "_source.cl";
+        char    s[256];
 
-        std::ifstream is;
+        cl_uint numKernels = num_kernels_ret[0];
 
-        is.open(
-            fileName1.c_str(),
-            std::ios::in | std::ios::binary );
-        if( is.good() )
-        {
-            log( "Injecting source file: " + fileName1 + "\n" );
-        }
-        else
+        str += "kernels = [ ";
+        for( cl_uint i = 0; i < numKernels; i++ )
         {
-            log( "Injection source file doesn't exist: " + fileName1 + "\n" );
+            CLI_SPRINTF( s, 256, "%p", kernels[i] );
+            str += s;
 
-            is.clear();
-            is.open(
-                fileName2.c_str(),
-                std::ios::in | std::ios::binary );
-            if( is.good() )
-            {
-                log( "Injecting source file: " + fileName2 + "\n" );
-            }
-            else
+            if( i < numKernels - 1 )
             {
-                log( "Injection source file doesn't exist: " + fileName2 + "\n" );
+                str += ", ";
             }
         }
+        str += " ]";
+    }
+}
 
-        if( is.good() )
-        {
-            // The file exists.  Figure out how big it is.
-            size_t  filesize = 0;
-
-            is.seekg(0, std::ios::end);
-            filesize = (size_t)is.tellg();
-            is.seekg(0, std::ios::beg);
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::getKernelArgString(
+    cl_uint arg_index,
+    size_t arg_size,
+    const void* arg_value,
+    std::string& str ) const
+{
+    char    s[256];
 
-            char*   newSingleString = new char[ filesize + 1 ];
-            if( newSingleString )
-            {
-                memset( newSingleString, 0, filesize + 1 );
+    if( checkGetSamplerString(
+            arg_size,
+            arg_value,
+            str ) )
+    {
+        CLI_SPRINTF( s, 256, "index = %u, size = %zu, value = %s\n",
+            arg_index,
+            arg_size,
+            str.c_str() );
+    }
+    else if( ( arg_value != NULL ) &&
+             ( arg_size == sizeof(cl_mem) ) )
+    {
+        cl_mem* pMem = (cl_mem*)arg_value;
+        CLI_SPRINTF( s, 256, "index = %u, size = %zu, value = %p",
+            arg_index,
+            arg_size,
+            pMem[0] );
+    }
+    else if( ( arg_value != NULL ) &&
+             ( arg_size == sizeof(cl_uint) ) )
+    {
+        cl_uint*    pData = (cl_uint*)arg_value;
+        CLI_SPRINTF( s, 256, "index = %u, size = %zu, value = 0x%x",
+            arg_index,
+            arg_size,
+            pData[0] );
+    }
+    else if( ( arg_value != NULL ) &&
+             ( arg_size == sizeof(cl_ulong) ) )
+    {
+        cl_ulong*   pData = (cl_ulong*)arg_value;
+        CLI_SPRINTF( s, 256, "index = %u, size = %zu, value = 0x%jx",
+            arg_index,
+            arg_size,
+            pData[0] );
+    }
+    else if( ( arg_value != NULL ) &&
+             ( arg_size == sizeof(cl_int4) ) )
+    {
+        cl_int4*   pData = (cl_int4*)arg_value;
+        CLI_SPRINTF( s, 256, "index = %u, size = %zu, valueX = 0x%0x, valueY = 0x%0x, valueZ = 0x%0x, valueW = 0x%0x",
+            arg_index,
+            arg_size,
+            pData->s[0],
+            pData->s[1],
+            pData->s[2],
+            pData->s[3]);
+    }
+    else
+    {
+        CLI_SPRINTF( s, 256, "index = %u, size = %zu",
+            arg_index,
+            arg_size );
+    }
 
-                is.read( newSingleString, filesize );
+    str = s;
+}
 
-                delete [] singleString;
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::getEnqueueNDRangeKernelArgsString(
+    cl_uint work_dim,
+    const size_t* global_work_offset,
+    const size_t* global_work_size,
+    const size_t* local_work_size,
+    std::string& str ) const
+{
+    std::ostringstream  ss;
 
-                singleString = newSingleString;
-                count = 1;
-                strings = ( const char** )&singleString;
-                lengths = NULL;
+    if( global_work_offset )
+    {
+        ss << "global_work_offset = < ";
+        for( cl_uint i = 0; i < work_dim; i++ )
+        {
+            ss << global_work_offset[i];
+            if( i < work_dim - 1 )
+            {
+                ss << ", ";
+            }
+        }
+        ss << " >, ";
+    }
 
-                injected = true;
+    ss << "global_work_size = < ";
+    if( global_work_size )
+    {
+        for( cl_uint i = 0; i < work_dim; i++ )
+        {
+            ss << global_work_size[i];
+            if( i < work_dim - 1 )
+            {
+                ss << " x ";
             }
+        }
+    }
+    else
+    {
+        ss << "NULL?";
+    }
+    ss << " >, ";
 
-            is.close();
+    ss << "local_work_size = < ";
+    if( local_work_size )
+    {
+        for( cl_uint i = 0; i < work_dim; i++ )
+        {
+            ss << local_work_size[i];
+            if( i < work_dim - 1 )
+            {
+                ss << " x ";
+            }
         }
     }
+    else
+    {
+        ss << "NULL";
+    }
+    ss << " >";
 
-    return injected;
+    str = ss.str();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-bool CLIntercept::prependProgramSource(
-    const uint64_t hash,
-    cl_uint& count,
-    const char**& strings,
-    const size_t*& lengths,
-    char*& singleString )
+void CLIntercept::getCreateSubBufferArgsString(
+    cl_buffer_create_type createType,
+    const void *createInfo,
+    std::string& str ) const
 {
-    // We don't expect to get here unless we've combined the app's string(s)
-    // into a single string and computed a hash from it.
-    CLI_ASSERT( singleString );
-
-    std::lock_guard<std::mutex> lock(m_Mutex);
-
-    bool    injected = false;
-
-    std::string fileName;
+    std::ostringstream  ss;
 
-    // Get the dump directory name.
+    switch( createType )
     {
-        OS().GetDumpDirectoryNameWithoutPid( sc_DumpDirectoryName, fileName );
-        fileName += "/Inject";
+    case CL_BUFFER_CREATE_TYPE_REGION:
+        ss << "region = ";
+        if( createInfo != NULL )
+        {
+            cl_buffer_region*   pRegion = (cl_buffer_region*)createInfo;
+            ss << "{ origin = "
+                << pRegion->origin
+                << ", size = "
+                << pRegion->size
+                << " }";
+        }
+        else
+        {
+            ss << "(NULL)";
+        }
+        break;
+    default:
+        ss << "<Unexpected!>";
+        break;
     }
 
-    // Make three candidate filenames.  They will have the form:
-    //   CLI_<program number>_<hash>_prepend.cl, or
-    //   CLI_<hash>_prepend.cl, or
-    //   CLI_prepend.cl
+    str = ss.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::logCLInfo()
+{
+    if( m_LoggedCLInfo == false )
     {
-        char    numberString1[256] = "";
-        CLI_SPRINTF( numberString1, 256, "%04u_%08X",
-            m_ProgramNumber,
-            (unsigned int)hash );
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-        char    numberString2[256] = "";
-        CLI_SPRINTF( numberString2, 256, "%08X",
-            (unsigned int)hash );
+        if( m_LoggedCLInfo == false )
+        {
+            m_LoggedCLInfo = true;
 
-        std::string fileName1;
-        fileName1 = fileName;
-        fileName1 += "/CLI_";
-        fileName1 += numberString1;
-        fileName1 += "_prepend.cl";
-
-        std::string fileName2;
-        fileName2 = fileName;
-        fileName2 += "/CLI_";
-        fileName2 += numberString2;
-        fileName2 += "_prepend.cl";
-
-        std::string fileName3;
-        fileName3 = fileName;
-        fileName3 += "/CLI_prepend.cl";
-
-        std::ifstream is;
-
-        is.open(
-            fileName1.c_str(),
-            std::ios::in | std::ios::binary );
-        if( is.good() )
-        {
-            log( "Prepending source file: " + fileName1 + "\n" );
-        }
-        else
-        {
-            log( "Prepend source file doesn't exist: " + fileName1 + "\n" );
+            cl_int  errorCode = CL_SUCCESS;
+            cl_uint numPlatforms = 0;
 
-            is.clear();
-            is.open(
-                fileName2.c_str(),
-                std::ios::in | std::ios::binary );
-            if( is.good() )
+            if( errorCode == CL_SUCCESS )
             {
-                log( "Prepending source file: " + fileName2 + "\n" );
+                errorCode = dispatch().clGetPlatformIDs(
+                    0,
+                    NULL,
+                    &numPlatforms );
             }
-            else
+
+            if( errorCode == CL_SUCCESS && numPlatforms != 0 )
             {
-                log( "Prepend source file doesn't exist: " + fileName2 + "\n" );
+                logf( "\nEnumerated %u platform%s.\n\n",
+                    numPlatforms,
+                    numPlatforms > 1 ? "s" : "" );
 
-                is.clear();
-                is.open(
-                    fileName3.c_str(),
-                    std::ios::in | std::ios::binary );
-                if( is.good() )
+                cl_platform_id* platforms = new cl_platform_id[numPlatforms];
+                if( platforms )
                 {
-                    log( "Prepending source file: " + fileName3 + "\n" );
+                    errorCode = dispatch().clGetPlatformIDs(
+                        numPlatforms,
+                        platforms,
+                        NULL );
                 }
                 else
                 {
-                    log( "Prepend source file doesn't exist: " + fileName3 + "\n" );
+                    errorCode = CL_OUT_OF_HOST_MEMORY;
                 }
-            }
-        }
-
-        if( is.good() )
-        {
-            // The file exists.  Figure out how big it is.
-            size_t  filesize = 0;
-
-            is.seekg(0, std::ios::end);
-            filesize = (size_t)is.tellg();
-            is.seekg(0, std::ios::beg);
 
-            size_t  newSize =
-                filesize +
-                strlen(singleString) +
-                1;  // for the null terminator
+                for( cl_uint p = 0; p < numPlatforms; p++ )
+                {
+                    if( errorCode == CL_SUCCESS )
+                    {
+                        logf( "Platform %u:\n", p );
+                        logPlatformInfo( platforms[p] );
+                    }
 
-            char*   newSingleString = new char[ newSize ];
-            if( newSingleString )
-            {
-                memset( newSingleString, 0, newSize );
+                    cl_uint numDevices = 0;
 
-                is.read( newSingleString, filesize );
+                    if( errorCode == CL_SUCCESS )
+                    {
+                        errorCode = dispatch().clGetDeviceIDs(
+                            platforms[p],
+                            CL_DEVICE_TYPE_ALL,
+                            0,
+                            NULL,
+                            &numDevices );
+                    }
+                    if( errorCode == CL_SUCCESS && numDevices != 0 )
+                    {
+                        logf( "\tPlatform has %u device%s.\n\n",
+                            numDevices,
+                            numDevices > 1 ? "s" : "" );
 
-                CLI_STRCAT( newSingleString, newSize, singleString );
+                        cl_device_id*   devices = new cl_device_id[numDevices];
+                        if( devices )
+                        {
+                            errorCode = dispatch().clGetDeviceIDs(
+                                platforms[p],
+                                CL_DEVICE_TYPE_ALL,
+                                numDevices,
+                                devices,
+                                NULL );
+                        }
+                        else
+                        {
+                            errorCode = CL_OUT_OF_HOST_MEMORY;
+                        }
 
-                delete [] singleString;
+                        for( cl_uint d = 0; d < numDevices; d++ )
+                        {
+                            if( errorCode == CL_SUCCESS )
+                            {
+                                logf( "Device %u:\n", d );
+                                logDeviceInfo( devices[d] );
+                                log( "\n" );
+                            }
+                        }
 
-                singleString = newSingleString;
-                count = 1;
-                strings = ( const char** )&singleString;
-                lengths = NULL;
+                        delete [] devices;
+                    }
+                }
 
-                injected = true;
+                delete [] platforms;
             }
-
-            is.close();
         }
     }
-
-    return injected;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-bool CLIntercept::injectProgramSPIRV(
-    const uint64_t hash,
-    size_t& length,
-    const void*& il,
-    char*& injectedIL )
+void CLIntercept::logBuild(
+    clock::time_point buildTimeStart,
+    const cl_program program,
+    cl_uint numDevices,
+    const cl_device_id* deviceList )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::chrono::duration<float, std::milli>    buildDuration =
+        clock::now() - buildTimeStart;
 
-    bool    injected = false;
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-    std::string fileName;
+    cl_device_id*   localDeviceList = NULL;
 
-    // Get the dump directory name.
+    cl_int  errorCode = CL_SUCCESS;
+
+    // There are two possibilities.  Either the device_list is NULL, in which
+    // case we need to get the build log for all devices, or it's non-NULL,
+    // in which case we only need to get the build log for all devices in
+    // the device list.
+
+    if( ( errorCode == CL_SUCCESS ) &&
+        ( deviceList == NULL ) )
     {
-        OS().GetDumpDirectoryNameWithoutPid( sc_DumpDirectoryName, fileName );
-        fileName += "/Inject";
+        errorCode = allocateAndGetProgramDeviceList(
+            program,
+            numDevices,
+            localDeviceList );
+        if( errorCode == CL_SUCCESS )
+        {
+            deviceList = localDeviceList;
+        }
     }
 
-    // Make two candidate filenames.  They will have the form:
-    //   CLI_<program number>_<hash>_0000.spv, or
-    //   CLI_<hash>_0000.spv
+    if( m_Config.BuildLogging &&
+        errorCode == CL_SUCCESS )
     {
-        char    numberString1[256] = "";
-        CLI_SPRINTF( numberString1, 256, "%04u_%08X_0000",
-            m_ProgramNumber,
-            (unsigned int)hash );
-
-        char    numberString2[256] = "";
-        CLI_SPRINTF( numberString2, 256, "%08X_0000",
-            (unsigned int)hash );
-
-        std::string fileName1;
-        fileName1 = fileName;
-        fileName1 += "/CLI_";
-        fileName1 += numberString1;
-        fileName1 += ".spv";
-
-        std::string fileName2;
-        fileName2 = fileName;
-        fileName2 += "/CLI_";
-        fileName2 += numberString2;
-        fileName2 += ".spv";
-
-        std::ifstream is;
+        const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
 
-        is.open(
-            fileName1.c_str(),
-            std::ios::in | std::ios::binary );
-        if( is.good() )
+        char    numberString[256] = "";
+        if( config().OmitProgramNumber )
         {
-            log( "Injecting SPIR-V file: " + fileName1 + "\n" );
+            CLI_SPRINTF( numberString, 256, "%08X_%04u_%08X",
+                (unsigned int)programInfo.ProgramHash,
+                programInfo.CompileCount,
+                (unsigned int)programInfo.OptionsHash );
         }
         else
         {
-            log( "Injection SPIR-V file doesn't exist: " + fileName1 + "\n" );
-
-            is.clear();
-            is.open(
-                fileName2.c_str(),
-                std::ios::in | std::ios::binary );
-            if( is.good() )
-            {
-                log( "Injecting SPIR-V file: " + fileName2 + "\n" );
-            }
-            else
-            {
-                log( "Injection SPIR-V file doesn't exist: " + fileName2 + "\n" );
-            }
+            CLI_SPRINTF( numberString, 256, "%04u_%08X_%04u_%08X",
+                programInfo.ProgramNumber,
+                (unsigned int)programInfo.ProgramHash,
+                programInfo.CompileCount,
+                (unsigned int)programInfo.OptionsHash );
         }
 
-        if( is.good() )
-        {
-            // The file exists.  Figure out how big it is.
-            size_t  filesize = 0;
+        logf( "Build Info for program %p (%s) for %u device(s):\n",
+            program,
+            numberString,
+            numDevices );
 
-            is.seekg(0, std::ios::end);
-            filesize = (size_t)is.tellg();
-            is.seekg(0, std::ios::beg);
+        float   buildTimeMS = buildDuration.count();
+        logf( "    Build finished in %.2f ms.\n", buildTimeMS );
+    }
 
-            injectedIL = new char[ filesize ];
-            if( injectedIL )
+    if( errorCode == CL_SUCCESS )
+    {
+        for( cl_uint i = 0; i < numDevices; i++ )
+        {
+            if( m_Config.BuildLogging )
             {
-                is.read( injectedIL, filesize );
-
-                il = injectedIL;
-                length = filesize;
-
-                injected = true;
-            }
-
-            is.close();
-        }
-    }
-
-    return injected;
-}
-
-///////////////////////////////////////////////////////////////////////////////
-//
-bool CLIntercept::injectProgramOptions(
-    const cl_program program,
-    cl_bool isCompile,
-    cl_bool isLink,
-    char*& newOptions )
-{
-    std::lock_guard<std::mutex> lock(m_Mutex);
-
-    CLI_ASSERT( newOptions == NULL );
-
-    bool    injected = false;
-
-    const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
-
-    std::string fileName;
+                cl_build_status buildStatus = CL_BUILD_NONE;
+                errorCode = dispatch().clGetProgramBuildInfo(
+                    program,
+                    deviceList[ i ],
+                    CL_PROGRAM_BUILD_STATUS,
+                    sizeof( buildStatus ),
+                    &buildStatus,
+                    NULL );
 
-    // Get the dump directory name.
-    {
-        OS().GetDumpDirectoryNameWithoutPid( sc_DumpDirectoryName, fileName );
-        fileName += "/Inject";
-    }
-    // Make four candidate filenames.  They will have the form:
-    //   CLI_<program number>_<program hash>_<compile count>_<options hash>_options.txt, or
-    //   CLI_<program hash>_<compile count>_<options hash>_options.txt, or
-    //   CLI_<program hash>_options.txt, or
-    //   CLI_options.txt
-    {
-        char    numberString1[256] = "";
-        CLI_SPRINTF( numberString1, 256, "%04u_%08X_%04u_%08X",
-            programInfo.ProgramNumber,
-            (unsigned int)programInfo.ProgramHash,
-            programInfo.CompileCount,
-            (unsigned int)programInfo.OptionsHash );
+                if( errorCode == CL_SUCCESS )
+                {
+                    char*   deviceName = NULL;
+                    char*   deviceOpenCLCVersion = NULL;
+                    errorCode = allocateAndGetDeviceInfoString(
+                        deviceList[i],
+                        CL_DEVICE_NAME,
+                        deviceName );
+                    errorCode |= allocateAndGetDeviceInfoString(
+                        deviceList[i],
+                        CL_DEVICE_OPENCL_C_VERSION,
+                        deviceOpenCLCVersion );
 
-        char    numberString2[256] = "";
-        CLI_SPRINTF( numberString2, 256, "%08X_%04u_%08X",
-            (unsigned int)programInfo.ProgramHash,
-            programInfo.CompileCount,
-            (unsigned int)programInfo.OptionsHash );
+                    char    str[256] = "";
 
-        char    numberString3[256] = "";
-        CLI_SPRINTF( numberString3, 256, "%08X",
-            (unsigned int)programInfo.ProgramHash );
+                    CLI_SPRINTF( str, 256, "Build Status for device %u = ", i );
 
-        const std::string suffix =
-            isCompile ? "_compile_options.txt" :
-            isLink ? "_link_options.txt" :
-            "_options.txt";
+                    std::string message = str;
 
-        std::string fileName1;
-        fileName1 = fileName;
-        fileName1 += "/CLI_";
-        fileName1 += numberString1;
-        fileName1 += suffix;
+                    if( errorCode == CL_SUCCESS )
+                    {
+                        message += deviceName;
+                        message += " (";
+                        message += deviceOpenCLCVersion;
+                        message += "): ";
+                    }
 
-        std::string fileName2;
-        fileName2 = fileName;
-        fileName2 += "/CLI_";
-        fileName2 += numberString2;
-        fileName2 += suffix;
+                    message += enumName().name_build_status( buildStatus );
+                    message += "\n";
 
-        std::string fileName3;
-        fileName3 = fileName;
-        fileName3 += "/CLI_";
-        fileName3 += numberString3;
-        fileName3 += suffix;
+                    log( message );
 
-        std::string fileName4;
-        fileName4 = fileName;
-        fileName4 += suffix;
+                    delete [] deviceName;
+                    deviceName = NULL;
 
-        std::ifstream is;
+                    delete [] deviceOpenCLCVersion;
+                    deviceOpenCLCVersion = NULL;
+                }
+            }
 
-        is.open(
-            fileName1.c_str(),
-            std::ios::in | std::ios::binary );
-        if( is.good() )
-        {
-            log( "Injecting options file: " + fileName1 + "\n" );
-        }
-        else
-        {
-            log( "Injection options file doesn't exist: " + fileName1 + "\n" );
+            size_t  buildLogSize = 0;
+            errorCode = dispatch().clGetProgramBuildInfo(
+                program,
+                deviceList[ i ],
+                CL_PROGRAM_BUILD_LOG,
+                0,
+                NULL,
+                &buildLogSize );
 
-            is.clear();
-            is.open(
-                fileName2.c_str(),
-                std::ios::in | std::ios::binary );
-            if( is.good() )
-            {
-                log( "Injecting options file: " + fileName2 + "\n" );
-            }
-            else
+            if( errorCode == CL_SUCCESS )
             {
-                log( "Injection options file doesn't exist: " + fileName2 + "\n" );
-
-                is.clear();
-                is.open(
-                    fileName3.c_str(),
-                    std::ios::in | std::ios::binary );
-                if( is.good() )
-                {
-                    log( "Injecting options file: " + fileName3 + "\n" );
-                }
-                else
+                char*   buildLog = new char[ buildLogSize + 1 ];
+                if( buildLog )
                 {
-                    log( "Injection options file doesn't exist: " + fileName3 + "\n" );
+                    dispatch().clGetProgramBuildInfo(
+                        program,
+                        deviceList[ i ],
+                        CL_PROGRAM_BUILD_LOG,
+                        buildLogSize,
+                        buildLog,
+                        NULL );
 
-                    is.clear();
-                    is.open(
-                        fileName4.c_str(),
-                        std::ios::in | std::ios::binary );
-                    if( is.good() )
+                    // Check if the build log is already null-terminated.
+                    // If it is, we're good, otherwise null terminate it.
+                    if( buildLog[ buildLogSize - 1 ] == '\0' )
                     {
-                        log( "Injecting options file: " + fileName4 + "\n" );
+                        buildLogSize--;
                     }
                     else
                     {
-                        log( "Injection options file doesn't exist: " + fileName4 + "\n" );
+                        buildLog[ buildLogSize ] = '\0';
                     }
-                }
-            }
-        }
-
-        if( is.good() )
-        {
-            // The file exists.  Figure out how big it is.
-            size_t  filesize = 0;
-
-            is.seekg(0, std::ios::end);
-            filesize = (size_t)is.tellg();
-            is.seekg(0, std::ios::beg);
-
-            newOptions = new char[ filesize + 1 ];
-            if( newOptions )
-            {
-                memset( newOptions, 0, filesize + 1 );
-
-                is.read( newOptions, filesize );
 
-                // Replace any newline characters with spaces.
-                // Some editors insert newline characters, especially at the
-                // end of the file, which can cause build options to become
-                // invalid.
-                for( size_t i = 0; i < filesize; i++ )
-                {
-                    if( newOptions[i] == '\n' )
+                    if( m_Config.BuildLogging )
                     {
-                        newOptions[i] = ' ';
+                        log( "-------> Start of Build Log:\n" );
+                        log( std::string(buildLog) );
+                        log( "<------- End of Build Log\n\n" );
+                    }
+                    if( m_Config.DumpProgramBuildLogs )
+                    {
+                        dumpProgramBuildLog(
+                            program,
+                            deviceList[ i ],
+                            buildLog,
+                            buildLogSize );
                     }
-                }
 
-                injected = true;
+                    delete [] buildLog;
+                }
             }
-
-            is.close();
         }
     }
 
-    return injected;
+    delete [] localDeviceList;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-bool CLIntercept::appendBuildOptions(
-    const char* append,
-    const char* options,
-    char*& newOptions ) const
+void CLIntercept::logError(
+    const std::string& functionName,
+    cl_int errorCode,
+    const cl_kernel kernel )
 {
-    bool    modified = false;
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-    size_t  newSize = strlen(append) + 1;    // for the null terminator
-
-    const char* oldOptions = newOptions ? newOptions : options;
-    if( oldOptions )
+    // Don't use getShortKernelName() directly, since the kernel may be
+    // invalid and we don't want to add it to the kernel info map.
+    std::string kernelName;
+    if( kernel && m_KernelInfoMap.find( kernel ) != m_KernelInfoMap.end() )
     {
-        newSize += strlen(oldOptions) + 1;  // for a space
+        kernelName = getShortKernelName( kernel );
     }
 
-    char* newNewOptions = new char[ newSize ];
-    if( newNewOptions )
+    SErrorStats& errorStats = m_ErrorStatsMap[
+        CErrorStatsKey( functionName, errorCode, kernelName ) ];
+    if( errorStats.NumberOfErrors == 0 )
     {
-        memset( newNewOptions, 0, newSize );
+        errorStats.FunctionName = functionName;
+        errorStats.ErrorCode = errorCode;
+        errorStats.KernelName = kernelName;
+    }
+    errorStats.NumberOfErrors++;
 
-        if( oldOptions )
+    const cl_uint   maxRepeats = m_Config.ErrorLoggingMaxRepeats;
+    if( maxRepeats == 0 || errorStats.NumberOfErrors <= maxRepeats )
+    {
+        std::ostringstream  ss;
+        ss << "ERROR! " << functionName << " returned " << enumName().name(errorCode) << " (" << errorCode << ")";
+        if( !kernelName.empty() )
         {
-            CLI_STRCAT( newNewOptions, newSize, oldOptions );
-            CLI_STRCAT( newNewOptions, newSize, " " );
+            ss << " for kernel " << kernelName;
         }
-        CLI_STRCAT( newNewOptions, newSize, append );
+        if( maxRepeats != 0 && errorStats.NumberOfErrors == maxRepeats )
+        {
+            ss << " (further occurrences will be summarized)";
+        }
+        ss << "\n";
 
-        delete [] newOptions;
-        newOptions = newNewOptions;
+        log( ss.str() );
 
-        modified = true;
+        errorStats.LastLogTime = clock::now();
+        return;
     }
 
-    return modified;
-}
+    // This error has been logged too many times already.  Count it, and log
+    // a summary if enough time has passed since the last summary.
 
-///////////////////////////////////////////////////////////////////////////////
-//
-void CLIntercept::dumpProgramSourceScript(
-    cl_program program,
-    const char* singleString )
-{
-#if defined(_WIN32)
-
-    std::lock_guard<std::mutex> lock(m_Mutex);
-
-    CLI_ASSERT( config().DumpProgramSourceScript || config().SimpleDumpProgramSource );
-
-    char    dirname[MAX_PATH] = "";
-    char    filename[MAX_PATH] = "";
-    char    filepath[MAX_PATH] = "";
-
-    if( config().DumpProgramSourceScript )
-    {
-        size_t  remaining = MAX_PATH;
-
-        char    date[9] = "";
-        char    time[9] = "";
-        char*   curPos = NULL;
-        char*   nextToken = NULL;
-        char*   pch = NULL;
-
-        // Directory:
-
-        curPos = dirname;
-        remaining = MAX_PATH;
-        memset( curPos, 0, MAX_PATH );
-
-        _strdate_s( date, 9 );
-        _strtime_s( time, 9 );
-
-        memcpy_s( curPos, remaining, "CLShaderDump_", 14 );
-        curPos += 13;
-        remaining -= 13;
-
-        memcpy_s( curPos, remaining, strtok_s( date, "/", &nextToken ), 2 );
-        curPos += 2;
-        remaining -= 2;
-
-        memcpy_s( curPos, remaining, strtok_s( NULL, "/", &nextToken ), 2 );
-        curPos += 2;
-        remaining -= 2;
-
-        memcpy_s( curPos, remaining, strtok_s( NULL, "/", &nextToken ), 2 );
-        curPos += 2;
-        remaining -= 2;
-
-        ::CreateDirectoryA( dirname, NULL );
-
-        // File:
-
-        curPos = filename;
-        remaining = MAX_PATH;
-        memset( curPos, 0, MAX_PATH );
-
-        if( GetModuleFileNameA( NULL, filename, MAX_PATH-1 ) == 0 )
-        {
-            CLI_ASSERT( 0 );
-            strcpy_s( curPos, remaining, "process.exe" );
-        }
-
-        pch = strrchr( filename, '\\' );
-        pch++;
-        memcpy_s( curPos, remaining, pch, strlen( pch ) );
-        curPos += strlen( pch ) - 4;    // -4 to cut off ".exe"
-        remaining -= strlen( pch ) - 4;
-
-        memcpy_s( curPos, remaining, "_", 2 );
-        curPos += 1;
-        remaining -= 1;
-
-        memcpy_s( curPos, remaining, strtok_s( time, ":", &nextToken ), 2 );
-        curPos += 2;
-        remaining -= 2;
-
-        memcpy_s( curPos, remaining, strtok_s( NULL, ":", &nextToken ), 2 );
-        curPos += 2;
-        remaining -= 2;
-
-        memcpy_s( curPos, remaining, strtok_s( NULL, ":", &nextToken ), 2 );
-        curPos += 2;
-        remaining -= 2;
+    errorStats.NumberOfSuppressedErrors++;
 
-        CLI_SPRINTF( curPos, remaining, "_%8.8x", m_ProgramNumber );
-        curPos += 9;
-        remaining -= 9;
-    }
-    else
+    clock::time_point   now = clock::now();
+    const uint64_t  msDelta =
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - errorStats.LastLogTime).count();
+    if( msDelta >= m_Config.ErrorLoggingSummaryIntervalMilliseconds )
     {
-        CLI_SPRINTF( dirname, MAX_PATH, "." );
-        CLI_SPRINTF( filename, MAX_PATH, "kernel" );
+        logErrorSummary( errorStats, now );
     }
+}
 
-    CLI_SPRINTF( filepath, MAX_PATH, "%s/%s.%s", dirname, filename, "cl" );
+///////////////////////////////////////////////////////////////////////////////
+//
+// Note: This function assumes the mutex is already locked.
+void CLIntercept::logErrorSummary(
+    SErrorStats& errorStats,
+    clock::time_point now )
+{
+    const uint64_t  msDelta =
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - errorStats.LastLogTime).count();
 
-    if( singleString )
+    std::ostringstream  ss;
+    ss << "ERROR! " << errorStats.FunctionName << " returned " << enumName().name(errorStats.ErrorCode) << " (" << errorStats.ErrorCode << ")";
+    if( !errorStats.KernelName.empty() )
     {
-        std::ofstream os;
-        os.open(
-            filepath,
-            std::ios::out | std::ios::binary );
-        if( os.good() )
-        {
-            os.write( singleString, strlen( singleString ) );
-            os.close();
-        }
-        else
-        {
-            logf( "Failed to open program source dump file for writing: %s\n",
-                filepath );
-        }
+        ss << " for kernel " << errorStats.KernelName;
     }
+    ss << " " << errorStats.NumberOfSuppressedErrors << " more time(s) in the last " << msDelta << " ms"
+        << " (" << errorStats.NumberOfErrors << " total)\n";
 
-    SProgramInfo&   programInfo = m_ProgramInfoMap[ program ];
-    programInfo.ProgramNumber = m_ProgramNumber;
-    programInfo.CompileCount = 0;
-
-    m_ProgramNumber++;
+    log( ss.str() );
 
-#else
-    CLI_ASSERT( 0 );
-#endif
+    errorStats.NumberOfSuppressedErrors = 0;
+    errorStats.LastLogTime = now;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::dumpProgramSource(
-    uint64_t hash,
-    cl_program program,
-    const char* singleString )
+// Note: This function assumes the mutex is already locked.
+void CLIntercept::logPendingErrorSummaries()
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
-
-    CLI_ASSERT( config().DumpProgramSource || config().AutoCreateSPIRV );
-
-    std::string fileName;
+    // Summarize errors that were suppressed since their last summary, so
+    // they are not lost when the application exits before the summary
+    // interval elapses.
+    clock::time_point   now = clock::now();
 
-    // Get the dump directory name.
-    {
-        OS().GetDumpDirectoryName( sc_DumpDirectoryName, fileName );
-    }
-    // Make the filename.  It will have the form:
-    //   CLI_<program number>_<hash>_source.cl
+    CErrorStatsMap::iterator i = m_ErrorStatsMap.begin();
+    while( i != m_ErrorStatsMap.end() )
     {
-        char    numberString[256] = "";
-
-        if( config().OmitProgramNumber )
-        {
-            CLI_SPRINTF( numberString, 256, "%08X",
-                (unsigned int)hash );
-        }
-        else
+        SErrorStats& errorStats = (*i).second;
+        if( errorStats.NumberOfSuppressedErrors )
         {
-            CLI_SPRINTF( numberString, 256, "%04u_%08X",
-                m_ProgramNumber,
-                (unsigned int)hash );
+            logErrorSummary( errorStats, now );
         }
-
-        fileName += "/CLI_";
-        fileName += numberString;
-        fileName += "_source.cl";
-    }
-    // Now make directories as appropriate.
-    {
-        OS().MakeDumpDirectories( fileName );
+        ++i;
     }
-    // Dump the program source to a .cl file.
-    if( singleString )
-    {
-        std::ofstream os;
-        os.open(
-            fileName.c_str(),
-            std::ios::out | std::ios::binary );
-        if( os.good() )
-        {
-            log( "Dumping program to file (inject): " + fileName + "\n" );
+}
 
-            // don't write the null terminator to the file
-            os.write( singleString, strlen( singleString ) );
-            os.close();
-        }
-        else
-        {
-            logf( "Failed to open program source dump file for writing: %s\n",
-                fileName.c_str() );
-        }
-    }
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::logFlushOrFinishAfterEnqueueStart(
+    const std::string& flushOrFinish,
+    const std::string& functionName )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+    log( "Calling " + flushOrFinish + " after " + functionName + "...\n" );
+}
 
-    SProgramInfo&   programInfo = m_ProgramInfoMap[ program ];
-    programInfo.ProgramNumber = m_ProgramNumber;
-    programInfo.CompileCount = 0;
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::logFlushOrFinishAfterEnqueueEnd(
+    const std::string& flushOrFinish,
+    const std::string& functionName,
+    cl_int errorCode )
+{
+    std::ostringstream  ss;
+    ss << "... " << flushOrFinish << " after " << functionName << " returned " << enumName().name( errorCode ) << " (" << errorCode << ")\n";
 
-    m_ProgramNumber++;
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+    log( ss.str() );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::dumpInputProgramBinaries(
-    uint64_t hash,
-    const cl_program program,
-    cl_uint num_devices,
-    const cl_device_id* device_list,
-    const size_t* lengths,
-    const unsigned char** binaries )
+void CLIntercept::logKernelInfo(
+    const cl_kernel* kernels,
+    cl_uint numKernels )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
-
-    CLI_ASSERT( config().DumpInputProgramBinaries );
+    if( numKernels > 0 )
+    {
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-    std::string fileName;
+        cl_int  errorCode = CL_SUCCESS;
 
-    // Get the dump directory name.
-    {
-        OS().GetDumpDirectoryName( sc_DumpDirectoryName, fileName );
-    }
+        // We can share the program and device list for all kernels.
 
-    // Make the filename.  It will have the form:
-    //   CLI_<program number>_<hash>
-    // Leave off the extension for now.
-    {
-        char    numberString[256] = "";
+        cl_kernel   queryKernel = kernels[0];
 
-        if( config().OmitProgramNumber )
+        // First, get the program for this kernel.
+        cl_program  program = NULL;
+        if( errorCode == CL_SUCCESS )
         {
-            CLI_SPRINTF( numberString, 256, "%08X",
-                (unsigned int)hash );
+            errorCode = dispatch().clGetKernelInfo(
+                queryKernel,
+                CL_KERNEL_PROGRAM,
+                sizeof(program),
+                &program,
+                NULL );
         }
-        else
+
+        // Next, get the list of devices for the program.
+        cl_uint         numDevices = 0;
+        cl_device_id*   deviceList = NULL;
+        if( errorCode == CL_SUCCESS )
         {
-            CLI_SPRINTF( numberString, 256, "%04u_%08X",
-                m_ProgramNumber,
-                (unsigned int)hash );
+            errorCode = allocateAndGetProgramDeviceList(
+                program,
+                numDevices,
+                deviceList );
         }
 
-        fileName += "/CLI_";
-        fileName += numberString;
-    }
-    // Now make directories as appropriate.
-    {
-        OS().MakeDumpDirectories( fileName );
-    }
+        // Log the preferred work group size multiple for each kernel,
+        // for each device.
+        while( numDevices && numKernels-- )
+        {
+            cl_kernel   kernel = kernels[ numKernels ];
 
-    for( size_t i = 0; i < num_devices; i++ )
-    {
-        cl_device_type  deviceType = CL_DEVICE_TYPE_DEFAULT;
+            const std::string& kernelName = getShortKernelNameWithHash(kernel);
+            log( "Kernel Info for: " + kernelName + "\n" );
 
-        // It's OK if this fails.  If it does, it just
-        // means that our output file won't have a device
-        // type.
-        dispatch().clGetDeviceInfo(
-            device_list[ i ],
-            CL_DEVICE_TYPE,
-            sizeof( deviceType ),
-            &deviceType,
-            NULL );
+            for( cl_uint i = 0; i < numDevices; i++ )
+            {
+                char*   deviceName = NULL;
+                errorCode = allocateAndGetDeviceInfoString(
+                    deviceList[i],
+                    CL_DEVICE_NAME,
+                    deviceName );
 
-        std::string outputFileName = fileName;
+                cl_uint args = 0;
+                errorCode |= dispatch().clGetKernelInfo(
+                    kernel,
+                    CL_KERNEL_NUM_ARGS,
+                    sizeof(args),
+                    &args,
+                    NULL );
 
-        if( deviceType & CL_DEVICE_TYPE_CPU )
-        {
-            outputFileName += "_CPU";
-        }
-        if( deviceType & CL_DEVICE_TYPE_GPU )
-        {
-            outputFileName += "_GPU";
-        }
-        if( deviceType & CL_DEVICE_TYPE_ACCELERATOR )
-        {
-            outputFileName += "_ACC";
-        }
-        if( deviceType & CL_DEVICE_TYPE_CUSTOM )
-        {
-            outputFileName += "_CUSTOM";
+                size_t  pwgsm = 0;
+                errorCode |= dispatch().clGetKernelWorkGroupInfo(
+                    kernel,
+                    deviceList[i],
+                    CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE,
+                    sizeof(pwgsm),
+                    &pwgsm,
+                    NULL );
+                size_t  wgs = 0;
+                errorCode |= dispatch().clGetKernelWorkGroupInfo(
+                    kernel,
+                    deviceList[i],
+                    CL_KERNEL_WORK_GROUP_SIZE,
+                    sizeof(wgs),
+                    &wgs,
+                    NULL );
+                cl_ulong pms = 0;
+                errorCode |= dispatch().clGetKernelWorkGroupInfo(
+                    kernel,
+                    deviceList[i],
+                    CL_KERNEL_PRIVATE_MEM_SIZE,
+                    sizeof(pms),
+                    &pms,
+                    NULL );
+                cl_ulong lms = 0;
+                errorCode |= dispatch().clGetKernelWorkGroupInfo(
+                    kernel,
+                    deviceList[i],
+                    CL_KERNEL_LOCAL_MEM_SIZE,
+                    sizeof(lms),
+                    &lms,
+                    NULL );
+                cl_ulong sms = 0;
+                cl_int errorCode_sms =dispatch().clGetKernelWorkGroupInfo(
+                    kernel,
+                    deviceList[i],
+                    CL_KERNEL_SPILL_MEM_SIZE_INTEL,
+                    sizeof(sms),
+                    &sms,
+                    NULL );
+                if( errorCode == CL_SUCCESS )
+                {
+                    logf( "    For device: %s\n",
+                        deviceName );
+                    if( config().KernelInfoLogging )
+                    {
+                        logf( "        Num Args: %u\n", args);
+                    }
+                    if( config().KernelInfoLogging ||
+                        config().PreferredWorkGroupSizeMultipleLogging )
+                    {
+                        logf( "        Preferred Work Group Size Multiple: %zu\n", pwgsm);
+                    }
+                    if( config().KernelInfoLogging )
+                    {
+                        logf( "        Work Group Size: %zu\n", wgs);
+                        logf( "        Private Mem Size: %u\n", (cl_uint)pms);
+                        logf( "        Local Mem Size: %u\n", (cl_uint)lms);
+                        if( errorCode_sms == CL_SUCCESS )
+                        {
+                            logf( "        Spill Mem Size: %u\n", (cl_uint)sms);
+                        }
+                    }
+                }
+                else if( deviceName )
+                {
+                    logf( "Error querying kernel info for device %s!\n", deviceName );
+                }
+                else
+                {
+                    logf( "Error querying kernel info!\n" );
+                }
+
+                delete [] deviceName;
+            }
         }
 
-        outputFileName += ".bin";
+        delete [] deviceList;
+    }
+}
 
-        std::ofstream os;
-        os.open(
-            outputFileName.c_str(),
-            std::ios::out | std::ios::binary );
-        if( os.good() )
-        {
-            log( "Dumping input program binary to file: " + outputFileName + "\n" );
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::logQueueInfo(
+    const cl_device_id device,
+    const cl_command_queue queue )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-            os.write(
-                (const char*)binaries[ i ],
-                lengths[ i ] );
-            os.close();
-        }
-        else
-        {
-            logf( "Failed to open program binary dump file for writing: %s\n",
-                outputFileName.c_str());
-        }
+    cl_int  errorCode = CL_SUCCESS;
+
+    logf( "Queue Info for %p:\n", queue );
+
+    char*   deviceName = NULL;
+    errorCode |= allocateAndGetDeviceInfoString(
+        device,
+        CL_DEVICE_NAME,
+        deviceName );
+    cl_command_queue_properties props = 0;
+    errorCode |= dispatch().clGetCommandQueueInfo(
+        queue,
+        CL_QUEUE_PROPERTIES,
+        sizeof(props),
+        &props,
+        NULL );
+    if( errorCode == CL_SUCCESS )
+    {
+        logf( "    For device: %s\n", deviceName );
+        logf( "    Queue properties: %s\n",
+            props == 0 ?
+            "(None)" :
+            enumName().name_command_queue_properties(props).c_str() );
     }
 
-    SProgramInfo&   programInfo = m_ProgramInfoMap[ program ];
-    programInfo.ProgramNumber = m_ProgramNumber;
-    programInfo.CompileCount = 0;
+    // Queue family information, may not be supported for all devices.
+    cl_uint queueFamily = 0;
+    cl_int errorCode_qf = dispatch().clGetCommandQueueInfo(
+        queue,
+        CL_QUEUE_FAMILY_INTEL,
+        sizeof(queueFamily),
+        &queueFamily,
+        NULL );
+    cl_uint queueIndex = 0;
+    errorCode_qf |= dispatch().clGetCommandQueueInfo(
+        queue,
+        CL_QUEUE_INDEX_INTEL,
+        sizeof(queueIndex),
+        &queueIndex,
+        NULL );
+    if( errorCode_qf == CL_SUCCESS )
+    {
+        logf( "    Queue family: %u\n", queueFamily );
+        logf( "    Queue index: %u\n", queueIndex );
+    }
 
-    m_ProgramNumber++;
+    delete [] deviceName;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::dumpProgramSPIRV(
-    uint64_t hash,
-    cl_program program,
-    const size_t length,
-    const void* il )
+cl_int CLIntercept::autoPartitionGetDeviceIDs(
+    cl_platform_id platform,
+    cl_device_type device_type,
+    cl_uint num_entries,
+    cl_device_id* devices,
+    cl_uint* num_devices )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-    CLI_ASSERT( config().DumpProgramSPIRV );
+    CLI_ASSERT( config().AutoPartitionAllDevices ||
+                config().AutoPartitionAllSubDevices ||
+                config().AutoPartitionSingleSubDevice );
 
-    std::string fileName;
+    cl_int  errorCode = CL_SUCCESS;
+    std::vector<cl_device_id>   parentDevices;
+    std::vector<cl_device_id>   returnedDevices;
 
-    // Get the dump directory name.
+    cl_uint numDevices = 0;
+    errorCode = dispatch().clGetDeviceIDs(
+        platform,
+        device_type,
+        0,
+        NULL,
+        &numDevices );
+    if( errorCode == CL_SUCCESS && numDevices != 0 )
     {
-        OS().GetDumpDirectoryName( sc_DumpDirectoryName, fileName );
+        parentDevices.resize(numDevices);
+        errorCode = dispatch().clGetDeviceIDs(
+            platform,
+            device_type,
+            numDevices,
+            parentDevices.data(),
+            NULL );
     }
 
-    // Make the filename.  It will have the form:
-    //   CLI_<program number>_<hash>_0000.spv
+    for( auto parent : parentDevices )
     {
-        char    numberString[256] = "";
+        std::vector<cl_device_id>&  subDevices = m_SubDeviceCacheMap[parent];
 
-        if( config().OmitProgramNumber )
-        {
-            CLI_SPRINTF( numberString, 256, "%08X_0000",
-                (unsigned int)hash );
-        }
-        else
+        if( subDevices.empty() )
         {
-            CLI_SPRINTF( numberString, 256, "%04u_%08X_0000",
-                m_ProgramNumber,
-                (unsigned int)hash );
-        }
+            std::string deviceInfo;
+            getDeviceInfoString(
+                1,
+                &parent,
+                deviceInfo );
 
-        fileName += "/CLI_";
-        fileName += numberString;
-        fileName += ".spv";
-    }
-
-    // Now make directories as appropriate.
-    {
-        OS().MakeDumpDirectories( fileName );
-    }
+            if( subDevices.size() == 0 &&
+                config().AutoPartitionByAffinityDomain )
+            {
+                const cl_device_partition_property props[] = {
+                    CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN,
+                    CL_DEVICE_AFFINITY_DOMAIN_NEXT_PARTITIONABLE,
+                    0
+                };
 
-    // Dump the program source to a .cl file.
-    {
-        std::ofstream os;
-        os.open(
-            fileName.c_str(),
-            std::ios::out | std::ios::binary );
-        if( os.good() )
-        {
-            log( "Dumping program to file (inject): " + fileName + "\n" );
+                cl_uint numSubDevices = 0;
+                dispatch().clCreateSubDevices(
+                    parent,
+                    props,
+                    0,
+                    NULL,
+                    &numSubDevices );
+                if( numSubDevices > 1 )
+                {
+                    logf("Partitioned device %s by affinity domain into %u sub-devices.\n",
+                        deviceInfo.c_str(),
+                        numSubDevices );
 
-            os.write( (const char*)il, length );
-            os.close();
+                    subDevices.resize(numSubDevices);
+                    dispatch().clCreateSubDevices(
+                        parent,
+                        props,
+                        numSubDevices,
+                        subDevices.data(),
+                        NULL );
+                }
+            }
 
-            // Optionally, run spirv-dis to disassemble the generated module.
-            if( !config().SPIRVDis.empty() )
+            if( subDevices.size() == 0 &&
+                config().AutoPartitionEqually )
             {
-                std::string command =
-                    config().SPIRVDis +
-                    " -o " + fileName + "t" +
-                    " " + fileName;
+                const cl_device_partition_property props[] = {
+                    CL_DEVICE_PARTITION_EQUALLY,
+                    (cl_device_partition_property)config().AutoPartitionEqually,
+                    0
+                };
 
-                logf( "Running: %s\n", command.c_str() );
-                OS().ExecuteCommand( command );
+                cl_uint numSubDevices = 0;
+                dispatch().clCreateSubDevices(
+                    parent,
+                    props,
+                    0,
+                    NULL,
+                    &numSubDevices );
+                if( numSubDevices > 1 )
+                {
+                    logf("Partitioned device %s equally into %u sub-devices with %u compute unit%s.\n",
+                        deviceInfo.c_str(),
+                        numSubDevices,
+                        config().AutoPartitionEqually,
+                        config().AutoPartitionEqually > 1 ? "s" : "" );
+
+                    subDevices.resize(numSubDevices);
+                    dispatch().clCreateSubDevices(
+                        parent,
+                        props,
+                        numSubDevices,
+                        subDevices.data(),
+                        NULL );
+                }
+            }
+
+            if( subDevices.size() == 0 )
+            {
+                logf("Couldn't partition device %s.\n",
+                    deviceInfo.c_str() );
             }
         }
+
+        if( subDevices.size() == 0 )
+        {
+            returnedDevices.push_back(parent);
+        }
         else
         {
-            logf( "Failed to open il program dump file for writing: %s\n",
-                fileName.c_str() );
+            if( config().AutoPartitionAllDevices )
+            {
+                returnedDevices.push_back(parent);
+            }
+            if( config().AutoPartitionAllDevices ||
+                config().AutoPartitionAllSubDevices )
+            {
+                returnedDevices.insert(
+                    returnedDevices.end(),
+                    subDevices.begin(),
+                    subDevices.end() );
+            }
+            else if( config().AutoPartitionSingleSubDevice )
+            {
+                returnedDevices.push_back( subDevices.front() );
+            }
+            else
+            {
+                CLI_ASSERT( 0 );
+                returnedDevices.push_back( parent );
+            }
         }
     }
 
-    SProgramInfo&   programInfo = m_ProgramInfoMap[ program ];
-    programInfo.ProgramNumber = m_ProgramNumber;
-    programInfo.CompileCount = 0;
+    if( errorCode == CL_SUCCESS )
+    {
+        for( cl_uint d = 0; d < returnedDevices.size(); d++ )
+        {
+            if( d < num_entries )
+            {
+                devices[d] = returnedDevices[d];
+            }
+        }
 
-    m_ProgramNumber++;
+        if( num_devices )
+        {
+            num_devices[0] = (cl_uint)returnedDevices.size();
+        }
+    }
+
+    return errorCode;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::dumpProgramOptionsScript(
-    const cl_program program,
-    const char* options )
+void CLIntercept::contextCallbackCaller(
+    const char* errinfo,
+    const void* private_info,
+    size_t cb,
+    void* user_data )
 {
-#if defined(_WIN32)
+    SContextCallbackInfo*   pContextCallbackInfo =
+        (SContextCallbackInfo*)user_data;
 
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    pContextCallbackInfo->pIntercept->contextCallback(
+        errinfo,
+        private_info,
+        cb );
+    if( pContextCallbackInfo->pApplicationCallback )
+    {
+        pContextCallbackInfo->pApplicationCallback(
+            errinfo,
+            private_info,
+            cb,
+            pContextCallbackInfo->pUserData );
+    }
+}
 
-    CLI_ASSERT( config().DumpProgramSource || config().SimpleDumpProgramSource );
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::contextCallback(
+    const std::string& errinfo,
+    const void* private_info,
+    size_t cb )
+{
+    char    str[256] = "";
+    CLI_SPRINTF( str, 256, "=======> Context Callback (private_info = %p, cb = %zu):\n",
+        private_info,
+        cb );
 
-    const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+    log( str + errinfo + "\n" + "<======= End of Context Callback\n" );
+}
 
-    if( options )
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::contextCallbackOverrideInit(
+    const cl_context_properties* properties,
+    void (CL_CALLBACK*& pCallback)( const char*, const void*, size_t, void* ),
+    void*& pUserData,
+    SContextCallbackInfo*& pContextCallbackInfo,
+    cl_context_properties*& pLocalContextProperties )
+{
+    if( m_Config.ContextCallbackLogging )
     {
-        char    dirname[MAX_PATH] = "";
-        char    filename[MAX_PATH] = "";
-        char    filepath[MAX_PATH] = "";
-
-        if( config().DumpProgramSourceScript )
+        pContextCallbackInfo = new SContextCallbackInfo;
+        if( pContextCallbackInfo )
         {
-            size_t  remaining = MAX_PATH;
-
-            char    date[9] = "";
-            char    time[9] = "";
-            char*   curPos = NULL;
-            char*   nextToken = NULL;
-            char*   pch = NULL;
-
-            // Directory:
-
-            curPos = dirname;
-            remaining = MAX_PATH;
-            memset( curPos, 0, MAX_PATH );
-
-            _strdate_s( date, 9 );
-            _strtime_s( time, 9 );
+            pContextCallbackInfo->pIntercept = this;
+            pContextCallbackInfo->pApplicationCallback = pCallback;
+            pContextCallbackInfo->pUserData = pUserData;
 
-            memcpy_s( curPos, remaining, "CLShaderDump_", 14 );
-            curPos += 13;
-            remaining -= 13;
+            pCallback = CLIntercept::contextCallbackCaller;
+            pUserData = pContextCallbackInfo;
+        }
+    }
 
-            memcpy_s( curPos, remaining, strtok_s( date, "/", &nextToken ), 2 );
-            curPos += 2;
-            remaining -= 2;
+    if( m_Config.ContextHintLevel )
+    {
+        // We want to add a context hints to the context properties, unless
+        // the context properties already requests performance hints
+        // (requesting the same property twice is an error).  So, look through
+        // the context properties for the performance hint enum.  We need to
+        // do this anyways to count the number of property pairs.
+        bool    foundPerformanceHintEnum = false;
+        int     numProperties = 0;
+        if( properties )
+        {
+            while( properties[ numProperties ] != 0 )
+            {
+                if( properties[ numProperties ] == CL_CONTEXT_SHOW_DIAGNOSTICS_INTEL )
+                {
+                    foundPerformanceHintEnum = true;
+                }
+                numProperties += 2;
+            }
+        }
 
-            memcpy_s( curPos, remaining, strtok_s( NULL, "/", &nextToken ), 2 );
-            curPos += 2;
-            remaining -= 2;
+        if( foundPerformanceHintEnum == false )
+        {
+            // The performance hint property isn't already set, so we'll
+            // need to allocate an extra pair of properties for it.
+            numProperties += 2;
+        }
 
-            memcpy_s( curPos, remaining, strtok_s( NULL, "/", &nextToken ), 2 );
-            curPos += 2;
-            remaining -= 2;
-
-            ::CreateDirectoryA( dirname, NULL );
-
-            // File:
-
-            curPos = filename;
-            remaining = MAX_PATH;
-            memset( curPos, 0, MAX_PATH );
-
-            if( GetModuleFileNameA( NULL, filename, MAX_PATH-1 ) == 0 )
+        // Allocate a new array of properties.  We need to allocate two
+        // properties for each pair, plus one property for the terminating
+        // zero.
+        pLocalContextProperties = new cl_context_properties[ numProperties + 1 ];
+        if( pLocalContextProperties )
+        {
+            // Copy the old properties array to the new properties array,
+            // if the new properties array exists.
+            numProperties = 0;
+            if( properties )
             {
-                CLI_ASSERT( 0 );
-                strcpy_s( curPos, remaining, "process.exe" );
+                while( properties[ numProperties ] != 0 )
+                {
+                    pLocalContextProperties[ numProperties ] = properties[ numProperties ];
+                    if( properties[ numProperties ] == CL_CONTEXT_SHOW_DIAGNOSTICS_INTEL )
+                    {
+                        CLI_ASSERT( foundPerformanceHintEnum );
+                        pLocalContextProperties[ numProperties + 1 ] = m_Config.ContextHintLevel;
+                    }
+                    else
+                    {
+                        pLocalContextProperties[ numProperties + 1 ] = properties[ numProperties + 1 ];
+                    }
+                    numProperties += 2;
+                }
             }
-
-            pch = strrchr( filename, '\\' );
-            pch++;
-            memcpy_s( curPos, remaining, pch, strlen( pch ) );
-            curPos += strlen( pch ) - 4;    // -4 to cut off ".exe"
-            remaining -= strlen( pch ) - 4;
-
-            memcpy_s( curPos, remaining, "_", 2 );
-            curPos += 1;
-            remaining -= 1;
-
-            memcpy_s( curPos, remaining, strtok_s( time, ":", &nextToken ), 2 );
-            curPos += 2;
-            remaining -= 2;
-
-            memcpy_s( curPos, remaining, strtok_s( NULL, ":", &nextToken ), 2 );
-            curPos += 2;
-            remaining -= 2;
-
-            memcpy_s( curPos, remaining, strtok_s( NULL, ":", &nextToken ), 2 );
-            curPos += 2;
-            remaining -= 2;
-
-            CLI_SPRINTF( curPos, remaining, "_%8.8x", programInfo.ProgramNumber );
-            curPos += 9;
-            remaining -= 9;
-        }
-        else
-        {
-            CLI_SPRINTF( dirname, MAX_PATH, "." );
-            CLI_SPRINTF( filename, MAX_PATH, "kernel" );
-        }
-
-        CLI_SPRINTF( filepath, MAX_PATH, "%s/%s.%s", dirname, filename, "txt" );
-
-        std::ofstream os;
-        os.open(
-            filepath,
-            std::ios::out | std::ios::binary );
-        if( os.good() )
-        {
-            os.write( options, strlen( options ) );
-            os.close();
-        }
-        else
-        {
-            logf( "Failed to open program options dump file for writing: %s\n",
-                filepath );
+            // Add the performance hint property if it wasn't already set.
+            if( foundPerformanceHintEnum == false )
+            {
+                pLocalContextProperties[ numProperties ] = CL_CONTEXT_SHOW_DIAGNOSTICS_INTEL;
+                pLocalContextProperties[ numProperties + 1 ] = m_Config.ContextHintLevel;
+                numProperties += 2;
+            }
+            // Add the terminating zero.
+            pLocalContextProperties[ numProperties ] = 0;
         }
     }
-
-#else
-    CLI_ASSERT( 0 );
-#endif
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::dumpProgramOptions(
-    const cl_program program,
-    cl_bool isCompile,
-    cl_bool isLink,
-    const char* options )
+void CLIntercept::contextCallbackOverrideCleanup(
+    const cl_context context,
+    SContextCallbackInfo*& pContextCallbackInfo,
+    cl_context_properties*& pLocalContextProperties )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
-
-    CLI_ASSERT(
-        config().DumpProgramSource ||
-        config().DumpInputProgramBinaries ||
-        config().DumpProgramBinaries ||
-        config().DumpProgramSPIRV );
-
-    const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
-
-    if( options )
+    if( context && pContextCallbackInfo )
     {
-        std::string fileName;
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-        // Get the dump directory name.
+        // Check if we already have a context callback info for this context.  If
+        // we do, free it.
+        SContextCallbackInfo* pOldContextCallbackInfo =
+            m_ContextCallbackInfoMap[ context ];
+        if( pOldContextCallbackInfo )
         {
-            OS().GetDumpDirectoryName( sc_DumpDirectoryName, fileName );
+            delete pOldContextCallbackInfo;
+            pOldContextCallbackInfo = NULL;
         }
-        // Make the filename.  It will have the form:
-        //   CLI_<program number>_<program hash>_<compile count>_<options hash>
-        // Leave off the extension for now.
-        {
-            char    numberString[256] = "";
-
-            if( config().OmitProgramNumber )
-            {
-                CLI_SPRINTF( numberString, 256, "%08X_%04u_%08X",
-                    (unsigned int)programInfo.ProgramHash,
-                    programInfo.CompileCount,
-                    (unsigned int)programInfo.OptionsHash );
-            }
-            else
-            {
-                CLI_SPRINTF( numberString, 256, "%04u_%08X_%04u_%08X",
-                    programInfo.ProgramNumber,
-                    (unsigned int)programInfo.ProgramHash,
-                    programInfo.CompileCount,
-                    (unsigned int)programInfo.OptionsHash );
-            }
 
-            fileName += "/CLI_";
-            fileName += numberString;
-        }
-        // Dump the program options to a .txt file.
-        {
-            fileName +=
-                isCompile ? "_compile_options.txt" :
-                isLink ? "_link_options.txt" :
-                "_options.txt";
-            std::ofstream os;
-            os.open(
-                fileName.c_str(),
-                std::ios::out | std::ios::binary );
-            if( os.good() )
-            {
-                log( "Dumping program options to file (inject): " + fileName + "\n" );
+        m_ContextCallbackInfoMap[ context ]  = pContextCallbackInfo;
+    }
+    else
+    {
+        delete pContextCallbackInfo;
+        pContextCallbackInfo = NULL;
+    }
 
-                // don't write the null terminator to the file
-                os.write( options, strlen( options) );
-                os.close();
-            }
-            else
-            {
-                logf( "Failed to open program options dump file for writing: %s\n",
-                    fileName.c_str() );
-            }
-        }
+    if( pLocalContextProperties )
+    {
+        delete pLocalContextProperties;
+        pLocalContextProperties = NULL;
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::dumpProgramBuildLog(
-    const cl_program program,
-    const cl_device_id device,
-    const char* buildLog,
-    const size_t buildLogSize )
+void CLIntercept::eventCallbackCaller(
+    cl_event event,
+    cl_int status,
+    void* user_data )
 {
-    // We're already in a critical section when we get here, so we don't need to
-    // grab the critical section again.
+    SEventCallbackInfo* pEventCallbackInfo =
+        (SEventCallbackInfo*)user_data;
 
-    CLI_ASSERT( config().DumpProgramBuildLogs );
-    CLI_ASSERT( buildLog );
+    CLIntercept*    pIntercept = pEventCallbackInfo->pIntercept;
 
-    const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
+    GET_ENQUEUE_COUNTER();
+    CALL_LOGGING_ENTER( "event = %p, status = %s (%d)",
+        event,
+        pIntercept->enumName().name_command_exec_status( status ).c_str(),
+        status );
 
-    std::string fileName;
+    clock::time_point   cpuStart = clock::now();
 
-    // Get the dump directory name.
+    pIntercept->eventCallback(
+        event,
+        status );
+    if( pEventCallbackInfo->pApplicationCallback )
     {
-        OS().GetDumpDirectoryName( sc_DumpDirectoryName, fileName );
+        pEventCallbackInfo->pApplicationCallback(
+            event,
+            status,
+            pEventCallbackInfo->pUserData );
     }
-    // Make the filename.  It will have the form:
-    //   CLI_<program number>_<program hash>_<compile count>_<options hash>
-    // Leave off the extension for now.
-    {
-        char    numberString[256] = "";
 
-        if( config().OmitProgramNumber )
-        {
-            CLI_SPRINTF( numberString, 256, "%08X_%04u_%08X",
-                (unsigned int)programInfo.ProgramHash,
-                programInfo.CompileCount,
-                (unsigned int)programInfo.OptionsHash );
-        }
-        else
-        {
-            CLI_SPRINTF( numberString, 256, "%04u_%08X_%04u_%08X",
-                programInfo.ProgramNumber,
-                (unsigned int)programInfo.ProgramHash,
-                programInfo.CompileCount,
-                (unsigned int)programInfo.OptionsHash );
-        }
+    clock::time_point   cpuEnd = clock::now();
 
-        fileName += "/CLI_";
-        fileName += numberString;
-    }
-    // Now make directories as appropriate.
-    {
-        OS().MakeDumpDirectories( fileName );
-    }
+    CALL_LOGGING_EXIT( CL_SUCCESS );
 
-    cl_device_type  deviceType = CL_DEVICE_TYPE_DEFAULT;
+    delete pEventCallbackInfo;
+}
 
-    // It's OK if this fails.  If it does, it just
-    // means that our output file won't have a device
-    // type.
-    dispatch().clGetDeviceInfo(
-        device,
-        CL_DEVICE_TYPE,
-        sizeof( deviceType ),
-        &deviceType,
-        NULL );
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::eventCallback(
+    cl_event event,
+    cl_int status )
+{
+    // TODO: Since we call log the eventCallbackCaller, do we need to do
+    //       anything here?
+}
 
-    if( deviceType & CL_DEVICE_TYPE_CPU )
-    {
-        fileName += "_CPU";
-    }
-    if( deviceType & CL_DEVICE_TYPE_GPU )
-    {
-        fileName += "_GPU";
-    }
-    if( deviceType & CL_DEVICE_TYPE_ACCELERATOR )
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::overrideNullLocalWorkSize(
+    const cl_uint work_dim,
+    const size_t* global_work_size,
+    const size_t*& local_work_size )
+{
+    if( local_work_size == NULL )
     {
-        fileName += "_ACC";
+        switch( work_dim )
+        {
+        case 1:
+            if( m_Config.NullLocalWorkSizeX != 0 )
+            {
+                if( global_work_size[0] % m_Config.NullLocalWorkSizeX == 0 )
+                {
+                    local_work_size = &m_Config.NullLocalWorkSizeX;
+                }
+                else
+                {
+                    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+                    logf( "Couldn't override NULL local work size: < %zu > %% < %zu > != 0!\n",
+                        global_work_size[0],
+                        m_Config.NullLocalWorkSizeX );
+                }
+            }
+            break;
+        case 2:
+            if( ( m_Config.NullLocalWorkSizeX != 0 ) &&
+                ( m_Config.NullLocalWorkSizeY != 0 ) )
+            {
+                if( ( global_work_size[0] % m_Config.NullLocalWorkSizeX == 0 ) &&
+                    ( global_work_size[1] % m_Config.NullLocalWorkSizeY == 0 ) )
+                {
+                    local_work_size = &m_Config.NullLocalWorkSizeX;
+                }
+                else
+                {
+                    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+                    logf( "Couldn't override NULL local work size: < %zu x %zu > %% < %zu x %zu > != 0!\n",
+                        global_work_size[0],
+                        global_work_size[1],
+                        m_Config.NullLocalWorkSizeX,
+                        m_Config.NullLocalWorkSizeY );
+                }
+            }
+            break;
+        case 3:
+            if( ( m_Config.NullLocalWorkSizeX != 0 ) &&
+                ( m_Config.NullLocalWorkSizeY != 0 ) &&
+                ( m_Config.NullLocalWorkSizeZ != 0 ) )
+            {
+                if( ( global_work_size[0] % m_Config.NullLocalWorkSizeX == 0 ) &&
+                    ( global_work_size[1] % m_Config.NullLocalWorkSizeY == 0 ) &&
+                    ( global_work_size[2] % m_Config.NullLocalWorkSizeZ == 0 ) )
+                {
+                    local_work_size = &m_Config.NullLocalWorkSizeX;
+                }
+                else
+                {
+                    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+                    logf( "Couldn't override NULL local work size: < %zu x %zu x %zu > %% < %zu x %zu x %zu > != 0!\n",
+                        global_work_size[0],
+                        global_work_size[1],
+                        global_work_size[2],
+                        m_Config.NullLocalWorkSizeX,
+                        m_Config.NullLocalWorkSizeY,
+                        m_Config.NullLocalWorkSizeZ );
+                }
+            }
+            break;
+        default:
+            // Nothing.
+            break;
+        }
     }
-    if( deviceType & CL_DEVICE_TYPE_CUSTOM )
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::combineProgramStrings(
+    cl_uint& count,
+    const char**& strings,
+    const size_t*& lengths,
+    char*& singleString ) const
+{
+    size_t  allocSize = 0;
+    cl_uint i = 0;
+
+    for( i = 0; i < count; i++ )
     {
-        fileName += "_CUSTOM";
+        size_t  length = 0;
+        if( ( lengths == NULL ) ||
+            ( lengths[i] == 0 ) )
+        {
+            if( strings != NULL && strings[i] != NULL )
+            {
+                length = strlen( strings[i] );
+            }
+        }
+        else
+        {
+            length = lengths[i];
+        }
+        allocSize += length;
     }
 
-    fileName += "_build_log.txt";
+    // Allocate a multiple of four bytes.
+    // Allocate some extra to make sure we're null terminated.
+    allocSize = ( allocSize + ( 4 + 4 - 1 ) ) & ~( 4 - 1 );
 
-    std::ofstream os;
-    os.open(
-        fileName.c_str(),
-        std::ios::out | std::ios::binary );
-    if( os.good() )
+    singleString = new char[ allocSize ];
+    if( singleString )
     {
-        log( "Dumping build log to file: " + fileName + "\n" );
+        memset( singleString, 0, allocSize );
 
-        os.write(
-            buildLog,
-            buildLogSize );
-        os.close();
-    }
-    else
-    {
-        logf( "Failed to open program build log dump file for writing: %s\n",
-            fileName.c_str() );
+        char*   pDst = singleString;
+        size_t  remaining = allocSize;
+        for( i = 0; i < count; i++ )
+        {
+            size_t  length = 0;
+            if( ( lengths == NULL ) ||
+                ( lengths[i] == 0 ) )
+            {
+                if( strings != NULL && strings[i] != NULL )
+                {
+                    length = strlen( strings[i] );
+                }
+            }
+            else
+            {
+                length = lengths[i];
+            }
+            if( length )
+            {
+                CLI_MEMCPY(
+                    pDst,
+                    remaining,
+                    strings[i],
+                    length );
+                pDst += length;
+                remaining -= length;
+            }
+        }
+
+        // Replace any NULL chars between kernels with spaces.
+        if( count > 1 )
+        {
+            for( char* pStr = singleString; pStr < pDst - 1; pStr++ )
+            {
+                if( *pStr == 0x0 )
+                {
+                    *pStr = 0x20;
+                }
+            }
+        }
+
+        count = 1;
+        strings = ( const char** )&singleString;
+        lengths = NULL;
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::updateHostTimingStats(
-    const std::string& functionName,
-    cl_kernel kernel,
-    clock::time_point start,
-    clock::time_point end )
+void CLIntercept::incrementProgramCompileCount(
+    const cl_program program )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+    m_ProgramInfoMap[ program ].CompileCount++;
+}
 
-    std::string key( functionName );
-    if( kernel )
+///////////////////////////////////////////////////////////////////////////////
+//
+uint64_t CLIntercept::hashString(
+    const char* singleString,
+    size_t length )
+{
+    uint64_t    hash = 0;
+
+    if( singleString != NULL )
     {
-        const std::string& kernelName = getShortKernelNameWithHash(kernel);
-        key += "( ";
-        key += kernelName;
-        key += " )";
-    }
+        const unsigned int* dwProgramSource = (const unsigned int*)singleString;
+        size_t  dwProgramSize = length;
 
-    SHostTimingStats& hostTimingStats = m_HostTimingStatsMap[ key ];
+        dwProgramSize = ( dwProgramSize + ( 4 - 1 ) ) & ~( 4 - 1 );
+        dwProgramSize /= 4;
 
-    using ns = std::chrono::nanoseconds;
-    uint64_t    nsDelta = std::chrono::duration_cast<ns>(end - start).count();
+        hash = Hash(
+            dwProgramSource,
+            dwProgramSize );
+    }
 
-    hostTimingStats.NumberOfCalls++;
-    hostTimingStats.TotalNS += nsDelta;
-    hostTimingStats.MinNS = std::min<uint64_t>( hostTimingStats.MinNS, nsDelta );
-    hostTimingStats.MaxNS = std::max<uint64_t>( hostTimingStats.MaxNS, nsDelta );
+    return hash;
+}
 
-    if( config().HostPerformanceTimeLogging )
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::saveProgramHash(
+    const cl_program program,
+    uint64_t hash )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+    if( program != NULL )
     {
-        uint64_t    numberOfCalls = hostTimingStats.NumberOfCalls;
-        logf( "Host Time for call %u: %s = %u\n",
-            (unsigned int)numberOfCalls,
-            key.c_str(),
-            (unsigned int)nsDelta );
+        m_ProgramInfoMap[ program ].ProgramHash = hash;
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::modifyCommandQueueProperties(
-    cl_command_queue_properties& props ) const
+void CLIntercept::saveProgramOptionsHash(
+    const cl_program program,
+    const char* options )
 {
-    if( config().InOrderQueue )
-    {
-        props &= ~(cl_command_queue_properties)CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
-    }
-    if( config().NoProfilingQueue )
-    {
-        props &= ~(cl_command_queue_properties)CL_QUEUE_PROFILING_ENABLE;
-    }
-    if( config().DevicePerformanceTiming ||
-        config().ITTPerformanceTiming ||
-        config().ChromePerformanceTiming ||
-        config().DevicePerfCounterEventBasedSampling )
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    if( program != NULL && options != NULL )
     {
-        props |= (cl_command_queue_properties)CL_QUEUE_PROFILING_ENABLE;
+        // First: Create a copy of the options string that's padded to a
+        // multiple of four bytes.
+
+        cl_uint count = 1;
+        const char** strings = &options;
+        const size_t* lengths = NULL;
+        char* singleString = NULL;
+        combineProgramStrings(
+            count,
+            strings,
+            lengths,
+            singleString );
+
+        uint64_t hash = hashString(
+            singleString,
+            strlen( singleString ) );
+
+        m_ProgramInfoMap[ program ].OptionsHash = hash;
+
+        delete [] singleString;
+        singleString = NULL;
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::createCommandQueueProperties(
-    cl_device_id device,
-    cl_command_queue_properties props,
-    cl_queue_properties*& pLocalQueueProperties ) const
+bool CLIntercept::injectProgramSource(
+    const uint64_t hash,
+    cl_uint& count,
+    const char**& strings,
+    const size_t*& lengths,
+    char*& singleString )
 {
-    bool    addCommandQueuePropertiesEnum = true;
-    bool    addPriorityHintEnum =
-                config().DefaultQueuePriorityHint != 0 &&
-                checkDeviceForExtension( device, "cl_khr_priority_hints" );
-    bool    addThrottleHintEnum =
-                config().DefaultQueueThrottleHint != 0 &&
-                checkDeviceForExtension( device, "cl_khr_throttle_hints" );
+    // We don't expect to get here unless we've combined the app's string(s)
+    // into a single string and computed a hash from it.
+    CLI_ASSERT( singleString );
 
-    int numProperties = 0;
-    if( addCommandQueuePropertiesEnum )
-    {
-        numProperties += 2;
-    }
-    if( addThrottleHintEnum )
-    {
-        numProperties += 2;
-    }
-    if( addThrottleHintEnum )
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    bool    injected = false;
+
+    std::string fileName;
+
+    // Get the dump directory name.
     {
-        numProperties += 2;
+        OS().GetDumpDirectoryNameWithoutPid( sc_DumpDirectoryName, fileName );
+        fileName += "/Inject";
     }
 
-    // Allocate a new array of properties.  We need to allocate two
-    // properties for each pair, plus one property for the terminating
-    // zero.
-    pLocalQueueProperties = new cl_queue_properties[ numProperties + 1 ];
-    if( pLocalQueueProperties )
+    // Make two candidate filenames.  They will have the form:
+    //   CLI_<program number>_<hash>_source.cl, or
+    //   CLI_<hash>_source.cl
     {
-        numProperties = 0;
+        char    numberString1[256] = "";
+        CLI_SPRINTF( numberString1, 256, "%04u_%08X",
+            m_ProgramNumber,
+            (unsigned int)hash );
 
-        if( addPriorityHintEnum )
+        char    numberString2[256] = "";
+        CLI_SPRINTF( numberString2, 256, "%08X",
+            (unsigned int)hash );
+
+        std::string fileName1;
+        fileName1 = fileName;
+        fileName1 += "/CLI_";
+        fileName1 += numberString1;
+        fileName1 += "_source.cl";
+
+        std::string fileName2;
+        fileName2 = fileName;
+        fileName2 += "/CLI_";
+        fileName2 += numberString2;
+        fileName2 += "_source.cl";
+
+        std::ifstream is;
+
+        is.open(
+            fileName1.c_str(),
+            std::ios::in | std::ios::binary );
+        if( is.good() )
         {
-            CLI_ASSERT( config().DefaultQueuePriorityHint != 0 );
-            pLocalQueueProperties[ numProperties] = CL_QUEUE_PRIORITY_KHR;
-            pLocalQueueProperties[ numProperties + 1 ] = config().DefaultQueuePriorityHint;
-            numProperties += 2;
+            log( "Injecting source file: " + fileName1 + "\n" );
         }
-        if( config().DefaultQueueThrottleHint != 0 )
+        else
         {
-            CLI_ASSERT( config().DefaultQueueThrottleHint != 0 );
-            pLocalQueueProperties[ numProperties] = CL_QUEUE_THROTTLE_KHR;
-            pLocalQueueProperties[ numProperties + 1 ] = config().DefaultQueueThrottleHint;
-            numProperties += 2;
+            log( "Injection source file doesn't exist: " + fileName1 + "\n" );
+
+            is.clear();
+            is.open(
+                fileName2.c_str(),
+                std::ios::in | std::ios::binary );
+            if( is.good() )
+            {
+                log( "Injecting source file: " + fileName2 + "\n" );
+            }
+            else
+            {
+                log( "Injection source file doesn't exist: " + fileName2 + "\n" );
+            }
         }
 
-        // This setting is added last in the list, in order to better behave with runtimes
-        // truncating it when a property has a value of 0, which may be the case below.
-        if( addCommandQueuePropertiesEnum )
+        if( is.good() )
         {
-            modifyCommandQueueProperties(props);
+            // The file exists.  Figure out how big it is.
+            size_t  filesize = 0;
 
-            pLocalQueueProperties[numProperties] = CL_QUEUE_PROPERTIES;
-            pLocalQueueProperties[numProperties + 1] = props;
-            numProperties += 2;
-        }
+            is.seekg(0, std::ios::end);
+            filesize = (size_t)is.tellg();
+            is.seekg(0, std::ios::beg);
 
-        // Add the terminating zero.
-        pLocalQueueProperties[ numProperties ] = 0;
+            char*   newSingleString = new char[ filesize + 1 ];
+            if( newSingleString )
+            {
+                memset( newSingleString, 0, filesize + 1 );
+
+                is.read( newSingleString, filesize );
+
+                delete [] singleString;
+
+                singleString = newSingleString;
+                count = 1;
+                strings = ( const char** )&singleString;
+                lengths = NULL;
+
+                injected = true;
+            }
+
+            is.close();
+        }
     }
+
+    return injected;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::createCommandQueuePropertiesOverride(
-    cl_device_id device,
-    const cl_queue_properties* properties,
-    cl_queue_properties*& pLocalQueueProperties ) const
+bool CLIntercept::prependProgramSource(
+    const uint64_t hash,
+    cl_uint& count,
+    const char**& strings,
+    const size_t*& lengths,
+    char*& singleString )
 {
-    // We're always going to add command queue properties, unless command queue
-    // properties already exist (requesting the same property twice is an
-    // error).  We also may add priority hints or throttle hints, in some cases.
-    // So, look through the queue properties for these enums.  We need to do
-    // this anyways to count the number of property pairs.
-    bool    addCommandQueuePropertiesEnum = true;
-    bool    addPriorityHintEnum =
-                config().DefaultQueuePriorityHint != 0 &&
-                checkDeviceForExtension( device, "cl_khr_priority_hints" );
-    bool    addThrottleHintEnum =
-                config().DefaultQueueThrottleHint != 0 &&
-                checkDeviceForExtension( device, "cl_khr_throttle_hints" );
+    // We don't expect to get here unless we've combined the app's string(s)
+    // into a single string and computed a hash from it.
+    CLI_ASSERT( singleString );
 
-    int     numProperties = 0;
-    if( properties )
-    {
-        while( properties[ numProperties ] != 0 )
-        {
-            switch( properties[ numProperties ] )
-            {
-            case CL_QUEUE_PROPERTIES:
-                addCommandQueuePropertiesEnum = false;
-                break;
-            case CL_QUEUE_PRIORITY_KHR:
-                addPriorityHintEnum = false;
-                break;
-            case CL_QUEUE_THROTTLE_KHR:
-                addThrottleHintEnum = false;
-                break;
-            default:
-                break;
-            }
-            numProperties += 2;
-        }
-    }
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-    if( addCommandQueuePropertiesEnum )
-    {
-        numProperties += 2;
-    }
-    if( addThrottleHintEnum )
-    {
-        numProperties += 2;
-    }
-    if( addThrottleHintEnum )
+    bool    injected = false;
+
+    std::string fileName;
+
+    // Get the dump directory name.
     {
-        numProperties += 2;
+        OS().GetDumpDirectoryNameWithoutPid( sc_DumpDirectoryName, fileName );
+        fileName += "/Inject";
     }
 
-    // Allocate a new array of properties.  We need to allocate two
-    // properties for each pair, plus one property for the terminating
-    // zero.
-    pLocalQueueProperties = new cl_queue_properties[ numProperties + 1 ];
-    if( pLocalQueueProperties )
+    // Make three candidate filenames.  They will have the form:
+    //   CLI_<program number>_<hash>_prepend.cl, or
+    //   CLI_<hash>_prepend.cl, or
+    //   CLI_prepend.cl
     {
-        // Copy the old properties array to the new properties array,
-        // if the new properties array exists.
-        numProperties = 0;
-        if( properties )
-        {
-            while( properties[ numProperties ] != 0 )
-            {
-                pLocalQueueProperties[ numProperties ] = properties[ numProperties ];
-                if( properties[ numProperties ] == CL_QUEUE_PROPERTIES )
-                {
-                    CLI_ASSERT( addCommandQueuePropertiesEnum == false );
-
-                    cl_command_queue_properties props = properties[ numProperties + 1 ];
+        char    numberString1[256] = "";
+        CLI_SPRINTF( numberString1, 256, "%04u_%08X",
+            m_ProgramNumber,
+            (unsigned int)hash );
 
-                    modifyCommandQueueProperties( props );
+        char    numberString2[256] = "";
+        CLI_SPRINTF( numberString2, 256, "%08X",
+            (unsigned int)hash );
 
-                    pLocalQueueProperties[ numProperties + 1 ] = props;
+        std::string fileName1;
+        fileName1 = fileName;
+        fileName1 += "/CLI_";
+        fileName1 += numberString1;
+        fileName1 += "_prepend.cl";
+
+        std::string fileName2;
+        fileName2 = fileName;
+        fileName2 += "/CLI_";
+        fileName2 += numberString2;
+        fileName2 += "_prepend.cl";
+
+        std::string fileName3;
+        fileName3 = fileName;
+        fileName3 += "/CLI_prepend.cl";
+
+        std::ifstream is;
+
+        is.open(
+            fileName1.c_str(),
+            std::ios::in | std::ios::binary );
+        if( is.good() )
+        {
+            log( "Prepending source file: " + fileName1 + "\n" );
+        }
+        else
+        {
+            log( "Prepend source file doesn't exist: " + fileName1 + "\n" );
+
+            is.clear();
+            is.open(
+                fileName2.c_str(),
+                std::ios::in | std::ios::binary );
+            if( is.good() )
+            {
+                log( "Prepending source file: " + fileName2 + "\n" );
+            }
+            else
+            {
+                log( "Prepend source file doesn't exist: " + fileName2 + "\n" );
+
+                is.clear();
+                is.open(
+                    fileName3.c_str(),
+                    std::ios::in | std::ios::binary );
+                if( is.good() )
+                {
+                    log( "Prepending source file: " + fileName3 + "\n" );
                 }
                 else
                 {
-                    pLocalQueueProperties[ numProperties + 1 ] =
-                        properties[ numProperties + 1 ];
+                    log( "Prepend source file doesn't exist: " + fileName3 + "\n" );
                 }
-                numProperties += 2;
             }
         }
-        if( addPriorityHintEnum )
-        {
-            CLI_ASSERT( config().DefaultQueuePriorityHint != 0 );
-            pLocalQueueProperties[ numProperties] = CL_QUEUE_PRIORITY_KHR;
-            pLocalQueueProperties[ numProperties + 1 ] = config().DefaultQueuePriorityHint;
-            numProperties += 2;
-        }
-        if( addThrottleHintEnum )
-        {
-            CLI_ASSERT( config().DefaultQueueThrottleHint != 0 );
-            pLocalQueueProperties[ numProperties] = CL_QUEUE_THROTTLE_KHR;
-            pLocalQueueProperties[ numProperties + 1 ] = config().DefaultQueueThrottleHint;
-            numProperties += 2;
-        }
 
-        // This setting is added last in the list, in order to better behave with runtimes
-        // truncating it when a property has a value of 0, which may be the case below.
-        if( addCommandQueuePropertiesEnum )
+        if( is.good() )
         {
-            cl_command_queue_properties props = 0;
+            // The file exists.  Figure out how big it is.
+            size_t  filesize = 0;
 
-            modifyCommandQueueProperties(props);
+            is.seekg(0, std::ios::end);
+            filesize = (size_t)is.tellg();
+            is.seekg(0, std::ios::beg);
 
-            pLocalQueueProperties[numProperties] = CL_QUEUE_PROPERTIES;
-            pLocalQueueProperties[numProperties + 1] = props;
-            numProperties += 2;
-        }
+            size_t  newSize =
+                filesize +
+                strlen(singleString) +
+                1;  // for the null terminator
 
-        // Add the terminating zero.
-        pLocalQueueProperties[ numProperties ] = 0;
+            char*   newSingleString = new char[ newSize ];
+            if( newSingleString )
+            {
+                memset( newSingleString, 0, newSize );
+
+                is.read( newSingleString, filesize );
+
+                CLI_STRCAT( newSingleString, newSize, singleString );
+
+                delete [] singleString;
+
+                singleString = newSingleString;
+                count = 1;
+                strings = ( const char** )&singleString;
+                lengths = NULL;
+
+                injected = true;
+            }
+
+            is.close();
+        }
     }
+
+    return injected;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::dummyCommandQueue(
-    cl_context context,
-    cl_device_id device )
+bool CLIntercept::injectProgramSPIRV(
+    const uint64_t hash,
+    size_t& length,
+    const void*& il,
+    char*& injectedIL )
 {
-    if( config().DummyOutOfOrderQueue )
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    bool    injected = false;
+
+    std::string fileName;
+
+    // Get the dump directory name.
     {
-        cl_command_queue_properties props;
-        dispatch().clGetDeviceInfo(
-            device,
-            CL_DEVICE_QUEUE_ON_HOST_PROPERTIES,
-            sizeof(props),
-            &props,
-            NULL );
-        if( props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE )
-        {
-            std::lock_guard<std::mutex> lock(m_Mutex);
+        OS().GetDumpDirectoryNameWithoutPid( sc_DumpDirectoryName, fileName );
+        fileName += "/Inject";
+    }
 
-            log( "Creating and destroying a dummy out-of-order queue.\n" );
+    // Make two candidate filenames.  They will have the form:
+    //   CLI_<program number>_<hash>_0000.spv, or
+    //   CLI_<hash>_0000.spv
+    {
+        char    numberString1[256] = "";
+        CLI_SPRINTF( numberString1, 256, "%04u_%08X_0000",
+            m_ProgramNumber,
+            (unsigned int)hash );
 
-            cl_int  errorCode = CL_SUCCESS;
-            cl_command_queue dummy = dispatch().clCreateCommandQueue(
-                context,
-                device,
-                CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE,
-                &errorCode );
-            if( errorCode == CL_SUCCESS )
+        char    numberString2[256] = "";
+        CLI_SPRINTF( numberString2, 256, "%08X_0000",
+            (unsigned int)hash );
+
+        std::string fileName1;
+        fileName1 = fileName;
+        fileName1 += "/CLI_";
+        fileName1 += numberString1;
+        fileName1 += ".spv";
+
+        std::string fileName2;
+        fileName2 = fileName;
+        fileName2 += "/CLI_";
+        fileName2 += numberString2;
+        fileName2 += ".spv";
+
+        std::ifstream is;
+
+        is.open(
+            fileName1.c_str(),
+            std::ios::in | std::ios::binary );
+        if( is.good() )
+        {
+            log( "Injecting SPIR-V file: " + fileName1 + "\n" );
+        }
+        else
+        {
+            log( "Injection SPIR-V file doesn't exist: " + fileName1 + "\n" );
+
+            is.clear();
+            is.open(
+                fileName2.c_str(),
+                std::ios::in | std::ios::binary );
+            if( is.good() )
             {
-                dispatch().clReleaseCommandQueue( dummy );
+                log( "Injecting SPIR-V file: " + fileName2 + "\n" );
             }
             else
             {
-                logf( "Error creating dummy command queue!  %s (%i)\n",
-                    enumName().name( errorCode ).c_str(),
-                    errorCode );
+                log( "Injection SPIR-V file doesn't exist: " + fileName2 + "\n" );
+            }
+        }
+
+        if( is.good() )
+        {
+            // The file exists.  Figure out how big it is.
+            size_t  filesize = 0;
+
+            is.seekg(0, std::ios::end);
+            filesize = (size_t)is.tellg();
+            is.seekg(0, std::ios::beg);
+
+            injectedIL = new char[ filesize ];
+            if( injectedIL )
+            {
+                is.read( injectedIL, filesize );
+
+                il = injectedIL;
+                length = filesize;
+
+                injected = true;
             }
+
+            is.close();
         }
     }
+
+    return injected;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::addTimingEvent(
-    const std::string& functionName,
-    const uint64_t enqueueCounter,
-    const clock::time_point queuedTime,
-    const cl_kernel kernel,
-    const cl_uint workDim,
-    const size_t* gwo,
-    const size_t* gws,
-    const size_t* lws,
-    cl_command_queue queue,
-    cl_event event )
+bool CLIntercept::injectProgramOptions(
+    const cl_program program,
+    cl_bool isCompile,
+    cl_bool isLink,
+    char*& newOptions )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-    m_EventList.emplace_back();
+    CLI_ASSERT( newOptions == NULL );
 
-    SEventListNode& node = m_EventList.back();
+    bool    injected = false;
 
-    cl_device_id device = NULL;
-    dispatch().clGetCommandQueueInfo(
-        queue,
-        CL_QUEUE_DEVICE,
-        sizeof(device),
-        &device,
-        NULL );
+    const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
 
-    // Cache the device info if it's not cached already, since we'll print
-    // the device name and other device properties as part of the report.
-    cacheDeviceInfo( device );
-
-    node.Device = device;
-    node.QueueNumber = m_QueueNumberMap[ queue ];
-    node.FunctionName = functionName;
-    node.EnqueueCounter = enqueueCounter;
-    node.QueuedTime = queuedTime;
-    node.Kernel = kernel; // Note: no retain, so cannot count on this value...
-    node.Event = event;
+    std::string fileName;
 
-    if( kernel )
+    // Get the dump directory name.
     {
-        node.KernelName = getShortKernelNameWithHash(kernel);
+        OS().GetDumpDirectoryNameWithoutPid( sc_DumpDirectoryName, fileName );
+        fileName += "/Inject";
+    }
+    // Make four candidate filenames.  They will have the form:
+    //   CLI_<program number>_<program hash>_<compile count>_<options hash>_options.txt, or
+    //   CLI_<program hash>_<compile count>_<options hash>_options.txt, or
+    //   CLI_<program hash>_options.txt, or
+    //   CLI_options.txt
+    {
+        char    numberString1[256] = "";
+        CLI_SPRINTF( numberString1, 256, "%04u_%08X_%04u_%08X",
+            programInfo.ProgramNumber,
+            (unsigned int)programInfo.ProgramHash,
+            programInfo.CompileCount,
+            (unsigned int)programInfo.OptionsHash );
 
-        if( config().DevicePerformanceTimeKernelInfoTracking && device )
-        {
-            const SDeviceInfo& deviceInfo = m_DeviceInfoMap[device];
+        char    numberString2[256] = "";
+        CLI_SPRINTF( numberString2, 256, "%08X_%04u_%08X",
+            (unsigned int)programInfo.ProgramHash,
+            programInfo.CompileCount,
+            (unsigned int)programInfo.OptionsHash );
 
-            std::ostringstream  ss;
-            {
-                size_t  maxsgs = 0;
-                size_t  pwgsm = 0;
-                size_t  simd = 0;
+        char    numberString3[256] = "";
+        CLI_SPRINTF( numberString3, 256, "%08X",
+            (unsigned int)programInfo.ProgramHash );
 
-                // Use the kernel "max subgroup size" and "preferred work
-                // group size multiple" to get a reasonable estimate of
-                // the kernel "SIMD size".  We'll try to query both values,
-                // and if both queries are successful, we'll pick the
-                // smallest one.  Empirically, this is reasonably accurate.
+        const std::string suffix =
+            isCompile ? "_compile_options.txt" :
+            isLink ? "_link_options.txt" :
+            "_options.txt";
 
-                // First, query the "max subgroup size":
+        std::string fileName1;
+        fileName1 = fileName;
+        fileName1 += "/CLI_";
+        fileName1 += numberString1;
+        fileName1 += suffix;
 
-                // The query for the max subgroup size requires passing in
-                // a local work size.  We'll use the local work size provided
-                // by the app if there is one, otherwise we will query the
-                // max local work size for this kernel and use it.
-                const size_t*   queryLWS = lws;
-                cl_uint queryWorkDim = workDim;
+        std::string fileName2;
+        fileName2 = fileName;
+        fileName2 += "/CLI_";
+        fileName2 += numberString2;
+        fileName2 += suffix;
 
-                size_t  kwgs = 0;
-                if( queryLWS == NULL )
+        std::string fileName3;
+        fileName3 = fileName;
+        fileName3 += "/CLI_";
+        fileName3 += numberString3;
+        fileName3 += suffix;
+
+        std::string fileName4;
+        fileName4 = fileName;
+        fileName4 += suffix;
+
+        std::ifstream is;
+
+        is.open(
+            fileName1.c_str(),
+            std::ios::in | std::ios::binary );
+        if( is.good() )
+        {
+            log( "Injecting options file: " + fileName1 + "\n" );
+        }
+        else
+        {
+            log( "Injection options file doesn't exist: " + fileName1 + "\n" );
+
+            is.clear();
+            is.open(
+                fileName2.c_str(),
+                std::ios::in | std::ios::binary );
+            if( is.good() )
+            {
+                log( "Injecting options file: " + fileName2 + "\n" );
+            }
+            else
+            {
+                log( "Injection options file doesn't exist: " + fileName2 + "\n" );
+
+                is.clear();
+                is.open(
+                    fileName3.c_str(),
+                    std::ios::in | std::ios::binary );
+                if( is.good() )
                 {
-                    dispatch().clGetKernelWorkGroupInfo(
-                        kernel,
-                        device,
-                        CL_KERNEL_WORK_GROUP_SIZE,
-                        sizeof(kwgs),
-                        &kwgs,
-                        NULL );
-                    queryLWS = &kwgs;
-                    queryWorkDim = 1;
+                    log( "Injecting options file: " + fileName3 + "\n" );
                 }
-
-                if( maxsgs == 0 &&
-                    deviceInfo.Supports_cl_khr_subgroups )
+                else
                 {
-                    cl_platform_id  platform = getPlatform(device);
+                    log( "Injection options file doesn't exist: " + fileName3 + "\n" );
 
-                    if( dispatchX(platform).clGetKernelSubGroupInfoKHR == NULL )
+                    is.clear();
+                    is.open(
+                        fileName4.c_str(),
+                        std::ios::in | std::ios::binary );
+                    if( is.good() )
                     {
-                        getExtensionFunctionAddress(
-                            platform,
-                            "clGetKernelSubGroupInfoKHR" );
+                        log( "Injecting options file: " + fileName4 + "\n" );
                     }
-
-                    auto dispatchX = this->dispatchX(platform);
-                    if( dispatchX.clGetKernelSubGroupInfoKHR )
+                    else
                     {
-                        dispatchX.clGetKernelSubGroupInfoKHR(
-                            kernel,
-                            device,
-                            CL_KERNEL_MAX_SUB_GROUP_SIZE_FOR_NDRANGE_KHR,
-                            queryWorkDim * sizeof(queryLWS[0]),
-                            queryLWS,
-                            sizeof(maxsgs),
-                            &maxsgs,
-                            NULL );
+                        log( "Injection options file doesn't exist: " + fileName4 + "\n" );
                     }
                 }
-                if( maxsgs == 0 &&
-                    deviceInfo.NumericVersion >= CL_MAKE_VERSION_KHR(2, 1, 0) &&
-                    dispatch().clGetKernelSubGroupInfo )
-                {
-                    dispatch().clGetKernelSubGroupInfo(
-                        kernel,
-                        device,
-                        CL_KERNEL_MAX_SUB_GROUP_SIZE_FOR_NDRANGE,
-                        queryWorkDim * sizeof(queryLWS[0]),
-                        queryLWS,
-                        sizeof(maxsgs),
-                        &maxsgs,
-                        NULL );
-                }
+            }
+        }
 
-                // Next, query the "preferred work group size multiple":
+        if( is.good() )
+        {
+            // The file exists.  Figure out how big it is.
+            size_t  filesize = 0;
 
-                dispatch().clGetKernelWorkGroupInfo(
-                    kernel,
-                    device,
-                    CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE,
-                    sizeof(pwgsm),
-                    &pwgsm,
-                    NULL );
+            is.seekg(0, std::ios::end);
+            filesize = (size_t)is.tellg();
+            is.seekg(0, std::ios::beg);
 
-                // If either query is zero, use the other query.
-                // Otherwise, use the smallest query.
+            newOptions = new char[ filesize + 1 ];
+            if( newOptions )
+            {
+                memset( newOptions, 0, filesize + 1 );
 
-                maxsgs = ( maxsgs == 0 ) ? pwgsm : maxsgs;
-                pwgsm = ( pwgsm == 0 ) ? maxsgs : pwgsm;
-                simd = ( maxsgs < pwgsm ) ? maxsgs : pwgsm;
+                is.read( newOptions, filesize );
 
-                if( simd )
-                {
-                    ss << " SIMD" << simd;
-                }
-            }
-            {
-                cl_ulong slm = 0;
-                dispatch().clGetKernelWorkGroupInfo(
-                    kernel,
-                    device,
-                    CL_KERNEL_LOCAL_MEM_SIZE,
-                    sizeof(slm),
-                    &slm,
-                    NULL );
-                if( slm )
-                {
-                    ss << " SLM=" << slm;
-                }
-            }
-            {
-                cl_ulong tpm = 0;
-                dispatch().clGetKernelWorkGroupInfo(
-                    kernel,
-                    device,
-                    CL_KERNEL_PRIVATE_MEM_SIZE,
-                    sizeof(tpm),
-                    &tpm,
-                    NULL );
-                if( tpm )
-                {
-                    ss << " TPM=" << tpm;
-                }
-            }
-            {
-                cl_ulong spill = 0;
-                dispatch().clGetKernelWorkGroupInfo(
-                    kernel,
-                    device,
-                    CL_KERNEL_SPILL_MEM_SIZE_INTEL,
-                    sizeof(spill),
-                    &spill,
-                    NULL );
-                if( spill )
+                // Replace any newline characters with spaces.
+                // Some editors insert newline characters, especially at the
+                // end of the file, which can cause build options to become
+                // invalid.
+                for( size_t i = 0; i < filesize; i++ )
                 {
-                    ss << " SPILL=" << spill;
+                    if( newOptions[i] == '\n' )
+                    {
+                        newOptions[i] = ' ';
+                    }
                 }
+
+                injected = true;
             }
-            node.KernelName += ss.str();
+
+            is.close();
         }
+    }
 
-        if( config().DevicePerformanceTimeGWOTracking )
-        {
-            std::ostringstream  ss;
-            ss << " GWO[ ";
-            if( gwo )
+    return injected;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CLIntercept::appendBuildOptions(
+    const char* append,
+    const char* options,
+    char*& newOptions ) const
+{
+    bool    modified = false;
+
+    size_t  newSize = strlen(append) + 1;    // for the null terminator
+
+    const char* oldOptions = newOptions ? newOptions : options;
+    if( oldOptions )
+    {
+        newSize += strlen(oldOptions) + 1;  // for a space
+    }
+
+    char* newNewOptions = new char[ newSize ];
+    if( newNewOptions )
+    {
+        memset( newNewOptions, 0, newSize );
+
+        if( oldOptions )
+        {
+            CLI_STRCAT( newNewOptions, newSize, oldOptions );
+            CLI_STRCAT( newNewOptions, newSize, " " );
+        }
+        CLI_STRCAT( newNewOptions, newSize, append );
+
+        delete [] newOptions;
+        newOptions = newNewOptions;
+
+        modified = true;
+    }
+
+    return modified;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::dumpProgramSourceScript(
+    cl_program program,
+    const char* singleString )
+{
+#if defined(_WIN32)
+
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CLI_ASSERT( config().DumpProgramSourceScript || config().SimpleDumpProgramSource );
+
+    char    dirname[MAX_PATH] = "";
+    char    filename[MAX_PATH] = "";
+    char    filepath[MAX_PATH] = "";
+
+    if( config().DumpProgramSourceScript )
+    {
+        size_t  remaining = MAX_PATH;
+
+        char    date[9] = "";
+        char    time[9] = "";
+        char*   curPos = NULL;
+        char*   nextToken = NULL;
+        char*   pch = NULL;
+
+        // Directory:
+
+        curPos = dirname;
+        remaining = MAX_PATH;
+        memset( curPos, 0, MAX_PATH );
+
+        _strdate_s( date, 9 );
+        _strtime_s( time, 9 );
+
+        memcpy_s( curPos, remaining, "CLShaderDump_", 14 );
+        curPos += 13;
+        remaining -= 13;
+
+        memcpy_s( curPos, remaining, strtok_s( date, "/", &nextToken ), 2 );
+        curPos += 2;
+        remaining -= 2;
+
+        memcpy_s( curPos, remaining, strtok_s( NULL, "/", &nextToken ), 2 );
+        curPos += 2;
+        remaining -= 2;
+
+        memcpy_s( curPos, remaining, strtok_s( NULL, "/", &nextToken ), 2 );
+        curPos += 2;
+        remaining -= 2;
+
+        ::CreateDirectoryA( dirname, NULL );
+
+        // File:
+
+        curPos = filename;
+        remaining = MAX_PATH;
+        memset( curPos, 0, MAX_PATH );
+
+        if( GetModuleFileNameA( NULL, filename, MAX_PATH-1 ) == 0 )
+        {
+            CLI_ASSERT( 0 );
+            strcpy_s( curPos, remaining, "process.exe" );
+        }
+
+        pch = strrchr( filename, '\\' );
+        pch++;
+        memcpy_s( curPos, remaining, pch, strlen( pch ) );
+        curPos += strlen( pch ) - 4;    // -4 to cut off ".exe"
+        remaining -= strlen( pch ) - 4;
+
+        memcpy_s( curPos, remaining, "_", 2 );
+        curPos += 1;
+        remaining -= 1;
+
+        memcpy_s( curPos, remaining, strtok_s( time, ":", &nextToken ), 2 );
+        curPos += 2;
+        remaining -= 2;
+
+        memcpy_s( curPos, remaining, strtok_s( NULL, ":", &nextToken ), 2 );
+        curPos += 2;
+        remaining -= 2;
+
+        memcpy_s( curPos, remaining, strtok_s( NULL, ":", &nextToken ), 2 );
+        curPos += 2;
+        remaining -= 2;
+
+        CLI_SPRINTF( curPos, remaining, "_%8.8x", m_ProgramNumber );
+        curPos += 9;
+        remaining -= 9;
+    }
+    else
+    {
+        CLI_SPRINTF( dirname, MAX_PATH, "." );
+        CLI_SPRINTF( filename, MAX_PATH, "kernel" );
+    }
+
+    CLI_SPRINTF( filepath, MAX_PATH, "%s/%s.%s", dirname, filename, "cl" );
+
+    if( singleString )
+    {
+        std::ofstream os;
+        os.open(
+            filepath,
+            std::ios::out | std::ios::binary );
+        if( os.good() )
+        {
+            os.write( singleString, strlen( singleString ) );
+            os.close();
+        }
+        else
+        {
+            logf( "Failed to open program source dump file for writing: %s\n",
+                filepath );
+        }
+    }
+
+    SProgramInfo&   programInfo = m_ProgramInfoMap[ program ];
+    programInfo.ProgramNumber = m_ProgramNumber;
+    programInfo.CompileCount = 0;
+
+    m_ProgramNumber++;
+
+#else
+    CLI_ASSERT( 0 );
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::dumpProgramSource(
+    uint64_t hash,
+    cl_program program,
+    const char* singleString )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CLI_ASSERT( config().DumpProgramSource || config().AutoCreateSPIRV );
+
+    std::string fileName;
+
+    // Get the dump directory name.
+    {
+        OS().GetDumpDirectoryName( sc_DumpDirectoryName, fileName );
+    }
+    // Make the filename.  It will have the form:
+    //   CLI_<program number>_<hash>_source.cl
+    {
+        char    numberString[256] = "";
+
+        if( config().OmitProgramNumber )
+        {
+            CLI_SPRINTF( numberString, 256, "%08X",
+                (unsigned int)hash );
+        }
+        else
+        {
+            CLI_SPRINTF( numberString, 256, "%04u_%08X",
+                m_ProgramNumber,
+                (unsigned int)hash );
+        }
+
+        fileName += "/CLI_";
+        fileName += numberString;
+        fileName += "_source.cl";
+    }
+    // Now make directories as appropriate.
+    {
+        OS().MakeDumpDirectories( fileName );
+    }
+    // Dump the program source to a .cl file.
+    if( singleString )
+    {
+        std::ofstream os;
+        os.open(
+            fileName.c_str(),
+            std::ios::out | std::ios::binary );
+        if( os.good() )
+        {
+            log( "Dumping program to file (inject): " + fileName + "\n" );
+
+            // don't write the null terminator to the file
+            os.write( singleString, strlen( singleString ) );
+            os.close();
+        }
+        else
+        {
+            logf( "Failed to open program source dump file for writing: %s\n",
+                fileName.c_str() );
+        }
+    }
+
+    SProgramInfo&   programInfo = m_ProgramInfoMap[ program ];
+    programInfo.ProgramNumber = m_ProgramNumber;
+    programInfo.CompileCount = 0;
+
+    m_ProgramNumber++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::dumpInputProgramBinaries(
+    uint64_t hash,
+    const cl_program program,
+    cl_uint num_devices,
+    const cl_device_id* device_list,
+    const size_t* lengths,
+    const unsigned char** binaries )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CLI_ASSERT( config().DumpInputProgramBinaries );
+
+    std::string fileName;
+
+    // Get the dump directory name.
+    {
+        OS().GetDumpDirectoryName( sc_DumpDirectoryName, fileName );
+    }
+
+    // Make the filename.  It will have the form:
+    //   CLI_<program number>_<hash>
+    // Leave off the extension for now.
+    {
+        char    numberString[256] = "";
+
+        if( config().OmitProgramNumber )
+        {
+            CLI_SPRINTF( numberString, 256, "%08X",
+                (unsigned int)hash );
+        }
+        else
+        {
+            CLI_SPRINTF( numberString, 256, "%04u_%08X",
+                m_ProgramNumber,
+                (unsigned int)hash );
+        }
+
+        fileName += "/CLI_";
+        fileName += numberString;
+    }
+    // Now make directories as appropriate.
+    {
+        OS().MakeDumpDirectories( fileName );
+    }
+
+    for( size_t i = 0; i < num_devices; i++ )
+    {
+        cl_device_type  deviceType = CL_DEVICE_TYPE_DEFAULT;
+
+        // It's OK if this fails.  If it does, it just
+        // means that our output file won't have a device
+        // type.
+        dispatch().clGetDeviceInfo(
+            device_list[ i ],
+            CL_DEVICE_TYPE,
+            sizeof( deviceType ),
+            &deviceType,
+            NULL );
+
+        std::string outputFileName = fileName;
+
+        if( deviceType & CL_DEVICE_TYPE_CPU )
+        {
+            outputFileName += "_CPU";
+        }
+        if( deviceType & CL_DEVICE_TYPE_GPU )
+        {
+            outputFileName += "_GPU";
+        }
+        if( deviceType & CL_DEVICE_TYPE_ACCELERATOR )
+        {
+            outputFileName += "_ACC";
+        }
+        if( deviceType & CL_DEVICE_TYPE_CUSTOM )
+        {
+            outputFileName += "_CUSTOM";
+        }
+
+        outputFileName += ".bin";
+
+        std::ofstream os;
+        os.open(
+            outputFileName.c_str(),
+            std::ios::out | std::ios::binary );
+        if( os.good() )
+        {
+            log( "Dumping input program binary to file: " + outputFileName + "\n" );
+
+            os.write(
+                (const char*)binaries[ i ],
+                lengths[ i ] );
+            os.close();
+        }
+        else
+        {
+            logf( "Failed to open program binary dump file for writing: %s\n",
+                outputFileName.c_str());
+        }
+    }
+
+    SProgramInfo&   programInfo = m_ProgramInfoMap[ program ];
+    programInfo.ProgramNumber = m_ProgramNumber;
+    programInfo.CompileCount = 0;
+
+    m_ProgramNumber++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::dumpProgramSPIRV(
+    uint64_t hash,
+    cl_program program,
+    const size_t length,
+    const void* il )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CLI_ASSERT( config().DumpProgramSPIRV );
+
+    std::string fileName;
+
+    // Get the dump directory name.
+    {
+        OS().GetDumpDirectoryName( sc_DumpDirectoryName, fileName );
+    }
+
+    // Make the filename.  It will have the form:
+    //   CLI_<program number>_<hash>_0000.spv
+    {
+        char    numberString[256] = "";
+
+        if( config().OmitProgramNumber )
+        {
+            CLI_SPRINTF( numberString, 256, "%08X_0000",
+                (unsigned int)hash );
+        }
+        else
+        {
+            CLI_SPRINTF( numberString, 256, "%04u_%08X_0000",
+                m_ProgramNumber,
+                (unsigned int)hash );
+        }
+
+        fileName += "/CLI_";
+        fileName += numberString;
+        fileName += ".spv";
+    }
+
+    // Now make directories as appropriate.
+    {
+        OS().MakeDumpDirectories( fileName );
+    }
+
+    // Dump the program source to a .cl file.
+    {
+        std::ofstream os;
+        os.open(
+            fileName.c_str(),
+            std::ios::out | std::ios::binary );
+        if( os.good() )
+        {
+            log( "Dumping program to file (inject): " + fileName + "\n" );
+
+            os.write( (const char*)il, length );
+            os.close();
+
+            // Optionally, run spirv-dis to disassemble the generated module.
+            if( !config().SPIRVDis.empty() )
+            {
+                std::string command =
+                    config().SPIRVDis +
+                    " -o " + fileName + "t" +
+                    " " + fileName;
+
+                logf( "Running: %s\n", command.c_str() );
+                OS().ExecuteCommand( command );
+            }
+        }
+        else
+        {
+            logf( "Failed to open il program dump file for writing: %s\n",
+                fileName.c_str() );
+        }
+    }
+
+    SProgramInfo&   programInfo = m_ProgramInfoMap[ program ];
+    programInfo.ProgramNumber = m_ProgramNumber;
+    programInfo.CompileCount = 0;
+
+    m_ProgramNumber++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::dumpProgramOptionsScript(
+    const cl_program program,
+    const char* options )
+{
+#if defined(_WIN32)
+
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CLI_ASSERT( config().DumpProgramSource || config().SimpleDumpProgramSource );
+
+    const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
+
+    if( options )
+    {
+        char    dirname[MAX_PATH] = "";
+        char    filename[MAX_PATH] = "";
+        char    filepath[MAX_PATH] = "";
+
+        if( config().DumpProgramSourceScript )
+        {
+            size_t  remaining = MAX_PATH;
+
+            char    date[9] = "";
+            char    time[9] = "";
+            char*   curPos = NULL;
+            char*   nextToken = NULL;
+            char*   pch = NULL;
+
+            // Directory:
+
+            curPos = dirname;
+            remaining = MAX_PATH;
+            memset( curPos, 0, MAX_PATH );
+
+            _strdate_s( date, 9 );
+            _strtime_s( time, 9 );
+
+            memcpy_s( curPos, remaining, "CLShaderDump_", 14 );
+            curPos += 13;
+            remaining -= 13;
+
+            memcpy_s( curPos, remaining, strtok_s( date, "/", &nextToken ), 2 );
+            curPos += 2;
+            remaining -= 2;
+
+            memcpy_s( curPos, remaining, strtok_s( NULL, "/", &nextToken ), 2 );
+            curPos += 2;
+            remaining -= 2;
+
+            memcpy_s( curPos, remaining, strtok_s( NULL, "/", &nextToken ), 2 );
+            curPos += 2;
+            remaining -= 2;
+
+            ::CreateDirectoryA( dirname, NULL );
+
+            // File:
+
+            curPos = filename;
+            remaining = MAX_PATH;
+            memset( curPos, 0, MAX_PATH );
+
+            if( GetModuleFileNameA( NULL, filename, MAX_PATH-1 ) == 0 )
+            {
+                CLI_ASSERT( 0 );
+                strcpy_s( curPos, remaining, "process.exe" );
+            }
+
+            pch = strrchr( filename, '\\' );
+            pch++;
+            memcpy_s( curPos, remaining, pch, strlen( pch ) );
+            curPos += strlen( pch ) - 4;    // -4 to cut off ".exe"
+            remaining -= strlen( pch ) - 4;
+
+            memcpy_s( curPos, remaining, "_", 2 );
+            curPos += 1;
+            remaining -= 1;
+
+            memcpy_s( curPos, remaining, strtok_s( time, ":", &nextToken ), 2 );
+            curPos += 2;
+            remaining -= 2;
+
+            memcpy_s( curPos, remaining, strtok_s( NULL, ":", &nextToken ), 2 );
+            curPos += 2;
+            remaining -= 2;
+
+            memcpy_s( curPos, remaining, strtok_s( NULL, ":", &nextToken ), 2 );
+            curPos += 2;
+            remaining -= 2;
+
+            CLI_SPRINTF( curPos, remaining, "_%8.8x", programInfo.ProgramNumber );
+            curPos += 9;
+            remaining -= 9;
+        }
+        else
+        {
+            CLI_SPRINTF( dirname, MAX_PATH, "." );
+            CLI_SPRINTF( filename, MAX_PATH, "kernel" );
+        }
+
+        CLI_SPRINTF( filepath, MAX_PATH, "%s/%s.%s", dirname, filename, "txt" );
+
+        std::ofstream os;
+        os.open(
+            filepath,
+            std::ios::out | std::ios::binary );
+        if( os.good() )
+        {
+            os.write( options, strlen( options ) );
+            os.close();
+        }
+        else
+        {
+            logf( "Failed to open program options dump file for writing: %s\n",
+                filepath );
+        }
+    }
+
+#else
+    CLI_ASSERT( 0 );
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::dumpProgramOptions(
+    const cl_program program,
+    cl_bool isCompile,
+    cl_bool isLink,
+    const char* options )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CLI_ASSERT(
+        config().DumpProgramSource ||
+        config().DumpInputProgramBinaries ||
+        config().DumpProgramBinaries ||
+        config().DumpProgramSPIRV );
+
+    const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
+
+    if( options )
+    {
+        std::string fileName;
+
+        // Get the dump directory name.
+        {
+            OS().GetDumpDirectoryName( sc_DumpDirectoryName, fileName );
+        }
+        // Make the filename.  It will have the form:
+        //   CLI_<program number>_<program hash>_<compile count>_<options hash>
+        // Leave off the extension for now.
+        {
+            char    numberString[256] = "";
+
+            if( config().OmitProgramNumber )
+            {
+                CLI_SPRINTF( numberString, 256, "%08X_%04u_%08X",
+                    (unsigned int)programInfo.ProgramHash,
+                    programInfo.CompileCount,
+                    (unsigned int)programInfo.OptionsHash );
+            }
+            else
+            {
+                CLI_SPRINTF( numberString, 256, "%04u_%08X_%04u_%08X",
+                    programInfo.ProgramNumber,
+                    (unsigned int)programInfo.ProgramHash,
+                    programInfo.CompileCount,
+                    (unsigned int)programInfo.OptionsHash );
+            }
+
+            fileName += "/CLI_";
+            fileName += numberString;
+        }
+        // Dump the program options to a .txt file.
+        {
+            fileName +=
+                isCompile ? "_compile_options.txt" :
+                isLink ? "_link_options.txt" :
+                "_options.txt";
+            std::ofstream os;
+            os.open(
+                fileName.c_str(),
+                std::ios::out | std::ios::binary );
+            if( os.good() )
+            {
+                log( "Dumping program options to file (inject): " + fileName + "\n" );
+
+                // don't write the null terminator to the file
+                os.write( options, strlen( options) );
+                os.close();
+            }
+            else
+            {
+                logf( "Failed to open program options dump file for writing: %s\n",
+                    fileName.c_str() );
+            }
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::dumpProgramBuildLog(
+    const cl_program program,
+    const cl_device_id device,
+    const char* buildLog,
+    const size_t buildLogSize )
+{
+    // We're already in a critical section when we get here, so we don't need to
+    // grab the critical section again.
+
+    CLI_ASSERT( config().DumpProgramBuildLogs );
+    CLI_ASSERT( buildLog );
+
+    const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
+
+    std::string fileName;
+
+    // Get the dump directory name.
+    {
+        OS().GetDumpDirectoryName( sc_DumpDirectoryName, fileName );
+    }
+    // Make the filename.  It will have the form:
+    //   CLI_<program number>_<program hash>_<compile count>_<options hash>
+    // Leave off the extension for now.
+    {
+        char    numberString[256] = "";
+
+        if( config().OmitProgramNumber )
+        {
+            CLI_SPRINTF( numberString, 256, "%08X_%04u_%08X",
+                (unsigned int)programInfo.ProgramHash,
+                programInfo.CompileCount,
+                (unsigned int)programInfo.OptionsHash );
+        }
+        else
+        {
+            CLI_SPRINTF( numberString, 256, "%04u_%08X_%04u_%08X",
+                programInfo.ProgramNumber,
+                (unsigned int)programInfo.ProgramHash,
+                programInfo.CompileCount,
+                (unsigned int)programInfo.OptionsHash );
+        }
+
+        fileName += "/CLI_";
+        fileName += numberString;
+    }
+    // Now make directories as appropriate.
+    {
+        OS().MakeDumpDirectories( fileName );
+    }
+
+    cl_device_type  deviceType = CL_DEVICE_TYPE_DEFAULT;
+
+    // It's OK if this fails.  If it does, it just
+    // means that our output file won't have a device
+    // type.
+    dispatch().clGetDeviceInfo(
+        device,
+        CL_DEVICE_TYPE,
+        sizeof( deviceType ),
+        &deviceType,
+        NULL );
+
+    if( deviceType & CL_DEVICE_TYPE_CPU )
+    {
+        fileName += "_CPU";
+    }
+    if( deviceType & CL_DEVICE_TYPE_GPU )
+    {
+        fileName += "_GPU";
+    }
+    if( deviceType & CL_DEVICE_TYPE_ACCELERATOR )
+    {
+        fileName += "_ACC";
+    }
+    if( deviceType & CL_DEVICE_TYPE_CUSTOM )
+    {
+        fileName += "_CUSTOM";
+    }
+
+    fileName += "_build_log.txt";
+
+    std::ofstream os;
+    os.open(
+        fileName.c_str(),
+        std::ios::out | std::ios::binary );
+    if( os.good() )
+    {
+        log( "Dumping build log to file: " + fileName + "\n" );
+
+        os.write(
+            buildLog,
+            buildLogSize );
+        os.close();
+    }
+    else
+    {
+        logf( "Failed to open program build log dump file for writing: %s\n",
+            fileName.c_str() );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::updateHostTimingStats(
+    const std::string& functionName,
+    cl_kernel kernel,
+    clock::time_point start,
+    clock::time_point end )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    std::string key( functionName );
+    if( kernel )
+    {
+        const std::string& kernelName = getShortKernelNameWithHash(kernel);
+        key += "( ";
+        key += kernelName;
+        key += " )";
+    }
+
+    SHostTimingStats& hostTimingStats = m_HostTimingStatsMap[ key ];
+
+    using ns = std::chrono::nanoseconds;
+    uint64_t    nsDelta = std::chrono::duration_cast<ns>(end - start).count();
+
+    hostTimingStats.NumberOfCalls++;
+    hostTimingStats.TotalNS += nsDelta;
+    hostTimingStats.MinNS = std::min<uint64_t>( hostTimingStats.MinNS, nsDelta );
+    hostTimingStats.MaxNS = std::max<uint64_t>( hostTimingStats.MaxNS, nsDelta );
+
+    if( !m_RollingStatsWindows.empty() )
+    {
+        SRollingStatsWindow*    pWindow = getRollingStatsWindow( end );
+        if( pWindow )
+        {
+            addRollingStats( pWindow->HostStats, key, nsDelta );
+        }
+    }
+
+    if( config().HostPerformanceTimeLogging )
+    {
+        uint64_t    numberOfCalls = hostTimingStats.NumberOfCalls;
+        logf( "Host Time for call %u: %s = %u\n",
+            (unsigned int)numberOfCalls,
+            key.c_str(),
+            (unsigned int)nsDelta );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::addStreamWriterTimingStats(
+    const std::string& name,
+    const CStreamWriter& writer )
+{
+    const CStreamWriter::SStats stats = writer.getStats();
+
+    if( stats.NumberOfCalls )
+    {
+        SHostTimingStats& hostTimingStats = m_HostTimingStatsMap[ name ];
+
+        hostTimingStats.NumberOfCalls = stats.NumberOfCalls;
+        hostTimingStats.TotalNS = stats.TotalNS;
+        hostTimingStats.MinNS = stats.MinNS;
+        hostTimingStats.MaxNS = stats.MaxNS;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::modifyCommandQueueProperties(
+    cl_device_id device,
+    cl_command_queue_properties& props ) const
+{
+    if( config().InOrderQueue )
+    {
+        props &= ~(cl_command_queue_properties)CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+    }
+    else if( config().AutoOutOfOrderQueue &&
+             checkAutoOutOfOrderQueueProperties( props ) )
+    {
+        cl_command_queue_properties deviceProps = 0;
+        dispatch().clGetDeviceInfo(
+            device,
+            CL_DEVICE_QUEUE_ON_HOST_PROPERTIES,
+            sizeof(deviceProps),
+            &deviceProps,
+            NULL );
+        if( deviceProps & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE )
+        {
+            props |= (cl_command_queue_properties)CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+        }
+    }
+    if( config().NoProfilingQueue )
+    {
+        props &= ~(cl_command_queue_properties)CL_QUEUE_PROFILING_ENABLE;
+    }
+    if( config().DevicePerformanceTiming ||
+        config().ITTPerformanceTiming ||
+        config().ChromePerformanceTiming ||
+        config().DevicePerfCounterEventBasedSampling )
+    {
+        props |= (cl_command_queue_properties)CL_QUEUE_PROFILING_ENABLE;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::createCommandQueueProperties(
+    cl_device_id device,
+    cl_command_queue_properties props,
+    cl_queue_properties*& pLocalQueueProperties ) const
+{
+    bool    addCommandQueuePropertiesEnum = true;
+    bool    addPriorityHintEnum =
+                config().DefaultQueuePriorityHint != 0 &&
+                checkDeviceForExtension( device, "cl_khr_priority_hints" );
+    bool    addThrottleHintEnum =
+                config().DefaultQueueThrottleHint != 0 &&
+                checkDeviceForExtension( device, "cl_khr_throttle_hints" );
+
+    int numProperties = 0;
+    if( addCommandQueuePropertiesEnum )
+    {
+        numProperties += 2;
+    }
+    if( addThrottleHintEnum )
+    {
+        numProperties += 2;
+    }
+    if( addThrottleHintEnum )
+    {
+        numProperties += 2;
+    }
+
+    // Allocate a new array of properties.  We need to allocate two
+    // properties for each pair, plus one property for the terminating
+    // zero.
+    pLocalQueueProperties = new cl_queue_properties[ numProperties + 1 ];
+    if( pLocalQueueProperties )
+    {
+        numProperties = 0;
+
+        if( addPriorityHintEnum )
+        {
+            CLI_ASSERT( config().DefaultQueuePriorityHint != 0 );
+            pLocalQueueProperties[ numProperties] = CL_QUEUE_PRIORITY_KHR;
+            pLocalQueueProperties[ numProperties + 1 ] = config().DefaultQueuePriorityHint;
+            numProperties += 2;
+        }
+        if( config().DefaultQueueThrottleHint != 0 )
+        {
+            CLI_ASSERT( config().DefaultQueueThrottleHint != 0 );
+            pLocalQueueProperties[ numProperties] = CL_QUEUE_THROTTLE_KHR;
+            pLocalQueueProperties[ numProperties + 1 ] = config().DefaultQueueThrottleHint;
+            numProperties += 2;
+        }
+
+        // This setting is added last in the list, in order to better behave with runtimes
+        // truncating it when a property has a value of 0, which may be the case below.
+        if( addCommandQueuePropertiesEnum )
+        {
+            modifyCommandQueueProperties(device, props);
+
+            pLocalQueueProperties[numProperties] = CL_QUEUE_PROPERTIES;
+            pLocalQueueProperties[numProperties + 1] = props;
+            numProperties += 2;
+        }
+
+        // Add the terminating zero.
+        pLocalQueueProperties[ numProperties ] = 0;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::createCommandQueuePropertiesOverride(
+    cl_device_id device,
+    const cl_queue_properties* properties,
+    cl_queue_properties*& pLocalQueueProperties ) const
+{
+    // We're always going to add command queue properties, unless command queue
+    // properties already exist (requesting the same property twice is an
+    // error).  We also may add priority hints or throttle hints, in some cases.
+    // So, look through the queue properties for these enums.  We need to do
+    // this anyways to count the number of property pairs.
+    bool    addCommandQueuePropertiesEnum = true;
+    bool    addPriorityHintEnum =
+                config().DefaultQueuePriorityHint != 0 &&
+                checkDeviceForExtension( device, "cl_khr_priority_hints" );
+    bool    addThrottleHintEnum =
+                config().DefaultQueueThrottleHint != 0 &&
+                checkDeviceForExtension( device, "cl_khr_throttle_hints" );
+
+    int     numProperties = 0;
+    if( properties )
+    {
+        while( properties[ numProperties ] != 0 )
+        {
+            switch( properties[ numProperties ] )
+            {
+            case CL_QUEUE_PROPERTIES:
+                addCommandQueuePropertiesEnum = false;
+                break;
+            case CL_QUEUE_PRIORITY_KHR:
+                addPriorityHintEnum = false;
+                break;
+            case CL_QUEUE_THROTTLE_KHR:
+                addThrottleHintEnum = false;
+                break;
+            default:
+                break;
+            }
+            numProperties += 2;
+        }
+    }
+
+    if( addCommandQueuePropertiesEnum )
+    {
+        numProperties += 2;
+    }
+    if( addThrottleHintEnum )
+    {
+        numProperties += 2;
+    }
+    if( addThrottleHintEnum )
+    {
+        numProperties += 2;
+    }
+
+    // Allocate a new array of properties.  We need to allocate two
+    // properties for each pair, plus one property for the terminating
+    // zero.
+    pLocalQueueProperties = new cl_queue_properties[ numProperties + 1 ];
+    if( pLocalQueueProperties )
+    {
+        // Copy the old properties array to the new properties array,
+        // if the new properties array exists.
+        numProperties = 0;
+        if( properties )
+        {
+            while( properties[ numProperties ] != 0 )
+            {
+                pLocalQueueProperties[ numProperties ] = properties[ numProperties ];
+                if( properties[ numProperties ] == CL_QUEUE_PROPERTIES )
+                {
+                    CLI_ASSERT( addCommandQueuePropertiesEnum == false );
+
+                    cl_command_queue_properties props = properties[ numProperties + 1 ];
+
+                    modifyCommandQueueProperties( device, props );
+
+                    pLocalQueueProperties[ numProperties + 1 ] = props;
+                }
+                else
+                {
+                    pLocalQueueProperties[ numProperties + 1 ] =
+                        properties[ numProperties + 1 ];
+                }
+                numProperties += 2;
+            }
+        }
+        if( addPriorityHintEnum )
+        {
+            CLI_ASSERT( config().DefaultQueuePriorityHint != 0 );
+            pLocalQueueProperties[ numProperties] = CL_QUEUE_PRIORITY_KHR;
+            pLocalQueueProperties[ numProperties + 1 ] = config().DefaultQueuePriorityHint;
+            numProperties += 2;
+        }
+        if( addThrottleHintEnum )
+        {
+            CLI_ASSERT( config().DefaultQueueThrottleHint != 0 );
+            pLocalQueueProperties[ numProperties] = CL_QUEUE_THROTTLE_KHR;
+            pLocalQueueProperties[ numProperties + 1 ] = config().DefaultQueueThrottleHint;
+            numProperties += 2;
+        }
+
+        // This setting is added last in the list, in order to better behave with runtimes
+        // truncating it when a property has a value of 0, which may be the case below.
+        if( addCommandQueuePropertiesEnum )
+        {
+            cl_command_queue_properties props = 0;
+
+            modifyCommandQueueProperties(device, props);
+
+            pLocalQueueProperties[numProperties] = CL_QUEUE_PROPERTIES;
+            pLocalQueueProperties[numProperties + 1] = props;
+            numProperties += 2;
+        }
+
+        // Add the terminating zero.
+        pLocalQueueProperties[ numProperties ] = 0;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::dummyCommandQueue(
+    cl_context context,
+    cl_device_id device )
+{
+    if( config().DummyOutOfOrderQueue )
+    {
+        cl_command_queue_properties props;
+        dispatch().clGetDeviceInfo(
+            device,
+            CL_DEVICE_QUEUE_ON_HOST_PROPERTIES,
+            sizeof(props),
+            &props,
+            NULL );
+        if( props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE )
+        {
+            CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+            log( "Creating and destroying a dummy out-of-order queue.\n" );
+
+            cl_int  errorCode = CL_SUCCESS;
+            cl_command_queue dummy = dispatch().clCreateCommandQueue(
+                context,
+                device,
+                CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE,
+                &errorCode );
+            if( errorCode == CL_SUCCESS )
+            {
+                dispatch().clReleaseCommandQueue( dummy );
+            }
+            else
+            {
+                logf( "Error creating dummy command queue!  %s (%i)\n",
+                    enumName().name( errorCode ).c_str(),
+                    errorCode );
+            }
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::addTimingEvent(
+    const std::string& functionName,
+    const uint64_t enqueueCounter,
+    const clock::time_point queuedTime,
+    const cl_kernel kernel,
+    const cl_uint workDim,
+    const size_t* gwo,
+    const size_t* gws,
+    const size_t* lws,
+    cl_command_queue queue,
+    cl_event event )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    const clock::time_point overheadStart =
+        m_Config.OverheadBudgetPercent ? clock::now() : clock::time_point();
+
+    m_EventList.emplace_back();
+
+    SEventListNode& node = m_EventList.back();
+
+    cl_device_id device = NULL;
+    dispatch().clGetCommandQueueInfo(
+        queue,
+        CL_QUEUE_DEVICE,
+        sizeof(device),
+        &device,
+        NULL );
+
+    // Cache the device info if it's not cached already, since we'll print
+    // the device name and other device properties as part of the report.
+    cacheDeviceInfo( device );
+
+    node.Device = device;
+    node.Queue = queue;
+    node.QueueNumber = m_QueueNumberMap[ queue ];
+    node.FunctionName = functionName;
+    node.EnqueueCounter = enqueueCounter;
+    node.QueuedTime = queuedTime;
+    node.Kernel = kernel; // Note: no retain, so cannot count on this value...
+    node.Event = event;
+
+    if( config().SubmitLatencyAnalysis )
+    {
+        SSubmitBlockingEnqueue& blockingEnqueue = submitBlockingEnqueue();
+        if( blockingEnqueue.EnqueueCounter == enqueueCounter &&
+            !blockingEnqueue.Pattern.empty() )
+        {
+            m_SubmitPatternMap[ enqueueCounter ] = blockingEnqueue.Pattern;
+        }
+        else if( m_SubmitPatternMap.find( enqueueCounter ) == m_SubmitPatternMap.end() )
+        {
+            m_SubmitPendingMap[ queue ].insert( enqueueCounter );
+        }
+    }
+
+    if( config().KernelAnomalyDetection )
+    {
+        node.QueueDepth = m_KernelAnomalyQueueInFlightMap[ queue ]++;
+        node.DeviceInFlight = m_KernelAnomalyDeviceInFlightMap[ device ]++;
+
+        if( kernel && gws )
+        {
+            std::ostringstream  ss;
+            ss << "GWS[ ";
+            for( cl_uint i = 0; i < workDim; i++ )
+            {
+                ss << ( i ? " x " : "" ) << gws[i];
+            }
+            ss << " ] LWS[ ";
+            if( lws )
+            {
+                for( cl_uint i = 0; i < workDim; i++ )
+                {
+                    ss << ( i ? " x " : "" ) << lws[i];
+                }
+            }
+            else
+            {
+                ss << "NULL";
+            }
+            ss << " ]";
+            node.WorkSizes = ss.str();
+        }
+    }
+
+    if( kernel )
+    {
+        node.KernelName = getShortKernelNameWithHash(kernel);
+
+        if( config().DevicePerformanceTimeKernelInfoTracking && device )
+        {
+            const SDeviceInfo& deviceInfo = m_DeviceInfoMap[device];
+
+            std::ostringstream  ss;
+            {
+                size_t  maxsgs = 0;
+                size_t  pwgsm = 0;
+                size_t  simd = 0;
+
+                // Use the kernel "max subgroup size" and "preferred work
+                // group size multiple" to get a reasonable estimate of
+                // the kernel "SIMD size".  We'll try to query both values,
+                // and if both queries are successful, we'll pick the
+                // smallest one.  Empirically, this is reasonably accurate.
+
+                // First, query the "max subgroup size":
+
+                // The query for the max subgroup size requires passing in
+                // a local work size.  We'll use the local work size provided
+                // by the app if there is one, otherwise we will query the
+                // max local work size for this kernel and use it.
+                const size_t*   queryLWS = lws;
+                cl_uint queryWorkDim = workDim;
+
+                size_t  kwgs = 0;
+                if( queryLWS == NULL )
+                {
+                    dispatch().clGetKernelWorkGroupInfo(
+                        kernel,
+                        device,
+                        CL_KERNEL_WORK_GROUP_SIZE,
+                        sizeof(kwgs),
+                        &kwgs,
+                        NULL );
+                    queryLWS = &kwgs;
+                    queryWorkDim = 1;
+                }
+
+                if( maxsgs == 0 &&
+                    deviceInfo.Supports_cl_khr_subgroups )
+                {
+                    cl_platform_id  platform = getPlatform(device);
+
+                    if( dispatchX(platform).clGetKernelSubGroupInfoKHR == NULL )
+                    {
+                        getExtensionFunctionAddress(
+                            platform,
+                            "clGetKernelSubGroupInfoKHR" );
+                    }
+
+                    auto dispatchX = this->dispatchX(platform);
+                    if( dispatchX.clGetKernelSubGroupInfoKHR )
+                    {
+                        dispatchX.clGetKernelSubGroupInfoKHR(
+                            kernel,
+                            device,
+                            CL_KERNEL_MAX_SUB_GROUP_SIZE_FOR_NDRANGE_KHR,
+                            queryWorkDim * sizeof(queryLWS[0]),
+                            queryLWS,
+                            sizeof(maxsgs),
+                            &maxsgs,
+                            NULL );
+                    }
+                }
+                if( maxsgs == 0 &&
+                    deviceInfo.NumericVersion >= CL_MAKE_VERSION_KHR(2, 1, 0) &&
+                    dispatch().clGetKernelSubGroupInfo )
+                {
+                    dispatch().clGetKernelSubGroupInfo(
+                        kernel,
+                        device,
+                        CL_KERNEL_MAX_SUB_GROUP_SIZE_FOR_NDRANGE,
+                        queryWorkDim * sizeof(queryLWS[0]),
+                        queryLWS,
+                        sizeof(maxsgs),
+                        &maxsgs,
+                        NULL );
+                }
+
+                // Next, query the "preferred work group size multiple":
+
+                dispatch().clGetKernelWorkGroupInfo(
+                    kernel,
+                    device,
+                    CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE,
+                    sizeof(pwgsm),
+                    &pwgsm,
+                    NULL );
+
+                // If either query is zero, use the other query.
+                // Otherwise, use the smallest query.
+
+                maxsgs = ( maxsgs == 0 ) ? pwgsm : maxsgs;
+                pwgsm = ( pwgsm == 0 ) ? maxsgs : pwgsm;
+                simd = ( maxsgs < pwgsm ) ? maxsgs : pwgsm;
+
+                if( simd )
+                {
+                    ss << " SIMD" << simd;
+                }
+            }
+            {
+                cl_ulong slm = 0;
+                dispatch().clGetKernelWorkGroupInfo(
+                    kernel,
+                    device,
+                    CL_KERNEL_LOCAL_MEM_SIZE,
+                    sizeof(slm),
+                    &slm,
+                    NULL );
+                if( slm )
+                {
+                    ss << " SLM=" << slm;
+                }
+            }
+            {
+                cl_ulong tpm = 0;
+                dispatch().clGetKernelWorkGroupInfo(
+                    kernel,
+                    device,
+                    CL_KERNEL_PRIVATE_MEM_SIZE,
+                    sizeof(tpm),
+                    &tpm,
+                    NULL );
+                if( tpm )
+                {
+                    ss << " TPM=" << tpm;
+                }
+            }
+            {
+                cl_ulong spill = 0;
+                dispatch().clGetKernelWorkGroupInfo(
+                    kernel,
+                    device,
+                    CL_KERNEL_SPILL_MEM_SIZE_INTEL,
+                    sizeof(spill),
+                    &spill,
+                    NULL );
+                if( spill )
+                {
+                    ss << " SPILL=" << spill;
+                }
+            }
+            node.KernelName += ss.str();
+        }
+
+        if( config().DevicePerformanceTimeGWOTracking )
+        {
+            std::ostringstream  ss;
+            ss << " GWO[ ";
+            if( gwo )
+            {
+                if( workDim >= 1 )
+                {
+                    ss << gwo[0];
+                }
+                if( workDim >= 2 )
+                {
+                    ss << ", " << gwo[1];
+                }
+                if( workDim >= 3 )
+                {
+                    ss << ", " << gwo[2];
+                }
+            }
+            else
+            {
+                ss << "NULL";
+            }
+            ss << " ]";
+            node.KernelName += ss.str();
+        }
+
+        if( config().DevicePerformanceTimeGWSTracking && gws )
+        {
+            std::ostringstream  ss;
+            ss << " GWS[ ";
+            if( workDim >= 1 )
+            {
+                ss << gws[0];
+            }
+            if( workDim >= 2 )
+            {
+                ss << " x " << gws[1];
+            }
+            if( workDim >= 3 )
+            {
+                ss << " x " << gws[2];
+            }
+            ss << " ]";
+            node.KernelName += ss.str();
+        }
+
+        if( config().DevicePerformanceTimeLWSTracking )
+        {
+            bool    useSuggestedLWS = false;
+            size_t  suggestedLWS[3] = { 0, 0, 0 };
+            size_t  emptyGWO[3] = { 0, 0, 0 };
+
+            if( lws == NULL &&
+                workDim <= 3 &&
+                config().DevicePerformanceTimeSuggestedLWSTracking )
+            {
+                cl_platform_id  platform = getPlatform(device);
+
+                // Try the cl_khr_suggested_local_work_size version first.
+                if( useSuggestedLWS == false )
+                {
+                    if( dispatchX(platform).clGetKernelSuggestedLocalWorkSizeKHR == NULL )
+                    {
+                        getExtensionFunctionAddress(
+                            platform,
+                            "clGetKernelSuggestedLocalWorkSizeKHR" );
+                    }
+
+                    auto dispatchX = this->dispatchX(platform);
+                    if( dispatchX.clGetKernelSuggestedLocalWorkSizeKHR )
+                    {
+                        cl_int testErrorCode = dispatchX.clGetKernelSuggestedLocalWorkSizeKHR(
+                            queue,
+                            kernel,
+                            workDim,
+                            gwo,
+                            gws,
+                            suggestedLWS );
+                        useSuggestedLWS = ( testErrorCode == CL_SUCCESS );
+                    }
+                }
+
+                // If this fails, try the unofficial Intel version next.
+                if( useSuggestedLWS == false )
+                {
+                    if( dispatchX(platform).clGetKernelSuggestedLocalWorkSizeINTEL == NULL )
+                    {
+                        getExtensionFunctionAddress(
+                            platform,
+                            "clGetKernelSuggestedLocalWorkSizeINTEL" );
+                    }
+
+                    auto dispatchX = this->dispatchX(platform);
+                    if( dispatchX.clGetKernelSuggestedLocalWorkSizeINTEL )
+                    {
+                        cl_int testErrorCode = dispatchX.clGetKernelSuggestedLocalWorkSizeINTEL(
+                            queue,
+                            kernel,
+                            workDim,
+                            gwo == NULL ? emptyGWO : gwo,
+                            gws,
+                            suggestedLWS );
+                        useSuggestedLWS = ( testErrorCode == CL_SUCCESS );
+                    }
+                }
+            }
+
+            std::ostringstream  ss;
+            if( useSuggestedLWS )
+            {
+                ss << " SLWS[ ";
+                lws = suggestedLWS;
+            }
+            else
+            {
+                ss << " LWS[ ";
+            }
+
+            if( lws )
+            {
+                if( workDim >= 1 )
+                {
+                    ss << lws[0];
+                }
+                if( workDim >= 2 )
+                {
+                    ss << " x " << lws[1];
+                }
+                if( workDim >= 3 )
+                {
+                    ss << " x " << lws[2];
+                }
+            }
+            else
+            {
+                ss << "NULL";
+            }
+            ss << " ]";
+            node.KernelName += ss.str();
+        }
+
+        if( !config().DevicePerformanceTimeScalarArgTracking.empty() )
+        {
+            node.KernelName += getScalarArgString(kernel);
+        }
+    }
+
+    if( m_Config.OverheadBudgetPercent )
+    {
+        addOverheadBudgetTime( overheadStart );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::checkTimingEvents()
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    const clock::time_point overheadStart =
+        m_Config.OverheadBudgetPercent ? clock::now() : clock::time_point();
+
+    CEventList::iterator    current = m_EventList.begin();
+    CEventList::iterator    next;
+
+    while( current != m_EventList.end() )
+    {
+        cl_int  errorCode = CL_SUCCESS;
+        cl_int  eventStatus = 0;
+
+        next = current;
+        ++next;
+
+        const SEventListNode& node = *current;
+
+        errorCode = dispatch().clGetEventInfo(
+            node.Event,
+            CL_EVENT_COMMAND_EXECUTION_STATUS,
+            sizeof( eventStatus ),
+            &eventStatus,
+            NULL );
+
+        switch( errorCode )
+        {
+        case CL_SUCCESS:
+            if( eventStatus == CL_COMPLETE )
+            {
+                if( config().DevicePerformanceTiming ||
+                    config().ITTPerformanceTiming ||
+                    config().ChromePerformanceTiming )
+                {
+                    cl_ulong    commandQueued = 0;
+                    cl_ulong    commandSubmit = 0;
+                    cl_ulong    commandStart = 0;
+                    cl_ulong    commandEnd = 0;
+
+                    errorCode |= dispatch().clGetEventProfilingInfo(
+                        node.Event,
+                        CL_PROFILING_COMMAND_QUEUED,
+                        sizeof( commandQueued ),
+                        &commandQueued,
+                        NULL );
+                    errorCode |= dispatch().clGetEventProfilingInfo(
+                        node.Event,
+                        CL_PROFILING_COMMAND_SUBMIT,
+                        sizeof( commandSubmit ),
+                        &commandSubmit,
+                        NULL );
+                    errorCode |= dispatch().clGetEventProfilingInfo(
+                        node.Event,
+                        CL_PROFILING_COMMAND_START,
+                        sizeof( commandStart ),
+                        &commandStart,
+                        NULL );
+                    errorCode |= dispatch().clGetEventProfilingInfo(
+                        node.Event,
+                        CL_PROFILING_COMMAND_END,
+                        sizeof( commandEnd ),
+                        &commandEnd,
+                        NULL );
+                    if( errorCode == CL_SUCCESS )
+                    {
+                        cl_ulong delta = commandEnd - commandStart;
+
+                        const std::string&  name =
+                            node.KernelName.empty() ?
+                            node.FunctionName :
+                            node.KernelName;
+
+                        SDeviceTimingStats& deviceTimingStats = m_DeviceTimingStatsMap[node.Device][name];
+
+                        deviceTimingStats.NumberOfCalls++;
+                        deviceTimingStats.TotalNS += delta;
+                        deviceTimingStats.MinNS = std::min< cl_ulong >( deviceTimingStats.MinNS, delta );
+                        deviceTimingStats.MaxNS = std::max< cl_ulong >( deviceTimingStats.MaxNS, delta );
+
+                        if( config().BottleneckAnalysis )
+                        {
+                            addBottleneckCommand(
+                                node,
+                                commandQueued,
+                                commandStart,
+                                commandEnd );
+                        }
+
+                        if( !m_KernelFootprintEnqueueMap.empty() )
+                        {
+                            CKernelFootprintEnqueueMap::iterator footprint =
+                                m_KernelFootprintEnqueueMap.find( node.EnqueueCounter );
+                            if( footprint != m_KernelFootprintEnqueueMap.end() )
+                            {
+                                SKernelFootprintStats& footprintStats =
+                                    m_KernelFootprintStatsMap[ footprint->second.first ];
+                                footprintStats.NumberOfTimedEnqueues++;
+                                footprintStats.TimedBytes += footprint->second.second;
+                                footprintStats.TimedNS += delta;
+
+                                m_KernelFootprintEnqueueMap.erase( footprint );
+                            }
+                        }
+
+                        if( config().DeviceConcurrencyAnalysis )
+                        {
+                            addConcurrencyInterval(
+                                node,
+                                commandStart,
+                                commandEnd );
+                        }
+
+                        if( config().KernelAnomalyDetection && node.Kernel )
+                        {
+                            checkKernelAnomaly( node, name, delta );
+                        }
+
+                        if( !m_RollingStatsWindows.empty() )
+                        {
+                            // Convert the device end time to host time using
+                            // the host time when the command was queued.
+                            const clock::time_point endTime =
+                                node.QueuedTime +
+                                std::chrono::nanoseconds( commandEnd - commandQueued );
+
+                            SRollingStatsWindow*    pWindow = getRollingStatsWindow( endTime );
+                            if( pWindow )
+                            {
+                                addRollingStats(
+                                    pWindow->DeviceStats[ node.Device ],
+                                    name,
+                                    delta );
+                            }
+                        }
+
+                        if( config().SubmitLatencyAnalysis )
+                        {
+                            addSubmitLatency(
+                                node,
+                                commandQueued,
+                                commandSubmit,
+                                commandStart,
+                                commandEnd );
+                        }
+
+                        if( !m_RedundantKernelEnqueueMap.empty() )
+                        {
+                            CRedundantKernelEnqueueMap::iterator redundant =
+                                m_RedundantKernelEnqueueMap.find( node.EnqueueCounter );
+                            if( redundant != m_RedundantKernelEnqueueMap.end() )
+                            {
+                                SRedundantKernelStats& redundantStats =
+                                    m_RedundantKernelStatsMap[ redundant->second ];
+                                redundantStats.NumberOfTimedEnqueues++;
+                                redundantStats.RedundantNS += delta;
+
+                                m_RedundantKernelEnqueueMap.erase( redundant );
+                            }
+                        }
+
+                        //uint64_t    numberOfCalls = deviceTimingStats.NumberOfCalls;
+
+                        if( config().DevicePerformanceTimeLogging )
+                        {
+                            cl_ulong    queuedDelta = commandSubmit - commandQueued;
+                            cl_ulong    submitDelta = commandStart - commandSubmit;
+
+                            std::ostringstream  ss;
+
+                            ss << "Device Time for "
+                                //<< "call " << numberOfCalls << " to "
+                                << name << " (enqueue " << node.EnqueueCounter << ") = "
+                                << queuedDelta << " ns (queued -> submit), "
+                                << submitDelta << " ns (submit -> start), "
+                                << delta << " ns (start -> end)\n";
+
+                            log( ss.str() );
+                        }
+
+                        if( config().DevicePerformanceTimelineLogging )
+                        {
+                            std::ostringstream  ss;
+
+                            ss << "Device Timeline for "
+                                //<< "call " << numberOfCalls << " to "
+                                << name << " (enqueue " << node.EnqueueCounter << ") = "
+                                << commandQueued << " ns (queued), "
+                                << commandSubmit << " ns (submit), "
+                                << commandStart << " ns (start), "
+                                << commandEnd << " ns (end)\n";
+
+                            log( ss.str() );
+                        }
+                    }
+                }
+
+#if defined(USE_ITT)
+                if( config().ITTPerformanceTiming )
+                {
+                    const std::string& name =
+                        node.KernelName.empty() ?
+                        node.FunctionName :
+                        node.KernelName;
+
+                    ittTraceEvent(
+                        name,
+                        node.Event,
+                        node.QueuedTime );
+                }
+#endif
+
+                if( config().ChromePerformanceTiming )
+                {
+                    const std::string& name =
+                        node.KernelName.empty() ?
+                        node.FunctionName :
+                        node.KernelName;
+
+                    chromeTraceEvent(
+                        name,
+                        node.EnqueueCounter,
+                        node.QueueNumber,
+                        node.Event,
+                        node.QueuedTime );
+                }
+
+#if defined(USE_MDAPI)
+                if( config().DevicePerfCounterEventBasedSampling )
+                {
+                    const std::string& name =
+                        node.KernelName.empty() ?
+                        node.FunctionName :
+                        node.KernelName;
+
+                    getMDAPICountersFromEvent(
+                        name,
+                        node.Event );
+                }
+#endif
+
+                dispatch().clReleaseEvent( node.Event );
+
+                retireTimingEvent( node );
+
+                m_EventList.erase( current );
+            }
+            break;
+        case CL_INVALID_EVENT:
+            {
+                // This is unexpected.  We retained the event when we
+                // added it to the list.  Remove the event from the
+                // list.
+                logf( "Unexpectedly got CL_INVALID_EVENT for an event from %s!\n",
+                    node.FunctionName.c_str() );
+
+                retireTimingEvent( node );
+
+                m_EventList.erase( current );
+            }
+            break;
+        default:
+            // nothing
+            break;
+        }
+
+        current = next;
+    }
+
+#if defined(USE_MDAPI)
+    if( config().DevicePerfCounterTimeBasedSampling )
+    {
+        getMDAPICountersFromStream();
+    }
+#endif
+
+    if( m_Config.OverheadBudgetPercent )
+    {
+        addOverheadBudgetTime( overheadStart );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::retireTimingEvent(
+    const SEventListNode& node )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    // Remove any records for this enqueue that were not consumed, for
+    // example because the profiling information could not be queried.
+
+    if( config().KernelAnomalyDetection )
+    {
+        removeKernelAnomalyInFlight( node );
+    }
+
+    if( !m_RedundantKernelEnqueueMap.empty() )
+    {
+        m_RedundantKernelEnqueueMap.erase( node.EnqueueCounter );
+    }
+
+    if( !m_KernelFootprintEnqueueMap.empty() )
+    {
+        m_KernelFootprintEnqueueMap.erase( node.EnqueueCounter );
+    }
+
+    if( config().SubmitLatencyAnalysis )
+    {
+        m_SubmitPatternMap.erase( node.EnqueueCounter );
+
+        CSubmitPendingMap::iterator pendingIter =
+            m_SubmitPendingMap.find( node.Queue );
+        if( pendingIter != m_SubmitPendingMap.end() )
+        {
+            pendingIter->second.erase( node.EnqueueCounter );
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::getPendingTimingEvents(
+    cl_command_queue queue,
+    CBlockingEventList& events )
+{
+    std::set<cl_command_queue>  queues;
+    queues.insert( queue );
+
+    getPendingTimingEvents( queues, events );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::getPendingTimingEvents(
+    cl_uint numEvents,
+    const cl_event* eventList,
+    CBlockingEventList& events )
+{
+    // The commands that may complete while waiting for a list of events are
+    // the commands in the queues of the events that are waited on.
+    std::set<cl_command_queue>  queues;
+    for( cl_uint i = 0; eventList != NULL && i < numEvents; i++ )
+    {
+        cl_command_queue    queue = NULL;
+        cl_int  errorCode = dispatch().clGetEventInfo(
+            eventList[i],
+            CL_EVENT_COMMAND_QUEUE,
+            sizeof( queue ),
+            &queue,
+            NULL );
+        if( errorCode == CL_SUCCESS && queue != NULL )
+        {
+            queues.insert( queue );
+        }
+    }
+
+    if( !queues.empty() )
+    {
+        getPendingTimingEvents( queues, events );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::getPendingTimingEvents(
+    const std::set<cl_command_queue>& queues,
+    CBlockingEventList& events )
+{
+    // Retain the events in these queues under the lock, since the event list
+    // may release them before the blocking call returns, but check whether
+    // they are still pending without the lock.
+    {
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+        CEventList::const_iterator  current = m_EventList.begin();
+        while( current != m_EventList.end() )
+        {
+            const SEventListNode& node = *current;
+
+            if( queues.find( node.Queue ) != queues.end() )
+            {
+                dispatch().clRetainEvent( node.Event );
+
+                SBlockingEvent  blockingEvent;
+                blockingEvent.Event = node.Event;
+                blockingEvent.Name =
+                    node.KernelName.empty() ?
+                    node.FunctionName :
+                    node.KernelName;
+                blockingEvent.QueuedTime = node.QueuedTime;
+                events.push_back( blockingEvent );
+            }
+
+            ++current;
+        }
+    }
+
+    size_t  numPending = 0;
+    for( size_t i = 0; i < events.size(); i++ )
+    {
+        cl_int  eventStatus = CL_COMPLETE;
+        cl_int  errorCode = dispatch().clGetEventInfo(
+            events[i].Event,
+            CL_EVENT_COMMAND_EXECUTION_STATUS,
+            sizeof( eventStatus ),
+            &eventStatus,
+            NULL );
+        if( errorCode == CL_SUCCESS && eventStatus > CL_COMPLETE )
+        {
+            events[numPending++] = events[i];
+        }
+        else
+        {
+            dispatch().clReleaseEvent( events[i].Event );
+        }
+    }
+    events.resize( numPending );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::attributeHostBlockingTime(
+    const std::string& functionName,
+    cl_event event,
+    CBlockingEventList& events,
+    clock::time_point start,
+    clock::time_point end )
+{
+    // If the blocking call itself generated an event, it is also a
+    // candidate for attribution.  It was queued by the blocking call, so
+    // the start of the blocking call is used as its queued time.
+    if( event )
+    {
+        dispatch().clRetainEvent( event );
+
+        SBlockingEvent  blockingEvent;
+        blockingEvent.Event = event;
+        blockingEvent.Name = functionName;
+        blockingEvent.QueuedTime = start;
+        events.push_back( blockingEvent );
+    }
+
+    using ns = std::chrono::nanoseconds;
+    const uint64_t  blockingNS =
+        std::chrono::duration_cast<ns>(end - start).count();
+
+    // Find the device commands that completed during the blocking call,
+    // and their start and end times.  The profiling timestamps are in the
+    // device timebase, so the blocking window is converted to the device
+    // timebase for each command using the same correlation as the Chrome
+    // trace: the host time when the command was queued corresponds to its
+    // CL_PROFILING_COMMAND_QUEUED timestamp.
+
+    std::vector<size_t>     completed;
+    std::vector<cl_ulong>   commandStart( events.size(), 0 );
+    std::vector<cl_ulong>   commandEnd( events.size(), 0 );
+    std::vector<cl_ulong>   windowStart( events.size(), 0 );
+    std::vector<cl_ulong>   windowEnd( events.size(), 0 );
+
+    for( size_t i = 0; i < events.size(); i++ )
+    {
+        cl_ulong    commandQueued = 0;
+        cl_int  eventStatus = 0;
+        cl_int  errorCode = dispatch().clGetEventInfo(
+            events[i].Event,
+            CL_EVENT_COMMAND_EXECUTION_STATUS,
+            sizeof( eventStatus ),
+            &eventStatus,
+            NULL );
+        if( errorCode == CL_SUCCESS && eventStatus == CL_COMPLETE )
+        {
+            errorCode |= dispatch().clGetEventProfilingInfo(
+                events[i].Event,
+                CL_PROFILING_COMMAND_QUEUED,
+                sizeof( commandQueued ),
+                &commandQueued,
+                NULL );
+            errorCode |= dispatch().clGetEventProfilingInfo(
+                events[i].Event,
+                CL_PROFILING_COMMAND_START,
+                sizeof( commandStart[i] ),
+                &commandStart[i],
+                NULL );
+            errorCode |= dispatch().clGetEventProfilingInfo(
+                events[i].Event,
+                CL_PROFILING_COMMAND_END,
+                sizeof( commandEnd[i] ),
+                &commandEnd[i],
+                NULL );
+            if( errorCode == CL_SUCCESS && commandEnd[i] >= commandStart[i] )
+            {
+                const int64_t   startDeltaNS =
+                    std::chrono::duration_cast<ns>(start - events[i].QueuedTime).count();
+                const int64_t   endDeltaNS =
+                    std::chrono::duration_cast<ns>(end - events[i].QueuedTime).count();
+                windowStart[i] = ( startDeltaNS > 0 ) ?
+                    commandQueued + startDeltaNS :
+                    commandQueued;
+                windowEnd[i] = ( endDeltaNS > 0 ) ?
+                    commandQueued + endDeltaNS :
+                    commandQueued;
+                completed.push_back( i );
+            }
+        }
+        dispatch().clReleaseEvent( events[i].Event );
+    }
+
+    // Attribute the blocking time proportionally to how much of each
+    // command executed during the blocking window.  If no command
+    // overlaps the window, e.g. because the commands finished before the
+    // host started to wait, fall back to the command durations.
+
+    std::vector<cl_ulong>   weight( completed.size(), 0 );
+    cl_ulong    totalWeight = 0;
+
+    for( size_t c = 0; c < completed.size(); c++ )
+    {
+        const size_t    i = completed[c];
+        const cl_ulong  overlapStart = std::max< cl_ulong >( commandStart[i], windowStart[i] );
+        const cl_ulong  overlapEnd = std::min< cl_ulong >( commandEnd[i], windowEnd[i] );
+        weight[c] = ( overlapEnd > overlapStart ) ? overlapEnd - overlapStart : 0;
+        totalWeight += weight[c];
+    }
+    if( totalWeight == 0 )
+    {
+        for( size_t c = 0; c < completed.size(); c++ )
+        {
+            const size_t    i = completed[c];
+            weight[c] = commandEnd[i] - commandStart[i];
+            totalWeight += weight[c];
+        }
+    }
+
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    SHostBlockingStats& blockingStats = m_HostBlockingStatsMap[ functionName ];
+    blockingStats.NumberOfCalls++;
+    blockingStats.TotalNS += blockingNS;
+
+    if( totalWeight == 0 )
+    {
+        blockingStats.UnattributedCalls++;
+        blockingStats.UnattributedNS += blockingNS;
+    }
+    else
+    {
+        for( size_t c = 0; c < completed.size(); c++ )
+        {
+            const std::string&  name = events[ completed[c] ].Name;
+
+            SHostBlockingAttribution& attribution = m_HostBlockingAttributionMap[ name ];
+            attribution.NumberOfCalls++;
+            attribution.AttributedNS += (uint64_t)( (double)blockingNS * weight[c] / totalWeight );
+        }
+    }
+
+    events.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CLIntercept::checkAutoOutOfOrderQueueProperties(
+    cl_command_queue_properties props ) const
+{
+    // Only in-order host queues are converted.
+    return ( props & ( CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE |
+                       CL_QUEUE_ON_DEVICE ) ) == 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CLIntercept::checkAutoOutOfOrderQueueProperties(
+    const cl_queue_properties* properties ) const
+{
+    cl_command_queue_properties props = 0;
+    if( properties )
+    {
+        for( int i = 0; properties[ i ] != 0; i += 2 )
+        {
+            if( properties[ i ] == CL_QUEUE_PROPERTIES )
+            {
+                props = (cl_command_queue_properties)properties[ i + 1 ];
+            }
+        }
+    }
+    return checkAutoOutOfOrderQueueProperties( props );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::addAutoOutOfOrderQueue(
+    cl_command_queue queue )
+{
+    // The queue may still be in-order, if the device does not support
+    // out-of-order queues.
+    cl_command_queue_properties props = 0;
+    dispatch().clGetCommandQueueInfo(
+        queue,
+        CL_QUEUE_PROPERTIES,
+        sizeof(props),
+        &props,
+        NULL );
+    if( props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE )
+    {
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+        m_AutoOutOfOrderQueueMap[ queue ];
+        m_AutoOutOfOrderStats.NumberOfQueues++;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::checkRemoveAutoOutOfOrderQueue(
+    cl_command_queue queue )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CAutoOutOfOrderQueueMap::iterator iter = m_AutoOutOfOrderQueueMap.find( queue );
+    if( iter != m_AutoOutOfOrderQueueMap.end() &&
+        getRefCount( queue ) == 1 )
+    {
+        releaseAutoOutOfOrderNodes( iter->second );
+        m_AutoOutOfOrderQueueMap.erase( iter );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::autoOutOfOrderQueueInfo(
+    cl_command_queue queue,
+    cl_command_queue_info param_name,
+    void* param_value )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    // Hide the conversion from the application.
+    if( param_name == CL_QUEUE_PROPERTIES &&
+        m_AutoOutOfOrderQueueMap.find( queue ) != m_AutoOutOfOrderQueueMap.end() )
+    {
+        cl_command_queue_properties* pProps = (cl_command_queue_properties*)param_value;
+        pProps[0] &= ~(cl_command_queue_properties)CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::autoOutOfOrderKernelExecInfo(
+    cl_kernel kernel )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    // Kernel exec info may allow the kernel to access memory that is not
+    // passed as a kernel argument, so the memory this kernel accesses is
+    // unknown.
+    m_AutoOutOfOrderIndirectKernels.insert( kernel );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::cloneKernelArgs(
+    cl_kernel sourceKernel,
+    cl_kernel clonedKernel )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CKernelArgMap::const_iterator iter = m_KernelArgMap.find( sourceKernel );
+    if( iter != m_KernelArgMap.end() )
+    {
+        m_KernelArgMap[ clonedKernel ] = iter->second;
+    }
+
+    if( m_AutoOutOfOrderIndirectKernels.find( sourceKernel ) !=
+        m_AutoOutOfOrderIndirectKernels.end() )
+    {
+        m_AutoOutOfOrderIndirectKernels.insert( clonedKernel );
+    }
+
+    CAutoOutOfOrderArgIndexMap::const_iterator unknownIter =
+        m_AutoOutOfOrderUnknownArgs.find( sourceKernel );
+    if( unknownIter != m_AutoOutOfOrderUnknownArgs.end() )
+    {
+        m_AutoOutOfOrderUnknownArgs[ clonedKernel ] = unknownIter->second;
+    }
+
+    CScalarArgMap::const_iterator scalarIter = m_ScalarArgMap.find( sourceKernel );
+    if( scalarIter != m_ScalarArgMap.end() )
+    {
+        m_ScalarArgMap[ clonedKernel ] = scalarIter->second;
+    }
+
+    CRedundantKernelArgsMap::const_iterator redundantIter =
+        m_RedundantKernelArgsMap.find( sourceKernel );
+    if( redundantIter != m_RedundantKernelArgsMap.end() )
+    {
+        m_RedundantKernelArgsMap[ clonedKernel ] = redundantIter->second;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::resolveAutoOutOfOrderResource(
+    SAutoOutOfOrderResource& resource,
+    bool& fullBarrier ) const
+{
+    // Note: This function assumes the mutex is already locked.
+
+    if( resource.Mem )
+    {
+        // Sub-buffers alias their parent buffer, so track the parent.
+        cl_mem  parent = NULL;
+        while( dispatch().clGetMemObjectInfo(
+                    resource.Mem,
+                    CL_MEM_ASSOCIATED_MEMOBJECT,
+                    sizeof(parent),
+                    &parent,
+                    NULL ) == CL_SUCCESS &&
+               parent != NULL )
+        {
+            resource.Mem = parent;
+        }
+        return;
+    }
+
+    if( resource.Begin != resource.End )
+    {
+        return;
+    }
+
+    // An empty range describes an entire SVM or USM allocation.
+    const void* ptr = resource.Begin;
+
+    CSVMAllocInfoMap::const_iterator svm = m_SVMAllocInfoMap.upper_bound( ptr );
+    if( svm != m_SVMAllocInfoMap.begin() )
+    {
+        --svm;
+        const char* begin = (const char*)svm->first;
+        if( resource.Begin >= begin && resource.Begin < begin + svm->second )
+        {
+            resource.Begin = begin;
+            resource.End = begin + svm->second;
+            return;
+        }
+    }
+
+    CUSMAllocInfoMap::const_iterator usm = m_USMAllocInfoMap.upper_bound( ptr );
+    if( usm != m_USMAllocInfoMap.begin() )
+    {
+        --usm;
+        const char* begin = (const char*)usm->first;
+        if( resource.Begin >= begin && resource.Begin < begin + usm->second )
+        {
+            resource.Begin = begin;
+            resource.End = begin + usm->second;
+            return;
+        }
+    }
+
+    fullBarrier = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+static bool AutoOutOfOrderConflict(
+    const std::vector<CLIntercept::SAutoOutOfOrderResource>& a,
+    const std::vector<CLIntercept::SAutoOutOfOrderResource>& b )
+{
+    for( size_t i = 0; i < a.size(); i++ )
+    {
+        for( size_t j = 0; j < b.size(); j++ )
+        {
+            if( a[i].Mem || b[j].Mem )
+            {
+                if( a[i].Mem == b[j].Mem )
+                {
+                    return true;
+                }
+            }
+            else if( a[i].Begin < b[j].End && b[j].Begin < a[i].End )
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::releaseAutoOutOfOrderNodes(
+    CAutoOutOfOrderNodeList& nodes )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    CAutoOutOfOrderNodeList::iterator iter = nodes.begin();
+    while( iter != nodes.end() )
+    {
+        releaseAutoOutOfOrderNode( *iter );
+        ++iter;
+    }
+    nodes.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::releaseAutoOutOfOrderNode(
+    SAutoOutOfOrderNode& node )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    dispatch().clReleaseEvent( node.Event );
+    node.Event = NULL;
+
+    if( --node.Completion->References == 0 )
+    {
+        delete node.Completion;
+    }
+    node.Completion = NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CL_CALLBACK CLIntercept::autoOutOfOrderCallback(
+    cl_event event,
+    cl_int status,
+    void* user_data )
+{
+    // This may be called from any thread, so it does not lock the mutex.
+    SAutoOutOfOrderCompletion*  pCompletion = (SAutoOutOfOrderCompletion*)user_data;
+
+    pCompletion->Complete = true;
+    if( --pCompletion->References == 0 )
+    {
+        delete pCompletion;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CLIntercept::autoOutOfOrderStart(
+    cl_command_queue queue,
+    bool blocking,
+    bool appEvent,
+    SAutoOutOfOrderCommand& command,
+    cl_uint& numEvents,
+    const cl_event*& eventList )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CAutoOutOfOrderQueueMap::iterator iter = m_AutoOutOfOrderQueueMap.find( queue );
+    if( iter == m_AutoOutOfOrderQueueMap.end() )
+    {
+        return false;
+    }
+
+    CAutoOutOfOrderNodeList&    nodes = iter->second;
+
+    command.Queue = queue;
+
+    // Kernels read and write all of their memory object, SVM, and USM
+    // arguments.
+    if( command.Kernel )
+    {
+        if( m_AutoOutOfOrderIndirectKernels.find( command.Kernel ) !=
+            m_AutoOutOfOrderIndirectKernels.end() )
+        {
+            command.FullBarrier = true;
+        }
+
+        // Kernels with memory arguments that are not tracked may access
+        // any memory.
+        CAutoOutOfOrderArgIndexMap::const_iterator unknown =
+            m_AutoOutOfOrderUnknownArgs.find( command.Kernel );
+        if( unknown != m_AutoOutOfOrderUnknownArgs.end() &&
+            !unknown->second.empty() )
+        {
+            command.FullBarrier = true;
+        }
+
+        CKernelArgMap::const_iterator args = m_KernelArgMap.find( command.Kernel );
+        if( args != m_KernelArgMap.end() )
+        {
+            CKernelArgMemMap::const_iterator arg = args->second.begin();
+            while( arg != args->second.end() )
+            {
+                cl_mem  memobj = (cl_mem)arg->second;
+                if( memobj == NULL )
+                {
+                    // NULL pointers cannot be accessed.
+                }
+                else if( m_BufferInfoMap.find( memobj ) != m_BufferInfoMap.end() ||
+                    m_ImageInfoMap.find( memobj ) != m_ImageInfoMap.end() )
+                {
+                    command.readMem( memobj );
+                }
+                else
+                {
+                    command.readPtr( arg->second, 0 );
+                }
+                ++arg;
+            }
+            command.Writes = command.Reads;
+        }
+    }
+
+    for( size_t i = 0; i < command.Reads.size(); i++ )
+    {
+        resolveAutoOutOfOrderResource( command.Reads[i], command.FullBarrier );
+    }
+    for( size_t i = 0; i < command.Writes.size(); i++ )
+    {
+        resolveAutoOutOfOrderResource( command.Writes[i], command.FullBarrier );
+    }
+
+    // Remove commands that have completed.  Completion is recorded by an
+    // event callback, so this does not need to query each event.
+    CAutoOutOfOrderNodeList::iterator node = nodes.begin();
+    while( node != nodes.end() )
+    {
+        if( node->Completion->Complete )
+        {
+            releaseAutoOutOfOrderNode( *node );
+            node = nodes.erase( node );
+        }
+        else
+        {
+            ++node;
+        }
+    }
+
+    // Blocking commands and barriers wait for all previous commands, as
+    // do markers with an event wait list (a marker with no event wait
+    // list already waits for all previous commands).  Commands that return
+    // an event to the application also wait for all previous commands,
+    // since the application may use the event to determine that all
+    // previous commands are complete, for example before using the results
+    // of a previous non-blocking read.  Other commands wait for previous
+    // commands with conflicting memory accesses.
+    const bool  waitForAll =
+        blocking ||
+        appEvent ||
+        command.FullBarrier ||
+        ( ( command.QueueBarrier || command.Marker ) && numEvents != 0 );
+
+    command.WaitList.assign( eventList, eventList + ( eventList ? numEvents : 0 ) );
+
+    size_t  numDependencies = 0;
+    bool    dependsOnPrevious = false;
+    node = nodes.begin();
+    while( node != nodes.end() )
+    {
+        if( waitForAll ||
+            node->FullBarrier ||
+            AutoOutOfOrderConflict( command.Writes, node->Reads ) ||
+            AutoOutOfOrderConflict( command.Writes, node->Writes ) ||
+            AutoOutOfOrderConflict( command.Reads, node->Writes ) )
+        {
+            command.WaitList.push_back( node->Event );
+            numDependencies++;
+            dependsOnPrevious = true;
+        }
+        else
+        {
+            dependsOnPrevious = false;
+        }
+        ++node;
+    }
+
+    if( !command.QueueBarrier && !command.Marker )
+    {
+        m_AutoOutOfOrderStats.NumberOfCommands++;
+        m_AutoOutOfOrderStats.DependenciesAdded += numDependencies;
+        m_AutoOutOfOrderStats.IndependentInFlight += nodes.size() - numDependencies;
+        if( !nodes.empty() && !dependsOnPrevious )
+        {
+            m_AutoOutOfOrderStats.IndependentCommands++;
+        }
+        if( command.FullBarrier )
+        {
+            m_AutoOutOfOrderStats.FullBarrierCommands++;
+        }
+        if( blocking )
+        {
+            m_AutoOutOfOrderStats.BlockingCommands++;
+        }
+        else if( appEvent && !command.FullBarrier )
+        {
+            m_AutoOutOfOrderStats.EventCommands++;
+        }
+    }
+
+    if( numDependencies )
+    {
+        numEvents = (cl_uint)command.WaitList.size();
+        eventList = command.WaitList.data();
+    }
+
+    // For blocking commands, all previous commands will be complete once
+    // the command is complete, so there is nothing to track afterwards.
+    if( blocking )
+    {
+        command.QueueBarrier = true;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::autoOutOfOrderEnd(
+    const SAutoOutOfOrderCommand& command,
+    bool success,
+    cl_event event,
+    bool ownEvent )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CAutoOutOfOrderQueueMap::iterator iter = m_AutoOutOfOrderQueueMap.find( command.Queue );
+    if( !success || event == NULL || iter == m_AutoOutOfOrderQueueMap.end() ||
+        command.Marker )
+    {
+        if( ownEvent && event )
+        {
+            dispatch().clReleaseEvent( event );
+        }
+        return;
+    }
+
+    CAutoOutOfOrderNodeList&    nodes = iter->second;
+
+    // Commands enqueued after a barrier implicitly wait for the barrier,
+    // and commands enqueued after a full barrier explicitly wait for it,
+    // so the commands before either no longer need to be tracked.
+    if( command.QueueBarrier || command.FullBarrier )
+    {
+        releaseAutoOutOfOrderNodes( nodes );
+    }
+
+    if( command.QueueBarrier )
+    {
+        if( ownEvent )
+        {
+            dispatch().clReleaseEvent( event );
+        }
+        return;
+    }
+
+    if( !ownEvent )
+    {
+        dispatch().clRetainEvent( event );
+    }
+
+    nodes.emplace_back();
+
+    SAutoOutOfOrderNode&    node = nodes.back();
+    node.Event = event;
+    node.FullBarrier = command.FullBarrier;
+    node.Completion = new SAutoOutOfOrderCompletion();
+    node.Reads = command.Reads;
+    node.Writes = command.Writes;
+
+    // If the callback cannot be set then the node is only removed by a
+    // barrier or a synchronizing command, which is conservative.
+    if( dispatch().clSetEventCallback == NULL ||
+        dispatch().clSetEventCallback(
+            event,
+            CL_COMPLETE,
+            autoOutOfOrderCallback,
+            node.Completion ) != CL_SUCCESS )
+    {
+        node.Completion->References = 1;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::autoOutOfOrderQueueSync(
+    cl_command_queue queue )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    // After clFinish all previous commands are complete, and after
+    // clEnqueueBarrier all subsequent commands implicitly wait for all
+    // previous commands.
+    CAutoOutOfOrderQueueMap::iterator iter = m_AutoOutOfOrderQueueMap.find( queue );
+    if( iter != m_AutoOutOfOrderQueueMap.end() )
+    {
+        releaseAutoOutOfOrderNodes( iter->second );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CL_CALLBACK CLIntercept::coalescedWritesCallback(
+    cl_event event,
+    cl_int status,
+    void* user_data )
+{
+    // The staging data for a combined transfer may be freed once the
+    // transfer is complete.
+    std::vector<char>*  pData = (std::vector<char>*)user_data;
+    delete pData;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+cl_int CLIntercept::flushCoalescedWrites(
+    cl_command_queue queue,
+    SCoalescedWrites& writes,
+    cl_event* event )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    if( writes.Buffer == NULL )
+    {
+        return CL_SUCCESS;
+    }
+
+    std::vector<char>*  pData = new std::vector<char>();
+    pData->swap( writes.Data );
+
+    const size_t    size = pData->size();
+
+    cl_event    transferEvent = NULL;
+    cl_int  errorCode = dispatch().clEnqueueWriteBuffer(
+        queue,
+        writes.Buffer,
+        CL_FALSE,
+        writes.Offset,
+        size,
+        pData->data(),
+        0,
+        NULL,
+        &transferEvent );
+    if( errorCode == CL_SUCCESS )
+    {
+        if( dispatch().clSetEventCallback(
+                transferEvent,
+                CL_COMPLETE,
+                coalescedWritesCallback,
+                pData ) != CL_SUCCESS )
+        {
+            dispatch().clWaitForEvents( 1, &transferEvent );
+            delete pData;
+        }
+
+        if( event )
+        {
+            event[0] = transferEvent;
+        }
+        else
+        {
+            dispatch().clReleaseEvent( transferEvent );
+        }
+
+        m_CoalescedWriteStats.NumberOfTransfers++;
+        m_CoalescedWriteStats.TotalBytes += size;
+    }
+    else
+    {
+        logf( "Combined write of %u buffer writes to buffer %p returned %s (%d)!\n",
+            (unsigned int)writes.NumberOfWrites,
+            writes.Buffer,
+            enumName().name( errorCode ).c_str(),
+            errorCode );
+        m_CoalescedWriteStats.NumberOfErrors++;
+        delete pData;
+    }
+
+    writes.Buffer = NULL;
+    writes.Offset = 0;
+    writes.NumberOfWrites = 0;
+
+    return errorCode;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+cl_int CLIntercept::coalesceWriteBuffer(
+    cl_command_queue queue,
+    cl_mem buffer,
+    cl_bool blocking_write,
+    size_t offset,
+    size_t cb,
+    const void* ptr,
+    cl_uint num_events_in_wait_list,
+    cl_event* event )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CCoalescedWritesMap::iterator iter = m_CoalescedWritesMap.find( queue );
+    if( iter == m_CoalescedWritesMap.end() )
+    {
+        cl_command_queue_properties props = 0;
+        dispatch().clGetCommandQueueInfo(
+            queue,
+            CL_QUEUE_PROPERTIES,
+            sizeof(props),
+            &props,
+            NULL );
+
+        SCoalescedWrites&   writes = m_CoalescedWritesMap[ queue ];
+        writes.InOrder = ( props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE ) == 0;
+
+        iter = m_CoalescedWritesMap.find( queue );
+    }
+
+    SCoalescedWrites&   writes = iter->second;
+
+    // Only small non-blocking writes with no event dependencies to buffers
+    // with a known size are combined.  Writes to out-of-order queues could
+    // also be combined, but may overlap with other commands.
+    CBufferInfoMap::const_iterator  bufferInfo = m_BufferInfoMap.find( buffer );
+    const bool  eligible =
+        writes.InOrder &&
+        blocking_write == CL_FALSE &&
+        num_events_in_wait_list == 0 &&
+        ptr != NULL &&
+        cb != 0 &&
+        cb <= config().CoalesceBufferWritesMaxSize &&
+        bufferInfo != m_BufferInfoMap.end() &&
+        offset <= bufferInfo->second &&
+        cb <= bufferInfo->second - offset;
+
+    const bool  adjacent =
+        eligible &&
+        writes.Buffer == buffer &&
+        writes.Offset + writes.Data.size() == offset &&
+        writes.Data.size() + cb <= config().CoalesceBufferWritesMaxBatchSize;
+
+    if( !adjacent )
+    {
+        flushCoalescedWrites( queue, writes, NULL );
+    }
+
+    // If the application requested an event, then the pending writes must
+    // be issued now, so a write that would start a new combined transfer is
+    // issued normally instead.
+    if( !eligible || ( event != NULL && writes.Buffer == NULL ) )
+    {
+        return CL_INVALID_OPERATION;
+    }
+
+    if( writes.Buffer == NULL )
+    {
+        writes.Buffer = buffer;
+        writes.Offset = offset;
+    }
+
+    const char* data = (const char*)ptr;
+    writes.Data.insert( writes.Data.end(), data, data + cb );
+    writes.NumberOfWrites++;
+
+    m_CoalescedWriteStats.NumberOfWrites++;
+
+    if( event )
+    {
+        return flushCoalescedWrites( queue, writes, event );
+    }
+
+    return CL_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::flushCoalescedBufferWrites(
+    cl_command_queue queue,
+    cl_mem memobj )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    if( queue )
+    {
+        CCoalescedWritesMap::iterator iter = m_CoalescedWritesMap.find( queue );
+        if( iter != m_CoalescedWritesMap.end() )
+        {
+            flushCoalescedWrites( queue, iter->second, NULL );
+        }
+    }
+    else
+    {
+        CCoalescedWritesMap::iterator iter = m_CoalescedWritesMap.begin();
+        while( iter != m_CoalescedWritesMap.end() )
+        {
+            if( memobj == NULL || iter->second.Buffer == memobj )
+            {
+                flushCoalescedWrites( iter->first, iter->second, NULL );
+            }
+            ++iter;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::checkRemoveCoalescedBufferWrites(
+    cl_command_queue queue )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CCoalescedWritesMap::iterator iter = m_CoalescedWritesMap.find( queue );
+    if( iter != m_CoalescedWritesMap.end() )
+    {
+        flushCoalescedWrites( queue, iter->second, NULL );
+        if( getRefCount( queue ) == 1 )
+        {
+            m_CoalescedWritesMap.erase( iter );
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+CLIntercept::SPinnedStagingPool* CLIntercept::getPinnedStagingPool(
+    cl_command_queue queue,
+    const void* ptr,
+    size_t cb )
+{
+    if( ptr == NULL || cb < config().PinnedStagingMinSize )
+    {
+        return NULL;
+    }
+
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    // Pointers to SVM or USM allocations do not need to be staged.
+    CSVMAllocInfoMap::const_iterator svm = m_SVMAllocInfoMap.upper_bound( ptr );
+    if( svm != m_SVMAllocInfoMap.begin() )
+    {
+        --svm;
+        if( (const char*)ptr < (const char*)svm->first + svm->second )
+        {
+            return NULL;
+        }
+    }
+    CUSMAllocInfoMap::const_iterator usm = m_USMAllocInfoMap.upper_bound( ptr );
+    if( usm != m_USMAllocInfoMap.begin() )
+    {
+        --usm;
+        if( (const char*)ptr < (const char*)usm->first + usm->second )
+        {
+            return NULL;
+        }
+    }
+
+    CPinnedStagingPoolMap::iterator iter = m_PinnedStagingPoolMap.find( queue );
+    if( iter == m_PinnedStagingPoolMap.end() )
+    {
+        // Chunks are only ordered with respect to each other on in-order
+        // queues.
+        cl_command_queue_properties props = 0;
+        dispatch().clGetCommandQueueInfo(
+            queue,
+            CL_QUEUE_PROPERTIES,
+            sizeof(props),
+            &props,
+            NULL );
+
+        SPinnedStagingPool* pPool = new SPinnedStagingPool();
+        pPool->Failed = ( props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE ) != 0;
+
+        iter = m_PinnedStagingPoolMap.insert(
+            CPinnedStagingPoolMap::value_type( queue, pPool ) ).first;
+    }
+
+    SPinnedStagingPool* pPool = iter->second;
+    if( pPool->Failed )
+    {
+        return NULL;
+    }
+
+    return pPool;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CLIntercept::initPinnedStagingPool(
+    cl_command_queue queue,
+    SPinnedStagingPool& pool )
+{
+    // Note: This function assumes the pool mutex is already locked.
+
+    if( pool.Initialized )
+    {
+        return !pool.Failed;
+    }
+
+    pool.Initialized = true;
+    pool.ChunkSize = std::max< size_t >( config().PinnedStagingChunkSize, 4096 );
+
+    cl_context  context = NULL;
+    dispatch().clGetCommandQueueInfo(
+        queue,
+        CL_QUEUE_CONTEXT,
+        sizeof(context),
+        &context,
+        NULL );
+
+    const cl_uint   numSlots = std::max< cl_uint >( config().PinnedStagingBufferCount, 1 );
+    for( cl_uint i = 0; i < numSlots; i++ )
+    {
+        cl_int  errorCode = CL_SUCCESS;
+
+        SPinnedStagingSlot  slot;
+        slot.Event = NULL;
+        slot.Pointer = NULL;
+        slot.Buffer = dispatch().clCreateBuffer(
+            context,
+            CL_MEM_ALLOC_HOST_PTR,
+            pool.ChunkSize,
+            NULL,
+            &errorCode );
+        if( errorCode == CL_SUCCESS )
+        {
+            slot.Pointer = dispatch().clEnqueueMapBuffer(
+                queue,
+                slot.Buffer,
+                CL_TRUE,
+                CL_MAP_READ | CL_MAP_WRITE,
+                0,
+                pool.ChunkSize,
+                0,
+                NULL,
+                NULL,
+                &errorCode );
+            if( errorCode != CL_SUCCESS )
+            {
+                dispatch().clReleaseMemObject( slot.Buffer );
+            }
+        }
+        if( errorCode != CL_SUCCESS )
+        {
+            logf( "Couldn't create pinned staging buffer for queue %p: %s (%d)!\n",
+                queue,
+                enumName().name( errorCode ).c_str(),
+                errorCode );
+            break;
+        }
+
+        pool.Slots.push_back( slot );
+    }
+
+    pool.Failed = pool.Slots.empty();
+    return !pool.Failed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::addPinnedStagingTransfer(
+    const std::string& functionName,
+    bool staged,
+    bool timed,
+    size_t cb,
+    clock::time_point start )
+{
+    clock::time_point   end = clock::now();
+
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    SPinnedStagingStats& stats =
+        m_PinnedStagingStatsMap[ functionName + ( staged ? " (Staged)" : " (Direct)" ) ];
+
+    stats.NumberOfCalls++;
+    stats.TotalBytes += cb;
+    if( timed )
+    {
+        stats.TimedBytes += cb;
+        stats.TimedNS += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+static void CopyMemoryRange(
+    char* dst,
+    const char* src,
+    size_t size )
+{
+    CLI_MEMCPY( dst, size, src, size );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::copyPinnedStagingChunk(
+    void* dst,
+    const void* src,
+    size_t size ) const
+{
+    // A single thread usually can't saturate the host memory bandwidth, so
+    // large chunks are split between the calling thread and additional
+    // threads.  Each thread copies at least 1MB, so small chunks are only
+    // copied by the calling thread.
+    const size_t    cMinCopySize = 1024 * 1024;
+    const size_t    numThreads = std::min< size_t >(
+        config().PinnedStagingCopyThreads,
+        size / cMinCopySize );
+    if( numThreads <= 1 )
+    {
+        CopyMemoryRange( (char*)dst, (const char*)src, size );
+        return;
+    }
+
+    const size_t    partSize = ( size + numThreads - 1 ) / numThreads;
+
+    std::vector<std::thread>    threads;
+    threads.reserve( numThreads - 1 );
+    for( size_t t = 1; t < numThreads; t++ )
+    {
+        const size_t    partOffset = t * partSize;
+        threads.push_back( std::thread(
+            CopyMemoryRange,
+            (char*)dst + partOffset,
+            (const char*)src + partOffset,
+            std::min( partSize, size - partOffset ) ) );
+    }
+
+    CopyMemoryRange( (char*)dst, (const char*)src, partSize );
+
+    for( size_t t = 0; t < threads.size(); t++ )
+    {
+        threads[t].join();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CLIntercept::stagedReadBuffer(
+    cl_command_queue queue,
+    cl_mem buffer,
+    cl_bool blocking_read,
+    size_t offset,
+    size_t cb,
+    void* ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list,
+    cl_event* event,
+    cl_int& errorCode )
+{
+    // The data is copied from the staging buffers after each chunk is
+    // read, so only blocking reads are staged.
+    SPinnedStagingPool* pPool =
+        blocking_read ? getPinnedStagingPool( queue, ptr, cb ) : NULL;
+    if( pPool == NULL )
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(pPool->Mutex);
+
+    clock::time_point   start = clock::now();
+
+    const uint64_t  interval = config().PinnedStagingCompareInterval;
+    if( ( interval != 0 && ++pPool->NumberOfTransfers % interval == 0 ) ||
+        !initPinnedStagingPool( queue, *pPool ) )
+    {
+        errorCode = dispatch().clEnqueueReadBuffer(
+            queue,
+            buffer,
+            blocking_read,
+            offset,
+            cb,
+            ptr,
+            num_events_in_wait_list,
+            event_wait_list,
+            event );
+        if( errorCode == CL_SUCCESS )
+        {
+            addPinnedStagingTransfer( "clEnqueueReadBuffer", false, true, cb, start );
+        }
+        return true;
+    }
+
+    std::vector<SPinnedStagingSlot>&    slots = pPool->Slots;
+    const size_t    chunkSize = pPool->ChunkSize;
+    const size_t    numChunks = ( cb + chunkSize - 1 ) / chunkSize;
+
+    // If a chunk fails, the error is returned to the application rather
+    // than retrying the entire read, since some chunks may already have
+    // been read.
+    errorCode = CL_SUCCESS;
+
+    // Keep a read in flight for each staging buffer, and copy each chunk
+    // to the destination as soon as it has been read.
+    size_t  numEnqueued = 0;
+    for( size_t chunk = 0; chunk < numChunks && errorCode == CL_SUCCESS; chunk++ )
+    {
+        while( numEnqueued < numChunks &&
+               numEnqueued < chunk + slots.size() &&
+               errorCode == CL_SUCCESS )
+        {
+            SPinnedStagingSlot& slot = slots[ numEnqueued % slots.size() ];
+            if( slot.Event )
+            {
+                dispatch().clWaitForEvents( 1, &slot.Event );
+                dispatch().clReleaseEvent( slot.Event );
+                slot.Event = NULL;
+            }
+
+            const size_t    chunkOffset = numEnqueued * chunkSize;
+            errorCode = dispatch().clEnqueueReadBuffer(
+                queue,
+                buffer,
+                CL_FALSE,
+                offset + chunkOffset,
+                std::min( chunkSize, cb - chunkOffset ),
+                slot.Pointer,
+                numEnqueued == 0 ? num_events_in_wait_list : 0,
+                numEnqueued == 0 ? event_wait_list : NULL,
+                &slot.Event );
+            if( errorCode != CL_SUCCESS )
+            {
+                slot.Event = NULL;
+            }
+            else
+            {
+                numEnqueued++;
+            }
+        }
+        if( errorCode != CL_SUCCESS )
+        {
+            break;
+        }
+
+        SPinnedStagingSlot& slot = slots[ chunk % slots.size() ];
+        errorCode = dispatch().clWaitForEvents( 1, &slot.Event );
+        if( errorCode == CL_SUCCESS )
+        {
+            const size_t    chunkOffset = chunk * chunkSize;
+            copyPinnedStagingChunk(
+                (char*)ptr + chunkOffset,
+                slot.Pointer,
+                std::min( chunkSize, cb - chunkOffset ) );
+        }
+
+        if( event && chunk == numChunks - 1 )
+        {
+            event[0] = slot.Event;
+        }
+        else
+        {
+            dispatch().clReleaseEvent( slot.Event );
+        }
+        slot.Event = NULL;
+    }
+
+    if( errorCode == CL_SUCCESS )
+    {
+        addPinnedStagingTransfer( "clEnqueueReadBuffer", true, true, cb, start );
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CLIntercept::stagedWriteBuffer(
+    cl_command_queue queue,
+    cl_mem buffer,
+    cl_bool blocking_write,
+    size_t offset,
+    size_t cb,
+    const void* ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list,
+    cl_event* event,
+    cl_int& errorCode )
+{
+    SPinnedStagingPool* pPool = getPinnedStagingPool( queue, ptr, cb );
+    if( pPool == NULL )
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(pPool->Mutex);
+
+    clock::time_point   start = clock::now();
+
+    const uint64_t  interval = config().PinnedStagingCompareInterval;
+    if( ( blocking_write && interval != 0 && ++pPool->NumberOfTransfers % interval == 0 ) ||
+        !initPinnedStagingPool( queue, *pPool ) )
+    {
+        errorCode = dispatch().clEnqueueWriteBuffer(
+            queue,
+            buffer,
+            blocking_write,
+            offset,
+            cb,
+            ptr,
+            num_events_in_wait_list,
+            event_wait_list,
+            event );
+        if( errorCode == CL_SUCCESS )
+        {
+            addPinnedStagingTransfer( "clEnqueueWriteBuffer", false, blocking_write != CL_FALSE, cb, start );
+        }
+        return true;
+    }
+
+    std::vector<SPinnedStagingSlot>&    slots = pPool->Slots;
+    const size_t    chunkSize = pPool->ChunkSize;
+
+    // If a chunk fails, the error is returned to the application rather
+    // than retrying the entire write, since some chunks may already have
+    // been written.
+    errorCode = CL_SUCCESS;
+    cl_event    lastEvent = NULL;
+
+    // Copy each chunk into the next free staging buffer while the previous
+    // chunks are being transferred.  The application's data has been fully
+    // copied when this function returns, so the staging buffers are only
+    // waited for when they are reused.
+    size_t  chunk = 0;
+    for( size_t chunkOffset = 0; chunkOffset < cb; chunkOffset += chunkSize, chunk++ )
+    {
+        SPinnedStagingSlot& slot = slots[ chunk % slots.size() ];
+        if( slot.Event )
+        {
+            dispatch().clWaitForEvents( 1, &slot.Event );
+            dispatch().clReleaseEvent( slot.Event );
+            slot.Event = NULL;
+        }
+
+        const size_t    size = std::min( chunkSize, cb - chunkOffset );
+        copyPinnedStagingChunk(
+            slot.Pointer,
+            (const char*)ptr + chunkOffset,
+            size );
+
+        errorCode = dispatch().clEnqueueWriteBuffer(
+            queue,
+            buffer,
+            CL_FALSE,
+            offset + chunkOffset,
+            size,
+            slot.Pointer,
+            chunk == 0 ? num_events_in_wait_list : 0,
+            chunk == 0 ? event_wait_list : NULL,
+            &slot.Event );
+        if( errorCode != CL_SUCCESS )
+        {
+            slot.Event = NULL;
+            break;
+        }
+
+        lastEvent = slot.Event;
+    }
+
+    if( errorCode == CL_SUCCESS )
+    {
+        // Chunks complete in order on an in-order queue, so the last
+        // chunk's event describes the entire write.
+        if( blocking_write )
+        {
+            errorCode = dispatch().clWaitForEvents( 1, &lastEvent );
+        }
+        if( event )
+        {
+            dispatch().clRetainEvent( lastEvent );
+            event[0] = lastEvent;
+        }
+        addPinnedStagingTransfer( "clEnqueueWriteBuffer", true, blocking_write != CL_FALSE, cb, start );
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::checkRemovePinnedStagingPool(
+    cl_command_queue queue )
+{
+    SPinnedStagingPool* pPool = NULL;
+    {
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+        CPinnedStagingPoolMap::iterator iter = m_PinnedStagingPoolMap.find( queue );
+        if( iter != m_PinnedStagingPoolMap.end() &&
+            getRefCount( queue ) == 1 )
+        {
+            pPool = iter->second;
+            m_PinnedStagingPoolMap.erase( iter );
+        }
+    }
+
+    if( pPool )
+    {
+        {
+            std::lock_guard<std::mutex> lock(pPool->Mutex);
+
+            for( size_t i = 0; i < pPool->Slots.size(); i++ )
+            {
+                SPinnedStagingSlot& slot = pPool->Slots[i];
+                if( slot.Event )
+                {
+                    dispatch().clReleaseEvent( slot.Event );
+                }
+                dispatch().clEnqueueUnmapMemObject(
+                    queue,
+                    slot.Buffer,
+                    slot.Pointer,
+                    0,
+                    NULL,
+                    NULL );
+            }
+            if( !pPool->Slots.empty() )
+            {
+                dispatch().clFinish( queue );
+            }
+            for( size_t i = 0; i < pPool->Slots.size(); i++ )
+            {
+                dispatch().clReleaseMemObject( pPool->Slots[i].Buffer );
+            }
+        }
+        delete pPool;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::initializeBufferContents(
+    cl_mem buffer,
+    size_t size )
+{
+    cl_context  context = NULL;
+    dispatch().clGetMemObjectInfo(
+        buffer,
+        CL_MEM_CONTEXT,
+        sizeof(context),
+        &context,
+        NULL );
+
+    cl_command_queue    queue = NULL;
+    {
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+        CInitializeBuffersQueueMap::iterator iter =
+            m_InitializeBuffersQueueMap.find( context );
+        if( iter != m_InitializeBuffersQueueMap.end() )
+        {
+            queue = iter->second;
+        }
+        else
+        {
+            // The context may have multiple devices, so query the size of
+            // the device list first.  The queue is created on the first
+            // device in the context.
+            size_t  numDevices = 0;
+            cl_int  errorCode = dispatch().clGetContextInfo(
+                context,
+                CL_CONTEXT_DEVICES,
+                0,
+                NULL,
+                &numDevices );
+            numDevices /= sizeof(cl_device_id);
+
+            std::vector<cl_device_id>   devices( numDevices );
+            if( errorCode == CL_SUCCESS && numDevices == 0 )
+            {
+                errorCode = CL_INVALID_CONTEXT;
+            }
+            if( errorCode == CL_SUCCESS )
+            {
+                errorCode = dispatch().clGetContextInfo(
+                    context,
+                    CL_CONTEXT_DEVICES,
+                    numDevices * sizeof(cl_device_id),
+                    devices.data(),
+                    NULL );
+            }
+            if( errorCode == CL_SUCCESS )
+            {
+                queue = dispatch().clCreateCommandQueue(
+                    context,
+                    devices[0],
+                    0,
+                    &errorCode );
+            }
+
+            // Failures are not cached, so the queue will be created again
+            // for the next buffer.
+            if( errorCode != CL_SUCCESS || queue == NULL )
+            {
+                logf( "Couldn't create a queue to initialize buffers for context %p: %s (%d)!\n",
+                    context,
+                    enumName().name( errorCode ).c_str(),
+                    errorCode );
+                queue = NULL;
+            }
+            else
+            {
+                m_InitializeBuffersQueueMap[ context ] = queue;
+            }
+        }
+
+        // The queue may be released from the map by another thread while
+        // it is in use, so retain it until the buffer is initialized.
+        if( queue )
+        {
+            dispatch().clRetainCommandQueue( queue );
+        }
+    }
+
+    if( queue == NULL )
+    {
+        return;
+    }
+
+    cl_int  errorCode = CL_INVALID_OPERATION;
+
+    if( dispatch().clEnqueueFillBuffer )
+    {
+        const cl_uchar  zero = 0;
+        errorCode = dispatch().clEnqueueFillBuffer(
+            queue,
+            buffer,
+            &zero,
+            sizeof(zero),
+            0,
+            size,
+            0,
+            NULL,
+            NULL );
+    }
+
+    if( errorCode != CL_SUCCESS )
+    {
+        // The zero block is only read, so it may be used by multiple writes
+        // at the same time.
+        const size_t    blockSize = 1024 * 1024;
+        const char* zeroBlock = NULL;
+        {
+            CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+            if( m_InitializeBuffersZeroBlock == NULL )
+            {
+                char*   ptr = (char*)allocateHostMemory( blockSize );
+                if( ptr )
+                {
+                    memset( ptr, 0, blockSize );
+                    m_InitializeBuffersZeroBlock = ptr;
+                }
+            }
+            zeroBlock = m_InitializeBuffersZeroBlock;
+        }
+
+        errorCode = zeroBlock ? CL_SUCCESS : CL_OUT_OF_HOST_MEMORY;
+        for( size_t offset = 0;
+             offset < size && errorCode == CL_SUCCESS;
+             offset += blockSize )
+        {
+            errorCode = dispatch().clEnqueueWriteBuffer(
+                queue,
+                buffer,
+                CL_FALSE,
+                offset,
+                std::min( blockSize, size - offset ),
+                zeroBlock,
+                0,
+                NULL,
+                NULL );
+        }
+    }
+
+    // The buffer must be initialized before the application can use it on
+    // another queue.
+    dispatch().clFinish( queue );
+    dispatch().clReleaseCommandQueue( queue );
+
+    if( errorCode != CL_SUCCESS )
+    {
+        logf( "Couldn't initialize buffer %p: %s (%d)!\n",
+            buffer,
+            enumName().name( errorCode ).c_str(),
+            errorCode );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::releaseInitializeBuffersQueue(
+    cl_context context )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    // The internal queue holds a reference to the context, so it is
+    // released whenever the application releases the context or queries
+    // the context reference count.  It will be created again if the
+    // context is still valid and another buffer is created.
+    CInitializeBuffersQueueMap::iterator iter =
+        m_InitializeBuffersQueueMap.find( context );
+    if( iter != m_InitializeBuffersQueueMap.end() )
+    {
+        if( iter->second )
+        {
+            dispatch().clReleaseCommandQueue( iter->second );
+        }
+        m_InitializeBuffersQueueMap.erase( iter );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::zeroCopyCheckBuffer(
+    cl_mem buffer,
+    cl_mem_flags flags,
+    size_t size,
+    const void* host_ptr )
+{
+    // The required alignment is the largest base address alignment of the
+    // devices in the buffer's context.
+    size_t  alignment = 1;
+
+    cl_context  context = NULL;
+    dispatch().clGetMemObjectInfo(
+        buffer,
+        CL_MEM_CONTEXT,
+        sizeof(context),
+        &context,
+        NULL );
+
+    size_t  numDevices = 0;
+    if( context )
+    {
+        dispatch().clGetContextInfo(
+            context,
+            CL_CONTEXT_DEVICES,
+            0,
+            NULL,
+            &numDevices );
+        numDevices /= sizeof(cl_device_id);
+    }
+
+    std::vector<cl_device_id>   devices( numDevices );
+    if( numDevices &&
+        dispatch().clGetContextInfo(
+            context,
+            CL_CONTEXT_DEVICES,
+            numDevices * sizeof(cl_device_id),
+            devices.data(),
+            NULL ) != CL_SUCCESS )
+    {
+        devices.clear();
+    }
+
+#if defined(_WIN32)
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo( &systemInfo );
+    const uintptr_t pageSize = systemInfo.dwPageSize;
+#else
+    const uintptr_t pageSize = (uintptr_t)sysconf( _SC_PAGESIZE );
+#endif
+
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    for( size_t d = 0; d < devices.size(); d++ )
+    {
+        cacheDeviceInfo( devices[d] );
+        alignment = std::max< size_t >(
+            alignment,
+            m_DeviceInfoMap[ devices[d] ].MemBaseAddrAlign );
+    }
+
+    // These are the typical requirements for zero-copy buffers: either
+    // the implementation allocates the host memory, or the application
+    // provides page aligned host memory with a size that is a multiple of
+    // the device base address alignment.
+    SZeroCopyBufferInfo&    info = m_ZeroCopyBufferInfoMap[ buffer ];
+    info = SZeroCopyBufferInfo();
+
+    // Use the same numbering as the other memory object reports.
+    CMemAllocNumberMap::const_iterator number = m_MemAllocNumberMap.find( buffer );
+    if( number == m_MemAllocNumberMap.end() )
+    {
+        m_MemAllocNumberMap[ buffer ] = m_MemAllocNumber;
+        number = m_MemAllocNumberMap.find( buffer );
+        m_MemAllocNumber++;
+    }
+
+    info.Number = number->second;
+    info.Flags = flags;
+    info.Size = size;
+    info.Alignment = alignment;
+
+    if( ( flags & CL_MEM_USE_HOST_PTR ) && host_ptr )
+    {
+        info.HostPtrNotPageAligned = ( (uintptr_t)host_ptr % pageSize ) != 0;
+        info.HostPtrNotBaseAddrAligned = ( (uintptr_t)host_ptr % alignment ) != 0;
+        info.SizeNotBaseAddrMultiple = ( size % alignment ) != 0;
+        info.Eligible =
+            !info.HostPtrNotPageAligned &&
+            !info.SizeNotBaseAddrMultiple;
+    }
+    else
+    {
+        info.Eligible = ( flags & CL_MEM_ALLOC_HOST_PTR ) != 0;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::zeroCopyCheckTransfer(
+    cl_mem buffer,
+    const void* ptr,
+    size_t size,
+    bool read )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CZeroCopyBufferInfoMap::iterator iter = m_ZeroCopyBufferInfoMap.find( buffer );
+    if( iter != m_ZeroCopyBufferInfoMap.end() )
+    {
+        SZeroCopyBufferInfo&    info = iter->second;
+        if( read )
+        {
+            info.NumberOfReads++;
+            info.BytesRead += size;
+        }
+        else
+        {
+            info.NumberOfWrites++;
+            info.BytesWritten += size;
+        }
+        if( (uintptr_t)ptr % info.Alignment != 0 )
+        {
+            info.UnalignedTransfers++;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::zeroCopyCheckMap(
+    cl_mem buffer,
+    size_t size )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CZeroCopyBufferInfoMap::iterator iter = m_ZeroCopyBufferInfoMap.find( buffer );
+    if( iter != m_ZeroCopyBufferInfoMap.end() )
+    {
+        SZeroCopyBufferInfo&    info = iter->second;
+        info.NumberOfMaps++;
+        info.BytesMapped += size;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CLIntercept::zeroCopyAvoidableBytesGreater(
+    const SZeroCopyBufferInfo& a,
+    const SZeroCopyBufferInfo& b )
+{
+    return a.getAvoidableBytes() > b.getAvoidableBytes();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::checkRemoveZeroCopyBuffer(
+    cl_mem memobj )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CZeroCopyBufferInfoMap::iterator iter = m_ZeroCopyBufferInfoMap.find( memobj );
+    if( iter != m_ZeroCopyBufferInfoMap.end() &&
+        getRefCount( memobj ) == 1 )
+    {
+        if( iter->second.getAvoidableBytes() != 0 )
+        {
+            m_ZeroCopyRetiredBuffers.push_back( iter->second );
+
+            // Only the buffers with the most avoidable copies are
+            // reported, so periodically discard the others.
+            const size_t    cMaxRetiredBuffers = 1024;
+            const size_t    cReportedBuffers = 32;
+            if( m_ZeroCopyRetiredBuffers.size() > cMaxRetiredBuffers )
+            {
+                std::sort(
+                    m_ZeroCopyRetiredBuffers.begin(),
+                    m_ZeroCopyRetiredBuffers.end(),
+                    zeroCopyAvoidableBytesGreater );
+                m_ZeroCopyRetiredBuffers.resize( cReportedBuffers );
+            }
+        }
+        m_ZeroCopyBufferInfoMap.erase( iter );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::addStartupMilestone(
+    const std::string& name,
+    clock::time_point time )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    m_StartupMilestones.emplace_back();
+
+    SStartupMilestone&  milestone = m_StartupMilestones.back();
+    milestone.Name = name;
+    milestone.Time = time;
+    milestone.Calls.swap( m_StartupCalls );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::startupProfileCall(
+    const char* functionName,
+    clock::time_point start,
+    clock::time_point end )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    if( m_StartupProfileComplete )
+    {
+        return;
+    }
+
+#if defined(__APPLE__)
+    // On OSX, the entry points are renamed with an "i" prefix, so strip it
+    // to get the OpenCL function name.
+    if( functionName[0] == 'i' )
+    {
+        functionName++;
+    }
+#endif
+
+    SStartupCallStats&  stats = m_StartupCalls[ functionName ];
+    stats.NumberOfCalls++;
+    stats.TotalNS +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    const std::string   name( functionName );
+
+    const char* milestone = NULL;
+    if( name == "clGetPlatformIDs" )
+    {
+        milestone = "First clGetPlatformIDs";
+    }
+    else if( name == "clGetDeviceIDs" )
+    {
+        milestone = "First clGetDeviceIDs";
+    }
+    else if( name == "clCreateContext" ||
+             name == "clCreateContextFromType" )
+    {
+        milestone = "First Context Created";
+    }
+    else if( name.compare( 0, 20, "clCreateCommandQueue" ) == 0 )
+    {
+        milestone = "First Command Queue Created";
+    }
+
+    if( milestone )
+    {
+        for( size_t m = 0; m < m_StartupMilestones.size(); m++ )
+        {
+            if( m_StartupMilestones[m].Name == milestone )
+            {
+                milestone = NULL;
+                break;
+            }
+        }
+    }
+    if( milestone )
+    {
+        addStartupMilestone( milestone, end );
+    }
+
+    // Every program build is a milestone.
+    if( name == "clBuildProgram" ||
+        name == "clCompileProgram" ||
+        name == "clLinkProgram" )
+    {
+        std::ostringstream  ss;
+        ss << name << " (" << ++m_StartupProgramBuilds << ")";
+        addStartupMilestone( ss.str(), end );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::startupProfileKernelEnqueue(
+    cl_command_queue queue )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    if( m_StartupKernelEnqueued || m_StartupProfileComplete )
+    {
+        return;
+    }
+
+    m_StartupKernelEnqueued = true;
+    addStartupMilestone( "First Kernel Enqueue", clock::now() );
+
+    // A marker with no wait list completes when all previous commands in
+    // the queue complete, so it completes when the first kernel completes
+    // for both in-order and out-of-order queues.
+    cl_event    event = NULL;
+    cl_int  errorCode = dispatch().clEnqueueMarkerWithWaitList(
+        queue,
+        0,
+        NULL,
+        &event );
+    if( errorCode == CL_SUCCESS )
+    {
+        errorCode = dispatch().clSetEventCallback(
+            event,
+            CL_COMPLETE,
+            startupProfileCallback,
+            this );
+        if( errorCode != CL_SUCCESS )
+        {
+            dispatch().clReleaseEvent( event );
+        }
+    }
+
+    if( errorCode != CL_SUCCESS )
+    {
+        logf( "Couldn't observe first kernel completion for the startup profile (%s)!\n",
+            enumName().name(errorCode).c_str() );
+        m_StartupProfileComplete = true;
+        chromeStartupProfile();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CL_CALLBACK CLIntercept::startupProfileCallback(
+    cl_event event,
+    cl_int status,
+    void* user_data )
+{
+    CLIntercept*    pIntercept = (CLIntercept*)user_data;
+
+    {
+        CInstrumentedLockGuard lock(pIntercept->m_Mutex, __FUNCTION__);
+
+        pIntercept->addStartupMilestone( "First Kernel Complete", clock::now() );
+        pIntercept->m_StartupProfileComplete = true;
+        pIntercept->chromeStartupProfile();
+    }
+
+    pIntercept->dispatch().clReleaseEvent( event );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::chromeStartupProfile()
+{
+    // Note: This function assumes the mutex is already locked.
+
+    if( !m_InterceptTrace.is_open() ||
+        m_StartupMilestones.size() < 2 )
+    {
+        return;
+    }
+
+    uint64_t    processId = OS().GetProcessID();
+
+    // Each slice on the startup track spans the gap before a milestone.
+    // Events before the start time are clamped to the start of the trace.
+    using us = std::chrono::microseconds;
+    for( size_t m = 1; m < m_StartupMilestones.size(); m++ )
+    {
+        const clock::time_point start = std::max( m_StartupMilestones[m - 1].Time, m_StartTime );
+        const clock::time_point end = std::max( m_StartupMilestones[m].Time, start );
+
+        uint64_t    usStart =
+            std::chrono::duration_cast<us>(start - m_StartTime).count();
+        uint64_t    usDelta =
+            std::chrono::duration_cast<us>(end - start).count();
+
+        uint64_t    numberOfCalls = 0;
+        CStartupCallStatsMap::const_iterator i = m_StartupMilestones[m].Calls.begin();
+        while( i != m_StartupMilestones[m].Calls.end() )
+        {
+            numberOfCalls += i->second.NumberOfCalls;
+            ++i;
+        }
+
+        m_InterceptTrace
+            << "{\"ph\":\"X\", \"pid\":" << processId
+            << ", \"tid\":\"Startup\""
+            << ", \"name\":\"" << m_StartupMilestones[m].Name
+            << "\", \"ts\":" << usStart
+            << ", \"dur\":" << usDelta
+            << ", \"args\":{\"calls\":" << numberOfCalls
+            << "}},\n";
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::addBottleneckCommand(
+    const SEventListNode& node,
+    cl_ulong commandQueued,
+    cl_ulong commandStart,
+    cl_ulong commandEnd )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    if( commandStart < commandQueued || commandEnd < commandStart )
+    {
+        return;
+    }
+
+    const uint64_t  windowNS =
+        std::max< uint64_t >( config().BottleneckAnalysisPhaseMilliseconds, 1 ) * 1000000;
+
+    // Convert device timestamps to host time using the host time when the
+    // command was queued.
+    const uint64_t  queuedNS =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(node.QueuedTime - m_StartTime).count();
+    const uint64_t  startNS = queuedNS + ( commandStart - commandQueued );
+    const uint64_t  endNS = startNS + ( commandEnd - commandStart );
+
+    m_BottleneckWindowMap[ queuedNS / windowNS ].NumberOfEnqueues++;
+
+    const bool  isKernel = ( node.Kernel != NULL );
+    const bool  isTransfer = !isKernel && isTransferCommand( node.FunctionName );
+
+    if( isKernel )
+    {
+        SBottleneckWindow&  window = m_BottleneckWindowMap[ startNS / windowNS ];
+        window.NumberOfKernels++;
+
+        AddLog2Histogram(
+            window.KernelHistogram,
+            BOTTLENECK_HISTOGRAM_BUCKETS,
+            commandEnd - commandStart );
+    }
+
+    // Split the command's execution across the windows it overlaps.
+    uint64_t    begin = startNS;
+    while( begin < endNS )
+    {
+        const uint64_t  w = begin / windowNS;
+        const uint64_t  end = std::min< uint64_t >( endNS, ( w + 1 ) * windowNS );
+
+        SBottleneckWindow&  window = m_BottleneckWindowMap[ w ];
+        if( isKernel )
+        {
+            window.KernelNS += end - begin;
+        }
+        else if( isTransfer )
+        {
+            window.TransferNS += end - begin;
+        }
+        else
+        {
+            window.OtherNS += end - begin;
+        }
+
+        begin = end;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+const char* CLIntercept::classifyBottleneck(
+    const SBottleneckWindow& window,
+    uint64_t windowNS,
+    std::string& evidence )
+{
+    const uint64_t  busyNS = window.KernelNS + window.TransferNS + window.OtherNS;
+    const double    utilization =
+        std::min( 1.0, (double)busyNS / (double)windowNS );
+    const double    transferShare =
+        busyNS ? (double)window.TransferNS / (double)busyNS : 0.0;
+
+    const uint64_t  medianKernelNS = GetLog2HistogramPercentile(
+        window.KernelHistogram,
+        BOTTLENECK_HISTOGRAM_BUCKETS,
+        window.NumberOfKernels,
+        50 );
+
+    const uint64_t  enqueueIntervalNS =
+        window.NumberOfEnqueues ? windowNS / window.NumberOfEnqueues : windowNS;
+
+    std::ostringstream  ss;
+    ss << std::fixed << std::setprecision(1)
+        << "device utilization " << utilization * 100.0 << "%, "
+        << "median kernel " << medianKernelNS << " ns, "
+        << "enqueue interval " << enqueueIntervalNS << " ns, "
+        << "transfer share " << transferShare * 100.0 << "%";
+    evidence = ss.str();
+
+    // Thresholds for classification.
+    const double    cBusyUtilization = 0.5;
+    const double    cTransferShare = 0.5;
+    const uint64_t  cTinyKernelNS = 50000;
+
+    if( utilization >= cBusyUtilization )
+    {
+        return transferShare >= cTransferShare ?
+            "transfer-bound" :
+            "compute-bound";
+    }
+    if( window.NumberOfKernels != 0 &&
+        medianKernelNS <= cTinyKernelNS &&
+        medianKernelNS <= enqueueIntervalNS &&
+        window.NumberOfEnqueues * cTinyKernelNS >= windowNS / 10 )
+    {
+        return "launch-bound";
+    }
+    return "host-bound";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+cl_kernel CLIntercept::createRecycledKernel(
+    cl_program program,
+    const char* kernel_name,
+    cl_int* errcode_ret )
+{
+    cl_kernel   templateKernel = NULL;
+
+    // Look up the template kernel while holding the lock, but retain it so it
+    // can be cloned without holding the lock, even if the program is released
+    // concurrently.
+    if( program && kernel_name )
+    {
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+        CKernelRecyclingTemplateMap::const_iterator programIter =
+            m_KernelRecyclingTemplateMap.find( program );
+        if( programIter != m_KernelRecyclingTemplateMap.end() )
+        {
+            CKernelRecyclingTemplateNameMap::const_iterator nameIter =
+                programIter->second.find( kernel_name );
+            if( nameIter != programIter->second.end() )
+            {
+                templateKernel = nameIter->second;
+                dispatch().clRetainKernel( templateKernel );
+            }
+        }
+    }
+
+    cl_kernel   kernel = NULL;
+
+    clock::time_point   start = clock::now();
+
+    if( templateKernel )
+    {
+        kernel = dispatch().clCloneKernel(
+            templateKernel,
+            errcode_ret );
+        dispatch().clReleaseKernel( templateKernel );
+
+        if( kernel )
+        {
+            clock::time_point   end = clock::now();
+
+            CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+            SKernelRecyclingStats&  stats = m_KernelRecyclingStatsMap[ kernel_name ];
+            stats.NumberOfRecycled++;
+            stats.RecycleNS +=
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+            // The kernel handle may have been used by a kernel that was
+            // released previously, so remove any stale kernel argument
+            // information.
+            m_KernelArgMap.erase( kernel );
+            m_ScalarArgMap.erase( kernel );
+            m_RedundantKernelArgsMap.erase( kernel );
+            m_AutoOutOfOrderIndirectKernels.erase( kernel );
+            m_AutoOutOfOrderUnknownArgs.erase( kernel );
+
+            return kernel;
+        }
+    }
+
+    // There is no template kernel, or it could not be cloned, so create the
+    // kernel normally.  Nothing is recorded if the program or kernel name are
+    // invalid, since the kernel will not be created.
+    kernel = dispatch().clCreateKernel(
+        program,
+        kernel_name,
+        errcode_ret );
+
+    clock::time_point   end = clock::now();
+
+    if( kernel == NULL )
+    {
+        return kernel;
+    }
+
+    // Clone the kernel before the application sets any arguments, so the
+    // template kernel is pristine.  Templates are only kept for programs
+    // whose references are tracked, so they can be released in time.
+    bool    trackedProgram = false;
+    {
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+        trackedProgram =
+            m_KernelRecyclingProgramRefMap.find( program ) !=
+            m_KernelRecyclingProgramRefMap.end();
+    }
+
+    cl_kernel   newTemplate = NULL;
+    if( templateKernel == NULL && trackedProgram && dispatch().clCloneKernel )
+    {
+        newTemplate = dispatch().clCloneKernel(
+            kernel,
+            NULL );
+    }
+
+    clock::time_point   cloneEnd = clock::now();
+
+    {
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+        SKernelRecyclingStats&  stats = m_KernelRecyclingStatsMap[ kernel_name ];
+        stats.NumberOfCreates++;
+        stats.CreateNS +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        if( newTemplate &&
+            m_KernelRecyclingProgramRefMap.find( program ) !=
+                m_KernelRecyclingProgramRefMap.end() )
+        {
+            stats.RecycleNS +=
+                std::chrono::duration_cast<std::chrono::nanoseconds>(cloneEnd - end).count();
+
+            // Another thread may have created a template kernel for this
+            // program and kernel name in the meantime.
+            cl_kernel&  poolTemplate = m_KernelRecyclingTemplateMap[ program ][ kernel_name ];
+            if( poolTemplate == NULL )
+            {
+                poolTemplate = newTemplate;
+                newTemplate = NULL;
+            }
+        }
+    }
+
+    if( newTemplate )
+    {
+        dispatch().clReleaseKernel( newTemplate );
+    }
+
+    return kernel;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::addRecycledKernelsProgramRef(
+    cl_program program )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    m_KernelRecyclingProgramRefMap[ program ]++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::releaseRecycledKernels(
+    cl_program program )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    // Release the template kernels when the application releases its last
+    // reference to the program, since these kernels would otherwise keep the
+    // program alive.
+    CKernelRecyclingProgramRefMap::iterator refIter =
+        m_KernelRecyclingProgramRefMap.find( program );
+    if( refIter == m_KernelRecyclingProgramRefMap.end() ||
+        --refIter->second != 0 )
+    {
+        return;
+    }
+
+    m_KernelRecyclingProgramRefMap.erase( refIter );
+
+    CKernelRecyclingTemplateMap::iterator iter = m_KernelRecyclingTemplateMap.find( program );
+    if( iter != m_KernelRecyclingTemplateMap.end() )
+    {
+        releaseRecycledKernelTemplates( iter );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::releaseRecycledKernelTemplates(
+    cl_program program )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    // A program cannot be built, compiled, or linked while kernels are
+    // attached to it, so release the template kernels first.  New templates
+    // are created by the next clCreateKernel() call for the program.
+    CKernelRecyclingTemplateMap::iterator iter = m_KernelRecyclingTemplateMap.find( program );
+    if( iter != m_KernelRecyclingTemplateMap.end() )
+    {
+        releaseRecycledKernelTemplates( iter );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::releaseRecycledKernelTemplates(
+    CKernelRecyclingTemplateMap::iterator iter )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    CKernelRecyclingTemplateNameMap::iterator templateIter = iter->second.begin();
+    while( templateIter != iter->second.end() )
+    {
+        dispatch().clReleaseKernel( templateIter->second );
+        ++templateIter;
+    }
+
+    m_KernelRecyclingTemplateMap.erase( iter );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::redundantKernelSetArg(
+    cl_kernel kernel,
+    cl_uint arg_index,
+    size_t arg_size,
+    const void* arg_value )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    std::vector<unsigned char>& value =
+        m_RedundantKernelArgsMap[ kernel ].Values[ arg_index ];
+
+    // Local memory arguments have no value, so record their size instead.
+    const unsigned char*    data =
+        arg_value ?
+        (const unsigned char*)arg_value :
+        (const unsigned char*)&arg_size;
+    const size_t    size =
+        arg_value ?
+        arg_size :
+        sizeof(arg_size);
+
+    value.assign( data, data + size );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+const void* CLIntercept::getWriteGenerationKey(
+    SAutoOutOfOrderResource resource ) const
+{
+    // Note: This function assumes the mutex is already locked.
+
+    // Write generations are tracked for entire memory objects and SVM or USM
+    // allocations.  Host memory is not tracked.
+    bool    unknown = false;
+    if( resource.Mem == NULL )
+    {
+        resource.End = resource.Begin;
+    }
+    resolveAutoOutOfOrderResource( resource, unknown );
+
+    if( unknown )
+    {
+        return NULL;
+    }
+    return resource.Mem ?
+        (const void*)resource.Mem :
+        (const void*)resource.Begin;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+uint64_t CLIntercept::getWriteGeneration(
+    const void* key )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    // Generations are unique across all allocations, so a new allocation
+    // that reuses the handle or address of a released allocation does not
+    // match previous enqueues.
+    CWriteGenerationMap::iterator iter = m_WriteGenerationMap.find( key );
+    if( iter == m_WriteGenerationMap.end() )
+    {
+        iter = m_WriteGenerationMap.insert(
+            std::make_pair( key, ++m_WriteGeneration ) ).first;
+    }
+    return iter->second;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::redundantKernelCheckWrites(
+    const SAutoOutOfOrderCommand& command )
+{
+    if( command.Writes.empty() )
+    {
+        return;
+    }
+
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    for( size_t i = 0; i < command.Writes.size(); i++ )
+    {
+        const void* key = getWriteGenerationKey( command.Writes[i] );
+        if( key )
+        {
+            m_WriteGenerationMap[ key ] = ++m_WriteGeneration;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CLIntercept::hostAllocationPlacementEnabled() const
+{
+#if defined(__linux__)
+    return m_Config.HostAllocationHugePages != 0 ||
+        m_Config.HostAllocationNUMAPolicy != 0;
+#else
+    return false;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void* CLIntercept::allocateHostMemory(
+    size_t size )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    if( !hostAllocationPlacementEnabled() || size == 0 )
+    {
+        return new char[size];
+    }
+
+#if defined(__linux__)
+    const size_t    cHugePageSize = 2 * 1024 * 1024;
+    const size_t    pageSize = (size_t)sysconf( _SC_PAGESIZE );
+
+    void*   ptr = MAP_FAILED;
+    size_t  allocSize = 0;
+
+#if defined(MAP_HUGETLB)
+    if( m_Config.HostAllocationHugePages == 2 )
+    {
+        allocSize = ( size + cHugePageSize - 1 ) & ~( cHugePageSize - 1 );
+        ptr = mmap(
+            NULL,
+            allocSize,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+            -1,
+            0 );
+    }
+#endif
+    if( ptr == MAP_FAILED )
+    {
+        // Align transparent huge page allocations to the huge page size
+        // so the entire allocation is eligible for huge pages.
+        const size_t    alignment =
+            m_Config.HostAllocationHugePages ? cHugePageSize : pageSize;
+        allocSize = ( size + alignment - 1 ) & ~( alignment - 1 );
+        ptr = mmap(
+            NULL,
+            allocSize,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS,
+            -1,
+            0 );
+        if( ptr == MAP_FAILED )
+        {
+            return new char[size];
+        }
+#if defined(MADV_HUGEPAGE)
+        if( m_Config.HostAllocationHugePages )
+        {
+            madvise( ptr, allocSize, MADV_HUGEPAGE );
+        }
+#endif
+    }
+
+#if defined(SYS_mbind) && defined(SYS_getcpu)
+    if( m_Config.HostAllocationNUMAPolicy )
+    {
+        unsigned int    node = m_Config.HostAllocationNUMANode;
+        if( m_Config.HostAllocationNUMAPolicy == 2 )
+        {
+            unsigned int    cpu = 0;
+            syscall( SYS_getcpu, &cpu, &node, NULL );
+        }
+
+        // The memory is not touched yet, so setting the policy places every
+        // page on the node when it is first touched.  The node is preferred
+        // rather than required, so pages are placed on other nodes instead
+        // of failing if the node is out of memory.
+        const int           cMPOL_PREFERRED = 1;
+        const unsigned int  cBitsPerLong = sizeof(unsigned long) * 8;
+        unsigned long       nodeMask[4] = { 0, 0, 0, 0 };
+        if( node < sizeof(nodeMask) * 8 )
+        {
+            nodeMask[ node / cBitsPerLong ] = 1UL << ( node % cBitsPerLong );
+            if( syscall(
+                    SYS_mbind,
+                    ptr,
+                    allocSize,
+                    cMPOL_PREFERRED,
+                    nodeMask,
+                    sizeof(nodeMask) * 8,
+                    0 ) != 0 )
+            {
+                logf( "Failed to set NUMA policy for host allocation to node %u!\n", node );
+            }
+        }
+    }
+#endif
+
+    m_HostAllocationMap[ ptr ] = allocSize;
+    return ptr;
+#else
+    return new char[size];
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::freeHostMemory(
+    void* ptr )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    if( ptr == NULL )
+    {
+        return;
+    }
+
+#if defined(__linux__)
+    CHostAllocationMap::iterator iter = m_HostAllocationMap.find( ptr );
+    if( iter != m_HostAllocationMap.end() )
+    {
+        munmap( ptr, iter->second );
+        m_HostAllocationMap.erase( iter );
+        return;
+    }
+#endif
+
+    delete [] (char*)ptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::benchmarkHostAllocations()
+{
+    const size_t    cSize = 256 * 1024 * 1024;
+    const int       cIterations = 8;
+
+#if defined(__linux__)
+    // Pin the benchmark thread to the CPU it is running on, so both
+    // measurements are made from the same NUMA node, and so the node
+    // chosen for placed allocations is the node that copies the data.
+    cpu_set_t   savedMask;
+    bool        pinned = false;
+    if( sched_getaffinity( 0, sizeof(savedMask), &savedMask ) == 0 )
+    {
+        const int   cpu = sched_getcpu();
+        if( cpu >= 0 )
+        {
+            cpu_set_t   mask;
+            CPU_ZERO( &mask );
+            CPU_SET( cpu, &mask );
+            pinned = sched_setaffinity( 0, sizeof(mask), &mask ) == 0;
+            if( pinned )
+            {
+                logf( "Host allocation benchmark: running on CPU %d\n", cpu );
+            }
+        }
+    }
+#endif
+
+    // Measure normal allocations first, then placed allocations.
+    for( int placed = 0; placed < 2; placed++ )
+    {
+        char*   src = NULL;
+        char*   dst = NULL;
+        if( placed )
+        {
+            CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+            src = (char*)allocateHostMemory( cSize );
+            dst = (char*)allocateHostMemory( cSize );
+        }
+        else
+        {
+            src = new char[ cSize ];
+            dst = new char[ cSize ];
+        }
+
+        // Touch the memory first, so page faults are not measured.
+        memset( src, 1, cSize );
+        memset( dst, 0, cSize );
+
+        clock::time_point   start = clock::now();
+        for( int i = 0; i < cIterations; i++ )
+        {
+            memcpy( dst, src, cSize );
+        }
+        clock::time_point   end = clock::now();
+
+        const uint64_t  nsDelta =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        // Bytes per nanosecond is equivalent to GB/s.
+        logf( "Host allocation benchmark: %s allocations: %.2f GB/s\n",
+            placed ? "placed" : "normal",
+            nsDelta ? (double)cSize * cIterations / (double)nsDelta : 0.0 );
+
+        if( placed )
+        {
+            CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+            freeHostMemory( src );
+            freeHostMemory( dst );
+        }
+        else
+        {
+            delete [] src;
+            delete [] dst;
+        }
+    }
+
+#if defined(__linux__)
+    if( pinned )
+    {
+        sched_setaffinity( 0, sizeof(savedMask), &savedMask );
+    }
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::mapAccessTrackingMap(
+    cl_mem buffer,
+    cl_map_flags flags,
+    void* ptr,
+    size_t size )
+{
+#if defined(__linux__)
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    // Only pages entirely within the mapped region are protected, so
+    // unrelated data on the same pages is not affected.
+    const uintptr_t pageSize = s_MapAccessPageSize;
+    const uintptr_t begin = ( (uintptr_t)ptr + pageSize - 1 ) & ~( pageSize - 1 );
+    const uintptr_t end = ( (uintptr_t)ptr + size ) & ~( pageSize - 1 );
+
+    // If a fault was handed back to the previous SIGSEGV handler then
+    // regions can no longer be tracked.
+    if( s_MapAccessHandedOff.load() ||
+        begin >= end ||
+        m_MapAccessRecordMap.find( ptr ) != m_MapAccessRecordMap.end() )
+    {
+        m_MapAccessUntrackedMaps++;
+        return;
+    }
+
+    // Find a free slot, and make sure the region does not overlap a
+    // region that is already protected.
+    size_t  slot = s_cMaxMapAccessRegions;
+    for( size_t i = 0; i < s_cMaxMapAccessRegions; i++ )
+    {
+        const uintptr_t regionBegin = s_MapAccessRegions[i].Begin.load( std::memory_order_acquire );
+        if( regionBegin == 0 )
+        {
+            if( slot == s_cMaxMapAccessRegions )
+            {
+                slot = i;
+            }
+        }
+        else if( begin < s_MapAccessRegions[i].End.load() && regionBegin < end )
+        {
+            m_MapAccessUntrackedMaps++;
+            return;
+        }
+    }
+    if( slot == s_cMaxMapAccessRegions )
+    {
+        m_MapAccessUntrackedMaps++;
+        return;
+    }
+
+    const size_t    numPages = ( end - begin ) / pageSize;
+
+    SMapAccessRegion&   region = s_MapAccessRegions[slot];
+    if( region.Capacity.load() < numPages )
+    {
+        // Publish the larger storage before the larger capacity, so the
+        // signal handler never indexes past the end of the storage it
+        // loads.  The old storage is kept until shutdown.
+        uint8_t*    oldPageState = region.PageState.exchange( new uint8_t[ numPages ] );
+        if( oldPageState )
+        {
+            s_MapAccessRetiredPageStates.push_back( oldPageState );
+        }
+        region.Capacity.store( numPages, std::memory_order_release );
+    }
+
+    uint8_t*    pageState = region.PageState.load();
+    for( size_t p = 0; p < numPages; p++ )
+    {
+        pageState[p] = 0;
+    }
+    region.End.store( end );
+    region.Begin.store( begin, std::memory_order_release );
+
+    if( mprotect( (void*)begin, end - begin, PROT_NONE ) != 0 )
+    {
+        region.Begin.store( 0, std::memory_order_release );
+
+        m_MapAccessUntrackedMaps++;
+        return;
+    }
+
+    SMapAccessRecord&   record = m_MapAccessRecordMap[ ptr ];
+    record.Slot = slot;
+    record.MemObj = buffer;
+    record.Flags = flags;
+    record.Size = size;
+    record.NumberOfPages = numPages;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::mapAccessTrackingUnmap(
+    cl_mem memobj,
+    void* ptr )
+{
+#if defined(__linux__)
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CMapAccessRecordMap::iterator iter = m_MapAccessRecordMap.find( ptr );
+    if( iter == m_MapAccessRecordMap.end() )
+    {
+        return;
+    }
+
+    const SMapAccessRecord& record = iter->second;
+    SMapAccessRegion&   region = s_MapAccessRegions[ record.Slot ];
+
+    const uintptr_t begin = region.Begin.load( std::memory_order_acquire );
+
+    const uintptr_t end = region.End.load();
+
+    // Restore access before removing the region, so no new faults occur
+    // for the region.  Faults that are already in flight will find the
+    // retired range and retry.
+    region.RetiredBegin.store( 0 );
+    region.RetiredEnd.store( end );
+    region.RetiredBegin.store( begin );
+    mprotect( (void*)begin, end - begin, PROT_READ | PROT_WRITE );
+
+    const uint8_t*  pageState = region.PageState.load();
+
+    uint64_t    readPages = 0;
+    uint64_t    writtenPages = 0;
+    for( size_t p = 0; p < record.NumberOfPages; p++ )
+    {
+        if( pageState[p] == 1 )
+        {
+            readPages++;
+        }
+        else if( pageState[p] == 2 )
+        {
+            writtenPages++;
+        }
+    }
+
+    region.Begin.store( 0, std::memory_order_release );
+
+    std::ostringstream  ss;
+    CMemAllocNumberMap::const_iterator number = m_MemAllocNumberMap.find( memobj );
+    if( number != m_MemAllocNumberMap.end() )
+    {
+        ss << "Buffer " << number->second;
+    }
+    else
+    {
+        ss << "Buffer " << (const void*)memobj;
+    }
+    ss << " (" << enumName().name_map_flags( record.Flags ) << ")";
+
+    const uint64_t  trackedBytes = record.NumberOfPages * s_MapAccessPageSize;
+    const uint64_t  touchedBytes = ( readPages + writtenPages ) * s_MapAccessPageSize;
+
+    SMapAccessStats&    stats = m_MapAccessStatsMap[ ss.str() ];
+    stats.NumberOfMaps++;
+    stats.MappedBytes += record.Size;
+    stats.TrackedBytes += trackedBytes;
+    stats.ReadBytes += readPages * s_MapAccessPageSize;
+    stats.WrittenBytes += writtenPages * s_MapAccessPageSize;
+
+    if( touchedBytes * 100 < trackedBytes * config().MapAccessTrackingThreshold )
+    {
+        // Scale the untouched fraction of the tracked pages to the size of
+        // the mapped region to estimate the bytes transferred needlessly.
+        stats.NumberOfLowTouchMaps++;
+        stats.NeedlessBytes +=
+            (uint64_t)( (double)record.Size *
+                (double)( trackedBytes - touchedBytes ) / (double)trackedBytes );
+    }
+
+    m_MapAccessRecordMap.erase( iter );
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::kernelFootprintCheck(
+    uint64_t enqueueCounter,
+    bool deviceTiming,
+    cl_kernel kernel )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    // Count each allocation once, even if it is passed to multiple kernel
+    // arguments.
+    std::set< const void* >    allocations;
+    uint64_t    footprint = 0;
+
+    CKernelArgMap::const_iterator argMap = m_KernelArgMap.find( kernel );
+    if( argMap != m_KernelArgMap.end() )
+    {
+        CKernelArgMemMap::const_iterator i = argMap->second.begin();
+        while( i != argMap->second.end() )
+        {
+            const void* allocation = i->second;
+            ++i;
+
+            cl_mem  memobj = (cl_mem)allocation;
+
+            CBufferInfoMap::const_iterator buffer = m_BufferInfoMap.find( memobj );
+            if( buffer != m_BufferInfoMap.end() )
+            {
+                if( allocations.insert( allocation ).second )
+                {
+                    footprint += buffer->second;
+                }
+                continue;
+            }
+
+            CImageInfoMap::const_iterator image = m_ImageInfoMap.find( memobj );
+            if( image != m_ImageInfoMap.end() )
+            {
+                if( allocations.insert( allocation ).second )
+                {
+                    const SImageInfo&   info = image->second;
+                    footprint += (uint64_t)info.Region[0] * info.Region[1] *
+                        info.Region[2] * info.ElementSize;
+                }
+                continue;
+            }
+
+            // SVM and USM pointers may point into the middle of an
+            // allocation.  The kernel can touch the rest of the allocation
+            // from the pointer.
+            CSVMAllocInfoMap::const_iterator svm = m_SVMAllocInfoMap.upper_bound( allocation );
+            if( svm != m_SVMAllocInfoMap.begin() )
+            {
+                --svm;
+                const char* begin = (const char*)svm->first;
+                const char* ptr = (const char*)allocation;
+                if( ptr >= begin && ptr < begin + svm->second )
+                {
+                    if( allocations.insert( svm->first ).second )
+                    {
+                        footprint += begin + svm->second - ptr;
+                    }
+                    continue;
+                }
+            }
+
+            CUSMAllocInfoMap::const_iterator usm = m_USMAllocInfoMap.upper_bound( allocation );
+            if( usm != m_USMAllocInfoMap.begin() )
+            {
+                --usm;
+                const char* begin = (const char*)usm->first;
+                const char* ptr = (const char*)allocation;
+                if( ptr >= begin && ptr < begin + usm->second )
+                {
+                    if( allocations.insert( usm->first ).second )
+                    {
+                        footprint += begin + usm->second - ptr;
+                    }
+                    continue;
+                }
+            }
+        }
+    }
+
+    const std::string&  name = getShortKernelNameWithHash( kernel );
+
+    SKernelFootprintStats&  stats = m_KernelFootprintStatsMap[ name ];
+    stats.NumberOfEnqueues++;
+    stats.MaxBytes = std::max< uint64_t >( stats.MaxBytes, footprint );
+    stats.TotalBytes += footprint;
+
+    if( config().DevicePerformanceTiming && deviceTiming )
+    {
+        m_KernelFootprintEnqueueMap[ enqueueCounter ] =
+            std::make_pair( name, footprint );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::redundantKernelCheck(
+    uint64_t enqueueCounter,
+    bool deviceTiming,
+    cl_kernel kernel,
+    cl_uint workDim,
+    const size_t* gwo,
+    const size_t* gws,
+    const size_t* lws )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CKernelInfoMap::const_iterator kernelIter = m_KernelInfoMap.find( kernel );
+    if( kernelIter == m_KernelInfoMap.end() )
+    {
+        return;
+    }
+
+    const SKernelInfo&  kernelInfo = kernelIter->second;
+    const std::string   name = getShortKernelNameWithHash( kernel );
+
+    SRedundantKernelStats&  stats = m_RedundantKernelStatsMap[ name ];
+    stats.NumberOfEnqueues++;
+
+    SRedundantKernelArgs&   args = m_RedundantKernelArgsMap[ kernel ];
+    if( args.QueriedQualifiers == false )
+    {
+        args.QueriedQualifiers = true;
+
+        cl_uint numArgs = 0;
+        dispatch().clGetKernelInfo(
+            kernel,
+            CL_KERNEL_NUM_ARGS,
+            sizeof(numArgs),
+            &numArgs,
+            NULL );
+
+        // Note: argument qualifiers may be unavailable if the program was
+        // not built with -cl-kernel-arg-info.  In this case, all memory
+        // arguments are assumed to be both read and written.
+        for( cl_uint index = 0; index < numArgs; index++ )
+        {
+            cl_kernel_arg_address_qualifier addressQualifier = 0;
+            cl_kernel_arg_access_qualifier  accessQualifier = 0;
+            cl_kernel_arg_type_qualifier    typeQualifier = 0;
+            dispatch().clGetKernelArgInfo(
+                kernel,
+                index,
+                CL_KERNEL_ARG_ADDRESS_QUALIFIER,
+                sizeof(addressQualifier),
+                &addressQualifier,
+                NULL );
+            dispatch().clGetKernelArgInfo(
+                kernel,
+                index,
+                CL_KERNEL_ARG_ACCESS_QUALIFIER,
+                sizeof(accessQualifier),
+                &accessQualifier,
+                NULL );
+            dispatch().clGetKernelArgInfo(
+                kernel,
+                index,
+                CL_KERNEL_ARG_TYPE_QUALIFIER,
+                sizeof(typeQualifier),
+                &typeQualifier,
+                NULL );
+            if( addressQualifier == CL_KERNEL_ARG_ADDRESS_CONSTANT ||
+                accessQualifier == CL_KERNEL_ARG_ACCESS_READ_ONLY ||
+                ( typeQualifier & CL_KERNEL_ARG_TYPE_CONST ) )
+            {
+                args.ReadOnly.insert( index );
+            }
+            else if( accessQualifier == CL_KERNEL_ARG_ACCESS_WRITE_ONLY )
+            {
+                args.WriteOnly.insert( index );
+            }
+        }
+    }
+
+    // Collect the memory used by the kernel.  If the kernel may access
+    // memory that is not tracked then the enqueue cannot be checked.
+    bool    unknown =
+        m_AutoOutOfOrderIndirectKernels.find( kernel ) !=
+        m_AutoOutOfOrderIndirectKernels.end();
+
+    std::vector<const void*>    keys;
+    std::vector<bool>           reads;
+    std::vector<bool>           writes;
+
+    CKernelArgMap::const_iterator memArgs = m_KernelArgMap.find( kernel );
+    if( memArgs != m_KernelArgMap.end() )
+    {
+        CKernelArgMemMap::const_iterator arg = memArgs->second.begin();
+        while( arg != memArgs->second.end() )
+        {
+            if( arg->second != NULL )
             {
-                if( workDim >= 1 )
+                cl_mem  memobj = (cl_mem)arg->second;
+
+                SAutoOutOfOrderResource resource = { NULL, NULL, NULL };
+                if( m_BufferInfoMap.find( memobj ) != m_BufferInfoMap.end() ||
+                    m_ImageInfoMap.find( memobj ) != m_ImageInfoMap.end() )
                 {
-                    ss << gwo[0];
+                    resource.Mem = memobj;
                 }
-                if( workDim >= 2 )
+                else
                 {
-                    ss << ", " << gwo[1];
+                    resource.Begin = (const char*)arg->second;
                 }
-                if( workDim >= 3 )
+
+                // Host writes to host accessible SVM and USM allocations
+                // cannot be tracked, so kernels using them are not checked.
+                const void* key = getWriteGenerationKey( resource );
+                if( key &&
+                    m_HostAccessibleAllocationSet.find( key ) ==
+                    m_HostAccessibleAllocationSet.end() )
                 {
-                    ss << ", " << gwo[2];
+                    keys.push_back( key );
+                    reads.push_back(
+                        args.WriteOnly.find( arg->first ) == args.WriteOnly.end() );
+                    writes.push_back(
+                        args.ReadOnly.find( arg->first ) == args.ReadOnly.end() );
+                }
+                else
+                {
+                    unknown = true;
                 }
             }
-            else
+            ++arg;
+        }
+    }
+
+    bool    hasWrites =
+        std::find( writes.begin(), writes.end(), true ) != writes.end();
+    bool    redundant = false;
+
+    // Kernels that do not write any memory arguments are not checked, since
+    // they may have other side effects.
+    if( !unknown && hasWrites )
+    {
+        std::string signature = kernelInfo.KernelName;
+        signature.append( (const char*)&kernelInfo.ProgramHash, sizeof(kernelInfo.ProgramHash) );
+        signature.append( (const char*)&kernelInfo.OptionsHash, sizeof(kernelInfo.OptionsHash) );
+        signature.append( (const char*)&workDim, sizeof(workDim) );
+        for( cl_uint d = 0; d < workDim && d < 3; d++ )
+        {
+            const size_t    sizes[3] =
             {
-                ss << "NULL";
+                gwo ? gwo[d] : 0,
+                gws ? gws[d] : 0,
+                lws ? lws[d] : 0,
+            };
+            signature.append( (const char*)sizes, sizeof(sizes) );
+        }
+
+        std::map< cl_uint, std::vector<unsigned char> >::const_iterator value =
+            args.Values.begin();
+        while( value != args.Values.end() )
+        {
+            signature.append( (const char*)&value->first, sizeof(value->first) );
+            signature.append( value->second.begin(), value->second.end() );
+            ++value;
+        }
+
+        SRedundantKernelRecord  current;
+        for( size_t i = 0; i < keys.size(); i++ )
+        {
+            current.Before.push_back( getWriteGeneration( keys[i] ) );
+        }
+
+        // This enqueue is redundant if the memory it may read is unchanged
+        // since it was read by the previous enqueue, and the memory it may
+        // write is unchanged since it was written by the previous enqueue.
+        // Memory that may be both read and written must satisfy both, which
+        // is impossible since the previous enqueue changed it, so kernels
+        // that update memory in place are never redundant.
+        CRedundantKernelRecordMap::iterator record =
+            m_RedundantKernelRecordMap.find( signature );
+        if( record != m_RedundantKernelRecordMap.end() )
+        {
+            const SRedundantKernelRecord&   previous = record->second;
+
+            redundant =
+                previous.Before.size() == keys.size() &&
+                previous.After.size() == keys.size();
+            for( size_t i = 0; redundant && i < keys.size(); i++ )
+            {
+                if( reads[i] && current.Before[i] != previous.Before[i] )
+                {
+                    redundant = false;
+                }
+                if( writes[i] && current.Before[i] != previous.After[i] )
+                {
+                    redundant = false;
+                }
             }
-            ss << " ]";
-            node.KernelName += ss.str();
         }
+        else if( m_RedundantKernelRecordMap.size() >=
+                 config().RedundantKernelCheckingMaxRecords )
+        {
+            m_RedundantKernelRecordMap.clear();
+        }
+
+        // Record the generations after this enqueue writes its memory.
+        for( size_t i = 0; i < keys.size(); i++ )
+        {
+            if( writes[i] )
+            {
+                m_WriteGenerationMap[ keys[i] ] = ++m_WriteGeneration;
+            }
+            current.After.push_back( m_WriteGenerationMap[ keys[i] ] );
+        }
+        m_RedundantKernelRecordMap[ signature ] = current;
+    }
+    else
+    {
+        for( size_t i = 0; i < keys.size(); i++ )
+        {
+            if( unknown || writes[i] )
+            {
+                m_WriteGenerationMap[ keys[i] ] = ++m_WriteGeneration;
+            }
+        }
+    }
+
+    if( redundant )
+    {
+        stats.NumberOfRedundantEnqueues++;
+
+        if( config().DevicePerformanceTiming && deviceTiming )
+        {
+            m_RedundantKernelEnqueueMap[ enqueueCounter ] = name;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CLIntercept::isTransferCommand(
+    const std::string& functionName )
+{
+    return
+        functionName.find( "Read" ) != std::string::npos ||
+        functionName.find( "Write" ) != std::string::npos ||
+        functionName.find( "Copy" ) != std::string::npos ||
+        functionName.find( "Fill" ) != std::string::npos ||
+        functionName.find( "Map" ) != std::string::npos ||
+        functionName.find( "Memcpy" ) != std::string::npos ||
+        functionName.find( "Memset" ) != std::string::npos ||
+        functionName.find( "Migrate" ) != std::string::npos;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::addConcurrencyInterval(
+    const SEventListNode& node,
+    cl_ulong commandStart,
+    cl_ulong commandEnd )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    if( commandEnd < commandStart )
+    {
+        return;
+    }
+
+    SConcurrencyRecord& record = m_ConcurrencyRecordMap[ node.Device ];
+    if( record.Intervals.size() >= config().DeviceConcurrencyAnalysisMaxCommands )
+    {
+        record.NumberOfDroppedCommands++;
+        return;
+    }
+
+    SConcurrencyInterval    interval;
+    interval.Start = commandStart;
+    interval.End = commandEnd;
+    interval.Type =
+        node.Kernel ? CONCURRENCY_COMMAND_KERNEL :
+        isTransferCommand( node.FunctionName ) ? CONCURRENCY_COMMAND_TRANSFER :
+        CONCURRENCY_COMMAND_OTHER;
+
+    record.Intervals.push_back( interval );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CLIntercept::compareConcurrencyEvents(
+    const std::pair< cl_ulong, int >& a,
+    const std::pair< cl_ulong, int >& b )
+{
+    // Process command ends before command starts at the same time, so
+    // back-to-back commands are not counted as concurrent.
+    if( a.first != b.first )
+    {
+        return a.first < b.first;
+    }
+    return a.second < b.second;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::writeConcurrencyReport(
+    std::ostream& os,
+    const SConcurrencyRecord& record ) const
+{
+    // Build a sorted list of command start and end events.  Ends are
+    // encoded as negative values: -1 - type, and starts as the type.
+    std::vector< std::pair< cl_ulong, int > >   events;
+    events.reserve( record.Intervals.size() * 2 );
+
+    for( size_t i = 0; i < record.Intervals.size(); i++ )
+    {
+        const SConcurrencyInterval& interval = record.Intervals[i];
+        events.push_back( std::make_pair( interval.Start, interval.Type ) );
+        events.push_back( std::make_pair( interval.End, -1 - interval.Type ) );
+    }
+
+    std::sort( events.begin(), events.end(), compareConcurrencyEvents );
+
+    uint64_t    levelNS[CONCURRENCY_MAX_LEVEL + 1] = { 0 };
+    uint64_t    kernelKernelNS = 0;
+    uint64_t    kernelTransferNS = 0;
+    uint64_t    transferTransferNS = 0;
+
+    int active[3] = { 0, 0, 0 };
+
+    for( size_t i = 0; i < events.size(); i++ )
+    {
+        if( i > 0 )
+        {
+            const uint64_t  deltaNS = events[i].first - events[i - 1].first;
+            const int       level = active[0] + active[1] + active[2];
+
+            // Idle time before the first command and after the last command
+            // is not counted, so only count time between events.
+            levelNS[ std::min< int >( level, CONCURRENCY_MAX_LEVEL ) ] += deltaNS;
+
+            if( active[CONCURRENCY_COMMAND_KERNEL] >= 2 )
+            {
+                kernelKernelNS += deltaNS;
+            }
+            if( active[CONCURRENCY_COMMAND_KERNEL] >= 1 &&
+                active[CONCURRENCY_COMMAND_TRANSFER] >= 1 )
+            {
+                kernelTransferNS += deltaNS;
+            }
+            if( active[CONCURRENCY_COMMAND_TRANSFER] >= 2 )
+            {
+                transferTransferNS += deltaNS;
+            }
+        }
+
+        const int   type = events[i].second;
+        if( type >= 0 )
+        {
+            active[type]++;
+        }
+        else
+        {
+            active[-1 - type]--;
+        }
+    }
+
+    uint64_t    spanNS = 0;
+    uint64_t    busyNS = 0;
+    for( int l = 0; l <= CONCURRENCY_MAX_LEVEL; l++ )
+    {
+        spanNS += levelNS[l];
+        if( l > 0 )
+        {
+            busyNS += levelNS[l];
+        }
+    }
+
+    os << "  Commands: " << record.Intervals.size();
+    if( record.NumberOfDroppedCommands )
+    {
+        os << " (" << record.NumberOfDroppedCommands << " not recorded)";
+    }
+    os << std::endl;
+    os << "  Time Span: " << spanNS << " ns, Busy: " << busyNS << " ns" << std::endl;
+
+    os << std::fixed << std::setprecision(2);
+    os << "  Kernel + Kernel Overlap:     " << std::setw(14) << kernelKernelNS << " ns ("
+        << std::setw(6) << ( busyNS ? 100.0 * kernelKernelNS / busyNS : 0.0 ) << "% of busy time)" << std::endl;
+    os << "  Kernel + Transfer Overlap:   " << std::setw(14) << kernelTransferNS << " ns ("
+        << std::setw(6) << ( busyNS ? 100.0 * kernelTransferNS / busyNS : 0.0 ) << "% of busy time)" << std::endl;
+    os << "  Transfer + Transfer Overlap: " << std::setw(14) << transferTransferNS << " ns ("
+        << std::setw(6) << ( busyNS ? 100.0 * transferTransferNS / busyNS : 0.0 ) << "% of busy time)" << std::endl;
+
+    os << std::endl
+        << std::right << std::setw(20) << "Concurrent Commands" << ", "
+        << std::setw(14) << "Time (ns)" << ", "
+        << std::setw(10) << "Time %" << std::endl;
+    for( int l = 0; l <= CONCURRENCY_MAX_LEVEL; l++ )
+    {
+        std::ostringstream  level;
+        level << l;
+        if( l == CONCURRENCY_MAX_LEVEL )
+        {
+            level << "+";
+        }
+
+        os << std::right << std::setw(20) << level.str() << ", "
+            << std::setw(14) << levelNS[l] << ", "
+            << std::setw( 9) << ( spanNS ? 100.0 * levelNS[l] / spanNS : 0.0 ) << "%"
+            << std::endl;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::addOverheadBudgetTime(
+    clock::time_point start )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    const clock::time_point end = clock::now();
+
+    const uint64_t  nsDelta =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    m_OverheadBudgetIntervalNS += nsDelta;
+    m_OverheadBudgetTotalNS += nsDelta;
+
+    const uint64_t  intervalNS =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_OverheadBudgetIntervalStart).count();
+    if( intervalNS >= (uint64_t)config().OverheadBudgetIntervalMilliseconds * 1000000 &&
+        intervalNS != 0 )
+    {
+        adjustOverheadBudget(
+            100.0 * (double)m_OverheadBudgetIntervalNS / (double)intervalNS );
+
+        m_OverheadBudgetIntervalNS = 0;
+        m_OverheadBudgetIntervalStart = end;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::adjustOverheadBudget(
+    double overheadPercent )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    const double    budget = config().OverheadBudgetPercent;
+    const char*     action = NULL;
+
+    const cl_uint   sampleFactor = m_OverheadBudgetSampleFactor.load();
+
+    if( overheadPercent > budget )
+    {
+        // Reduce the instrumentation, cheapest loss of information first.
+        // Paused call logging takes effect when each call is entered.
+        if( config().ChromePerformanceTimingInStages &&
+            !m_OverheadBudgetStagesDisabled.load() )
+        {
+            m_OverheadBudgetStagesDisabled.store( true );
+            action = "disabled ChromePerformanceTimingInStages";
+        }
+        else if( sampleFactor < config().OverheadBudgetMaxSampleFactor )
+        {
+            m_OverheadBudgetSampleFactor.store( std::min< cl_uint >(
+                sampleFactor * 2,
+                config().OverheadBudgetMaxSampleFactor ) );
+            action = "increased the device timing sampling factor";
+        }
+        else if( !m_OverheadBudgetCallLoggingPaused.load() &&
+                 ( config().CallLogging || config().ChromeCallLogging ) )
+        {
+            m_OverheadBudgetCallLoggingPaused.store( true );
+            action = "paused call logging";
+        }
+    }
+    else if( overheadPercent < budget / 2 )
+    {
+        // Restore the instrumentation in the reverse order.
+        if( m_OverheadBudgetCallLoggingPaused.load() )
+        {
+            m_OverheadBudgetCallLoggingPaused.store( false );
+            action = "resumed call logging";
+        }
+        else if( sampleFactor > 1 )
+        {
+            m_OverheadBudgetSampleFactor.store( sampleFactor / 2 );
+            action = "decreased the device timing sampling factor";
+        }
+        else if( m_OverheadBudgetStagesDisabled.load() )
+        {
+            m_OverheadBudgetStagesDisabled.store( false );
+            action = "enabled ChromePerformanceTimingInStages";
+        }
+    }
+
+    if( action )
+    {
+        m_OverheadBudgetAdjustments++;
+        logf( "Overhead budget: intercept overhead was %.2f%% of host time (budget %u%%), %s (device timing sampling factor %u).\n",
+            overheadPercent,
+            config().OverheadBudgetPercent,
+            action,
+            m_OverheadBudgetSampleFactor.load() );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::checkKernelAnomaly(
+    const SEventListNode& node,
+    const std::string& name,
+    uint64_t delta )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    SKernelAnomalyStats&    stats = m_KernelAnomalyStatsMap[ node.Device ][ name ];
+
+    // Check for an anomaly before updating the statistics, so an anomaly
+    // does not hide itself by inflating the mean and the variance.
+    if( stats.NumberOfExecutions >= std::max< cl_uint >( config().KernelAnomalyMinSamples, 2 ) )
+    {
+        const bool  useEWMA = config().KernelAnomalyEWMAPercent != 0;
+
+        const double    mean = useEWMA ? stats.EWMAMean : stats.Mean;
+        const double    variance = useEWMA ?
+            stats.EWMAVariance :
+            stats.M2 / (double)( stats.NumberOfExecutions - 1 );
+
+        // Use a small floor for the standard deviation, so very consistent
+        // kernels do not report anomalies for insignificant jitter.
+        const double    stddev = std::max( std::sqrt( variance ), mean * 0.01 );
+
+        const uint64_t  medianNS = GetLog2HistogramPercentile(
+            stats.Histogram,
+            KERNEL_ANOMALY_HISTOGRAM_BUCKETS,
+            stats.NumberOfExecutions,
+            50 );
+
+        const bool  sigmaAnomaly =
+            config().KernelAnomalySigma != 0 &&
+            (double)delta > mean + config().KernelAnomalySigma * stddev;
+        const bool  medianAnomaly =
+            config().KernelAnomalyMedianMultiple != 0 &&
+            delta > (uint64_t)config().KernelAnomalyMedianMultiple * medianNS;
+
+        if( sigmaAnomaly || medianAnomaly )
+        {
+            stats.NumberOfAnomalies++;
+            stats.MaxAnomalyNS = std::max< uint64_t >( stats.MaxAnomalyNS, delta );
+
+            std::ostringstream  ss;
+            ss << std::fixed << std::setprecision(0)
+                << "Kernel anomaly for " << name
+                << " (enqueue " << node.EnqueueCounter << "): "
+                << delta << " ns, mean " << mean
+                << " ns, stddev " << stddev
+                << " ns, median " << medianNS << " ns";
+            if( !node.WorkSizes.empty() )
+            {
+                ss << ", " << node.WorkSizes;
+            }
+            ss << ", queue " << node.QueueNumber
+                << " depth " << node.QueueDepth
+                << ", " << node.DeviceInFlight << " other commands in flight on the device\n";
+            log( ss.str() );
+
+            if( config().KernelAnomalyDumpBuffers )
+            {
+                // The kernel's short name is the timing key up to any
+                // additional tracking information.
+                m_KernelAnomalyDumpSet.insert( name.substr( 0, name.find( ' ' ) ) );
+            }
+        }
+    }
+
+    stats.NumberOfExecutions++;
+
+    const double    x = (double)delta;
+    const double    d = x - stats.Mean;
+    stats.Mean += d / (double)stats.NumberOfExecutions;
+    stats.M2 += d * ( x - stats.Mean );
+
+    if( stats.NumberOfExecutions == 1 )
+    {
+        stats.EWMAMean = x;
+        stats.EWMAVariance = 0.0;
+    }
+    else
+    {
+        const double    alpha = std::min< cl_uint >( config().KernelAnomalyEWMAPercent, 100 ) / 100.0;
+        const double    e = x - stats.EWMAMean;
+        stats.EWMAMean += alpha * e;
+        stats.EWMAVariance = ( 1.0 - alpha ) * ( stats.EWMAVariance + alpha * e * e );
+    }
+
+    AddLog2Histogram(
+        stats.Histogram,
+        KERNEL_ANOMALY_HISTOGRAM_BUCKETS,
+        delta );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::removeKernelAnomalyInFlight(
+    const SEventListNode& node )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    CQueueInFlightMap::iterator queueIter =
+        m_KernelAnomalyQueueInFlightMap.find( node.Queue );
+    if( queueIter != m_KernelAnomalyQueueInFlightMap.end() )
+    {
+        if( --queueIter->second == 0 )
+        {
+            m_KernelAnomalyQueueInFlightMap.erase( queueIter );
+        }
+    }
+
+    CDeviceInFlightMap::iterator deviceIter =
+        m_KernelAnomalyDeviceInFlightMap.find( node.Device );
+    if( deviceIter != m_KernelAnomalyDeviceInFlightMap.end() &&
+        deviceIter->second != 0 )
+    {
+        deviceIter->second--;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::kernelAnomalyDumpBuffers(
+    uint64_t enqueueCounter,
+    cl_kernel kernel,
+    cl_command_queue queue )
+{
+    {
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+        if( m_KernelAnomalyDumpSet.empty() )
+        {
+            return;
+        }
+
+        std::set< std::string >::iterator iter =
+            m_KernelAnomalyDumpSet.find( getShortKernelNameWithHash( kernel ) );
+        if( iter == m_KernelAnomalyDumpSet.end() )
+        {
+            return;
+        }
+        m_KernelAnomalyDumpSet.erase( iter );
+    }
+
+    logf( "Dumping buffers for kernel %s (enqueue %u) after a kernel anomaly.\n",
+        getShortKernelNameWithHash( kernel ).c_str(),
+        (unsigned int)enqueueCounter );
+
+    dumpBuffersForKernel( "Anomaly", enqueueCounter, kernel, queue );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+CLIntercept::SRollingStatsWindow* CLIntercept::getRollingStatsWindow(
+    clock::time_point time )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    if( time < m_StartTime )
+    {
+        time = m_StartTime;
+    }
+
+    using ns = std::chrono::nanoseconds;
+
+    const uint64_t  windowNS = (uint64_t)config().RollingStatsWindowSeconds * 1000000000;
+    const uint64_t  number =
+        std::chrono::duration_cast<ns>(time - m_StartTime).count() / windowNS;
+
+    // Write the windows that are older than the lateness bound.
+    const uint64_t  currentNumber =
+        std::chrono::duration_cast<ns>(clock::now() - m_StartTime).count() / windowNS;
+    const uint64_t  lateWindows = config().RollingStatsLateWindows;
+    if( currentNumber > lateWindows &&
+        currentNumber - lateWindows > m_RollingStatsNextWindow )
+    {
+        writeRollingStatsWindows( currentNumber - lateWindows );
+    }
+
+    if( number < m_RollingStatsNextWindow )
+    {
+        // The window for this time has already been written.
+        return NULL;
+    }
+
+    SRollingStatsWindow&    window =
+        m_RollingStatsWindows[ number % m_RollingStatsWindows.size() ];
+    if( window.Valid && window.Number != number )
+    {
+        if( window.Number > number )
+        {
+            // The slot is in use by a newer window.
+            return NULL;
+        }
+        writeRollingStatsWindows( window.Number + 1 );
+    }
+    if( !window.Valid )
+    {
+        window.Valid = true;
+        window.Number = number;
+    }
 
-        if( config().DevicePerformanceTimeGWSTracking && gws )
+    return &window;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::addRollingStats(
+    CHostTimingStatsMap& statsMap,
+    const std::string& name,
+    uint64_t nsDelta )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    SHostTimingStats&   stats = statsMap[ name ];
+
+    stats.NumberOfCalls++;
+    stats.TotalNS += nsDelta;
+    stats.MinNS = std::min< uint64_t >( stats.MinNS, nsDelta );
+    stats.MaxNS = std::max< uint64_t >( stats.MaxNS, nsDelta );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::writeRollingStatsWindow(
+    SRollingStatsWindow& window )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    const uint64_t  windowStart =
+        window.Number * config().RollingStatsWindowSeconds;
+
+    CHostTimingStatsMap::const_iterator i = window.HostStats.begin();
+    while( i != window.HostStats.end() )
+    {
+        const SHostTimingStats& stats = i->second;
+        m_RollingStatsFile
+            << windowStart << ",Host,\"" << i->first << "\","
+            << stats.NumberOfCalls << ","
+            << stats.TotalNS << ","
+            << stats.MinNS << ","
+            << stats.MaxNS << "\n";
+        ++i;
+    }
+
+    SRollingStatsWindow::CDeviceStatsMap::const_iterator d = window.DeviceStats.begin();
+    while( d != window.DeviceStats.end() )
+    {
+        const std::string&  deviceName = m_DeviceInfoMap[ d->first ].NameForReport;
+
+        i = d->second.begin();
+        while( i != d->second.end() )
         {
-            std::ostringstream  ss;
-            ss << " GWS[ ";
-            if( workDim >= 1 )
-            {
-                ss << gws[0];
-            }
-            if( workDim >= 2 )
-            {
-                ss << " x " << gws[1];
-            }
-            if( workDim >= 3 )
+            const SHostTimingStats& stats = i->second;
+            m_RollingStatsFile
+                << windowStart << ",\"" << deviceName << "\",\"" << i->first << "\","
+                << stats.NumberOfCalls << ","
+                << stats.TotalNS << ","
+                << stats.MinNS << ","
+                << stats.MaxNS << "\n";
+            ++i;
+        }
+        ++d;
+    }
+
+    window.Valid = false;
+    window.HostStats.clear();
+    window.DeviceStats.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::writeRollingStatsWindows(
+    uint64_t endNumber )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    // Write the windows before endNumber, oldest first.  The ring is
+    // small, so it is simply searched for the oldest window each time.
+    while( true )
+    {
+        SRollingStatsWindow*    pOldest = NULL;
+        for( size_t w = 0; w < m_RollingStatsWindows.size(); w++ )
+        {
+            SRollingStatsWindow&    window = m_RollingStatsWindows[w];
+            if( window.Valid && window.Number < endNumber &&
+                ( pOldest == NULL || window.Number < pOldest->Number ) )
             {
-                ss << " x " << gws[2];
+                pOldest = &window;
             }
-            ss << " ]";
-            node.KernelName += ss.str();
         }
+        if( pOldest == NULL )
+        {
+            break;
+        }
+        writeRollingStatsWindow( *pOldest );
+    }
 
-        if( config().DevicePerformanceTimeLWSTracking )
+    m_RollingStatsNextWindow = std::max< uint64_t >( m_RollingStatsNextWindow, endNumber );
+    m_RollingStatsFile.flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::writeRollingStats()
+{
+    // Note: This function assumes the mutex is already locked.
+
+    // Write the remaining windows, oldest first.
+    uint64_t    endNumber = m_RollingStatsNextWindow;
+    for( size_t w = 0; w < m_RollingStatsWindows.size(); w++ )
+    {
+        const SRollingStatsWindow&  window = m_RollingStatsWindows[w];
+        if( window.Valid )
         {
-            bool    useSuggestedLWS = false;
-            size_t  suggestedLWS[3] = { 0, 0, 0 };
-            size_t  emptyGWO[3] = { 0, 0, 0 };
+            endNumber = std::max< uint64_t >( endNumber, window.Number + 1 );
+        }
+    }
 
-            if( lws == NULL &&
-                workDim <= 3 &&
-                config().DevicePerformanceTimeSuggestedLWSTracking )
-            {
-                cl_platform_id  platform = getPlatform(device);
+    writeRollingStatsWindows( endNumber );
+}
 
-                // Try the cl_khr_suggested_local_work_size version first.
-                if( useSuggestedLWS == false )
-                {
-                    if( dispatchX(platform).clGetKernelSuggestedLocalWorkSizeKHR == NULL )
-                    {
-                        getExtensionFunctionAddress(
-                            platform,
-                            "clGetKernelSuggestedLocalWorkSizeKHR" );
-                    }
+///////////////////////////////////////////////////////////////////////////////
+//
+static const char* getSubmitBatchString(
+    size_t batchSize )
+{
+    return
+        batchSize <= 1 ?  "1 command" :
+        batchSize <= 4 ?  "2-4 commands" :
+        batchSize <= 16 ? "5-16 commands" :
+        batchSize <= 64 ? "17-64 commands" :
+                          "65+ commands";
+}
 
-                    auto dispatchX = this->dispatchX(platform);
-                    if( dispatchX.clGetKernelSuggestedLocalWorkSizeKHR )
-                    {
-                        cl_int testErrorCode = dispatchX.clGetKernelSuggestedLocalWorkSizeKHR(
-                            queue,
-                            kernel,
-                            workDim,
-                            gwo,
-                            gws,
-                            suggestedLWS );
-                        useSuggestedLWS = ( testErrorCode == CL_SUCCESS );
-                    }
-                }
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::submitLatencyEnqueue(
+    cl_command_queue queue,
+    uint64_t enqueueCounter )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-                // If this fails, try the unofficial Intel version next.
-                if( useSuggestedLWS == false )
-                {
-                    if( dispatchX(platform).clGetKernelSuggestedLocalWorkSizeINTEL == NULL )
-                    {
-                        getExtensionFunctionAddress(
-                            platform,
-                            "clGetKernelSuggestedLocalWorkSizeINTEL" );
-                    }
+    // A blocking enqueue submits all of the pending commands in the queue
+    // along with the blocking command itself.
+    std::set< uint64_t >&   pending = m_SubmitPendingMap[ queue ];
 
-                    auto dispatchX = this->dispatchX(platform);
-                    if( dispatchX.clGetKernelSuggestedLocalWorkSizeINTEL )
-                    {
-                        cl_int testErrorCode = dispatchX.clGetKernelSuggestedLocalWorkSizeINTEL(
-                            queue,
-                            kernel,
-                            workDim,
-                            gwo == NULL ? emptyGWO : gwo,
-                            gws,
-                            suggestedLWS );
-                        useSuggestedLWS = ( testErrorCode == CL_SUCCESS );
-                    }
-                }
-            }
+    std::string pattern = "Blocking Enqueue, ";
+    pattern += getSubmitBatchString( pending.size() + 1 );
 
-            std::ostringstream  ss;
-            if( useSuggestedLWS )
-            {
-                ss << " SLWS[ ";
-                lws = suggestedLWS;
-            }
-            else
-            {
-                ss << " LWS[ ";
-            }
+    std::set< uint64_t >::const_iterator i = pending.begin();
+    while( i != pending.end() )
+    {
+        m_SubmitPatternMap[ *i ] = pattern;
+        ++i;
+    }
+    pending.clear();
 
-            if( lws )
-            {
-                if( workDim >= 1 )
-                {
-                    ss << lws[0];
-                }
-                if( workDim >= 2 )
-                {
-                    ss << " x " << lws[1];
-                }
-                if( workDim >= 3 )
-                {
-                    ss << " x " << lws[2];
-                }
-            }
-            else
-            {
-                ss << "NULL";
-            }
-            ss << " ]";
-            node.KernelName += ss.str();
+    SSubmitBlockingEnqueue& blockingEnqueue = submitBlockingEnqueue();
+    blockingEnqueue.EnqueueCounter = enqueueCounter;
+    blockingEnqueue.Pattern = pattern;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+CLIntercept::SSubmitBlockingEnqueue& CLIntercept::submitBlockingEnqueue()
+{
+    static thread_local SSubmitBlockingEnqueue  blockingEnqueue;
+    return blockingEnqueue;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::submitLatencyReleaseQueue(
+    cl_command_queue queue )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    if( getRefCount( queue ) == 1 )
+    {
+        m_SubmitPendingMap.erase( queue );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::submitLatencyFlush(
+    cl_command_queue queue,
+    const char* pattern )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CSubmitPendingMap::iterator iter = m_SubmitPendingMap.find( queue );
+    if( iter != m_SubmitPendingMap.end() && !iter->second.empty() )
+    {
+        std::set< uint64_t >&   pending = iter->second;
+
+        std::string label = pattern;
+        label += ", ";
+        label += getSubmitBatchString( pending.size() );
+
+        std::set< uint64_t >::const_iterator i = pending.begin();
+        while( i != pending.end() )
+        {
+            m_SubmitPatternMap[ *i ] = label;
+            ++i;
+        }
+        pending.clear();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::submitLatencyWait(
+    cl_uint numEvents,
+    const cl_event* eventList )
+{
+    if( eventList == NULL )
+    {
+        return;
+    }
+
+    std::set< cl_command_queue >    queues;
+    for( cl_uint i = 0; i < numEvents; i++ )
+    {
+        cl_command_queue    queue = NULL;
+        cl_int  errorCode = dispatch().clGetEventInfo(
+            eventList[i],
+            CL_EVENT_COMMAND_QUEUE,
+            sizeof(queue),
+            &queue,
+            NULL );
+        if( errorCode == CL_SUCCESS && queue != NULL )
+        {
+            queues.insert( queue );
+        }
+    }
+
+    std::set< cl_command_queue >::const_iterator i = queues.begin();
+    while( i != queues.end() )
+    {
+        submitLatencyFlush( *i, "clWaitForEvents" );
+        ++i;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::addSubmitLatency(
+    const SEventListNode& node,
+    cl_ulong commandQueued,
+    cl_ulong commandSubmit,
+    cl_ulong commandStart,
+    cl_ulong commandEnd )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    std::string pattern = "Implicit";
+
+    CSubmitPatternMap::iterator patternIter =
+        m_SubmitPatternMap.find( node.EnqueueCounter );
+    if( patternIter != m_SubmitPatternMap.end() )
+    {
+        pattern = patternIter->second;
+        m_SubmitPatternMap.erase( patternIter );
+    }
+    else
+    {
+        CSubmitPendingMap::iterator pendingIter =
+            m_SubmitPendingMap.find( node.Queue );
+        if( pendingIter != m_SubmitPendingMap.end() )
+        {
+            pendingIter->second.erase( node.EnqueueCounter );
         }
     }
+
+    if( commandSubmit < commandQueued ||
+        commandStart < commandSubmit ||
+        commandEnd < commandStart )
+    {
+        return;
+    }
+
+    cl_command_type commandType = 0;
+    dispatch().clGetEventInfo(
+        node.Event,
+        CL_EVENT_COMMAND_TYPE,
+        sizeof(commandType),
+        &commandType,
+        NULL );
+
+    std::ostringstream  queueName;
+    queueName << "Queue " << node.QueueNumber;
+
+    const uint64_t  queuedDelta = commandSubmit - commandQueued;
+    const uint64_t  submitDelta = commandStart - commandSubmit;
+    const uint64_t  executeDelta = commandEnd - commandStart;
+
+    SSubmitLatencyStats*    statsList[] = {
+        &m_SubmitLatencyQueueStatsMap[ queueName.str() ],
+        &m_SubmitLatencyCommandStatsMap[ enumName().name( commandType ) ],
+        &m_SubmitLatencyPatternStatsMap[ pattern ],
+    };
+
+    for( size_t s = 0; s < sizeof(statsList) / sizeof(statsList[0]); s++ )
+    {
+        SSubmitLatencyStats&    stats = *statsList[s];
+
+        stats.NumberOfCommands++;
+        stats.QueuedNS += queuedDelta;
+        stats.SubmitNS += submitDelta;
+        stats.ExecuteNS += executeDelta;
+
+        AddLog2Histogram(
+            stats.QueuedHistogram,
+            SUBMIT_LATENCY_HISTOGRAM_BUCKETS,
+            queuedDelta );
+        AddLog2Histogram(
+            stats.SubmitHistogram,
+            SUBMIT_LATENCY_HISTOGRAM_BUCKETS,
+            submitDelta );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::writeSubmitLatencyStats(
+    std::ostream& os,
+    const std::string& title,
+    const CSubmitLatencyStatsMap& statsMap ) const
+{
+    size_t  longestName = title.length();
+
+    CSubmitLatencyStatsMap::const_iterator i = statsMap.begin();
+    while( i != statsMap.end() )
+    {
+        longestName = std::max< size_t >( i->first.length(), longestName );
+        ++i;
+    }
+
+    os << std::endl
+        << std::right << std::setw(longestName) << title << ", "
+        << std::setw( 8) << "Commands" << ", "
+        << std::setw(13) << "Avg Queued ns" << ", "
+        << std::setw(13) << "P50 Queued ns" << ", "
+        << std::setw(13) << "P90 Queued ns" << ", "
+        << std::setw(13) << "Avg Submit ns" << ", "
+        << std::setw(13) << "P50 Submit ns" << ", "
+        << std::setw(13) << "P90 Submit ns" << ", "
+        << std::setw(10) << "Latency %" << std::endl;
+
+    i = statsMap.begin();
+    while( i != statsMap.end() )
+    {
+        const SSubmitLatencyStats&  stats = i->second;
+
+        const uint64_t  totalNS = stats.QueuedNS + stats.SubmitNS + stats.ExecuteNS;
+        const double    latencyShare = totalNS ?
+            100.0 * (double)( stats.QueuedNS + stats.SubmitNS ) / (double)totalNS :
+            0.0;
+
+        os << std::right << std::setw(longestName) << i->first << ", "
+            << std::setw( 8) << stats.NumberOfCommands << ", "
+            << std::setw(13) << stats.QueuedNS / stats.NumberOfCommands << ", "
+            << std::setw(13) << GetLog2HistogramPercentile(
+                stats.QueuedHistogram, SUBMIT_LATENCY_HISTOGRAM_BUCKETS,
+                stats.NumberOfCommands, 50 ) << ", "
+            << std::setw(13) << GetLog2HistogramPercentile(
+                stats.QueuedHistogram, SUBMIT_LATENCY_HISTOGRAM_BUCKETS,
+                stats.NumberOfCommands, 90 ) << ", "
+            << std::setw(13) << stats.SubmitNS / stats.NumberOfCommands << ", "
+            << std::setw(13) << GetLog2HistogramPercentile(
+                stats.SubmitHistogram, SUBMIT_LATENCY_HISTOGRAM_BUCKETS,
+                stats.NumberOfCommands, 50 ) << ", "
+            << std::setw(13) << GetLog2HistogramPercentile(
+                stats.SubmitHistogram, SUBMIT_LATENCY_HISTOGRAM_BUCKETS,
+                stats.NumberOfCommands, 90 ) << ", "
+            << std::setw( 9) << std::fixed << std::setprecision(2) << latencyShare << "%"
+            << std::endl;
+
+        ++i;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+CLIntercept::SSyncThreadState& CLIntercept::syncThreadState()
+{
+    static thread_local SSyncThreadState    threadState;
+    return threadState;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+CLIntercept::SSyncQueueState& CLIntercept::getSyncQueueState(
+    cl_command_queue queue )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    CSyncQueueStateMap::iterator iter = m_SyncQueueStateMap.find( queue );
+    if( iter != m_SyncQueueStateMap.end() )
+    {
+        return iter->second;
+    }
+
+    SSyncQueueState&    state = m_SyncQueueStateMap[ queue ];
+
+    cl_command_queue_properties props = 0;
+    dispatch().clGetCommandQueueInfo(
+        queue,
+        CL_QUEUE_PROPERTIES,
+        sizeof(props),
+        &props,
+        NULL );
+    state.InOrder = ( props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE ) == 0;
+
+    return state;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
-void CLIntercept::checkTimingEvents()
+void CLIntercept::addRedundantSync(
+    const std::string& finding,
+    uint64_t hostNS )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    // Note: This function assumes the mutex is already locked.
 
-    CEventList::iterator    current = m_EventList.begin();
-    CEventList::iterator    next;
+    SRedundantSyncStats& stats = m_RedundantSyncStatsMap[ finding ];
+    stats.NumberOfCalls++;
+    stats.HostNS += hostNS;
+}
 
-    while( current != m_EventList.end() )
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::redundantSyncEnqueue(
+    cl_command_queue queue,
+    bool blocking )
+{
+    SSyncThreadState&   threadState = syncThreadState();
+
+    // If this thread's last blocking read returned only a short time ago,
+    // the application probably did not process the results of the read
+    // before it started enqueueing more work, so the read may not have
+    // needed to be blocking.  This is only a heuristic: it cannot tell
+    // whether the host used the results.
+    uint64_t    quickReadNS = 0;
+    bool        quickRead = false;
+    if( threadState.PendingRead )
     {
-        cl_int  errorCode = CL_SUCCESS;
-        cl_int  eventStatus = 0;
+        using us = std::chrono::microseconds;
+        const uint64_t  gapUS =
+            std::chrono::duration_cast<us>(clock::now() - threadState.ReturnTime).count();
+        quickRead = gapUS < config().RedundantSyncReadGapMicroseconds;
+        quickReadNS = threadState.BlockingNS;
+        threadState.PendingRead = false;
+    }
 
-        next = current;
-        ++next;
+    if( !quickRead &&
+        !blocking &&
+        threadState.Queue == queue &&
+        threadState.Epoch == m_SyncEpoch.load() )
+    {
+        return;
+    }
 
-        const SEventListNode& node = *current;
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-        errorCode = dispatch().clGetEventInfo(
-            node.Event,
-            CL_EVENT_COMMAND_EXECUTION_STATUS,
-            sizeof( eventStatus ),
-            &eventStatus,
-            NULL );
+    if( quickRead )
+    {
+        addRedundantSync(
+            "Blocking read quickly followed by an enqueue (heuristic)",
+            quickReadNS );
+    }
 
-        switch( errorCode )
-        {
-        case CL_SUCCESS:
-            if( eventStatus == CL_COMPLETE )
-            {
-                if( config().DevicePerformanceTiming ||
-                    config().ITTPerformanceTiming ||
-                    config().ChromePerformanceTiming )
-                {
-                    cl_ulong    commandQueued = 0;
-                    cl_ulong    commandSubmit = 0;
-                    cl_ulong    commandStart = 0;
-                    cl_ulong    commandEnd = 0;
+    SSyncQueueState&    state = getSyncQueueState( queue );
 
-                    errorCode |= dispatch().clGetEventProfilingInfo(
-                        node.Event,
-                        CL_PROFILING_COMMAND_QUEUED,
-                        sizeof( commandQueued ),
-                        &commandQueued,
-                        NULL );
-                    errorCode |= dispatch().clGetEventProfilingInfo(
-                        node.Event,
-                        CL_PROFILING_COMMAND_SUBMIT,
-                        sizeof( commandSubmit ),
-                        &commandSubmit,
-                        NULL );
-                    errorCode |= dispatch().clGetEventProfilingInfo(
-                        node.Event,
-                        CL_PROFILING_COMMAND_START,
-                        sizeof( commandStart ),
-                        &commandStart,
-                        NULL );
-                    errorCode |= dispatch().clGetEventProfilingInfo(
-                        node.Event,
-                        CL_PROFILING_COMMAND_END,
-                        sizeof( commandEnd ),
-                        &commandEnd,
-                        NULL );
-                    if( errorCode == CL_SUCCESS )
-                    {
-                        cl_ulong delta = commandEnd - commandStart;
+    // A blocking call implicitly flushes the queue.
+    if( blocking && state.Flushed )
+    {
+        addRedundantSync(
+            "clFlush followed by a blocking call",
+            state.FlushNS );
+    }
+    state.Flushed = false;
 
-                        const std::string&  name =
-                            node.KernelName.empty() ?
-                            node.FunctionName :
-                            node.KernelName;
+    // Once a blocking command completes on an in-order queue, all
+    // previously enqueued commands have completed also.
+    if( blocking && state.InOrder )
+    {
+        state.Outstanding = 0;
+        m_SyncEpoch++;
+    }
+    else
+    {
+        state.Outstanding++;
+    }
 
-                        SDeviceTimingStats& deviceTimingStats = m_DeviceTimingStatsMap[node.Device][name];
+    threadState.Queue = queue;
+    threadState.Epoch = m_SyncEpoch.load();
+}
 
-                        deviceTimingStats.NumberOfCalls++;
-                        deviceTimingStats.TotalNS += delta;
-                        deviceTimingStats.MinNS = std::min< cl_ulong >( deviceTimingStats.MinNS, delta );
-                        deviceTimingStats.MaxNS = std::max< cl_ulong >( deviceTimingStats.MaxNS, delta );
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::redundantSyncReleaseQueue(
+    cl_command_queue queue )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-                        //uint64_t    numberOfCalls = deviceTimingStats.NumberOfCalls;
+    if( getRefCount( queue ) == 1 )
+    {
+        m_SyncQueueStateMap.erase( queue );
+        m_SyncEpoch++;
+    }
+}
 
-                        if( config().DevicePerformanceTimeLogging )
-                        {
-                            cl_ulong    queuedDelta = commandSubmit - commandQueued;
-                            cl_ulong    submitDelta = commandStart - commandSubmit;
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::redundantSyncBlockingRead(
+    clock::time_point start,
+    clock::time_point end )
+{
+    SSyncThreadState&   threadState = syncThreadState();
+    threadState.PendingRead = true;
+    threadState.ReturnTime = end;
+    threadState.BlockingNS =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
 
-                            std::ostringstream  ss;
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::redundantSyncFlush(
+    cl_command_queue queue,
+    clock::time_point start,
+    clock::time_point end )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-                            ss << "Device Time for "
-                                //<< "call " << numberOfCalls << " to "
-                                << name << " (enqueue " << node.EnqueueCounter << ") = "
-                                << queuedDelta << " ns (queued -> submit), "
-                                << submitDelta << " ns (submit -> start), "
-                                << delta << " ns (start -> end)\n";
+    SSyncQueueState&    state = getSyncQueueState( queue );
+    state.Flushed = true;
+    state.FlushNS =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    m_SyncEpoch++;
+}
 
-                            log( ss.str() );
-                        }
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::redundantSyncFinish(
+    cl_command_queue queue,
+    clock::time_point start,
+    clock::time_point end )
+{
+    syncThreadState().PendingRead = false;
 
-                        if( config().DevicePerformanceTimelineLogging )
-                        {
-                            std::ostringstream  ss;
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-                            ss << "Device Timeline for "
-                                //<< "call " << numberOfCalls << " to "
-                                << name << " (enqueue " << node.EnqueueCounter << ") = "
-                                << commandQueued << " ns (queued), "
-                                << commandSubmit << " ns (submit), "
-                                << commandStart << " ns (start), "
-                                << commandEnd << " ns (end)\n";
+    SSyncQueueState&    state = getSyncQueueState( queue );
 
-                            log( ss.str() );
-                        }
-                    }
-                }
+    if( state.Outstanding == 0 )
+    {
+        addRedundantSync(
+            "clFinish with no outstanding commands",
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() );
+    }
+    if( state.Flushed )
+    {
+        addRedundantSync(
+            "clFlush followed by a blocking call",
+            state.FlushNS );
+    }
 
-#if defined(USE_ITT)
-                if( config().ITTPerformanceTiming )
-                {
-                    const std::string& name =
-                        node.KernelName.empty() ?
-                        node.FunctionName :
-                        node.KernelName;
+    state.Outstanding = 0;
+    state.Flushed = false;
+    m_SyncEpoch++;
+}
 
-                    ittTraceEvent(
-                        name,
-                        node.Event,
-                        node.QueuedTime );
-                }
-#endif
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CLIntercept::redundantSyncEventsComplete(
+    cl_uint numEvents,
+    const cl_event* eventList )
+{
+    if( eventList == NULL )
+    {
+        return false;
+    }
 
-                if( config().ChromePerformanceTiming )
-                {
-                    const std::string& name =
-                        node.KernelName.empty() ?
-                        node.FunctionName :
-                        node.KernelName;
+    for( cl_uint i = 0; i < numEvents; i++ )
+    {
+        cl_int  eventStatus = CL_QUEUED;
+        dispatch().clGetEventInfo(
+            eventList[i],
+            CL_EVENT_COMMAND_EXECUTION_STATUS,
+            sizeof( eventStatus ),
+            &eventStatus,
+            NULL );
+        if( eventStatus != CL_COMPLETE )
+        {
+            return false;
+        }
+    }
 
-                    chromeTraceEvent(
-                        name,
-                        node.EnqueueCounter,
-                        node.QueueNumber,
-                        node.Event,
-                        node.QueuedTime );
-                }
+    return numEvents != 0;
+}
 
-#if defined(USE_MDAPI)
-                if( config().DevicePerfCounterEventBasedSampling )
-                {
-                    const std::string& name =
-                        node.KernelName.empty() ?
-                        node.FunctionName :
-                        node.KernelName;
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::redundantSyncWait(
+    bool eventsComplete,
+    clock::time_point start,
+    clock::time_point end )
+{
+    syncThreadState().PendingRead = false;
 
-                    getMDAPICountersFromEvent(
-                        name,
-                        node.Event );
-                }
-#endif
+    if( eventsComplete )
+    {
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
-                dispatch().clReleaseEvent( node.Event );
+        addRedundantSync(
+            "clWaitForEvents with all events complete",
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() );
+    }
+}
 
-                m_EventList.erase( current );
-            }
-            break;
-        case CL_INVALID_EVENT:
-            {
-                // This is unexpected.  We retained the event when we
-                // added it to the list.  Remove the event from the
-                // list.
-                logf( "Unexpectedly got CL_INVALID_EVENT for an event from %s!\n",
-                    node.FunctionName.c_str() );
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::redundantSyncBarrier(
+    const std::string& functionName,
+    cl_command_queue queue,
+    cl_uint numEvents,
+    const cl_event* eventList,
+    const cl_event* event,
+    clock::time_point start,
+    clock::time_point end )
+{
+    // A barrier or marker that returns an event may be used for
+    // synchronization by the application.
+    if( event != NULL )
+    {
+        return;
+    }
 
-                m_EventList.erase( current );
-            }
-            break;
-        default:
-            // nothing
-            break;
+    // Any dependency on an event from another queue, or on a user event,
+    // is a cross-queue hazard that requires the barrier or marker.
+    for( cl_uint i = 0; eventList && i < numEvents; i++ )
+    {
+        cl_command_queue    eventQueue = NULL;
+        dispatch().clGetEventInfo(
+            eventList[i],
+            CL_EVENT_COMMAND_QUEUE,
+            sizeof( eventQueue ),
+            &eventQueue,
+            NULL );
+        if( eventQueue != queue )
+        {
+            return;
         }
-
-        current = next;
     }
 
-#if defined(USE_MDAPI)
-    if( config().DevicePerfCounterTimeBasedSampling )
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    SSyncQueueState&    state = getSyncQueueState( queue );
+    if( state.InOrder )
     {
-        getMDAPICountersFromStream();
+        addRedundantSync(
+            functionName + " on an in-order queue",
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() );
     }
-#endif
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -5795,7 +12181,7 @@ cl_command_queue CLIntercept::getCommandBufferCommandQueue(
         return queues[0];
     }
 
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_command_queue    queue = NULL;
 
@@ -5907,13 +12293,17 @@ void CLIntercept::addKernelInfo(
     const cl_program program,
     const std::string& kernelName )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
 
     SKernelInfo& kernelInfo = m_KernelInfoMap[ kernel ];
 
     kernelInfo.KernelName = kernelName;
+    if( kernelName == m_Config.CaptureWindowStartKernelName )
+    {
+        m_CaptureWindowStartKernelCreated.store( true );
+    }
 
     kernelInfo.ProgramHash = programInfo.ProgramHash;
     kernelInfo.OptionsHash = programInfo.OptionsHash;
@@ -5931,7 +12321,7 @@ void CLIntercept::addKernelInfo(
     const cl_program program,
     cl_uint numKernels )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
 
@@ -5966,6 +12356,10 @@ void CLIntercept::addKernelInfo(
                     SKernelInfo& kernelInfo = m_KernelInfoMap[ kernel ];
 
                     kernelInfo.KernelName = kernelName;
+                    if( kernelInfo.KernelName == m_Config.CaptureWindowStartKernelName )
+                    {
+                        m_CaptureWindowStartKernelCreated.store( true );
+                    }
 
                     kernelInfo.ProgramHash = programInfo.ProgramHash;
                     kernelInfo.OptionsHash = programInfo.OptionsHash;
@@ -5986,7 +12380,7 @@ void CLIntercept::addKernelInfo(
 //
 void CLIntercept::checkRemoveKernelInfo( cl_kernel kernel )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_uint refCount = getRefCount( kernel );
     if( refCount == 1 )
@@ -5999,6 +12393,8 @@ void CLIntercept::checkRemoveKernelInfo( cl_kernel kernel )
 #endif
 
         m_KernelInfoMap.erase( kernel );
+        m_ScalarArgMap.erase( kernel );
+        m_RedundantKernelArgsMap.erase( kernel );
     }
 }
 
@@ -6010,7 +12406,7 @@ void CLIntercept::addAcceleratorInfo(
 {
     if( accelerator )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         m_AcceleratorInfoMap[accelerator] = getPlatform(context);
     }
@@ -6021,7 +12417,7 @@ void CLIntercept::addAcceleratorInfo(
 void CLIntercept::checkRemoveAcceleratorInfo(
     cl_accelerator_intel accelerator )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     CAcceleratorInfoMap::iterator iter = m_AcceleratorInfoMap.find( accelerator );
     if( iter != m_AcceleratorInfoMap.end() )
@@ -6062,7 +12458,7 @@ void CLIntercept::addSemaphoreInfo(
 {
     if( semaphore )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         m_SemaphoreInfoMap[semaphore] = getPlatform(context);
     }
@@ -6073,7 +12469,7 @@ void CLIntercept::addSemaphoreInfo(
 void CLIntercept::checkRemoveSemaphoreInfo(
     cl_semaphore_khr semaphore )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     CSemaphoreInfoMap::iterator iter = m_SemaphoreInfoMap.find( semaphore );
     if( iter != m_SemaphoreInfoMap.end() )
@@ -6113,7 +12509,7 @@ void CLIntercept::addCommandBufferInfo(
 {
     if( cmdbuf )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         m_CommandBufferInfoMap[cmdbuf] = getPlatform(queue);
     }
@@ -6124,7 +12520,7 @@ void CLIntercept::addCommandBufferInfo(
 void CLIntercept::checkRemoveCommandBufferInfo(
     cl_command_buffer_khr cmdbuf)
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     CCommandBufferInfoMap::iterator iter = m_CommandBufferInfoMap.find( cmdbuf );
     if( iter != m_CommandBufferInfoMap.end() )
@@ -6164,7 +12560,7 @@ void CLIntercept::addSamplerString(
 {
     if( sampler )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
         m_SamplerDataMap[sampler] = str;
     }
 }
@@ -6174,7 +12570,7 @@ void CLIntercept::addSamplerString(
 void CLIntercept::checkRemoveSamplerString(
     cl_sampler sampler )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_uint refCount = getRefCount( sampler );
     if( refCount == 1 )
@@ -6215,7 +12611,7 @@ void CLIntercept::addQueue(
 {
     if( queue )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         m_QueueNumberMap[ queue ] = m_QueueNumber + 1;  // should be nonzero
         m_QueueNumber++;
@@ -6229,7 +12625,7 @@ void CLIntercept::addQueue(
 void CLIntercept::checkRemoveQueue(
     cl_command_queue queue )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_uint refCount = getRefCount( queue );
     if( refCount == 1 )
@@ -6265,7 +12661,7 @@ void CLIntercept::addEvent(
 {
     if( event )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         m_EventIdMap[ event ] = enqueueCounter;
     }
@@ -6276,7 +12672,7 @@ void CLIntercept::addEvent(
 void CLIntercept::checkRemoveEvent(
     cl_event event )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_uint refCount = getRefCount( event );
     if( refCount == 1 )
@@ -6292,7 +12688,7 @@ void CLIntercept::addBuffer(
 {
     if( buffer )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         cl_int  errorCode = CL_SUCCESS;
         size_t  size = 0;
@@ -6320,7 +12716,7 @@ void CLIntercept::addImage(
 {
     if( image )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         cl_int  errorCode = CL_SUCCESS;
 
@@ -6412,7 +12808,7 @@ void CLIntercept::addImage(
 void CLIntercept::checkRemoveMemObj(
     cl_mem memobj )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_uint refCount = getRefCount( memobj );
     if( refCount == 1 )
@@ -6420,6 +12816,7 @@ void CLIntercept::checkRemoveMemObj(
         m_MemAllocNumberMap.erase( memobj );
         m_BufferInfoMap.erase( memobj );
         m_ImageInfoMap.erase( memobj );
+        m_WriteGenerationMap.erase( memobj );
     }
 }
 
@@ -6427,15 +12824,21 @@ void CLIntercept::checkRemoveMemObj(
 //
 void CLIntercept::addSVMAllocation(
     void* svmPtr,
-    size_t size )
+    size_t size,
+    bool hostAccessible )
 {
     if( svmPtr )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         m_MemAllocNumberMap[ svmPtr ] = m_MemAllocNumber;
         m_SVMAllocInfoMap[ svmPtr ] = size;
         m_MemAllocNumber++;
+
+        if( hostAccessible )
+        {
+            m_HostAccessibleAllocationSet.insert( svmPtr );
+        }
     }
 }
 
@@ -6444,25 +12847,33 @@ void CLIntercept::addSVMAllocation(
 void CLIntercept::removeSVMAllocation(
     void* svmPtr )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     m_MemAllocNumberMap.erase( svmPtr );
     m_SVMAllocInfoMap.erase( svmPtr );
+    m_WriteGenerationMap.erase( svmPtr );
+    m_HostAccessibleAllocationSet.erase( svmPtr );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
 void CLIntercept::addUSMAllocation(
     void* usmPtr,
-    size_t size )
+    size_t size,
+    bool hostAccessible )
 {
     if( usmPtr )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         m_MemAllocNumberMap[ usmPtr ] = m_MemAllocNumber;
         m_USMAllocInfoMap[ usmPtr ] = size;
         m_MemAllocNumber++;
+
+        if( hostAccessible )
+        {
+            m_HostAccessibleAllocationSet.insert( usmPtr );
+        }
     }
 }
 
@@ -6471,10 +12882,12 @@ void CLIntercept::addUSMAllocation(
 void CLIntercept::removeUSMAllocation(
     void* usmPtr )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     m_MemAllocNumberMap.erase( usmPtr );
     m_USMAllocInfoMap.erase( usmPtr );
+    m_WriteGenerationMap.erase( usmPtr );
+    m_HostAccessibleAllocationSet.erase( usmPtr );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -6482,15 +12895,65 @@ void CLIntercept::removeUSMAllocation(
 void CLIntercept::setKernelArg(
     cl_kernel kernel,
     cl_uint arg_index,
-    cl_mem memobj )
+    size_t arg_size,
+    const void* arg_value )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    cl_mem  memobj = NULL;
+    if( arg_value != NULL && arg_size == sizeof(cl_mem) )
+    {
+        memobj = ((const cl_mem*)arg_value)[0];
+    }
+
+    {
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+        CAutoOutOfOrderArgIndexMap::iterator unknown =
+            m_AutoOutOfOrderUnknownArgs.find( kernel );
+        if( unknown != m_AutoOutOfOrderUnknownArgs.end() )
+        {
+            unknown->second.erase( arg_index );
+        }
 
-    if( m_MemAllocNumberMap.find( memobj ) != m_MemAllocNumberMap.end() )
+        if( m_MemAllocNumberMap.find( memobj ) != m_MemAllocNumberMap.end() )
+        {
+            CKernelArgMemMap&   kernelArgMap = m_KernelArgMap[ kernel ];
+            kernelArgMap[ arg_index ] = memobj;
+            return;
+        }
+
+        // Remove any previous memory object for this argument.
+        CKernelArgMap::iterator args = m_KernelArgMap.find( kernel );
+        if( args != m_KernelArgMap.end() )
+        {
+            args->second.erase( arg_index );
+        }
+
+        if( !m_Config.AutoOutOfOrderQueue || memobj == NULL )
+        {
+            return;
+        }
+    }
+
+    // This argument may be a memory object that is not tracked, such as a
+    // pipe, unless the kernel argument info says that it is passed by value.
+    // Kernel argument info is optional, so if it is not available assume
+    // that the argument is memory.
+    cl_kernel_arg_address_qualifier addressQualifier = 0;
+    if( dispatch().clGetKernelArgInfo &&
+        dispatch().clGetKernelArgInfo(
+            kernel,
+            arg_index,
+            CL_KERNEL_ARG_ADDRESS_QUALIFIER,
+            sizeof(addressQualifier),
+            &addressQualifier,
+            NULL ) == CL_SUCCESS &&
+        addressQualifier == CL_KERNEL_ARG_ADDRESS_PRIVATE )
     {
-        CKernelArgMemMap&   kernelArgMap = m_KernelArgMap[ kernel ];
-        kernelArgMap[ arg_index ] = memobj;
+        return;
     }
+
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+    m_AutoOutOfOrderUnknownArgs[ kernel ].insert( arg_index );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -6500,27 +12963,38 @@ void CLIntercept::setKernelArgSVMPointer(
     cl_uint arg_index,
     const void* arg )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     // Unlike clSetKernelArg(), which must pass a cl_mem, clSetKernelArgSVMPointer
     // can pass a pointer to the base of a SVM allocation or anywhere inside of
     // an SVM allocation.  As a result, we need to search the SVM map to find the
     // base address and size of the SVM allocation.
 
+    CAutoOutOfOrderArgIndexMap::iterator unknown =
+        m_AutoOutOfOrderUnknownArgs.find( kernel );
+    if( unknown != m_AutoOutOfOrderUnknownArgs.end() )
+    {
+        unknown->second.erase( arg_index );
+    }
+
     CKernelArgMemMap&   kernelArgMap = m_KernelArgMap[ kernel ];
 
-    CSVMAllocInfoMap::iterator iter = m_SVMAllocInfoMap.lower_bound( arg );
-    if( iter->first != arg && iter != m_SVMAllocInfoMap.begin() )
+    // Record the pointer itself if it is not in a known allocation, so
+    // a previous argument value does not remain in the map.
+    kernelArgMap[ arg_index ] = arg;
+
+    CSVMAllocInfoMap::iterator iter = m_SVMAllocInfoMap.upper_bound( arg );
+    if( iter != m_SVMAllocInfoMap.begin() )
     {
         // Go to the previous iterator.
         --iter;
-    }
 
-    const void* startPtr = iter->first;
-    const void* endPtr = (const char*)startPtr + iter->second;
-    if( arg >= startPtr && arg < endPtr )
-    {
-        kernelArgMap[ arg_index ] = startPtr;
+        const void* startPtr = iter->first;
+        const void* endPtr = (const char*)startPtr + iter->second;
+        if( arg >= startPtr && arg < endPtr )
+        {
+            kernelArgMap[ arg_index ] = startPtr;
+        }
     }
 }
 
@@ -6531,23 +13005,257 @@ void CLIntercept::setKernelArgUSMPointer(
     cl_uint arg_index,
     const void* arg )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CAutoOutOfOrderArgIndexMap::iterator unknown =
+        m_AutoOutOfOrderUnknownArgs.find( kernel );
+    if( unknown != m_AutoOutOfOrderUnknownArgs.end() )
+    {
+        unknown->second.erase( arg_index );
+    }
 
     CKernelArgMemMap&   kernelArgMap = m_KernelArgMap[ kernel ];
 
-    CUSMAllocInfoMap::iterator iter = m_USMAllocInfoMap.lower_bound( arg );
-    if( iter->first != arg && iter != m_USMAllocInfoMap.begin() )
+    // Record the pointer itself if it is not in a known allocation, so
+    // a previous argument value does not remain in the map.
+    kernelArgMap[ arg_index ] = arg;
+
+    CUSMAllocInfoMap::iterator iter = m_USMAllocInfoMap.upper_bound( arg );
+    if( iter != m_USMAllocInfoMap.begin() )
     {
         // Go to the previous iterator.
         --iter;
+
+        const void* startPtr = iter->first;
+        const void* endPtr = (const char*)startPtr + iter->second;
+        if( arg >= startPtr && arg < endPtr )
+        {
+            kernelArgMap[ arg_index ] = startPtr;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::setKernelArgScalar(
+    cl_kernel kernel,
+    cl_uint arg_index,
+    size_t arg_size,
+    const void* arg_value )
+{
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    CScalarArgList& argList = getScalarArgList( kernel );
+    for( size_t i = 0; i < argList.size(); i++ )
+    {
+        SScalarArg& arg = argList[i];
+        if( arg.Index == arg_index )
+        {
+            // Only scalar arguments up to 64 bits are tracked.  Larger
+            // arguments, such as structs and vectors, are not.
+            arg.IsSet = false;
+            if( arg_value != NULL &&
+                arg_size > 0 &&
+                arg_size <= sizeof(arg.Value) )
+            {
+                arg.IsSet = true;
+                arg.Size = arg_size;
+                arg.Value = 0;
+                CLI_MEMCPY(
+                    &arg.Value,
+                    sizeof(arg.Value),
+                    arg_value,
+                    arg_size );
+            }
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+CLIntercept::CScalarArgList& CLIntercept::getScalarArgList(
+    cl_kernel kernel )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    CScalarArgMap::iterator iter = m_ScalarArgMap.find( kernel );
+    if( iter != m_ScalarArgMap.end() )
+    {
+        return iter->second;
+    }
+
+    CScalarArgList& argList = m_ScalarArgMap[ kernel ];
+
+    CKernelInfoMap::const_iterator kernelIter = m_KernelInfoMap.find( kernel );
+    if( kernelIter == m_KernelInfoMap.end() )
+    {
+        return argList;
+    }
+
+    const std::string&  kernelName = kernelIter->second.KernelName;
+
+    cl_uint numArgs = 0;
+    dispatch().clGetKernelInfo(
+        kernel,
+        CL_KERNEL_NUM_ARGS,
+        sizeof(numArgs),
+        &numArgs,
+        NULL );
+
+    // The tracking string is a semicolon-separated list of
+    // <kernel name>:<argument> pairs.
+    std::istringstream  specs( config().DevicePerformanceTimeScalarArgTracking );
+    std::string spec;
+    while( std::getline( specs, spec, ';' ) )
+    {
+        size_t  colon = spec.rfind( ':' );
+        if( colon == std::string::npos )
+        {
+            continue;
+        }
+
+        const std::string   specKernel = spec.substr( 0, colon );
+        const std::string   specArg = spec.substr( colon + 1 );
+        if( specArg.empty() ||
+            ( specKernel != "*" && specKernel != kernelName ) )
+        {
+            continue;
+        }
+
+        bool    isIndex =
+            specArg.find_first_not_of( "0123456789" ) == std::string::npos;
+        for( cl_uint index = 0; index < numArgs; index++ )
+        {
+            char    name[256] = "";
+            dispatch().clGetKernelArgInfo(
+                kernel,
+                index,
+                CL_KERNEL_ARG_NAME,
+                sizeof(name),
+                name,
+                NULL );
+            name[sizeof(name) - 1] = 0;
+
+            if( ( isIndex && index == (cl_uint)strtoul( specArg.c_str(), NULL, 10 ) ) ||
+                ( !isIndex && specArg == name ) )
+            {
+                bool    found = false;
+                for( size_t i = 0; i < argList.size(); i++ )
+                {
+                    found = found || argList[i].Index == index;
+                }
+                if( found )
+                {
+                    continue;
+                }
+
+                char    typeName[256] = "";
+                dispatch().clGetKernelArgInfo(
+                    kernel,
+                    index,
+                    CL_KERNEL_ARG_TYPE_NAME,
+                    sizeof(typeName),
+                    typeName,
+                    NULL );
+                typeName[sizeof(typeName) - 1] = 0;
+
+                argList.emplace_back();
+
+                SScalarArg& arg = argList.back();
+                arg.Index = index;
+                arg.Name = name[0] ? name : "arg" + std::to_string(index);
+                arg.TypeName = typeName;
+            }
+        }
+    }
+
+    return argList;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+std::string CLIntercept::getScalarArgString(
+    cl_kernel kernel )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    CScalarArgMap::const_iterator iter = m_ScalarArgMap.find( kernel );
+    if( iter == m_ScalarArgMap.end() || iter->second.empty() )
+    {
+        return "";
+    }
+
+    CKernelInfoMap::const_iterator kernelIter = m_KernelInfoMap.find( kernel );
+    if( kernelIter == m_KernelInfoMap.end() )
+    {
+        return "";
     }
 
-    const void* startPtr = iter->first;
-    const void* endPtr = (const char*)startPtr + iter->second;
-    if( arg >= startPtr && arg < endPtr )
+    const CScalarArgList&   argList = iter->second;
+    const std::string&  kernelName = kernelIter->second.KernelName;
+
+    std::ostringstream  ss;
+    ss << " ARGS[ ";
+    for( size_t i = 0; i < argList.size(); i++ )
     {
-        kernelArgMap[ arg_index ] = startPtr;
+        const SScalarArg&   arg = argList[i];
+
+        std::ostringstream  value;
+        if( !arg.IsSet )
+        {
+            value << "?";
+        }
+        else if( arg.TypeName == "float" && arg.Size == sizeof(cl_float) )
+        {
+            cl_float    f = 0;
+            CLI_MEMCPY( &f, sizeof(f), &arg.Value, sizeof(f) );
+            value << f;
+        }
+        else if( arg.TypeName == "double" && arg.Size == sizeof(cl_double) )
+        {
+            cl_double   d = 0;
+            CLI_MEMCPY( &d, sizeof(d), &arg.Value, sizeof(d) );
+            value << d;
+        }
+        else if( arg.TypeName == "char" ||
+                 arg.TypeName == "short" ||
+                 arg.TypeName == "int" ||
+                 arg.TypeName == "long" )
+        {
+            // Sign extend the argument value.
+            const unsigned int  shift = (unsigned int)( 64 - 8 * arg.Size );
+            value << ( (int64_t)( arg.Value << shift ) >> shift );
+        }
+        else
+        {
+            value << arg.Value;
+        }
+
+        // Only track a limited number of distinct values for each argument,
+        // so the number of device timing keys cannot grow without bound.
+        std::set<std::string>&  values =
+            m_ScalarArgValuesMap[ kernelName + ":" + arg.Name ];
+        if( values.find( value.str() ) == values.end() )
+        {
+            if( values.size() < config().DevicePerformanceTimeScalarArgMaxValues )
+            {
+                values.insert( value.str() );
+            }
+            else
+            {
+                value.str( "*" );
+            }
+        }
+
+        if( i != 0 )
+        {
+            ss << ", ";
+        }
+        ss << arg.Name << "=" << value.str();
     }
+    ss << " ]";
+
+    return ss.str();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -6558,11 +13266,10 @@ void CLIntercept::dumpBuffersForKernel(
     cl_kernel kernel,
     cl_command_queue command_queue )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_platform_id  platform = getPlatform(kernel);
 
-    std::vector<char>   transferBuf;
     std::string fileNamePrefix = "";
 
     // Get the dump directory name.
@@ -6643,19 +13350,21 @@ void CLIntercept::dumpBuffersForKernel(
                         platform,
                         "clEnqueueMemcpyINTEL" );
                 }
-                if( transferBuf.size() < size )
+                if( m_DumpStagingBufferSize < size )
                 {
-                    transferBuf.resize(size);
+                    freeHostMemory( m_DumpStagingBuffer );
+                    m_DumpStagingBuffer = (char*)allocateHostMemory( size );
+                    m_DumpStagingBufferSize = m_DumpStagingBuffer ? size : 0;
                 }
 
                 auto dispatchX = this->dispatchX(platform);
                 if( dispatchX.clEnqueueMemcpyINTEL &&
-                    transferBuf.size() >= size )
+                    m_DumpStagingBufferSize >= size )
                 {
                     cl_int  error = dispatchX.clEnqueueMemcpyINTEL(
                         command_queue,
                         CL_TRUE,
-                        transferBuf.data(),
+                        m_DumpStagingBuffer,
                         allocation,
                         size,
                         0,
@@ -6670,7 +13379,7 @@ void CLIntercept::dumpBuffersForKernel(
 
                         if( os.good() )
                         {
-                            os.write( transferBuf.data(), size );
+                            os.write( m_DumpStagingBuffer, size );
                             os.close();
                         }
                         else
@@ -6775,7 +13484,7 @@ void CLIntercept::dumpImagesForKernel(
     cl_kernel kernel,
     cl_command_queue command_queue )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     std::string fileNamePrefix = "";
 
@@ -6921,7 +13630,7 @@ void CLIntercept::dumpArgument(
 {
     if( kernel )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         std::string fileName = "";
 
@@ -7002,7 +13711,7 @@ void CLIntercept::dumpBuffer(
     size_t offset,
     size_t size )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     if( m_BufferInfoMap.find( memobj ) != m_BufferInfoMap.end() )
     {
@@ -7145,7 +13854,7 @@ void CLIntercept::checkEventList(
 {
     if( numEvents != 0 && eventList == NULL )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
         logf( "Check Events for %s: Num Events is %u, but Event List is NULL!\n",
             functionName.c_str(),
             numEvents );
@@ -7156,7 +13865,7 @@ void CLIntercept::checkEventList(
         {
             if( event != NULL && *event == eventList[i] )
             {
-                std::lock_guard<std::mutex> lock(m_Mutex);
+                CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
                 logf( "Check Events for %s: outgoing event %p is also in the event wait list!\n",
                     functionName.c_str(),
                     eventList[i] );
@@ -7172,7 +13881,7 @@ void CLIntercept::checkEventList(
                 NULL );
             if( errorCode != CL_SUCCESS )
             {
-                std::lock_guard<std::mutex> lock(m_Mutex);
+                CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
                 logf( "Check Events for %s: clGetEventInfo for wait event %p returned %s (%d)!\n",
                     functionName.c_str(),
                     eventList[i],
@@ -7181,7 +13890,7 @@ void CLIntercept::checkEventList(
             }
             else if( eventCommandExecutionStatus < 0 )
             {
-                std::lock_guard<std::mutex> lock(m_Mutex);
+                CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
                 logf( "Check Events for %s: wait event %p is in an error state (%d)!\n",
                     functionName.c_str(),
                     eventList[i],
@@ -7197,7 +13906,7 @@ void CLIntercept::checkKernelArgUSMPointer(
     cl_kernel kernel,
     const void* arg )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_int errorCode = CL_SUCCESS;
 
@@ -7563,7 +14272,7 @@ void CLIntercept::startAubCapture(
 {
     if( m_AubCaptureStarted == false )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         // For kernels, perform aub capture skip checks.  We'll skip aubcapture if:
         // - the current skip counter is less than the specified skip counter, or
@@ -7731,7 +14440,7 @@ void CLIntercept::stopAubCapture(
 {
     if( m_AubCaptureStarted == true )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         if( m_AubCaptureStarted == true )
         {
@@ -7761,12 +14470,180 @@ void CLIntercept::stopAubCapture(
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::checkCaptureWindow(
+    uint64_t enqueueCounter,
+    const cl_kernel kernel )
+{
+    // Check whether the capture window may start or stop without taking the
+    // mutex, so enqueues that do not change the capture window are cheap.
+    const bool  signaled =
+        m_CaptureWindowSignalCount.load() != (uint64_t)s_CaptureWindowSignalCount;
+    const uint64_t  nowNS =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_StartTime).count();
+
+    if( !signaled )
+    {
+        if( m_CaptureWindowActive.load() == false )
+        {
+            if( m_CaptureWindowTriggered.load() ||
+                ( m_Config.CaptureWindowStartSeconds == 0 &&
+                  m_Config.CaptureWindowStartKernelName.empty() ) ||
+                ( m_Config.CaptureWindowStartSeconds &&
+                  nowNS < (uint64_t)m_Config.CaptureWindowStartSeconds * 1000000000 ) ||
+                ( !m_Config.CaptureWindowStartKernelName.empty() &&
+                  ( kernel == NULL || !m_CaptureWindowStartKernelCreated.load() ) ) )
+            {
+                return;
+            }
+        }
+        else
+        {
+            if( ( m_Config.CaptureWindowDurationSeconds == 0 ||
+                  nowNS - m_CaptureWindowStartNS.load() <
+                    (uint64_t)m_Config.CaptureWindowDurationSeconds * 1000000000 ) &&
+                ( m_Config.CaptureWindowEnqueueCount == 0 ||
+                  enqueueCounter - m_CaptureWindowStartEnqueue.load() <
+                    m_Config.CaptureWindowEnqueueCount ) )
+            {
+                return;
+            }
+        }
+    }
+
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    // Each signal toggles the capture window.  The state may have changed
+    // since it was checked without the mutex, so check it again.
+    const char* reason = NULL;
+    if( m_CaptureWindowSignalCount.load() != (uint64_t)s_CaptureWindowSignalCount )
+    {
+        m_CaptureWindowSignalCount++;
+        reason = "signal";
+    }
+
+    if( m_CaptureWindowActive.load() == false )
+    {
+        if( reason == NULL &&
+            m_CaptureWindowTriggered.load() == false &&
+            ( m_Config.CaptureWindowStartSeconds ||
+              !m_Config.CaptureWindowStartKernelName.empty() ) )
+        {
+            // All of the start conditions that are set must be satisfied.
+            bool    start = true;
+            if( m_Config.CaptureWindowStartSeconds &&
+                nowNS < (uint64_t)m_Config.CaptureWindowStartSeconds * 1000000000 )
+            {
+                start = false;
+            }
+            if( start &&
+                !m_Config.CaptureWindowStartKernelName.empty() )
+            {
+                CKernelInfoMap::const_iterator  iter = m_KernelInfoMap.end();
+                if( kernel )
+                {
+                    iter = m_KernelInfoMap.find( kernel );
+                }
+                if( iter == m_KernelInfoMap.end() ||
+                    iter->second.KernelName != m_Config.CaptureWindowStartKernelName )
+                {
+                    start = false;
+                }
+            }
+            if( start )
+            {
+                reason = kernel ? "kernel name" : "start time";
+            }
+        }
+
+        if( reason )
+        {
+            m_CaptureWindowTriggered.store( true );
+            startCaptureWindow( enqueueCounter, reason );
+        }
+    }
+    else
+    {
+        if( reason == NULL &&
+            m_Config.CaptureWindowDurationSeconds &&
+            nowNS - m_CaptureWindowStartNS.load() >=
+                (uint64_t)m_Config.CaptureWindowDurationSeconds * 1000000000 )
+        {
+            reason = "duration";
+        }
+        else if( reason == NULL &&
+                 m_Config.CaptureWindowEnqueueCount &&
+                 enqueueCounter - m_CaptureWindowStartEnqueue.load() >=
+                    m_Config.CaptureWindowEnqueueCount )
+        {
+            reason = "enqueue count";
+        }
+
+        if( reason )
+        {
+            stopCaptureWindow( enqueueCounter, reason );
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::startCaptureWindow(
+    uint64_t enqueueCounter,
+    const char* reason )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    m_CaptureWindowStartEnqueue.store( enqueueCounter );
+    m_CaptureWindowStartNS.store(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_StartTime).count() );
+    m_CaptureWindowActive.store( true );
+
+    // Threads that were seen before the capture window started were not
+    // named in the Chrome trace, so name them now.
+    if( m_Config.ChromeCallLogging )
+    {
+        CThreadNumberMap::const_iterator i = m_ThreadNumberMap.begin();
+        while( i != m_ThreadNumberMap.end() )
+        {
+            chromeRegisterThread( i->first, i->second );
+            ++i;
+        }
+    }
+
+    logf( "Capture window started at enqueue counter %llu (%s).\n",
+        (unsigned long long)enqueueCounter,
+        reason );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::stopCaptureWindow(
+    uint64_t enqueueCounter,
+    const char* reason )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    m_CaptureWindowActive.store( false );
+
+    const uint64_t  nowNS =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_StartTime).count();
+    const uint64_t  msDelta = ( nowNS - m_CaptureWindowStartNS.load() ) / 1000000;
+
+    logf( "Capture window stopped at enqueue counter %llu (%s) after %llu enqueues and %llu ms.\n",
+        (unsigned long long)enqueueCounter,
+        reason,
+        (unsigned long long)( enqueueCounter - m_CaptureWindowStartEnqueue.load() ),
+        (unsigned long long)msDelta );
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 void CLIntercept::initPrecompiledKernelOverrides(
     const cl_context context )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
     log( "Initializing precompiled kernel overrides...\n" );
 
     cl_int  errorCode = CL_SUCCESS;
@@ -7994,7 +14871,7 @@ void CLIntercept::initPrecompiledKernelOverrides(
 void CLIntercept::initBuiltinKernelOverrides(
     const cl_context context )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
     log( "Initializing builtin kernel overrides...\n" );
 
     cl_int  errorCode = CL_SUCCESS;
@@ -8153,7 +15030,7 @@ cl_program CLIntercept::createProgramWithInjectionBinaries(
     cl_context context,
     cl_int* errcode_ret )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_int      errorCode = CL_SUCCESS;
     cl_program  program = NULL;
@@ -8388,7 +15265,7 @@ cl_program CLIntercept::createProgramWithInjectionBinaries(
 void CLIntercept::dumpProgramBinary(
     const cl_program program )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
 
@@ -8591,7 +15468,7 @@ void CLIntercept::dumpProgramBinary(
 void CLIntercept::dumpKernelISABinaries(
     const cl_program program )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_int  errorCode = CL_SUCCESS;
 
@@ -8801,7 +15678,7 @@ cl_program CLIntercept::createProgramWithInjectionSPIRV(
     cl_context context,
     cl_int* errcode_ret )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_program  program = NULL;
 
@@ -8923,7 +15800,7 @@ void CLIntercept::autoCreateSPIRV(
     const cl_program program,
     const char* raw_options )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     const SProgramInfo& programInfo = m_ProgramInfoMap[ program ];
 
@@ -9362,7 +16239,7 @@ bool CLIntercept::overrideGetPlatformInfo(
     size_t* param_value_size_ret,
     cl_int& errorCode )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     bool    override = false;
 
@@ -9509,7 +16386,7 @@ bool CLIntercept::overrideGetDeviceInfo(
     size_t* param_value_size_ret,
     cl_int& errorCode )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     bool    override = false;
 
@@ -10072,7 +16949,7 @@ cl_int CLIntercept::ReadBuffer(
     const cl_event* eventWaitList,
     cl_event* event )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_int  errorCode = CL_SUCCESS;
 
@@ -10183,7 +17060,7 @@ cl_int CLIntercept::WriteBuffer(
     const cl_event* eventWaitList,
     cl_event* event )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_int  errorCode = CL_SUCCESS;
 
@@ -10274,7 +17151,7 @@ cl_int CLIntercept::CopyBuffer(
     const cl_event* eventWaitList,
     cl_event* event )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_int  errorCode = CL_SUCCESS;
 
@@ -10636,7 +17513,7 @@ cl_int CLIntercept::ReadImage(
     const cl_event* eventWaitList,
     cl_event* event )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_int  errorCode = CL_SUCCESS;
 
@@ -10785,7 +17662,7 @@ cl_int CLIntercept::WriteImage(
     const cl_event* eventWaitList,
     cl_event* event )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_int  errorCode = CL_SUCCESS;
 
@@ -10910,7 +17787,7 @@ cl_int CLIntercept::CopyImage(
     const cl_event* eventWaitList,
     cl_event* event )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_int  errorCode = CL_SUCCESS;
 
@@ -11274,7 +18151,7 @@ cl_int CLIntercept::CopyImageHelper(
 cl_program CLIntercept::createProgramWithBuiltinKernels(
     cl_context context )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_program  program = NULL;
 
@@ -11295,7 +18172,7 @@ cl_kernel CLIntercept::createBuiltinKernel(
     const std::string& kernel_name,
     cl_int* errcode_ret )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_int  errorCode = CL_SUCCESS;
 
@@ -11349,7 +18226,7 @@ cl_int CLIntercept::NDRangeBuiltinKernel(
     const cl_event* event_wait_list,
     cl_event* event )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
     cl_int  errorCode = CL_SUCCESS;
 
     cl_context  context = NULL;
@@ -12187,7 +19064,7 @@ void CLIntercept::ittInit()
 {
     if( m_ITTInitialized == false )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         if( m_ITTInitialized == false )
         {
@@ -12225,7 +19102,7 @@ void CLIntercept::ittCallLoggingEnter(
     std::string str( functionName );
     if( kernel )
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         const std::string& kernelName = getShortKernelNameWithHash(kernel);
         str += "( ";
@@ -12246,7 +19123,7 @@ void CLIntercept::ittRegisterCommandQueue(
     cl_command_queue queue,
     bool supportsPerfCounters )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_int  errorCode = CL_SUCCESS;
 
@@ -12356,7 +19233,7 @@ void CLIntercept::ittRegisterCommandQueue(
 void CLIntercept::ittReleaseCommandQueue(
     cl_command_queue queue )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     if( m_ITTQueueInfoMap.find(queue) != m_ITTQueueInfoMap.end() )
     {
@@ -12531,7 +19408,16 @@ void CLIntercept::chromeCallLoggingExit(
     clock::time_point tickStart,
     clock::time_point tickEnd )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
+
+    const clock::time_point overheadStart =
+        m_Config.OverheadBudgetPercent ? clock::now() : clock::time_point();
+
+    // This can happen if the call did not record a start time.
+    if( tickStart == clock::time_point() )
+    {
+        return;
+    }
 
     std::string name;
     name += functionName;
@@ -12572,6 +19458,56 @@ void CLIntercept::chromeCallLoggingExit(
         << ", \"dur\":" << usDelta
         << args.str()
         << "},\n";
+
+    if( m_Config.LockContentionTracking &&
+        m_Config.LockContentionChromeCounters )
+    {
+        chromeLockContentionCounters( tickEnd );
+    }
+
+    if( m_Config.OverheadBudgetPercent )
+    {
+        addOverheadBudgetTime( overheadStart );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CLIntercept::chromeLockContentionCounters(
+    clock::time_point now )
+{
+    // Note: This function assumes the mutex is already locked.
+
+    const uint64_t  msDelta =
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - m_LockContentionCounterTime).count();
+    if( msDelta < m_Config.LockContentionChromeCounters )
+    {
+        return;
+    }
+
+    const CInstrumentedMutex::SStats&   stats = m_Mutex.getIntervalStats();
+
+    uint64_t    processId =
+        OS().GetProcessID();
+
+    using us = std::chrono::microseconds;
+    uint64_t    usNow =
+        std::chrono::duration_cast<us>(now - m_StartTime).count();
+
+    m_InterceptTrace
+        << "{\"ph\":\"C\", \"pid\":" << processId
+        << ", \"name\":\"Lock Acquisitions\", \"ts\":" << usNow
+        << ", \"args\":{\"Uncontended\":" << stats.NumberOfAcquisitions - stats.NumberOfContendedAcquisitions
+        << ", \"Contended\":" << stats.NumberOfContendedAcquisitions
+        << "}},\n";
+    m_InterceptTrace
+        << "{\"ph\":\"C\", \"pid\":" << processId
+        << ", \"name\":\"Lock Wait Time (us)\", \"ts\":" << usNow
+        << ", \"args\":{\"Wait\":" << stats.WaitNS / 1000
+        << "}},\n";
+
+    m_Mutex.resetIntervalStats();
+    m_LockContentionCounterTime = now;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -12579,7 +19515,7 @@ void CLIntercept::chromeCallLoggingExit(
 void CLIntercept::chromeRegisterCommandQueue(
     cl_command_queue queue )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_int  errorCode = CL_SUCCESS;
 
@@ -12732,7 +19668,8 @@ void CLIntercept::chromeTraceEvent(
 
         const uint64_t  processId = OS().GetProcessID();
 
-        if( m_Config.ChromePerformanceTimingInStages )
+        if( m_Config.ChromePerformanceTimingInStages &&
+            !m_OverheadBudgetStagesDisabled.load( std::memory_order_relaxed ) )
         {
             const size_t cNumStates = 3;
             const std::string   colours[cNumStates] = {
@@ -12828,7 +19765,7 @@ bool CLIntercept::checkAubCaptureKernelSignature(
     const size_t* gws,
     const size_t* lws )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     bool    match = true;
 
@@ -13063,7 +20000,7 @@ void* CLIntercept::emulatedHostMemAlloc(
     cl_uint alignment,
     cl_int* errcode_ret)
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     if( !validateUSMMemProperties(properties) )
     {
@@ -13092,7 +20029,7 @@ void* CLIntercept::emulatedHostMemAlloc(
         return NULL;
     }
 
-    void*   ptr = new char[size];
+    void*   ptr = allocateHostMemory( size );
 #endif
     if( ptr == NULL )
     {
@@ -13130,7 +20067,7 @@ void* CLIntercept::emulatedDeviceMemAlloc(
     cl_uint alignment,
     cl_int* errcode_ret)
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     if( !validateUSMMemProperties(properties) )
     {
@@ -13186,7 +20123,7 @@ void* CLIntercept::emulatedSharedMemAlloc(
     cl_uint alignment,
     cl_int* errcode_ret)
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     if( !validateUSMMemProperties(properties) )
     {
@@ -13215,7 +20152,7 @@ void* CLIntercept::emulatedSharedMemAlloc(
         return NULL;
     }
 
-    void*   ptr = new char[size];
+    void*   ptr = allocateHostMemory( size );
 #endif
     if( ptr == NULL )
     {
@@ -13250,7 +20187,7 @@ cl_int CLIntercept::emulatedMemFree(
     cl_context context,
     const void* ptr )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     SUSMContextInfo&    usmContextInfo = m_USMContextInfoMap[context];
 
@@ -13294,7 +20231,7 @@ cl_int CLIntercept::emulatedMemFree(
             (void*)ptr );
         ptr = NULL;
 #else
-        delete [] ptr;
+        freeHostMemory( (void*)ptr );
         ptr = NULL;
 #endif
 
@@ -13417,7 +20354,7 @@ cl_int CLIntercept::trackUSMKernelExecInfo(
     size_t param_value_size,
     const void* param_value)
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     cl_int  retVal = CL_INVALID_VALUE;
 
@@ -13513,7 +20450,7 @@ cl_int CLIntercept::setUSMKernelExecInfo(
 
         const SUSMContextInfo& usmContextInfo = m_USMContextInfoMap[context];
 
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
         bool    hasSVMPtrs =
                     !usmKernelInfo.SVMPtrs.empty();
@@ -13654,7 +20591,7 @@ cl_int CLIntercept::setUSMKernelExecInfo(
 cl_int CLIntercept::finishAll(
     cl_context context )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     const CQueueList& queues = m_ContextQueuesMap[context];
 
@@ -21,6 +21,7 @@
 */
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <list>
@@ -30,13 +31,16 @@
 #include <set>
 #include <sstream>
 #include <queue>
+#include <tuple>
 
 #include <stdint.h>
 
 #include "common.h"
 #include "enummap.h"
 #include "dispatch.h"
+#include "instrumentedmutex.h"
 #include "objtracker.h"
+#include "streamwriter.h"
 
 #include "instrumentation.h"
 
@@ -68,6 +72,128 @@ public:
     using clock = std::chrono::steady_clock;
 #endif
 
+    // This is a snapshot of the device commands that were still pending
+    // when a blocking call started, for host blocking time attribution.
+    struct SBlockingEvent
+    {
+        cl_event    Event;
+        std::string Name;
+        clock::time_point   QueuedTime;
+    };
+
+    typedef std::vector< SBlockingEvent >   CBlockingEventList;
+
+    // This describes the memory read and written by a command that is
+    // enqueued to a command queue that was automatically created as an
+    // out-of-order queue, or by any command when checking for redundant
+    // kernel enqueues.  Either the memory object is set or the range
+    // of host, SVM, or USM memory is set.  An empty range describes the
+    // entire SVM or USM allocation containing the start of the range.
+    struct SAutoOutOfOrderResource
+    {
+        cl_mem      Mem;
+        const char* Begin;
+        const char* End;
+    };
+
+    struct SAutoOutOfOrderCommand
+    {
+        SAutoOutOfOrderCommand() :
+            Queue(NULL),
+            Kernel(NULL),
+            FullBarrier(false),
+            QueueBarrier(false),
+            Marker(false) {}
+
+        SAutoOutOfOrderCommand& readMem( cl_mem mem )
+        {
+            addMem( Reads, mem );
+            return *this;
+        }
+        SAutoOutOfOrderCommand& writeMem( cl_mem mem )
+        {
+            addMem( Writes, mem );
+            return *this;
+        }
+        SAutoOutOfOrderCommand& mapMem( cl_mem mem, cl_map_flags flags )
+        {
+            addMem( flags == CL_MAP_READ ? Reads : Writes, mem );
+            return *this;
+        }
+        SAutoOutOfOrderCommand& readPtr( const void* ptr, size_t size )
+        {
+            addPtr( Reads, ptr, size );
+            return *this;
+        }
+        SAutoOutOfOrderCommand& writePtr( const void* ptr, size_t size )
+        {
+            addPtr( Writes, ptr, size );
+            return *this;
+        }
+        SAutoOutOfOrderCommand& mapPtr( const void* ptr, size_t size, cl_map_flags flags )
+        {
+            addPtr( flags == CL_MAP_READ ? Reads : Writes, ptr, size );
+            return *this;
+        }
+        SAutoOutOfOrderCommand& useKernel( cl_kernel kernel )
+        {
+            Kernel = kernel;
+            return *this;
+        }
+        SAutoOutOfOrderCommand& fullBarrier()
+        {
+            FullBarrier = true;
+            return *this;
+        }
+        SAutoOutOfOrderCommand& queueBarrier()
+        {
+            QueueBarrier = true;
+            return *this;
+        }
+        SAutoOutOfOrderCommand& marker()
+        {
+            Marker = true;
+            return *this;
+        }
+
+        cl_command_queue    Queue;
+        cl_kernel           Kernel;
+        bool                FullBarrier;
+        bool                QueueBarrier;
+        bool                Marker;
+
+        std::vector< SAutoOutOfOrderResource >  Reads;
+        std::vector< SAutoOutOfOrderResource >  Writes;
+
+        // This holds the application's event wait list plus any added
+        // dependencies, so it must live until the command is enqueued.
+        std::vector< cl_event > WaitList;
+
+    private:
+        static void addMem(
+            std::vector< SAutoOutOfOrderResource >& resources,
+            cl_mem mem )
+        {
+            if( mem )
+            {
+                SAutoOutOfOrderResource resource = { mem, NULL, NULL };
+                resources.push_back( resource );
+            }
+        }
+        static void addPtr(
+            std::vector< SAutoOutOfOrderResource >& resources,
+            const void* ptr,
+            size_t size )
+        {
+            if( ptr )
+            {
+                SAutoOutOfOrderResource resource =
+                    { NULL, (const char*)ptr, (const char*)ptr + size };
+                resources.push_back( resource );
+            }
+        }
+    };
+
     static bool Create( void* pGlobalData, CLIntercept*& pIntercept );
     static void Delete( CLIntercept*& pIntercept );
 
@@ -199,7 +325,8 @@ public:
                 const cl_device_id* device_list );
     void    logError(
                 const std::string& functionName,
-                cl_int errorCode );
+                cl_int errorCode,
+                const cl_kernel kernel );
     void    logFlushOrFinishAfterEnqueueStart(
                 const std::string& flushOrFinish,
                 const std::string& functionName );
@@ -370,6 +497,7 @@ public:
                 clock::time_point end );
 
     void    modifyCommandQueueProperties(
+                cl_device_id device,
                 cl_command_queue_properties& props ) const;
     void    createCommandQueueProperties(
                 cl_device_id device,
@@ -383,6 +511,15 @@ public:
                 uint64_t enqueueCounter ) const;
     bool    checkDevicePerformanceTimingEnqueueLimits(
                 uint64_t enqueueCounter ) const;
+
+    // Call logging may be paused at runtime without changing the config.
+    // Whether call logging is paused is latched for each thread when a call
+    // is entered, so the entry and the exit of a call are either both
+    // logged or both skipped.
+    bool    callLoggingPaused() const;
+    bool    enterCallLogging() const;
+    static bool&    callLoggingActiveForThread();
+
     void    dummyCommandQueue(
                 cl_context context,
                 cl_device_id device );
@@ -398,6 +535,213 @@ public:
                 cl_command_queue queue,
                 cl_event event );
     void    checkTimingEvents();
+    void    getPendingTimingEvents(
+                cl_command_queue queue,
+                CBlockingEventList& events );
+    void    getPendingTimingEvents(
+                cl_uint numEvents,
+                const cl_event* eventList,
+                CBlockingEventList& events );
+    void    attributeHostBlockingTime(
+                const std::string& functionName,
+                cl_event event,
+                CBlockingEventList& events,
+                clock::time_point start,
+                clock::time_point end );
+
+    bool    checkAutoOutOfOrderQueueProperties(
+                cl_command_queue_properties props ) const;
+    bool    checkAutoOutOfOrderQueueProperties(
+                const cl_queue_properties* properties ) const;
+    void    addAutoOutOfOrderQueue(
+                cl_command_queue queue );
+    void    checkRemoveAutoOutOfOrderQueue(
+                cl_command_queue queue );
+    void    autoOutOfOrderQueueInfo(
+                cl_command_queue queue,
+                cl_command_queue_info param_name,
+                void* param_value );
+    void    autoOutOfOrderKernelExecInfo(
+                cl_kernel kernel );
+    void    cloneKernelArgs(
+                cl_kernel sourceKernel,
+                cl_kernel clonedKernel );
+    bool    autoOutOfOrderStart(
+                cl_command_queue queue,
+                bool blocking,
+                bool appEvent,
+                SAutoOutOfOrderCommand& command,
+                cl_uint& numEvents,
+                const cl_event*& eventList );
+    void    autoOutOfOrderEnd(
+                const SAutoOutOfOrderCommand& command,
+                bool success,
+                cl_event event,
+                bool ownEvent );
+    void    autoOutOfOrderQueueSync(
+                cl_command_queue queue );
+
+    cl_int  coalesceWriteBuffer(
+                cl_command_queue queue,
+                cl_mem buffer,
+                cl_bool blocking_write,
+                size_t offset,
+                size_t cb,
+                const void* ptr,
+                cl_uint num_events_in_wait_list,
+                cl_event* event );
+    void    flushCoalescedBufferWrites(
+                cl_command_queue queue,
+                cl_mem memobj );
+    void    checkRemoveCoalescedBufferWrites(
+                cl_command_queue queue );
+
+    bool    stagedReadBuffer(
+                cl_command_queue queue,
+                cl_mem buffer,
+                cl_bool blocking_read,
+                size_t offset,
+                size_t cb,
+                void* ptr,
+                cl_uint num_events_in_wait_list,
+                const cl_event* event_wait_list,
+                cl_event* event,
+                cl_int& errorCode );
+    bool    stagedWriteBuffer(
+                cl_command_queue queue,
+                cl_mem buffer,
+                cl_bool blocking_write,
+                size_t offset,
+                size_t cb,
+                const void* ptr,
+                cl_uint num_events_in_wait_list,
+                const cl_event* event_wait_list,
+                cl_event* event,
+                cl_int& errorCode );
+    void    checkRemovePinnedStagingPool(
+                cl_command_queue queue );
+
+    void    initializeBufferContents(
+                cl_mem buffer,
+                size_t size );
+    void    releaseInitializeBuffersQueue(
+                cl_context context );
+
+    void    zeroCopyCheckBuffer(
+                cl_mem buffer,
+                cl_mem_flags flags,
+                size_t size,
+                const void* host_ptr );
+    void    zeroCopyCheckTransfer(
+                cl_mem buffer,
+                const void* ptr,
+                size_t size,
+                bool read );
+    void    zeroCopyCheckMap(
+                cl_mem buffer,
+                size_t size );
+    void    checkRemoveZeroCopyBuffer(
+                cl_mem memobj );
+
+    bool    startupProfileComplete() const
+            {
+                return m_StartupProfileComplete.load( std::memory_order_relaxed );
+            }
+    void    startupProfileCall(
+                const char* functionName,
+                clock::time_point start,
+                clock::time_point end );
+    void    startupProfileKernelEnqueue(
+                cl_command_queue queue );
+
+    cl_kernel   createRecycledKernel(
+                    cl_program program,
+                    const char* kernel_name,
+                    cl_int* errcode_ret );
+    void    addRecycledKernelsProgramRef(
+                cl_program program );
+    void    releaseRecycledKernels(
+                cl_program program );
+    void    releaseRecycledKernelTemplates(
+                cl_program program );
+
+    void    redundantKernelSetArg(
+                cl_kernel kernel,
+                cl_uint arg_index,
+                size_t arg_size,
+                const void* arg_value );
+    void    redundantKernelCheckWrites(
+                const SAutoOutOfOrderCommand& command );
+    void    mapAccessTrackingMap(
+                cl_mem buffer,
+                cl_map_flags flags,
+                void* ptr,
+                size_t size );
+    void    mapAccessTrackingUnmap(
+                cl_mem memobj,
+                void* ptr );
+
+    void    kernelFootprintCheck(
+                uint64_t enqueueCounter,
+                bool deviceTiming,
+                cl_kernel kernel );
+    void    redundantKernelCheck(
+                uint64_t enqueueCounter,
+                bool deviceTiming,
+                cl_kernel kernel,
+                cl_uint workDim,
+                const size_t* gwo,
+                const size_t* gws,
+                const size_t* lws );
+
+    void    kernelAnomalyDumpBuffers(
+                uint64_t enqueueCounter,
+                cl_kernel kernel,
+                cl_command_queue queue );
+
+    void    submitLatencyEnqueue(
+                cl_command_queue queue,
+                uint64_t enqueueCounter );
+    void    submitLatencyFlush(
+                cl_command_queue queue,
+                const char* pattern );
+    void    submitLatencyWait(
+                cl_uint numEvents,
+                const cl_event* eventList );
+    void    submitLatencyReleaseQueue(
+                cl_command_queue queue );
+
+    void    redundantSyncEnqueue(
+                cl_command_queue queue,
+                bool blocking );
+    void    redundantSyncReleaseQueue(
+                cl_command_queue queue );
+    void    redundantSyncBlockingRead(
+                clock::time_point start,
+                clock::time_point end );
+    void    redundantSyncFlush(
+                cl_command_queue queue,
+                clock::time_point start,
+                clock::time_point end );
+    void    redundantSyncFinish(
+                cl_command_queue queue,
+                clock::time_point start,
+                clock::time_point end );
+    bool    redundantSyncEventsComplete(
+                cl_uint numEvents,
+                const cl_event* eventList );
+    void    redundantSyncWait(
+                bool eventsComplete,
+                clock::time_point start,
+                clock::time_point end );
+    void    redundantSyncBarrier(
+                const std::string& functionName,
+                cl_command_queue queue,
+                cl_uint numEvents,
+                const cl_event* eventList,
+                const cl_event* event,
+                clock::time_point start,
+                clock::time_point end );
 
     cl_command_queue    getCommandBufferCommandQueue(
                 cl_uint numQueues,
@@ -467,18 +811,21 @@ public:
                 cl_mem memobj );
     void    addSVMAllocation(
                 void* svmPtr,
-                size_t size );
+                size_t size,
+                bool hostAccessible );
     void    removeSVMAllocation(
                 void* svmPtr );
     void    addUSMAllocation(
                 void* usmPtr,
-                size_t size );
+                size_t size,
+                bool hostAccessible );
     void    removeUSMAllocation(
                 void* usmPtr );
     void    setKernelArg(
                 cl_kernel kernel,
                 cl_uint arg_index,
-                cl_mem memobj );
+                size_t arg_size,
+                const void* arg_value );
     void    setKernelArgSVMPointer(
                 cl_kernel kernel,
                 cl_uint arg_index,
@@ -487,6 +834,11 @@ public:
                 cl_kernel kernel,
                 cl_uint arg_index,
                 const void* arg );
+    void    setKernelArgScalar(
+                cl_kernel kernel,
+                cl_uint arg_index,
+                size_t arg_size,
+                const void* arg_value );
     void    dumpBuffersForKernel(
                 const std::string& name,
                 const uint64_t enqueueCounter,
@@ -542,6 +894,11 @@ public:
     void    stopAubCapture(
                 cl_command_queue commandQueue );
 
+    bool    captureWindowEnabled() const;
+    void    checkCaptureWindow(
+                uint64_t enqueueCounter,
+                const cl_kernel kernel );
+
     void    initPrecompiledKernelOverrides(
                 const cl_context context );
     void    initBuiltinKernelOverrides(
@@ -761,6 +1118,9 @@ public:
                 const size_t* lws);
 
     unsigned int    getThreadNumber( uint64_t threadId );
+    void    chromeRegisterThread(
+                uint64_t threadId,
+                unsigned int threadNumber );
 
     void    saveProgramNumber( const cl_program program );
     unsigned int    getProgramNumber() const;
@@ -795,6 +1155,8 @@ public:
                 const cl_kernel kernel,
                 clock::time_point start,
                 clock::time_point end );
+    void    chromeLockContentionCounters(
+                clock::time_point now );
     void    chromeRegisterCommandQueue(
                 cl_command_queue queue );
     void    chromeTraceEvent(
@@ -855,6 +1217,7 @@ private:
     static const char* sc_LogFileName;
     static const char* sc_TraceFileName;
     static const char* sc_DumpPerfCountersFileNamePrefix;
+    static const char* sc_RollingStatsFileName;
 
 #if defined(CLINTERCEPT_CMAKE)
     static const char* sc_GitDescribe;
@@ -892,8 +1255,17 @@ private:
 
     void    writeReport(
                 std::ostream& os );
+    void    addStreamWriterTimingStats(
+                const std::string& name,
+                const CStreamWriter& writer );
+    void    attachNodeReport();
+    void    writeNodeReport();
 
-    std::mutex      m_Mutex;
+    // This is the name of the shared memory segment for NodeReport.  It is
+    // empty if the process could not attach to the segment.
+    std::string m_NodeReportSegmentName;
+
+    CInstrumentedMutex  m_Mutex;
 
     typedef std::map< cl_platform_id, CLdispatchX > CLdispatchXMap;
 
@@ -905,8 +1277,9 @@ private:
 
     void*       m_OpenCLLibraryHandle;
 
-    std::ofstream   m_InterceptLog;
-    std::ofstream   m_InterceptTrace;
+    CStreamWriter   m_InterceptLog;
+    CStreamWriter   m_InterceptTrace;
+    std::ofstream   m_RollingStatsFile;
 
     mutable char    m_StringBuffer[CLI_STRING_BUFFER_SIZE];
 
@@ -958,6 +1331,10 @@ private:
     typedef std::map< std::string, SHostTimingStats >   CHostTimingStatsMap;
     CHostTimingStatsMap  m_HostTimingStatsMap;
 
+    void    writeHostTimingReport(
+                std::ostream& os,
+                const CHostTimingStatsMap& hostTimingStatsMap ) const;
+
     // These structures define a mapping between a device ID handle and
     // properties of a device, for easier querying.
 
@@ -970,6 +1347,7 @@ private:
 
         cl_uint     NumComputeUnits;
         cl_uint     MaxClockFrequency;
+        cl_uint     MemBaseAddrAlign;   // in bytes
 
         bool        Supports_cl_khr_create_command_queue;
         bool        Supports_cl_khr_subgroups;
@@ -1004,6 +1382,10 @@ private:
     typedef std::map< cl_device_id, CDeviceTimingStatsMap > CDeviceDeviceTimingStatsMap;
     CDeviceDeviceTimingStatsMap m_DeviceTimingStatsMap;
 
+    void    writeDeviceTimingReport(
+                std::ostream& os,
+                const CDeviceTimingStatsMap& deviceTimingStatsMap ) const;
+
     // This defines a mapping between the kernel handle and information
     // about the kernel.
 
@@ -1033,20 +1415,936 @@ private:
     // This is a list of pending events that haven't been added to the
     // device timing stats map yet.
 
-    struct SEventListNode
-    {
-        cl_device_id        Device;
-        unsigned int        QueueNumber;
-        std::string         FunctionName;
-        std::string         KernelName;
-        uint64_t            EnqueueCounter;
-        clock::time_point   QueuedTime;
-        cl_kernel           Kernel;
-        cl_event            Event;
+    struct SEventListNode
+    {
+        cl_device_id        Device;
+        cl_command_queue    Queue;
+        unsigned int        QueueNumber;
+        std::string         FunctionName;
+        std::string         KernelName;
+        uint64_t            EnqueueCounter;
+        clock::time_point   QueuedTime;
+        cl_kernel           Kernel;
+        cl_event            Event;
+
+        // These are only recorded for kernel anomaly detection.
+        std::string         WorkSizes;
+        uint32_t            QueueDepth;
+        uint32_t            DeviceInFlight;
+    };
+
+    typedef std::list< SEventListNode > CEventList;
+    CEventList  m_EventList;
+
+    void    retireTimingEvent(
+                const SEventListNode& node );
+
+    void    getPendingTimingEvents(
+                const std::set<cl_command_queue>& queues,
+                CBlockingEventList& events );
+
+    // These structures record the host time spent in blocking calls,
+    // per blocking function, and the share of that time attributed to
+    // each device command that completed during a blocking call.
+
+    struct SHostBlockingStats
+    {
+        SHostBlockingStats() :
+            NumberOfCalls(0),
+            TotalNS(0),
+            UnattributedCalls(0),
+            UnattributedNS(0) {}
+
+        uint64_t    NumberOfCalls;
+        uint64_t    TotalNS;
+        uint64_t    UnattributedCalls;
+        uint64_t    UnattributedNS;
+    };
+
+    typedef std::map< std::string, SHostBlockingStats > CHostBlockingStatsMap;
+    CHostBlockingStatsMap   m_HostBlockingStatsMap;
+
+    struct SHostBlockingAttribution
+    {
+        SHostBlockingAttribution() :
+            NumberOfCalls(0),
+            AttributedNS(0) {}
+
+        uint64_t    NumberOfCalls;
+        uint64_t    AttributedNS;
+    };
+
+    typedef std::map< std::string, SHostBlockingAttribution >   CHostBlockingAttributionMap;
+    CHostBlockingAttributionMap m_HostBlockingAttributionMap;
+
+    // These structures track the synchronization state of each command
+    // queue and of each thread, and count the synchronization that is
+    // likely unnecessary.
+
+    struct SSyncQueueState
+    {
+        SSyncQueueState() :
+            InOrder(true),
+            Outstanding(0),
+            Flushed(false),
+            FlushNS(0) {}
+
+        bool        InOrder;
+        uint64_t    Outstanding;
+        bool        Flushed;
+        uint64_t    FlushNS;
+    };
+
+    typedef std::map< cl_command_queue, SSyncQueueState >   CSyncQueueStateMap;
+    CSyncQueueStateMap  m_SyncQueueStateMap;
+
+    SSyncQueueState&    getSyncQueueState(
+                            cl_command_queue queue );
+
+    // The sync epoch is incremented whenever a command queue is
+    // synchronized or released.  A thread that enqueues a non-blocking
+    // command to the same queue as its last enqueue, with no sync since,
+    // cannot change the state of the queue, so it does not take the mutex.
+
+    std::atomic<uint64_t>   m_SyncEpoch;
+
+    struct SSyncThreadState
+    {
+        SSyncThreadState() :
+            Queue(NULL),
+            Epoch(0),
+            PendingRead(false),
+            BlockingNS(0) {}
+
+        cl_command_queue    Queue;
+        uint64_t            Epoch;
+        bool                PendingRead;
+        clock::time_point   ReturnTime;
+        uint64_t            BlockingNS;
+    };
+
+    static SSyncThreadState&    syncThreadState();
+
+    struct SRedundantSyncStats
+    {
+        SRedundantSyncStats() :
+            NumberOfCalls(0),
+            HostNS(0) {}
+
+        uint64_t    NumberOfCalls;
+        uint64_t    HostNS;
+    };
+
+    typedef std::map< std::string, SRedundantSyncStats >    CRedundantSyncStatsMap;
+    CRedundantSyncStatsMap  m_RedundantSyncStatsMap;
+
+    void    addRedundantSync(
+                const std::string& finding,
+                uint64_t hostNS );
+
+    // These structures track the commands that may still be executing on
+    // each command queue that was automatically created as an out-of-order
+    // queue, and what memory they access, so dependencies can be added to
+    // preserve in-order semantics.
+
+    // This is shared by a node and its event callback, so the node can
+    // check whether its command has completed without querying the event.
+    // It is freed when both the node and the callback are done with it.
+    struct SAutoOutOfOrderCompletion
+    {
+        SAutoOutOfOrderCompletion() :
+            References(2),
+            Complete(false) {}
+
+        std::atomic<int>    References;
+        std::atomic<bool>   Complete;
+    };
+
+    struct SAutoOutOfOrderNode
+    {
+        cl_event    Event;
+        bool        FullBarrier;
+        SAutoOutOfOrderCompletion*  Completion;
+
+        std::vector< SAutoOutOfOrderResource >  Reads;
+        std::vector< SAutoOutOfOrderResource >  Writes;
+    };
+
+    typedef std::list< SAutoOutOfOrderNode >    CAutoOutOfOrderNodeList;
+    typedef std::map< cl_command_queue, CAutoOutOfOrderNodeList >   CAutoOutOfOrderQueueMap;
+    CAutoOutOfOrderQueueMap m_AutoOutOfOrderQueueMap;
+
+    typedef std::set< cl_kernel >   CAutoOutOfOrderKernelSet;
+    CAutoOutOfOrderKernelSet    m_AutoOutOfOrderIndirectKernels;
+
+    // This tracks the indices of kernel arguments that may be memory but
+    // are not tracked, such as pipes, so the memory they access is unknown.
+    typedef std::map< cl_kernel, std::set< cl_uint > >  CAutoOutOfOrderArgIndexMap;
+    CAutoOutOfOrderArgIndexMap  m_AutoOutOfOrderUnknownArgs;
+
+    struct SAutoOutOfOrderStats
+    {
+        SAutoOutOfOrderStats() :
+            NumberOfQueues(0),
+            NumberOfCommands(0),
+            IndependentCommands(0),
+            DependenciesAdded(0),
+            IndependentInFlight(0),
+            FullBarrierCommands(0),
+            BlockingCommands(0),
+            EventCommands(0) {}
+
+        uint64_t    NumberOfQueues;
+        uint64_t    NumberOfCommands;
+        uint64_t    IndependentCommands;
+        uint64_t    DependenciesAdded;
+        uint64_t    IndependentInFlight;
+        uint64_t    FullBarrierCommands;
+        uint64_t    BlockingCommands;
+        uint64_t    EventCommands;
+    };
+
+    SAutoOutOfOrderStats    m_AutoOutOfOrderStats;
+
+    void    resolveAutoOutOfOrderResource(
+                SAutoOutOfOrderResource& resource,
+                bool& fullBarrier ) const;
+    void    releaseAutoOutOfOrderNodes(
+                CAutoOutOfOrderNodeList& nodes );
+    void    releaseAutoOutOfOrderNode(
+                SAutoOutOfOrderNode& node );
+    static void CL_CALLBACK autoOutOfOrderCallback(
+                cl_event event,
+                cl_int status,
+                void* user_data );
+
+    struct SCoalescedWrites
+    {
+        SCoalescedWrites() :
+            InOrder(false),
+            Buffer(NULL),
+            Offset(0),
+            NumberOfWrites(0) {}
+
+        bool        InOrder;
+        cl_mem      Buffer;
+        size_t      Offset;
+        uint64_t    NumberOfWrites;
+        std::vector<char>   Data;
+    };
+
+    typedef std::map< cl_command_queue, SCoalescedWrites >  CCoalescedWritesMap;
+    CCoalescedWritesMap m_CoalescedWritesMap;
+
+    struct SCoalescedWriteStats
+    {
+        SCoalescedWriteStats() :
+            NumberOfWrites(0),
+            NumberOfTransfers(0),
+            TotalBytes(0),
+            NumberOfErrors(0) {}
+
+        uint64_t    NumberOfWrites;
+        uint64_t    NumberOfTransfers;
+        uint64_t    TotalBytes;
+        uint64_t    NumberOfErrors;
+    };
+
+    SCoalescedWriteStats    m_CoalescedWriteStats;
+
+    static void CL_CALLBACK coalescedWritesCallback(
+                                cl_event,
+                                cl_int,
+                                void* );
+    cl_int  flushCoalescedWrites(
+                cl_command_queue queue,
+                SCoalescedWrites& writes,
+                cl_event* event );
+
+    struct SPinnedStagingSlot
+    {
+        cl_mem      Buffer;
+        void*       Pointer;
+        cl_event    Event;
+    };
+
+    struct SPinnedStagingPool
+    {
+        SPinnedStagingPool() :
+            Initialized(false),
+            Failed(false),
+            NumberOfTransfers(0) {}
+
+        std::mutex  Mutex;
+
+        bool        Initialized;
+        bool        Failed;
+        uint64_t    NumberOfTransfers;
+        size_t      ChunkSize;
+        std::vector<SPinnedStagingSlot> Slots;
+    };
+
+    typedef std::map< cl_command_queue, SPinnedStagingPool* >   CPinnedStagingPoolMap;
+    CPinnedStagingPoolMap   m_PinnedStagingPoolMap;
+
+    struct SPinnedStagingStats
+    {
+        SPinnedStagingStats() :
+            NumberOfCalls(0),
+            TotalBytes(0),
+            TimedBytes(0),
+            TimedNS(0) {}
+
+        uint64_t    NumberOfCalls;
+        uint64_t    TotalBytes;
+        uint64_t    TimedBytes;
+        uint64_t    TimedNS;
+    };
+
+    typedef std::map< std::string, SPinnedStagingStats >    CPinnedStagingStatsMap;
+    CPinnedStagingStatsMap  m_PinnedStagingStatsMap;
+
+    struct SZeroCopyBufferInfo
+    {
+        SZeroCopyBufferInfo() :
+            Number(0),
+            Flags(0),
+            Size(0),
+            Alignment(1),
+            Eligible(false),
+            HostPtrNotPageAligned(false),
+            HostPtrNotBaseAddrAligned(false),
+            SizeNotBaseAddrMultiple(false),
+            NumberOfReads(0),
+            NumberOfWrites(0),
+            NumberOfMaps(0),
+            BytesRead(0),
+            BytesWritten(0),
+            BytesMapped(0),
+            UnalignedTransfers(0) {}
+
+        uint64_t    Number;
+        cl_mem_flags    Flags;
+        size_t      Size;
+        size_t      Alignment;
+
+        bool        Eligible;
+        bool        HostPtrNotPageAligned;
+        bool        HostPtrNotBaseAddrAligned;
+        bool        SizeNotBaseAddrMultiple;
+
+        uint64_t    NumberOfReads;
+        uint64_t    NumberOfWrites;
+        uint64_t    NumberOfMaps;
+        uint64_t    BytesRead;
+        uint64_t    BytesWritten;
+        uint64_t    BytesMapped;
+        uint64_t    UnalignedTransfers;
+
+        uint64_t    getAvoidableBytes() const
+        {
+            uint64_t    bytes = BytesRead + BytesWritten;
+            if( !Eligible )
+            {
+                bytes += BytesMapped;
+                if( Flags & ( CL_MEM_COPY_HOST_PTR | CL_MEM_USE_HOST_PTR ) )
+                {
+                    bytes += Size;
+                }
+            }
+            return bytes;
+        }
+    };
+
+    typedef std::map< cl_context, cl_command_queue >    CInitializeBuffersQueueMap;
+    CInitializeBuffersQueueMap  m_InitializeBuffersQueueMap;
+
+    char*   m_InitializeBuffersZeroBlock;
+
+    // This tracks large host allocations made by the intercept layer itself
+    // that were placed using huge pages or NUMA binding, so they can be
+    // freed correctly.
+
+    typedef std::map< const void*, size_t > CHostAllocationMap;
+    CHostAllocationMap  m_HostAllocationMap;
+
+    char*   m_DumpStagingBuffer;
+    size_t  m_DumpStagingBufferSize;
+
+    bool    hostAllocationPlacementEnabled() const;
+    void*   allocateHostMemory(
+                size_t size );
+    void    freeHostMemory(
+                void* ptr );
+    void    benchmarkHostAllocations();
+
+    typedef std::map< cl_mem, SZeroCopyBufferInfo > CZeroCopyBufferInfoMap;
+    CZeroCopyBufferInfoMap  m_ZeroCopyBufferInfoMap;
+
+    typedef std::vector< SZeroCopyBufferInfo >  CZeroCopyBufferInfoList;
+    CZeroCopyBufferInfoList m_ZeroCopyRetiredBuffers;
+
+    static bool zeroCopyAvoidableBytesGreater(
+                    const SZeroCopyBufferInfo& a,
+                    const SZeroCopyBufferInfo& b );
+
+    // These structures record the execution interval of each command per
+    // device, to compute how often commands execute concurrently.
+
+    enum
+    {
+        CONCURRENCY_COMMAND_KERNEL,
+        CONCURRENCY_COMMAND_TRANSFER,
+        CONCURRENCY_COMMAND_OTHER,
+    };
+
+    enum
+    {
+        CONCURRENCY_MAX_LEVEL = 8,
+    };
+
+    struct SConcurrencyInterval
+    {
+        cl_ulong    Start;
+        cl_ulong    End;
+        int         Type;
+    };
+
+    struct SConcurrencyRecord
+    {
+        SConcurrencyRecord() :
+            NumberOfDroppedCommands(0) {}
+
+        std::vector< SConcurrencyInterval > Intervals;
+        uint64_t    NumberOfDroppedCommands;
+    };
+
+    typedef std::map< cl_device_id, SConcurrencyRecord >    CConcurrencyRecordMap;
+    CConcurrencyRecordMap   m_ConcurrencyRecordMap;
+
+    void    addConcurrencyInterval(
+                const SEventListNode& node,
+                cl_ulong commandStart,
+                cl_ulong commandEnd );
+    void    writeConcurrencyReport(
+                std::ostream& os,
+                const SConcurrencyRecord& record ) const;
+
+    static bool isTransferCommand(
+                    const std::string& functionName );
+    static bool compareConcurrencyEvents(
+                    const std::pair< cl_ulong, int >& a,
+                    const std::pair< cl_ulong, int >& b );
+
+    // This tracks the overhead budget.  The host time spent in expensive
+    // instrumentation is measured over each interval, and when it exceeds
+    // the budget the instrumentation is reduced one step at a time.  The
+    // config is never modified: the reductions are atomics that are read
+    // without the mutex.
+
+    uint64_t            m_OverheadBudgetIntervalNS;
+    uint64_t            m_OverheadBudgetTotalNS;
+    clock::time_point   m_OverheadBudgetIntervalStart;
+    uint64_t            m_OverheadBudgetAdjustments;
+    std::atomic<cl_uint>    m_OverheadBudgetSampleFactor;
+    std::atomic<bool>       m_OverheadBudgetStagesDisabled;
+    std::atomic<bool>       m_OverheadBudgetCallLoggingPaused;
+
+    // This is the time lock contention counters were last written to the
+    // Chrome trace.
+    clock::time_point   m_LockContentionCounterTime;
+
+    void    addOverheadBudgetTime(
+                clock::time_point start );
+    void    adjustOverheadBudget(
+                double overheadPercent );
+
+    // These structures record the running execution time statistics of
+    // each kernel, used to detect kernel executions that are much slower
+    // than usual.  The number of timed commands in flight per queue and per
+    // device is tracked to describe the conditions of each anomaly.
+
+    enum
+    {
+        KERNEL_ANOMALY_HISTOGRAM_BUCKETS = 40,
+    };
+
+    struct SKernelAnomalyStats
+    {
+        SKernelAnomalyStats() :
+            NumberOfExecutions(0),
+            Mean(0.0),
+            M2(0.0),
+            EWMAMean(0.0),
+            EWMAVariance(0.0),
+            NumberOfAnomalies(0),
+            MaxAnomalyNS(0)
+        {
+            for( int i = 0; i < KERNEL_ANOMALY_HISTOGRAM_BUCKETS; i++ )
+            {
+                Histogram[i] = 0;
+            }
+        }
+
+        uint64_t    NumberOfExecutions;
+        double      Mean;
+        double      M2;
+        double      EWMAMean;
+        double      EWMAVariance;
+        uint32_t    Histogram[KERNEL_ANOMALY_HISTOGRAM_BUCKETS];
+
+        uint64_t    NumberOfAnomalies;
+        uint64_t    MaxAnomalyNS;
+    };
+
+    typedef std::map< std::string, SKernelAnomalyStats >    CKernelAnomalyStatsMap;
+    typedef std::map< cl_device_id, CKernelAnomalyStatsMap >    CDeviceKernelAnomalyStatsMap;
+    CDeviceKernelAnomalyStatsMap    m_KernelAnomalyStatsMap;
+
+    typedef std::map< cl_command_queue, uint32_t >  CQueueInFlightMap;
+    CQueueInFlightMap   m_KernelAnomalyQueueInFlightMap;
+
+    typedef std::map< cl_device_id, uint32_t >  CDeviceInFlightMap;
+    CDeviceInFlightMap  m_KernelAnomalyDeviceInFlightMap;
+
+    // Short kernel names with a pending anomaly buffer dump.
+    std::set< std::string > m_KernelAnomalyDumpSet;
+
+    void    checkKernelAnomaly(
+                const SEventListNode& node,
+                const std::string& name,
+                uint64_t delta );
+    void    removeKernelAnomalyInFlight(
+                const SEventListNode& node );
+
+    // These structures aggregate host and device timing into fixed-length
+    // windows.  The windows are kept in a bounded ring indexed by the window
+    // number, so each update is a constant time lookup.  A window is written
+    // to the time series file once RollingStatsLateWindows following windows
+    // have ended, and later updates to it are dropped.
+
+    struct SRollingStatsWindow
+    {
+        SRollingStatsWindow() :
+            Valid(false),
+            Number(0) {}
+
+        bool        Valid;
+        uint64_t    Number;
+
+        CHostTimingStatsMap HostStats;
+
+        typedef std::map< cl_device_id, CHostTimingStatsMap >   CDeviceStatsMap;
+        CDeviceStatsMap     DeviceStats;
+    };
+
+    typedef std::vector< SRollingStatsWindow >  CRollingStatsWindowRing;
+    CRollingStatsWindowRing m_RollingStatsWindows;
+    uint64_t                m_RollingStatsNextWindow;
+
+    SRollingStatsWindow*    getRollingStatsWindow(
+                                clock::time_point time );
+    void    writeRollingStatsWindows(
+                uint64_t endNumber );
+    void    addRollingStats(
+                CHostTimingStatsMap& statsMap,
+                const std::string& name,
+                uint64_t nsDelta );
+    void    writeRollingStatsWindow(
+                SRollingStatsWindow& window );
+    void    writeRollingStats();
+
+    // These structures aggregate submission latency, the time from when a
+    // command is queued to when it is submitted and from when it is
+    // submitted to when it starts, per queue, per command type, and per
+    // flush pattern.
+
+    enum
+    {
+        SUBMIT_LATENCY_HISTOGRAM_BUCKETS = 40,
+    };
+
+    struct SSubmitLatencyStats
+    {
+        SSubmitLatencyStats() :
+            NumberOfCommands(0),
+            QueuedNS(0),
+            SubmitNS(0),
+            ExecuteNS(0)
+        {
+            for( int i = 0; i < SUBMIT_LATENCY_HISTOGRAM_BUCKETS; i++ )
+            {
+                QueuedHistogram[i] = 0;
+                SubmitHistogram[i] = 0;
+            }
+        }
+
+        uint64_t    NumberOfCommands;
+        uint64_t    QueuedNS;
+        uint64_t    SubmitNS;
+        uint64_t    ExecuteNS;
+        uint32_t    QueuedHistogram[SUBMIT_LATENCY_HISTOGRAM_BUCKETS];
+        uint32_t    SubmitHistogram[SUBMIT_LATENCY_HISTOGRAM_BUCKETS];
+    };
+
+    typedef std::map< std::string, SSubmitLatencyStats >    CSubmitLatencyStatsMap;
+    CSubmitLatencyStatsMap  m_SubmitLatencyQueueStatsMap;
+    CSubmitLatencyStatsMap  m_SubmitLatencyCommandStatsMap;
+    CSubmitLatencyStatsMap  m_SubmitLatencyPatternStatsMap;
+
+    // This tracks the timed commands that were enqueued to each queue and
+    // have not been explicitly submitted yet, and the flush pattern for
+    // commands that have been explicitly submitted.
+    typedef std::map< cl_command_queue, std::set< uint64_t > >  CSubmitPendingMap;
+    CSubmitPendingMap   m_SubmitPendingMap;
+
+    typedef std::map< uint64_t, std::string >   CSubmitPatternMap;
+    CSubmitPatternMap   m_SubmitPatternMap;
+
+    // This is the pattern for the blocking enqueue in progress on each
+    // thread.  It is only recorded if the enqueue is timed, so enqueues
+    // that fail or are not timed do not leave entries behind.
+    struct SSubmitBlockingEnqueue
+    {
+        SSubmitBlockingEnqueue() :
+            EnqueueCounter(0) {}
+
+        uint64_t    EnqueueCounter;
+        std::string Pattern;
+    };
+
+    static SSubmitBlockingEnqueue&  submitBlockingEnqueue();
+
+    void    addSubmitLatency(
+                const SEventListNode& node,
+                cl_ulong commandQueued,
+                cl_ulong commandSubmit,
+                cl_ulong commandStart,
+                cl_ulong commandEnd );
+    void    writeSubmitLatencyStats(
+                std::ostream& os,
+                const std::string& title,
+                const CSubmitLatencyStatsMap& statsMap ) const;
+
+    // These structures record the startup milestones and the OpenCL calls
+    // made between each milestone.
+
+    struct SStartupCallStats
+    {
+        SStartupCallStats() :
+            NumberOfCalls(0),
+            TotalNS(0) {}
+
+        uint64_t    NumberOfCalls;
+        uint64_t    TotalNS;
+    };
+
+    typedef std::map< std::string, SStartupCallStats >  CStartupCallStatsMap;
+
+    struct SStartupMilestone
+    {
+        std::string         Name;
+        clock::time_point   Time;
+        CStartupCallStatsMap    Calls;
+    };
+
+    typedef std::vector< SStartupMilestone >    CStartupMilestoneList;
+    CStartupMilestoneList   m_StartupMilestones;
+    CStartupCallStatsMap    m_StartupCalls;
+
+    clock::time_point   m_StartupLoadTime;
+    clock::time_point   m_StartupLibraryLoadedTime;
+    unsigned int        m_StartupProgramBuilds;
+    bool                m_StartupKernelEnqueued;
+    std::atomic<bool>   m_StartupProfileComplete;
+
+    void    addStartupMilestone(
+                const std::string& name,
+                clock::time_point time );
+    void    chromeStartupProfile();
+
+    static void CL_CALLBACK startupProfileCallback(
+                                cl_event,
+                                cl_int,
+                                void* );
+
+    // These structures track the pristine template kernel for each program
+    // and kernel name, and the number of references the application holds
+    // to each program, so the templates are released when the application
+    // releases its last reference, independent of how the implementation
+    // counts references from kernels.
+
+    typedef std::map< std::string, cl_kernel >  CKernelRecyclingTemplateNameMap;
+    typedef std::map< cl_program, CKernelRecyclingTemplateNameMap > CKernelRecyclingTemplateMap;
+    CKernelRecyclingTemplateMap m_KernelRecyclingTemplateMap;
+
+    typedef std::map< cl_program, cl_uint > CKernelRecyclingProgramRefMap;
+    CKernelRecyclingProgramRefMap   m_KernelRecyclingProgramRefMap;
+
+    void    releaseRecycledKernelTemplates(
+                CKernelRecyclingTemplateMap::iterator iter );
+
+    struct SKernelRecyclingStats
+    {
+        SKernelRecyclingStats() :
+            NumberOfCreates(0),
+            NumberOfRecycled(0),
+            CreateNS(0),
+            RecycleNS(0) {}
+
+        uint64_t    NumberOfCreates;
+        uint64_t    NumberOfRecycled;
+        uint64_t    CreateNS;
+        uint64_t    RecycleNS;
+    };
+
+    typedef std::map< std::string, SKernelRecyclingStats >  CKernelRecyclingStatsMap;
+    CKernelRecyclingStatsMap    m_KernelRecyclingStatsMap;
+
+    // These structures track a write generation for every memory object and
+    // SVM or USM allocation, and the memory write generations after each
+    // distinct kernel enqueue, to detect kernel enqueues that recompute the
+    // same results.
+
+    struct SRedundantKernelArgs
+    {
+        SRedundantKernelArgs() :
+            QueriedQualifiers(false) {}
+
+        std::map< cl_uint, std::vector<unsigned char> > Values;
+        std::set< cl_uint > ReadOnly;
+        std::set< cl_uint > WriteOnly;
+        bool    QueriedQualifiers;
+    };
+
+    typedef std::map< const cl_kernel, SRedundantKernelArgs >   CRedundantKernelArgsMap;
+    CRedundantKernelArgsMap m_RedundantKernelArgsMap;
+
+    typedef std::map< const void*, uint64_t >   CWriteGenerationMap;
+    CWriteGenerationMap m_WriteGenerationMap;
+
+    uint64_t    m_WriteGeneration;
+
+    // This records the write generations of the memory used by a kernel
+    // enqueue before the enqueue, for the memory the kernel may read, and
+    // after the enqueue, for the memory the kernel may write.
+    struct SRedundantKernelRecord
+    {
+        std::vector<uint64_t>   Before;
+        std::vector<uint64_t>   After;
+    };
+
+    typedef std::map< std::string, SRedundantKernelRecord > CRedundantKernelRecordMap;
+    CRedundantKernelRecordMap   m_RedundantKernelRecordMap;
+
+    // SVM and USM allocations the host may write without an OpenCL call,
+    // such as fine-grain SVM and USM host and shared allocations.  Writes to
+    // these allocations cannot be tracked.
+    typedef std::set< const void* > CHostAccessibleAllocationSet;
+    CHostAccessibleAllocationSet    m_HostAccessibleAllocationSet;
+
+    struct SRedundantKernelStats
+    {
+        SRedundantKernelStats() :
+            NumberOfEnqueues(0),
+            NumberOfRedundantEnqueues(0),
+            NumberOfTimedEnqueues(0),
+            RedundantNS(0) {}
+
+        uint64_t    NumberOfEnqueues;
+        uint64_t    NumberOfRedundantEnqueues;
+        uint64_t    NumberOfTimedEnqueues;
+        uint64_t    RedundantNS;
+    };
+
+    typedef std::map< std::string, SRedundantKernelStats >  CRedundantKernelStatsMap;
+    CRedundantKernelStatsMap    m_RedundantKernelStatsMap;
+
+    // This maps the enqueue counter of redundant kernel enqueues to the
+    // kernel name, until the device time for the enqueue is known.
+    typedef std::map< uint64_t, std::string >   CRedundantKernelEnqueueMap;
+    CRedundantKernelEnqueueMap  m_RedundantKernelEnqueueMap;
+
+    // These structures record the host accesses to mapped regions.  The
+    // pages of each tracked region are protected, and the SIGSEGV handler
+    // records the pages that are read or written and restores access.
+    // The regions themselves are in a fixed-size table that the signal
+    // handler can search without taking the mutex.
+
+    struct SMapAccessRecord
+    {
+        SMapAccessRecord() :
+            Slot(0),
+            MemObj(NULL),
+            Flags(0),
+            Size(0),
+            NumberOfPages(0) {}
+
+        size_t          Slot;
+        cl_mem          MemObj;
+        cl_map_flags    Flags;
+        size_t          Size;
+        size_t          NumberOfPages;
+    };
+
+    typedef std::map< const void*, SMapAccessRecord >   CMapAccessRecordMap;
+    CMapAccessRecordMap m_MapAccessRecordMap;
+
+    struct SMapAccessStats
+    {
+        SMapAccessStats() :
+            NumberOfMaps(0),
+            NumberOfLowTouchMaps(0),
+            MappedBytes(0),
+            TrackedBytes(0),
+            ReadBytes(0),
+            WrittenBytes(0),
+            NeedlessBytes(0) {}
+
+        uint64_t    NumberOfMaps;
+        uint64_t    NumberOfLowTouchMaps;
+        uint64_t    MappedBytes;
+        uint64_t    TrackedBytes;
+        uint64_t    ReadBytes;
+        uint64_t    WrittenBytes;
+        uint64_t    NeedlessBytes;
+    };
+
+    typedef std::map< std::string, SMapAccessStats >    CMapAccessStatsMap;
+    CMapAccessStatsMap  m_MapAccessStatsMap;
+
+    uint64_t    m_MapAccessUntrackedMaps;
+
+    // This structure aggregates errors by function name, error code, and
+    // kernel name, so repeated errors can be counted rather than logged.
+
+    struct SErrorStats
+    {
+        SErrorStats() :
+            ErrorCode(CL_SUCCESS),
+            NumberOfErrors(0),
+            NumberOfSuppressedErrors(0) {}
+
+        std::string FunctionName;
+        cl_int      ErrorCode;
+        std::string KernelName;
+
+        uint64_t    NumberOfErrors;
+
+        // This is the number of errors that have not been logged since the
+        // last time this error was logged or summarized.
+        uint64_t    NumberOfSuppressedErrors;
+        clock::time_point   LastLogTime;
+    };
+
+    typedef std::tuple< std::string, cl_int, std::string >  CErrorStatsKey;
+    typedef std::map< CErrorStatsKey, SErrorStats > CErrorStatsMap;
+    CErrorStatsMap  m_ErrorStatsMap;
+
+    void    logErrorSummary(
+                SErrorStats& errorStats,
+                clock::time_point now );
+    void    logPendingErrorSummaries();
+
+    // These structures record the memory footprint of each kernel enqueue,
+    // which is the total size of the memory objects and allocations passed
+    // as kernel arguments, and pair it with device time to estimate the
+    // effective bandwidth of each kernel.
+
+    struct SKernelFootprintStats
+    {
+        SKernelFootprintStats() :
+            NumberOfEnqueues(0),
+            MaxBytes(0),
+            TotalBytes(0),
+            NumberOfTimedEnqueues(0),
+            TimedBytes(0),
+            TimedNS(0) {}
+
+        uint64_t    NumberOfEnqueues;
+        uint64_t    MaxBytes;
+        uint64_t    TotalBytes;
+        uint64_t    NumberOfTimedEnqueues;
+        uint64_t    TimedBytes;
+        uint64_t    TimedNS;
+    };
+
+    typedef std::map< std::string, SKernelFootprintStats >  CKernelFootprintStatsMap;
+    CKernelFootprintStatsMap    m_KernelFootprintStatsMap;
+
+    // This maps the enqueue counter of kernel enqueues to the kernel name
+    // and footprint, until the device time for the enqueue is known.
+    typedef std::map< uint64_t, std::pair< std::string, uint64_t > >   CKernelFootprintEnqueueMap;
+    CKernelFootprintEnqueueMap  m_KernelFootprintEnqueueMap;
+
+    // These structures aggregate device activity over fixed intervals of
+    // host time, for bottleneck analysis.  Kernel durations are recorded in
+    // power-of-two histograms so the median can be estimated in constant
+    // space.
+
+    enum
+    {
+        BOTTLENECK_HISTOGRAM_BUCKETS = 40,
+    };
+
+    struct SBottleneckWindow
+    {
+        SBottleneckWindow() :
+            NumberOfEnqueues(0),
+            NumberOfKernels(0),
+            KernelNS(0),
+            TransferNS(0),
+            OtherNS(0)
+        {
+            for( int i = 0; i < BOTTLENECK_HISTOGRAM_BUCKETS; i++ )
+            {
+                KernelHistogram[i] = 0;
+            }
+        }
+
+        uint64_t    NumberOfEnqueues;
+        uint64_t    NumberOfKernels;
+        uint64_t    KernelNS;
+        uint64_t    TransferNS;
+        uint64_t    OtherNS;
+        uint32_t    KernelHistogram[BOTTLENECK_HISTOGRAM_BUCKETS];
     };
 
-    typedef std::list< SEventListNode > CEventList;
-    CEventList  m_EventList;
+    typedef std::map< uint64_t, SBottleneckWindow > CBottleneckWindowMap;
+    CBottleneckWindowMap    m_BottleneckWindowMap;
+
+    void    addBottleneckCommand(
+                const SEventListNode& node,
+                cl_ulong commandQueued,
+                cl_ulong commandStart,
+                cl_ulong commandEnd );
+    static const char* classifyBottleneck(
+                const SBottleneckWindow& window,
+                uint64_t windowNS,
+                std::string& evidence );
+
+    const void* getWriteGenerationKey(
+                    SAutoOutOfOrderResource resource ) const;
+    uint64_t    getWriteGeneration(
+                    const void* key );
+
+    SPinnedStagingPool* getPinnedStagingPool(
+                cl_command_queue queue,
+                const void* ptr,
+                size_t cb );
+    bool    initPinnedStagingPool(
+                cl_command_queue queue,
+                SPinnedStagingPool& pool );
+    void    addPinnedStagingTransfer(
+                const std::string& functionName,
+                bool staged,
+                bool timed,
+                size_t cb,
+                clock::time_point start );
+    void    copyPinnedStagingChunk(
+                void* dst,
+                const void* src,
+                size_t size ) const;
 
 #if defined(USE_MDAPI)
     MetricsDiscovery::MDHelper* m_pMDHelper;
@@ -1104,6 +2402,40 @@ private:
     typedef std::map< const cl_kernel, CKernelArgMemMap >   CKernelArgMap;
     CKernelArgMap   m_KernelArgMap;
 
+    // This tracks the values of scalar kernel arguments that are included
+    // in the device performance timing key.
+
+    struct SScalarArg
+    {
+        SScalarArg() :
+            Index(0),
+            IsSet(false),
+            Size(0),
+            Value(0) {}
+
+        cl_uint     Index;
+        std::string Name;
+        std::string TypeName;
+
+        bool        IsSet;
+        size_t      Size;
+        uint64_t    Value;
+    };
+
+    typedef std::vector< SScalarArg >   CScalarArgList;
+    typedef std::map< const cl_kernel, CScalarArgList > CScalarArgMap;
+    CScalarArgMap   m_ScalarArgMap;
+
+    // This tracks the distinct values seen for each kernel name and scalar
+    // argument, to limit the number of device timing keys.
+    typedef std::map< std::string, std::set< std::string > >   CScalarArgValuesMap;
+    CScalarArgValuesMap m_ScalarArgValuesMap;
+
+    CScalarArgList& getScalarArgList(
+                cl_kernel kernel );
+    std::string getScalarArgString(
+                cl_kernel kernel );
+
     bool    m_AubCaptureStarted;
     cl_uint m_AubCaptureKernelEnqueueSkipCounter;
     cl_uint m_AubCaptureKernelEnqueueCaptureCounter;
@@ -1111,6 +2443,26 @@ private:
     typedef std::set<std::string>   CAubCaptureSet;
     CAubCaptureSet  m_AubCaptureSet;
 
+    // This tracks the capture window.  Outside of the capture window,
+    // call logging and Chrome call logging are paused, and device
+    // performance timing is skipped.  The config is never modified.  The
+    // state is kept in atomics, so each enqueue can check whether the
+    // capture window may start or stop without taking the mutex.
+
+    std::atomic<bool>       m_CaptureWindowActive;
+    std::atomic<bool>       m_CaptureWindowTriggered;
+    std::atomic<bool>       m_CaptureWindowStartKernelCreated;
+    std::atomic<uint64_t>   m_CaptureWindowSignalCount;
+    std::atomic<uint64_t>   m_CaptureWindowStartEnqueue;
+    std::atomic<uint64_t>   m_CaptureWindowStartNS;
+
+    void    startCaptureWindow(
+                uint64_t enqueueCounter,
+                const char* reason );
+    void    stopCaptureWindow(
+                uint64_t enqueueCounter,
+                const char* reason );
+
     typedef std::map< const cl_context, SContextCallbackInfo* >  CContextCallbackInfoMap;
     CContextCallbackInfoMap m_ContextCallbackInfoMap;
 
@@ -1702,7 +3054,7 @@ inline uint64_t CLIntercept::getEnqueueCounter() const
 
 inline uint64_t CLIntercept::incrementEnqueueCounter()
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
     return m_EnqueueCounter++;
 }
 
@@ -1710,7 +3062,27 @@ inline uint64_t CLIntercept::incrementEnqueueCounter()
     uint64_t enqueueCounter = pIntercept->getEnqueueCounter();
 
 #define INCREMENT_ENQUEUE_COUNTER()                                         \
-    uint64_t enqueueCounter = pIntercept->incrementEnqueueCounter();
+    uint64_t enqueueCounter = pIntercept->incrementEnqueueCounter();        \
+    CHECK_CAPTURE_WINDOW( NULL )
+
+#define INCREMENT_ENQUEUE_COUNTER_KERNEL( kernel )                          \
+    uint64_t enqueueCounter = pIntercept->incrementEnqueueCounter();        \
+    CHECK_CAPTURE_WINDOW( kernel )
+
+///////////////////////////////////////////////////////////////////////////////
+//
+inline bool CLIntercept::captureWindowEnabled() const
+{
+    return m_Config.CaptureWindowStartSeconds ||
+           m_Config.CaptureWindowStartSignal ||
+           !m_Config.CaptureWindowStartKernelName.empty();
+}
+
+#define CHECK_CAPTURE_WINDOW( kernel )                                      \
+    if( pIntercept->captureWindowEnabled() )                                \
+    {                                                                       \
+        pIntercept->checkCaptureWindow( enqueueCounter, kernel );           \
+    }
 
 ///////////////////////////////////////////////////////////////////////////////
 //
@@ -1767,7 +3139,8 @@ inline CObjectTracker& CLIntercept::objectTracker()
 ///////////////////////////////////////////////////////////////////////////////
 //
 #define CALL_LOGGING_ENTER(...)                                             \
-    if( pIntercept->config().CallLogging )                                  \
+    if( pIntercept->config().CallLogging &&                                 \
+        pIntercept->enterCallLogging() )                                    \
     {                                                                       \
         pIntercept->callLoggingEnter(                                       \
             __FUNCTION__, enqueueCounter, NULL, ##__VA_ARGS__ );            \
@@ -1775,7 +3148,8 @@ inline CObjectTracker& CLIntercept::objectTracker()
     ITT_CALL_LOGGING_ENTER( NULL );
 
 #define CALL_LOGGING_ENTER_KERNEL(kernel, ...)                              \
-    if( pIntercept->config().CallLogging )                                  \
+    if( pIntercept->config().CallLogging &&                                 \
+        pIntercept->enterCallLogging() )                                    \
     {                                                                       \
         pIntercept->callLoggingEnter(                                       \
             __FUNCTION__, enqueueCounter, kernel, ##__VA_ARGS__ );          \
@@ -1783,13 +3157,15 @@ inline CObjectTracker& CLIntercept::objectTracker()
     ITT_CALL_LOGGING_ENTER( kernel );
 
 #define CALL_LOGGING_INFO(...)                                              \
-    if( pIntercept->config().CallLogging )                                  \
+    if( pIntercept->config().CallLogging &&                                 \
+        CLIntercept::callLoggingActiveForThread() )                         \
     {                                                                       \
         pIntercept->callLoggingInfo( __VA_ARGS__ );                         \
     }                                                                       \
 
 #define CALL_LOGGING_EXIT(errorCode, ...)                                   \
-    if( pIntercept->config().CallLogging )                                  \
+    if( pIntercept->config().CallLogging &&                                 \
+        CLIntercept::callLoggingActiveForThread() )                         \
     {                                                                       \
         pIntercept->callLoggingExit(                                        \
             __FUNCTION__,                                                   \
@@ -1797,7 +3173,8 @@ inline CObjectTracker& CLIntercept::objectTracker()
             NULL,                                                           \
             ##__VA_ARGS__ );                                                \
     }                                                                       \
-    if( pIntercept->config().ChromeCallLogging )                            \
+    if( pIntercept->config().ChromeCallLogging &&                           \
+        !pIntercept->callLoggingPaused() )                                  \
     {                                                                       \
         pIntercept->chromeCallLoggingExit(                                  \
             __FUNCTION__,                                                   \
@@ -1810,7 +3187,8 @@ inline CObjectTracker& CLIntercept::objectTracker()
     ITT_CALL_LOGGING_EXIT();
 
 #define CALL_LOGGING_EXIT_EVENT(errorCode, event, ...)                      \
-    if( pIntercept->config().CallLogging )                                  \
+    if( pIntercept->config().CallLogging &&                                 \
+        CLIntercept::callLoggingActiveForThread() )                         \
     {                                                                       \
         pIntercept->callLoggingExit(                                        \
             __FUNCTION__,                                                   \
@@ -1818,7 +3196,8 @@ inline CObjectTracker& CLIntercept::objectTracker()
             event,                                                          \
             ##__VA_ARGS__ );                                                \
     }                                                                       \
-    if( pIntercept->config().ChromeCallLogging )                            \
+    if( pIntercept->config().ChromeCallLogging &&                           \
+        !pIntercept->callLoggingPaused() )                                  \
     {                                                                       \
         pIntercept->chromeCallLoggingExit(                                  \
             __FUNCTION__,                                                   \
@@ -1831,7 +3210,8 @@ inline CObjectTracker& CLIntercept::objectTracker()
     ITT_CALL_LOGGING_EXIT();
 
 #define CALL_LOGGING_EXIT_KERNEL_EVENT(errorCode, kernel, event, ...)       \
-    if( pIntercept->config().CallLogging )                                  \
+    if( pIntercept->config().CallLogging &&                                 \
+        CLIntercept::callLoggingActiveForThread() )                         \
     {                                                                       \
         pIntercept->callLoggingExit(                                        \
             __FUNCTION__,                                                   \
@@ -1839,7 +3219,8 @@ inline CObjectTracker& CLIntercept::objectTracker()
             event,                                                          \
             ##__VA_ARGS__ );                                                \
     }                                                                       \
-    if( pIntercept->config().ChromeCallLogging )                            \
+    if( pIntercept->config().ChromeCallLogging &&                           \
+        !pIntercept->callLoggingPaused() )                                  \
     {                                                                       \
         pIntercept->chromeCallLoggingExit(                                  \
             __FUNCTION__,                                                   \
@@ -1865,6 +3246,9 @@ inline CObjectTracker& CLIntercept::objectTracker()
     }
 
 #define CHECK_ERROR( errorCode )                                            \
+    CHECK_ERROR_KERNEL( errorCode, NULL )
+
+#define CHECK_ERROR_KERNEL( errorCode, kernel )                             \
     if( ( pIntercept->config().ErrorLogging ||                              \
           pIntercept->config().ErrorAssert ||                               \
           pIntercept->config().NoErrors ) &&                                \
@@ -1872,7 +3256,7 @@ inline CObjectTracker& CLIntercept::objectTracker()
     {                                                                       \
         if( pIntercept->config().ErrorLogging )                             \
         {                                                                   \
-            pIntercept->logError( __FUNCTION__, errorCode );                \
+            pIntercept->logError( __FUNCTION__, errorCode, kernel );        \
         }                                                                   \
         if( pIntercept->config().ErrorAssert )                              \
         {                                                                   \
@@ -2051,18 +3435,28 @@ inline bool CLIntercept::checkDumpImageEnqueueLimits(
 
 #define ADD_BUFFER( _buffer )                                               \
     if( _buffer &&                                                          \
-        ( pIntercept->config().DumpBuffersAfterCreate ||                    \
+        ( pIntercept->config().AutoOutOfOrderQueue ||                       \
+          pIntercept->config().RedundantKernelChecking ||                   \
+          pIntercept->config().KernelFootprintAnalysis ||                   \
+          pIntercept->config().MapAccessTracking ||                         \
+          pIntercept->config().CoalesceBufferWrites ||                      \
+          pIntercept->config().ZeroCopyChecking ||                          \
+          pIntercept->config().DumpBuffersAfterCreate ||                    \
           pIntercept->config().DumpBuffersAfterMap ||                       \
           pIntercept->config().DumpBuffersBeforeUnmap ||                    \
           pIntercept->config().DumpBuffersBeforeEnqueue ||                  \
-          pIntercept->config().DumpBuffersAfterEnqueue ) )                  \
+          pIntercept->config().DumpBuffersAfterEnqueue ||                   \
+          pIntercept->config().KernelAnomalyDumpBuffers ) )                 \
     {                                                                       \
         pIntercept->addBuffer( _buffer );                                   \
     }
 
 #define ADD_IMAGE( _image )                                                 \
     if( _image &&                                                           \
-        ( pIntercept->config().DumpImagesBeforeEnqueue ||                   \
+        ( pIntercept->config().AutoOutOfOrderQueue ||                       \
+          pIntercept->config().RedundantKernelChecking ||                   \
+          pIntercept->config().KernelFootprintAnalysis ||                   \
+          pIntercept->config().DumpImagesBeforeEnqueue ||                   \
           pIntercept->config().DumpImagesAfterEnqueue ) )                   \
     {                                                                       \
         pIntercept->addImage( _image );                                     \
@@ -2070,11 +3464,18 @@ inline bool CLIntercept::checkDumpImageEnqueueLimits(
 
 #define REMOVE_MEMOBJ( _memobj )                                            \
     if( _memobj &&                                                          \
-        ( pIntercept->config().DumpBuffersAfterCreate ||                    \
+        ( pIntercept->config().AutoOutOfOrderQueue ||                       \
+          pIntercept->config().RedundantKernelChecking ||                   \
+          pIntercept->config().KernelFootprintAnalysis ||                   \
+          pIntercept->config().MapAccessTracking ||                         \
+          pIntercept->config().CoalesceBufferWrites ||                      \
+          pIntercept->config().ZeroCopyChecking ||                          \
+          pIntercept->config().DumpBuffersAfterCreate ||                    \
           pIntercept->config().DumpBuffersAfterMap ||                       \
           pIntercept->config().DumpBuffersBeforeUnmap ||                    \
           pIntercept->config().DumpBuffersBeforeEnqueue ||                  \
           pIntercept->config().DumpBuffersAfterEnqueue ||                   \
+          pIntercept->config().KernelAnomalyDumpBuffers ||                  \
           pIntercept->config().DumpImagesBeforeEnqueue ||                   \
           pIntercept->config().DumpImagesAfterEnqueue ) )                   \
     {                                                                       \
@@ -2095,34 +3496,54 @@ inline bool CLIntercept::checkDumpImageEnqueueLimits(
         pIntercept->checkRemoveSamplerString( sampler );                    \
     }
 
-#define ADD_SVM_ALLOCATION( svmPtr, size )                                  \
+#define ADD_SVM_ALLOCATION( svmPtr, size, hostAccessible )                  \
     if( svmPtr &&                                                           \
-        ( pIntercept->config().DumpBuffersBeforeEnqueue ||                  \
-          pIntercept->config().DumpBuffersAfterEnqueue ) )                  \
+        ( pIntercept->config().AutoOutOfOrderQueue ||                       \
+          pIntercept->config().RedundantKernelChecking ||                   \
+          pIntercept->config().KernelFootprintAnalysis ||                   \
+          pIntercept->config().PinnedStagingTransfers ||                    \
+          pIntercept->config().DumpBuffersBeforeEnqueue ||                  \
+          pIntercept->config().DumpBuffersAfterEnqueue ||                   \
+          pIntercept->config().KernelAnomalyDumpBuffers ) )                 \
     {                                                                       \
-        pIntercept->addSVMAllocation( svmPtr, size );                       \
+        pIntercept->addSVMAllocation( svmPtr, size, hostAccessible );       \
     }
 
 #define REMOVE_SVM_ALLOCATION( svmPtr )                                     \
     if( svmPtr &&                                                           \
-        ( pIntercept->config().DumpBuffersBeforeEnqueue ||                  \
-          pIntercept->config().DumpBuffersAfterEnqueue ) )                  \
+        ( pIntercept->config().AutoOutOfOrderQueue ||                       \
+          pIntercept->config().RedundantKernelChecking ||                   \
+          pIntercept->config().KernelFootprintAnalysis ||                   \
+          pIntercept->config().PinnedStagingTransfers ||                    \
+          pIntercept->config().DumpBuffersBeforeEnqueue ||                  \
+          pIntercept->config().DumpBuffersAfterEnqueue ||                   \
+          pIntercept->config().KernelAnomalyDumpBuffers ) )                 \
     {                                                                       \
         pIntercept->removeSVMAllocation( svmPtr );                          \
     }
 
-#define ADD_USM_ALLOCATION( usmPtr, size )                                  \
+#define ADD_USM_ALLOCATION( usmPtr, size, hostAccessible )                  \
     if( usmPtr &&                                                           \
-        ( pIntercept->config().DumpBuffersBeforeEnqueue ||                  \
-          pIntercept->config().DumpBuffersAfterEnqueue ) )                  \
+        ( pIntercept->config().AutoOutOfOrderQueue ||                       \
+          pIntercept->config().RedundantKernelChecking ||                   \
+          pIntercept->config().KernelFootprintAnalysis ||                   \
+          pIntercept->config().PinnedStagingTransfers ||                    \
+          pIntercept->config().DumpBuffersBeforeEnqueue ||                  \
+          pIntercept->config().DumpBuffersAfterEnqueue ||                   \
+          pIntercept->config().KernelAnomalyDumpBuffers ) )                 \
     {                                                                       \
-        pIntercept->addUSMAllocation( usmPtr, size );                       \
+        pIntercept->addUSMAllocation( usmPtr, size, hostAccessible );       \
     }
 
 #define REMOVE_USM_ALLOCATION( usmPtr )                                     \
     if( usmPtr &&                                                           \
-        ( pIntercept->config().DumpBuffersBeforeEnqueue ||                  \
-          pIntercept->config().DumpBuffersAfterEnqueue ) )                  \
+        ( pIntercept->config().AutoOutOfOrderQueue ||                       \
+          pIntercept->config().RedundantKernelChecking ||                   \
+          pIntercept->config().KernelFootprintAnalysis ||                   \
+          pIntercept->config().PinnedStagingTransfers ||                    \
+          pIntercept->config().DumpBuffersBeforeEnqueue ||                  \
+          pIntercept->config().DumpBuffersAfterEnqueue ||                   \
+          pIntercept->config().KernelAnomalyDumpBuffers ) )                 \
     {                                                                       \
         pIntercept->removeUSMAllocation( usmPtr );                          \
     }
@@ -2133,55 +3554,83 @@ inline bool CLIntercept::checkDumpImageEnqueueLimits(
         pIntercept->dumpArgument(                                           \
             enqueueCounter, kernel, arg_index, arg_size, arg_value );       \
     }                                                                       \
-    if( ( pIntercept->config().DumpBuffersBeforeEnqueue ||                  \
+    if( ( pIntercept->config().AutoOutOfOrderQueue ||                       \
+          pIntercept->config().RedundantKernelChecking ||                   \
+          pIntercept->config().KernelFootprintAnalysis ||                   \
+          pIntercept->config().DumpBuffersBeforeEnqueue ||                  \
           pIntercept->config().DumpBuffersAfterEnqueue ||                   \
+          pIntercept->config().KernelAnomalyDumpBuffers ||                  \
           pIntercept->config().DumpImagesBeforeEnqueue ||                   \
-          pIntercept->config().DumpImagesAfterEnqueue ) &&                  \
-        ( arg_value != NULL ) &&                                            \
-        ( arg_size == sizeof(cl_mem) ) )                                    \
+          pIntercept->config().DumpImagesAfterEnqueue ) )                   \
     {                                                                       \
-        cl_mem* pMem = (cl_mem*)arg_value;                                  \
-        pIntercept->setKernelArg( kernel, arg_index, pMem[0] );             \
+        pIntercept->setKernelArg( kernel, arg_index, arg_size, arg_value ); \
+    }                                                                       \
+    if( pIntercept->config().RedundantKernelChecking )                      \
+    {                                                                       \
+        pIntercept->redundantKernelSetArg(                                  \
+            kernel, arg_index, arg_size, arg_value );                       \
+    }                                                                       \
+    if( !pIntercept->config().DevicePerformanceTimeScalarArgTracking.empty() )\
+    {                                                                       \
+        pIntercept->setKernelArgScalar(                                     \
+            kernel, arg_index, arg_size, arg_value );                       \
     }
 
 #define SET_KERNEL_ARG_SVM_POINTER( kernel, arg_index, arg_value )          \
-    if( pIntercept->config().DumpBuffersBeforeEnqueue ||                    \
-        pIntercept->config().DumpBuffersAfterEnqueue )                      \
+    if( pIntercept->config().AutoOutOfOrderQueue ||                         \
+        pIntercept->config().RedundantKernelChecking ||                     \
+        pIntercept->config().KernelFootprintAnalysis ||                     \
+        pIntercept->config().DumpBuffersBeforeEnqueue ||                    \
+        pIntercept->config().DumpBuffersAfterEnqueue ||                     \
+        pIntercept->config().KernelAnomalyDumpBuffers )                     \
     {                                                                       \
         pIntercept->setKernelArgSVMPointer( kernel, arg_index, arg_value ); \
+    }                                                                       \
+    if( pIntercept->config().RedundantKernelChecking )                      \
+    {                                                                       \
+        pIntercept->redundantKernelSetArg(                                  \
+            kernel, arg_index, sizeof(arg_value), &arg_value );             \
     }
 
 #define SET_KERNEL_ARG_USM_POINTER( kernel, arg_index, arg_value )          \
-    if( pIntercept->config().DumpBuffersBeforeEnqueue ||                    \
-        pIntercept->config().DumpBuffersAfterEnqueue )                      \
+    if( pIntercept->config().AutoOutOfOrderQueue ||                         \
+        pIntercept->config().RedundantKernelChecking ||                     \
+        pIntercept->config().KernelFootprintAnalysis ||                     \
+        pIntercept->config().DumpBuffersBeforeEnqueue ||                    \
+        pIntercept->config().DumpBuffersAfterEnqueue ||                     \
+        pIntercept->config().KernelAnomalyDumpBuffers )                     \
     {                                                                       \
         pIntercept->setKernelArgUSMPointer( kernel, arg_index, arg_value ); \
+    }                                                                       \
+    if( pIntercept->config().RedundantKernelChecking )                      \
+    {                                                                       \
+        pIntercept->redundantKernelSetArg(                                  \
+            kernel, arg_index, sizeof(arg_value), &arg_value );             \
     }
 
 #define INITIALIZE_BUFFER_CONTENTS_INIT( _flags, _size, _ptr )              \
-    char*   zeroData = NULL;                                                \
-    if( pIntercept->config().InitializeBuffers &&                           \
+    bool    initializeBuffer =                                              \
+        pIntercept->config().InitializeBuffers &&                           \
         _ptr == NULL &&                                                     \
-        !( _flags & ( CL_MEM_USE_HOST_PTR | CL_MEM_COPY_HOST_PTR ) ) )      \
+        !( _flags & ( CL_MEM_USE_HOST_PTR | CL_MEM_COPY_HOST_PTR ) );
+
+#define INITIALIZE_BUFFER_CONTENTS( _buffer, _size )                        \
+    if( initializeBuffer && _buffer )                                       \
     {                                                                       \
-        zeroData = new char[ _size ];                                       \
-        if( zeroData != NULL )                                              \
-        {                                                                   \
-            memset( zeroData, 0, _size );                                   \
-            _ptr = zeroData;                                                \
-            _flags |= (cl_mem_flags)CL_MEM_COPY_HOST_PTR;                   \
-        }                                                                   \
+        pIntercept->initializeBufferContents( _buffer, _size );             \
+    }
+
+#define INITIALIZE_BUFFERS_CONTEXT_INFO( _context, _param )                 \
+    if( pIntercept->config().InitializeBuffers &&                           \
+        _param == CL_CONTEXT_REFERENCE_COUNT )                              \
+    {                                                                       \
+        pIntercept->releaseInitializeBuffersQueue( _context );              \
     }
 
-// Note: The cleanup setup currently does not reset the flags or host pointer.
-// This mostly means that initialized buffers may be dumped after creation,
-// whereas if the flags were reset then the dump buffer after create step
-// would not be triggered.
-#define INITIALIZE_BUFFER_CONTENTS_CLEANUP( _flags, _ptr )                  \
-    if( zeroData != NULL )                                                  \
+#define INITIALIZE_BUFFERS_RELEASE_CONTEXT( _context )                      \
+    if( pIntercept->config().InitializeBuffers && _context )                \
     {                                                                       \
-        delete [] zeroData;                                                 \
-        zeroData = NULL;                                                    \
+        pIntercept->releaseInitializeBuffersQueue( _context );              \
     }
 
 #define DUMP_BUFFER_AFTER_CREATE( memobj, flags, ptr, size )                \
@@ -2236,6 +3685,13 @@ inline bool CLIntercept::checkDumpImageEnqueueLimits(
             "Post", enqueueCounter, kernel, command_queue );                \
     }
 
+#define KERNEL_ANOMALY_DUMP_BUFFERS( kernel, command_queue )                \
+    if( pIntercept->config().KernelAnomalyDumpBuffers )                     \
+    {                                                                       \
+        pIntercept->kernelAnomalyDumpBuffers(                               \
+            enqueueCounter, kernel, command_queue );                        \
+    }
+
 #define DUMP_IMAGES_BEFORE_ENQUEUE( kernel, command_queue )                 \
     if( pIntercept->checkDumpImageEnqueueLimits( enqueueCounter ) &&        \
         pIntercept->config().DumpImagesBeforeEnqueue &&                     \
@@ -2610,14 +4066,20 @@ inline bool CLIntercept::checkHostPerformanceTimingEnqueueLimits(
 #define CPU_PERFORMANCE_TIMING_START()                                      \
     CLIntercept::clock::time_point   cpuStart, cpuEnd;                      \
     if( pIntercept->config().HostPerformanceTiming ||                       \
-        pIntercept->config().ChromeCallLogging )                            \
+        pIntercept->config().ChromeCallLogging ||                           \
+        pIntercept->config().RedundantSyncChecking ||                       \
+        ( pIntercept->config().StartupProfile &&                            \
+          !pIntercept->startupProfileComplete() ) )                         \
     {                                                                       \
         cpuStart = CLIntercept::clock::now();                               \
     }
 
 #define CPU_PERFORMANCE_TIMING_END()                                        \
     if( pIntercept->config().HostPerformanceTiming ||                       \
-        pIntercept->config().ChromeCallLogging )                            \
+        pIntercept->config().ChromeCallLogging ||                           \
+        pIntercept->config().RedundantSyncChecking ||                       \
+        ( pIntercept->config().StartupProfile &&                            \
+          !pIntercept->startupProfileComplete() ) )                         \
     {                                                                       \
         cpuEnd = CLIntercept::clock::now();                                 \
         if( pIntercept->config().HostPerformanceTiming &&                   \
@@ -2629,11 +4091,18 @@ inline bool CLIntercept::checkHostPerformanceTimingEnqueueLimits(
                 cpuStart,                                                   \
                 cpuEnd );                                                   \
         }                                                                   \
+        if( pIntercept->config().StartupProfile &&                          \
+            cpuStart != CLIntercept::clock::time_point() )                  \
+        {                                                                   \
+            pIntercept->startupProfileCall( __FUNCTION__, cpuStart, cpuEnd );\
+        }                                                                   \
     }
 
 #define CPU_PERFORMANCE_TIMING_END_KERNEL( _kernel )                        \
     if( pIntercept->config().HostPerformanceTiming ||                       \
-        pIntercept->config().ChromeCallLogging )                            \
+        pIntercept->config().ChromeCallLogging ||                           \
+        ( pIntercept->config().StartupProfile &&                            \
+          !pIntercept->startupProfileComplete() ) )                         \
     {                                                                       \
         cpuEnd = CLIntercept::clock::now();                                 \
         if( pIntercept->config().HostPerformanceTiming &&                   \
@@ -2645,6 +4114,19 @@ inline bool CLIntercept::checkHostPerformanceTimingEnqueueLimits(
                 cpuStart,                                                   \
                 cpuEnd );                                                   \
         }                                                                   \
+        if( pIntercept->config().StartupProfile &&                          \
+            cpuStart != CLIntercept::clock::time_point() )                  \
+        {                                                                   \
+            pIntercept->startupProfileCall( __FUNCTION__, cpuStart, cpuEnd );\
+        }                                                                   \
+    }
+
+#define STARTUP_PROFILE_KERNEL_ENQUEUE( _queue, _success )                  \
+    if( pIntercept->config().StartupProfile &&                              \
+        !pIntercept->startupProfileComplete() &&                            \
+        _success )                                                          \
+    {                                                                       \
+        pIntercept->startupProfileKernelEnqueue( _queue );                  \
     }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2653,7 +4135,34 @@ inline bool CLIntercept::checkDevicePerformanceTimingEnqueueLimits(
     uint64_t enqueueCounter ) const
 {
     return ( enqueueCounter >= m_Config.DevicePerformanceTimingMinEnqueue ) &&
-           ( enqueueCounter <= m_Config.DevicePerformanceTimingMaxEnqueue );
+           ( enqueueCounter <= m_Config.DevicePerformanceTimingMaxEnqueue ) &&
+           ( enqueueCounter % m_OverheadBudgetSampleFactor.load( std::memory_order_relaxed ) == 0 ) &&
+           m_CaptureWindowActive.load( std::memory_order_relaxed );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+inline bool CLIntercept::callLoggingPaused() const
+{
+    return m_OverheadBudgetCallLoggingPaused.load( std::memory_order_relaxed ) ||
+           !m_CaptureWindowActive.load( std::memory_order_relaxed );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+inline bool& CLIntercept::callLoggingActiveForThread()
+{
+    static thread_local bool    active = true;
+    return active;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+inline bool CLIntercept::enterCallLogging() const
+{
+    bool&   active = callLoggingActiveForThread();
+    active = !callLoggingPaused();
+    return active;
 }
 
 #define CREATE_COMMAND_QUEUE_PROPERTIES( _device, _props, _newprops )       \
@@ -2672,6 +4181,7 @@ inline bool CLIntercept::checkDevicePerformanceTimingEnqueueLimits(
         pIntercept->config().ChromePerformanceTiming ||                     \
         pIntercept->config().DevicePerfCounterEventBasedSampling ||         \
         pIntercept->config().InOrderQueue ||                                \
+        pIntercept->config().AutoOutOfOrderQueue ||                         \
         pIntercept->config().NoProfilingQueue ||                            \
         pIntercept->config().DefaultQueuePriorityHint ||                    \
         pIntercept->config().DefaultQueueThrottleHint )                     \
@@ -2704,10 +4214,13 @@ inline bool CLIntercept::checkDevicePerformanceTimingEnqueueLimits(
     CLIntercept::clock::time_point   queuedTime;                            \
     cl_event    local_event = NULL;                                         \
     bool        retainAppEvent = true;                                      \
-    if( pIntercept->config().DevicePerformanceTiming ||                     \
-        pIntercept->config().ITTPerformanceTiming ||                        \
-        pIntercept->config().ChromePerformanceTiming ||                     \
-        pIntercept->config().DevicePerfCounterEventBasedSampling )          \
+    const bool  deviceTiming =                                              \
+        ( pIntercept->config().DevicePerformanceTiming ||                   \
+          pIntercept->config().ITTPerformanceTiming ||                      \
+          pIntercept->config().ChromePerformanceTiming ||                   \
+          pIntercept->config().DevicePerfCounterEventBasedSampling ) &&     \
+        pIntercept->checkDevicePerformanceTimingEnqueueLimits( enqueueCounter );\
+    if( deviceTiming )                                                      \
     {                                                                       \
         queuedTime = CLIntercept::clock::now();                             \
         if( pEvent == NULL )                                                \
@@ -2722,9 +4235,9 @@ inline bool CLIntercept::checkDevicePerformanceTimingEnqueueLimits(
           pIntercept->config().ITTPerformanceTiming ||                      \
           pIntercept->config().ChromePerformanceTiming ||                   \
           pIntercept->config().DevicePerfCounterEventBasedSampling ) &&     \
-        ( pEvent != NULL ) )                                                \
+        ( pEvent != NULL ) && ( pEvent[0] != NULL ) )                       \
     {                                                                       \
-        if( !pIntercept->checkDevicePerformanceTimingEnqueueLimits( enqueueCounter ) ||\
+        if( !deviceTiming ||                                                \
             ( pIntercept->config().DevicePerformanceTimingSkipUnmap &&      \
               std::string(__FUNCTION__) == "clEnqueueUnmapMemObject" ) )    \
         {                                                                   \
@@ -2762,7 +4275,7 @@ inline bool CLIntercept::checkDevicePerformanceTimingEnqueueLimits(
           pIntercept->config().DevicePerfCounterEventBasedSampling ) &&     \
         ( pEvent != NULL ) )                                                \
     {                                                                       \
-        if( !pIntercept->checkDevicePerformanceTimingEnqueueLimits( enqueueCounter ) )\
+        if( !deviceTiming )                                                 \
         {                                                                   \
             if( retainAppEvent == false )                                   \
             {                                                               \
@@ -2791,6 +4304,348 @@ inline bool CLIntercept::checkDevicePerformanceTimingEnqueueLimits(
         }                                                                   \
     }
 
+#define HOST_BLOCKING_TIME_START( _blocking, _queue )                       \
+    CLIntercept::CBlockingEventList blockingEvents;                         \
+    CLIntercept::clock::time_point  blockingStart;                          \
+    if( pIntercept->config().HostBlockingTimeAttribution && ( _blocking ) ) \
+    {                                                                       \
+        pIntercept->getPendingTimingEvents( _queue, blockingEvents );       \
+        blockingStart = CLIntercept::clock::now();                          \
+    }
+
+#define HOST_BLOCKING_TIME_WAIT_START( _numEvents, _eventList )             \
+    CLIntercept::CBlockingEventList blockingEvents;                         \
+    CLIntercept::clock::time_point  blockingStart;                          \
+    if( pIntercept->config().HostBlockingTimeAttribution )                  \
+    {                                                                       \
+        pIntercept->getPendingTimingEvents(                                 \
+            _numEvents,                                                     \
+            _eventList,                                                     \
+            blockingEvents );                                               \
+        blockingStart = CLIntercept::clock::now();                          \
+    }
+
+#define HOST_BLOCKING_TIME_END( _blocking, _event )                         \
+    if( pIntercept->config().HostBlockingTimeAttribution && ( _blocking ) ) \
+    {                                                                       \
+        CLIntercept::clock::time_point  blockingEnd =                       \
+            CLIntercept::clock::now();                                      \
+        pIntercept->attributeHostBlockingTime(                              \
+            __FUNCTION__,                                                   \
+            _event,                                                         \
+            blockingEvents,                                                 \
+            blockingStart,                                                  \
+            blockingEnd );                                                  \
+    }
+
+#define AUTO_OUT_OF_ORDER_QUEUE_INIT( _props )                              \
+    bool    autoOutOfOrderQueue = false;                                    \
+    if( pIntercept->config().AutoOutOfOrderQueue )                          \
+    {                                                                       \
+        autoOutOfOrderQueue =                                               \
+            pIntercept->checkAutoOutOfOrderQueueProperties( _props );       \
+    }
+
+#define ADD_AUTO_OUT_OF_ORDER_QUEUE( _queue )                               \
+    if( autoOutOfOrderQueue && _queue )                                     \
+    {                                                                       \
+        pIntercept->addAutoOutOfOrderQueue( _queue );                       \
+    }
+
+#define REMOVE_AUTO_OUT_OF_ORDER_QUEUE( _queue )                            \
+    if( pIntercept->config().AutoOutOfOrderQueue && _queue )                \
+    {                                                                       \
+        pIntercept->checkRemoveAutoOutOfOrderQueue( _queue );               \
+    }
+
+#define AUTO_OUT_OF_ORDER_QUEUE_INFO( _queue, _param, _value )              \
+    if( pIntercept->config().AutoOutOfOrderQueue &&                         \
+        retVal == CL_SUCCESS &&                                             \
+        _value != NULL )                                                    \
+    {                                                                       \
+        pIntercept->autoOutOfOrderQueueInfo( _queue, _param, _value );      \
+    }
+
+#define AUTO_OUT_OF_ORDER_KERNEL_EXEC_INFO( _kernel )                       \
+    if( ( pIntercept->config().AutoOutOfOrderQueue ||                       \
+          pIntercept->config().RedundantKernelChecking ) &&                 \
+        retVal == CL_SUCCESS )                                              \
+    {                                                                       \
+        pIntercept->autoOutOfOrderKernelExecInfo( _kernel );                \
+    }
+
+#define CLONE_KERNEL_ARGS( _kernel, _clone )                                \
+    if( _clone &&                                                           \
+        ( pIntercept->config().AutoOutOfOrderQueue ||                       \
+          pIntercept->config().RedundantKernelChecking ||                   \
+          pIntercept->config().KernelFootprintAnalysis ||                   \
+          !pIntercept->config().DevicePerformanceTimeScalarArgTracking.empty() ||\
+          pIntercept->config().DumpBuffersBeforeEnqueue ||                  \
+          pIntercept->config().DumpBuffersAfterEnqueue ||                   \
+          pIntercept->config().KernelAnomalyDumpBuffers ||                  \
+          pIntercept->config().DumpImagesBeforeEnqueue ||                   \
+          pIntercept->config().DumpImagesAfterEnqueue ) )                   \
+    {                                                                       \
+        pIntercept->cloneKernelArgs( _kernel, _clone );                     \
+    }
+
+// The application requested an event if the event is not the local event
+// for device performance timing.
+#define AUTO_OUT_OF_ORDER_START( _queue, _blocking, _numEvents, _eventList, _event, _command )\
+    AUTO_OUT_OF_ORDER_START_APP_EVENT(                                      \
+        _queue,                                                             \
+        _blocking,                                                          \
+        _numEvents,                                                         \
+        _eventList,                                                         \
+        _event,                                                             \
+        _event != NULL && retainAppEvent,                                   \
+        _command )
+
+#define AUTO_OUT_OF_ORDER_START_APP_EVENT( _queue, _blocking, _numEvents, _eventList, _event, _appEvent, _command )\
+    CLIntercept::SAutoOutOfOrderCommand autoOutOfOrderCommand;              \
+    cl_event    autoOutOfOrderEvent = NULL;                                 \
+    if( pIntercept->config().AutoOutOfOrderQueue ||                         \
+        pIntercept->config().RedundantKernelChecking )                      \
+    {                                                                       \
+        autoOutOfOrderCommand._command;                                     \
+    }                                                                       \
+    if( pIntercept->config().AutoOutOfOrderQueue &&                         \
+        pIntercept->autoOutOfOrderStart(                                    \
+            _queue,                                                         \
+            _blocking != CL_FALSE,                                          \
+            _appEvent,                                                      \
+            autoOutOfOrderCommand,                                          \
+            _numEvents,                                                     \
+            _eventList ) &&                                                 \
+        _event == NULL )                                                    \
+    {                                                                       \
+        _event = &autoOutOfOrderEvent;                                      \
+    }
+
+#define AUTO_OUT_OF_ORDER_END( _success, _event )                           \
+    if( pIntercept->config().RedundantKernelChecking &&                     \
+        ( _success ) &&                                                     \
+        autoOutOfOrderCommand.Kernel == NULL )                              \
+    {                                                                       \
+        pIntercept->redundantKernelCheckWrites( autoOutOfOrderCommand );    \
+    }                                                                       \
+    if( autoOutOfOrderCommand.Queue )                                       \
+    {                                                                       \
+        pIntercept->autoOutOfOrderEnd(                                      \
+            autoOutOfOrderCommand,                                          \
+            _success,                                                       \
+            _event ? _event[0] : NULL,                                      \
+            _event == &autoOutOfOrderEvent );                               \
+        if( _event == &autoOutOfOrderEvent )                                \
+        {                                                                   \
+            _event = NULL;                                                  \
+        }                                                                   \
+    }
+
+#define AUTO_OUT_OF_ORDER_QUEUE_SYNC( _queue )                              \
+    if( pIntercept->config().AutoOutOfOrderQueue &&                         \
+        retVal == CL_SUCCESS )                                              \
+    {                                                                       \
+        pIntercept->autoOutOfOrderQueueSync( _queue );                      \
+    }
+
+#define FLUSH_COALESCED_BUFFER_WRITES( _queue )                             \
+    if( pIntercept->config().CoalesceBufferWrites )                         \
+    {                                                                       \
+        pIntercept->flushCoalescedBufferWrites( _queue, NULL );             \
+    }
+
+#define FLUSH_COALESCED_BUFFER_WRITES_FOR_MEMOBJ( _memobj )                 \
+    if( pIntercept->config().CoalesceBufferWrites )                         \
+    {                                                                       \
+        pIntercept->flushCoalescedBufferWrites( NULL, _memobj );            \
+    }
+
+#define REMOVE_COALESCED_BUFFER_WRITES( _queue )                            \
+    if( pIntercept->config().CoalesceBufferWrites && _queue )               \
+    {                                                                       \
+        pIntercept->checkRemoveCoalescedBufferWrites( _queue );             \
+    }
+
+#define REMOVE_PINNED_STAGING_POOL( _queue )                                \
+    if( pIntercept->config().PinnedStagingTransfers && _queue )             \
+    {                                                                       \
+        pIntercept->checkRemovePinnedStagingPool( _queue );                 \
+    }
+
+#define ZERO_COPY_CHECK_BUFFER( _buffer, _flags, _size, _ptr )              \
+    if( pIntercept->config().ZeroCopyChecking && _buffer )                  \
+    {                                                                       \
+        pIntercept->zeroCopyCheckBuffer( _buffer, _flags, _size, _ptr );    \
+    }
+
+#define ZERO_COPY_CHECK_TRANSFER( _success, _buffer, _ptr, _size, _read )  \
+    if( pIntercept->config().ZeroCopyChecking && _success )                 \
+    {                                                                       \
+        pIntercept->zeroCopyCheckTransfer( _buffer, _ptr, _size, _read );   \
+    }
+
+#define ZERO_COPY_CHECK_MAP( _success, _buffer, _size )                     \
+    if( pIntercept->config().ZeroCopyChecking && _success )                 \
+    {                                                                       \
+        pIntercept->zeroCopyCheckMap( _buffer, _size );                     \
+    }
+
+#define ZERO_COPY_CHECK_RELEASE( _memobj )                                  \
+    if( pIntercept->config().ZeroCopyChecking && _memobj )                  \
+    {                                                                       \
+        pIntercept->checkRemoveZeroCopyBuffer( _memobj );                   \
+    }
+
+#define ADD_RECYCLED_KERNELS_PROGRAM_REF( _program )                        \
+    if( pIntercept->config().RecycleKernels && _program )                   \
+    {                                                                       \
+        pIntercept->addRecycledKernelsProgramRef( _program );               \
+    }
+
+#define RELEASE_RECYCLED_KERNEL_TEMPLATES( _program )                       \
+    if( pIntercept->config().RecycleKernels && _program )                   \
+    {                                                                       \
+        pIntercept->releaseRecycledKernelTemplates( _program );             \
+    }
+
+#define RELEASE_RECYCLED_KERNEL_TEMPLATES_FOR_LINK( _num, _programs )       \
+    if( pIntercept->config().RecycleKernels && _programs )                  \
+    {                                                                       \
+        for( cl_uint p = 0; p < _num; p++ )                                 \
+        {                                                                   \
+            pIntercept->releaseRecycledKernelTemplates( _programs[p] );     \
+        }                                                                   \
+    }
+
+#define RELEASE_RECYCLED_KERNELS( _program )                                \
+    if( pIntercept->config().RecycleKernels && _program )                   \
+    {                                                                       \
+        pIntercept->releaseRecycledKernels( _program );                     \
+    }
+
+#define REDUNDANT_KERNEL_CHECK( _success, _kernel, _workDim, _gwo, _gws, _lws )\
+    if( pIntercept->config().RedundantKernelChecking && _success )          \
+    {                                                                       \
+        pIntercept->redundantKernelCheck(                                   \
+            enqueueCounter,                                                 \
+            deviceTiming,                                                   \
+            _kernel,                                                        \
+            _workDim,                                                       \
+            _gwo,                                                           \
+            _gws,                                                           \
+            _lws );                                                         \
+    }
+
+#define MAP_ACCESS_TRACKING_MAP( _buffer, _blocking, _flags, _ptr, _size ) \
+    if( pIntercept->config().MapAccessTracking &&                           \
+        _blocking &&                                                        \
+        _ptr != NULL )                                                      \
+    {                                                                       \
+        pIntercept->mapAccessTrackingMap( _buffer, _flags, _ptr, _size );   \
+    }
+
+#define MAP_ACCESS_TRACKING_UNMAP( _memobj, _ptr )                          \
+    if( pIntercept->config().MapAccessTracking &&                           \
+        _ptr != NULL )                                                      \
+    {                                                                       \
+        pIntercept->mapAccessTrackingUnmap( _memobj, _ptr );                \
+    }
+
+#define KERNEL_FOOTPRINT_CHECK( _success, _kernel )                        \
+    if( pIntercept->config().KernelFootprintAnalysis && _success )          \
+    {                                                                       \
+        pIntercept->kernelFootprintCheck(                                   \
+            enqueueCounter,                                                 \
+            deviceTiming,                                                   \
+            _kernel );                                                      \
+    }
+
+#define REDUNDANT_SYNC_CHECK_ENQUEUE( _queue, _blocking )                   \
+    if( pIntercept->config().RedundantSyncChecking )                        \
+    {                                                                       \
+        pIntercept->redundantSyncEnqueue( _queue, _blocking != CL_FALSE );  \
+    }
+
+#define SUBMIT_LATENCY_CHECK_ENQUEUE( _queue, _blocking )                   \
+    if( pIntercept->config().SubmitLatencyAnalysis && _blocking )           \
+    {                                                                       \
+        pIntercept->submitLatencyEnqueue( _queue, enqueueCounter );         \
+    }
+
+#define SUBMIT_LATENCY_CHECK_FLUSH( _queue, _pattern )                      \
+    if( pIntercept->config().SubmitLatencyAnalysis )                        \
+    {                                                                       \
+        pIntercept->submitLatencyFlush( _queue, _pattern );                 \
+    }
+
+#define SUBMIT_LATENCY_CHECK_WAIT( _numEvents, _eventList )                 \
+    if( pIntercept->config().SubmitLatencyAnalysis )                        \
+    {                                                                       \
+        pIntercept->submitLatencyWait( _numEvents, _eventList );            \
+    }
+
+#define REDUNDANT_SYNC_RELEASE_QUEUE( _queue )                              \
+    if( pIntercept->config().RedundantSyncChecking && _queue )              \
+    {                                                                       \
+        pIntercept->redundantSyncReleaseQueue( _queue );                    \
+    }
+
+#define SUBMIT_LATENCY_RELEASE_QUEUE( _queue )                              \
+    if( pIntercept->config().SubmitLatencyAnalysis && _queue )              \
+    {                                                                       \
+        pIntercept->submitLatencyReleaseQueue( _queue );                    \
+    }
+
+#define REDUNDANT_SYNC_CHECK_BLOCKING_READ( _blocking )                     \
+    if( pIntercept->config().RedundantSyncChecking && _blocking )           \
+    {                                                                       \
+        pIntercept->redundantSyncBlockingRead( cpuStart, cpuEnd );          \
+    }
+
+#define REDUNDANT_SYNC_CHECK_FLUSH( _queue )                                \
+    if( pIntercept->config().RedundantSyncChecking )                        \
+    {                                                                       \
+        pIntercept->redundantSyncFlush( _queue, cpuStart, cpuEnd );         \
+    }
+
+#define REDUNDANT_SYNC_CHECK_FINISH( _queue )                               \
+    if( pIntercept->config().RedundantSyncChecking )                        \
+    {                                                                       \
+        pIntercept->redundantSyncFinish( _queue, cpuStart, cpuEnd );        \
+    }
+
+#define REDUNDANT_SYNC_CHECK_WAIT_START( _numEvents, _eventList )           \
+    bool    syncEventsComplete = false;                                     \
+    if( pIntercept->config().RedundantSyncChecking )                        \
+    {                                                                       \
+        syncEventsComplete = pIntercept->redundantSyncEventsComplete(       \
+            _numEvents,                                                     \
+            _eventList );                                                   \
+    }
+
+#define REDUNDANT_SYNC_CHECK_WAIT_END()                                     \
+    if( pIntercept->config().RedundantSyncChecking )                        \
+    {                                                                       \
+        pIntercept->redundantSyncWait(                                      \
+            syncEventsComplete,                                             \
+            cpuStart,                                                       \
+            cpuEnd );                                                       \
+    }
+
+#define REDUNDANT_SYNC_CHECK_BARRIER( _queue, _numEvents, _eventList, _event )\
+    if( pIntercept->config().RedundantSyncChecking && retVal == CL_SUCCESS )\
+    {                                                                       \
+        pIntercept->redundantSyncBarrier(                                   \
+            __FUNCTION__,                                                   \
+            _queue,                                                         \
+            _numEvents,                                                     \
+            _eventList,                                                     \
+            _event,                                                         \
+            cpuStart,                                                       \
+            cpuEnd );                                                       \
+    }
+
 #define DEVICE_PERFORMANCE_TIMING_CHECK()                                   \
     if( pIntercept->config().DevicePerformanceTiming ||                     \
         pIntercept->config().ITTPerformanceTiming ||                        \
@@ -2918,28 +4773,37 @@ inline unsigned int CLIntercept::getThreadNumber( uint64_t threadId )
 
         if( m_Config.ChromeCallLogging )
         {
-            uint64_t    processId = OS().GetProcessID();
-            m_InterceptTrace
-                << "{\"ph\":\"M\", \"name\":\"thread_name\", \"pid\":" << processId
-                << ", \"tid\":" << threadId
-                << ", \"args\":{\"name\":\"Host Thread " << threadId
-                << "\"}},\n";
-            m_InterceptTrace
-                << "{\"ph\":\"M\", \"name\":\"thread_sort_index\", \"pid\":" << processId
-                << ", \"tid\":" << threadId
-                << ", \"args\":{\"sort_index\":\"" << threadNumber + 10000
-                << "\"}},\n";
+            chromeRegisterThread( threadId, threadNumber );
         }
     }
 
     return threadNumber;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//
+inline void CLIntercept::chromeRegisterThread(
+    uint64_t threadId,
+    unsigned int threadNumber )
+{
+    uint64_t    processId = OS().GetProcessID();
+    m_InterceptTrace
+        << "{\"ph\":\"M\", \"name\":\"thread_name\", \"pid\":" << processId
+        << ", \"tid\":" << threadId
+        << ", \"args\":{\"name\":\"Host Thread " << threadId
+        << "\"}},\n";
+    m_InterceptTrace
+        << "{\"ph\":\"M\", \"name\":\"thread_sort_index\", \"pid\":" << processId
+        << ", \"tid\":" << threadId
+        << ", \"args\":{\"sort_index\":\"" << threadNumber + 10000
+        << "\"}},\n";
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 inline void CLIntercept::saveProgramNumber( const cl_program program )
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    CInstrumentedLockGuard lock(m_Mutex, __FUNCTION__);
 
     SProgramInfo&   programInfo = m_ProgramInfoMap[ program ];
     programInfo.ProgramNumber = m_ProgramNumber;
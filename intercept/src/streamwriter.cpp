@@ -0,0 +1,721 @@
+/*
+// Copyright (c) 2018-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "streamwriter.h"
+
+static const uint32_t* GetCRC32Table()
+{
+    struct STable
+    {
+        STable()
+        {
+            for( uint32_t n = 0; n < 256; n++ )
+            {
+                uint32_t    c = n;
+                for( int k = 0; k < 8; k++ )
+                {
+                    c = ( c & 1 ) ? 0xEDB88320 ^ ( c >> 1 ) : c >> 1;
+                }
+                Table[n] = c;
+            }
+        }
+        uint32_t    Table[256];
+    };
+
+    static const STable table;
+    return table.Table;
+}
+
+static inline uint32_t ReverseBits( uint32_t code, uint32_t length )
+{
+    uint32_t    reversed = 0;
+    for( uint32_t i = 0; i < length; i++ )
+    {
+        reversed = ( reversed << 1 ) | ( code & 1 );
+        code >>= 1;
+    }
+    return reversed;
+}
+
+// Base values and extra bits for the deflate length and distance codes.
+static const uint16_t sc_LengthBase[] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t sc_LengthExtra[] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t sc_DistanceBase[] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t sc_DistanceExtra[] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+///////////////////////////////////////////////////////////////////////////////
+//
+CGzipEncoder::CGzipEncoder() :
+    m_pFile(NULL),
+    m_WindowPos(0),
+    m_WindowEnd(0),
+    m_OutputSize(0),
+    m_BitBuffer(0),
+    m_BitCount(0),
+    m_CRC(0),
+    m_InputSize(0),
+    m_BytesWritten(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CGzipEncoder::begin(
+    std::ofstream* pFile )
+{
+    m_pFile = pFile;
+
+    m_Window.resize( 2 * WINDOW_SIZE );
+    m_Head.assign( HASH_SIZE, -1 );
+    m_Prev.assign( WINDOW_SIZE, -1 );
+    m_WindowPos = 0;
+    m_WindowEnd = 0;
+
+    m_Output.resize( OUTPUT_SIZE );
+    m_OutputSize = 0;
+    m_BitBuffer = 0;
+    m_BitCount = 0;
+
+    m_CRC = 0xFFFFFFFF;
+    m_InputSize = 0;
+    m_BytesWritten = 0;
+
+    // gzip member header: magic, deflate, no flags, no mtime, unknown OS.
+    static const unsigned char header[] = {
+        0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF };
+    for( size_t i = 0; i < sizeof(header); i++ )
+    {
+        putBits( header[i], 8 );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CGzipEncoder::write(
+    const char* data,
+    size_t size )
+{
+    const uint32_t* crcTable = GetCRC32Table();
+    for( size_t i = 0; i < size; i++ )
+    {
+        m_CRC = crcTable[ ( m_CRC ^ (unsigned char)data[i] ) & 0xFF ] ^ ( m_CRC >> 8 );
+    }
+    m_InputSize += (uint32_t)size;
+
+    while( size )
+    {
+        size_t  copySize = std::min<size_t>( size, 2 * WINDOW_SIZE - m_WindowEnd );
+        memcpy( &m_Window[ m_WindowEnd ], data, copySize );
+        m_WindowEnd += (uint32_t)copySize;
+        data += copySize;
+        size -= copySize;
+
+        if( m_WindowEnd == 2 * WINDOW_SIZE )
+        {
+            compressPending( false );
+            slideWindow();
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CGzipEncoder::end()
+{
+    compressPending( true );
+    alignToByte();
+
+    uint32_t    crc = ~m_CRC;
+    for( int i = 0; i < 4; i++ )
+    {
+        putBits( ( crc >> ( 8 * i ) ) & 0xFF, 8 );
+    }
+    for( int i = 0; i < 4; i++ )
+    {
+        putBits( ( m_InputSize >> ( 8 * i ) ) & 0xFF, 8 );
+    }
+
+    flushOutput();
+
+    // Release the window and hash chains until the next file is started.
+    std::vector<unsigned char>().swap( m_Window );
+    std::vector<int32_t>().swap( m_Head );
+    std::vector<int32_t>().swap( m_Prev );
+    m_pFile = NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CGzipEncoder::compressPending(
+    bool final )
+{
+    // Each call emits one block using the fixed Huffman codes.
+    putBits( final ? 1 : 0, 1 );
+    putBits( 1, 2 );
+
+    const unsigned char* window = m_Window.data();
+    const uint32_t  end = m_WindowEnd;
+    uint32_t    pos = m_WindowPos;
+
+    while( pos < end )
+    {
+        uint32_t    bestLength = 0;
+        uint32_t    bestDistance = 0;
+
+        if( end - pos >= MIN_MATCH )
+        {
+            uint32_t    hash =
+                ( ( window[pos] << 10 ) ^ ( window[pos + 1] << 5 ) ^ window[pos + 2] ) &
+                ( HASH_SIZE - 1 );
+            uint32_t    maxLength = std::min<uint32_t>( MAX_MATCH, end - pos );
+
+            int32_t     candidate = m_Head[ hash ];
+            uint32_t    chain = MAX_CHAIN;
+            while( candidate >= 0 && chain-- )
+            {
+                uint32_t    distance = pos - (uint32_t)candidate;
+                if( distance >= WINDOW_SIZE )
+                {
+                    break;
+                }
+
+                if( window[ candidate + bestLength ] == window[ pos + bestLength ] )
+                {
+                    uint32_t    length = 0;
+                    while( length < maxLength &&
+                           window[ candidate + length ] == window[ pos + length ] )
+                    {
+                        length++;
+                    }
+                    if( length > bestLength )
+                    {
+                        bestLength = length;
+                        bestDistance = distance;
+                        if( length == maxLength )
+                        {
+                            break;
+                        }
+                    }
+                }
+
+                int32_t next = m_Prev[ candidate & ( WINDOW_SIZE - 1 ) ];
+                if( next >= candidate )
+                {
+                    break;
+                }
+                candidate = next;
+            }
+
+            m_Prev[ pos & ( WINDOW_SIZE - 1 ) ] = m_Head[ hash ];
+            m_Head[ hash ] = (int32_t)pos;
+        }
+
+        if( bestLength >= MIN_MATCH )
+        {
+            putMatch( bestLength, bestDistance );
+
+            for( uint32_t i = 1; i < bestLength && pos + i + MIN_MATCH <= end; i++ )
+            {
+                uint32_t    p = pos + i;
+                uint32_t    hash =
+                    ( ( window[p] << 10 ) ^ ( window[p + 1] << 5 ) ^ window[p + 2] ) &
+                    ( HASH_SIZE - 1 );
+                m_Prev[ p & ( WINDOW_SIZE - 1 ) ] = m_Head[ hash ];
+                m_Head[ hash ] = (int32_t)p;
+            }
+            pos += bestLength;
+        }
+        else
+        {
+            putLiteral( window[pos] );
+            pos++;
+        }
+    }
+
+    // End of block.
+    putLiteral( 256 );
+
+    m_WindowPos = end;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CGzipEncoder::slideWindow()
+{
+    memmove( &m_Window[0], &m_Window[ WINDOW_SIZE ], WINDOW_SIZE );
+    m_WindowPos -= WINDOW_SIZE;
+    m_WindowEnd -= WINDOW_SIZE;
+
+    for( size_t i = 0; i < m_Head.size(); i++ )
+    {
+        m_Head[i] = ( m_Head[i] >= WINDOW_SIZE ) ? m_Head[i] - WINDOW_SIZE : -1;
+    }
+    for( size_t i = 0; i < m_Prev.size(); i++ )
+    {
+        m_Prev[i] = ( m_Prev[i] >= WINDOW_SIZE ) ? m_Prev[i] - WINDOW_SIZE : -1;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CGzipEncoder::putBits(
+    uint32_t value,
+    uint32_t count )
+{
+    m_BitBuffer |= value << m_BitCount;
+    m_BitCount += count;
+    while( m_BitCount >= 8 )
+    {
+        if( m_OutputSize == m_Output.size() )
+        {
+            flushOutput();
+        }
+        m_Output[ m_OutputSize++ ] = (unsigned char)( m_BitBuffer & 0xFF );
+        m_BitBuffer >>= 8;
+        m_BitCount -= 8;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CGzipEncoder::putLiteral(
+    uint32_t symbol )
+{
+    // Fixed Huffman literal/length codes, see RFC 1951 section 3.2.6.
+    uint32_t    code = 0;
+    uint32_t    length = 0;
+    if( symbol < 144 )
+    {
+        code = 0x30 + symbol;
+        length = 8;
+    }
+    else if( symbol < 256 )
+    {
+        code = 0x190 + ( symbol - 144 );
+        length = 9;
+    }
+    else if( symbol < 280 )
+    {
+        code = symbol - 256;
+        length = 7;
+    }
+    else
+    {
+        code = 0xC0 + ( symbol - 280 );
+        length = 8;
+    }
+    putBits( ReverseBits( code, length ), length );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CGzipEncoder::putMatch(
+    uint32_t length,
+    uint32_t distance )
+{
+    uint32_t    lengthCode = 28;
+    while( sc_LengthBase[ lengthCode ] > length )
+    {
+        lengthCode--;
+    }
+    putLiteral( 257 + lengthCode );
+    putBits( length - sc_LengthBase[ lengthCode ], sc_LengthExtra[ lengthCode ] );
+
+    uint32_t    distanceCode = 29;
+    while( sc_DistanceBase[ distanceCode ] > distance )
+    {
+        distanceCode--;
+    }
+    putBits( ReverseBits( distanceCode, 5 ), 5 );
+    putBits( distance - sc_DistanceBase[ distanceCode ], sc_DistanceExtra[ distanceCode ] );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CGzipEncoder::alignToByte()
+{
+    if( m_BitCount )
+    {
+        putBits( 0, 8 - m_BitCount );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CGzipEncoder::flushOutput()
+{
+    if( m_pFile && m_OutputSize )
+    {
+        m_pFile->write( (const char*)m_Output.data(), m_OutputSize );
+    }
+    m_BytesWritten += m_OutputSize;
+    m_OutputSize = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+CStreamWriterBuffer::CStreamWriterBuffer() :
+    m_FileNumber(0),
+    m_FileBytes(0),
+    m_FileHasEvents(false)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+CStreamWriterBuffer::~CStreamWriterBuffer()
+{
+    close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CStreamWriterBuffer::open(
+    const std::string& fileName,
+    const SOptions& options )
+{
+    close();
+
+    m_Options = options;
+    m_BaseFileName = fileName;
+    m_FileNumber = 0;
+    m_Line.clear();
+    m_Header.clear();
+
+    if( !openFile() )
+    {
+        return false;
+    }
+
+    m_PutArea.resize( PUT_AREA_SIZE );
+    setp( m_PutArea.data(), m_PutArea.data() + m_PutArea.size() );
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CStreamWriterBuffer::close()
+{
+    if( m_File.is_open() )
+    {
+        clock::time_point   start = clock::now();
+
+        processPutArea( false );
+        if( !m_Line.empty() )
+        {
+            emit( m_Line.data(), m_Line.size() );
+            m_Line.clear();
+        }
+        closeFile();
+
+        clock::time_point   end = clock::now();
+
+        using ns = std::chrono::nanoseconds;
+        uint64_t    nsDelta = std::chrono::duration_cast<ns>(end - start).count();
+        m_Stats.NumberOfCalls++;
+        m_Stats.TotalNS += nsDelta;
+        m_Stats.MinNS = std::min<uint64_t>( m_Stats.MinNS, nsDelta );
+        m_Stats.MaxNS = std::max<uint64_t>( m_Stats.MaxNS, nsDelta );
+    }
+
+    setp( NULL, NULL );
+    std::vector<char>().swap( m_PutArea );
+    std::string().swap( m_Header );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+CStreamWriterBuffer::SStats CStreamWriterBuffer::getStats() const
+{
+    // The bytes written to a closed file are accumulated when the file is
+    // closed.  Include the bytes written to the current file so far, so a
+    // snapshot taken while the file is still open is not missing it.
+    SStats  stats = m_Stats;
+    if( m_File.is_open() )
+    {
+        stats.BytesOut += m_Options.Compress ?
+            m_Encoder.getBytesWritten() :
+            m_FileBytes;
+    }
+    return stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+CStreamWriterBuffer::int_type CStreamWriterBuffer::overflow(
+    int_type c )
+{
+    if( !m_File.is_open() )
+    {
+        return traits_type::eof();
+    }
+
+    processPutArea( false );
+    if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+    {
+        *pptr() = traits_type::to_char_type( c );
+        pbump( 1 );
+    }
+    return traits_type::not_eof( c );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+int CStreamWriterBuffer::sync()
+{
+    if( m_File.is_open() )
+    {
+        processPutArea( true );
+    }
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CStreamWriterBuffer::processPutArea(
+    bool flushFile )
+{
+    const char* data = pbase();
+    const char* dataEnd = pptr();
+    if( data == dataEnd )
+    {
+        return;
+    }
+
+    clock::time_point   start = clock::now();
+
+    while( data < dataEnd )
+    {
+        const char* newline = (const char*)memchr( data, '\n', dataEnd - data );
+        if( newline == NULL )
+        {
+            m_Line.append( data, dataEnd );
+            break;
+        }
+
+        m_Line.append( data, newline + 1 );
+        commitLine();
+        data = newline + 1;
+    }
+
+    setp( m_PutArea.data(), m_PutArea.data() + m_PutArea.size() );
+
+    // Compressed data is only written when a full deflate block is ready,
+    // so only flush the file for uncompressed output.
+    if( flushFile && !m_Options.Compress )
+    {
+        m_File.flush();
+    }
+
+    clock::time_point   end = clock::now();
+
+    using ns = std::chrono::nanoseconds;
+    uint64_t    nsDelta = std::chrono::duration_cast<ns>(end - start).count();
+    m_Stats.NumberOfCalls++;
+    m_Stats.TotalNS += nsDelta;
+    m_Stats.MinNS = std::min<uint64_t>( m_Stats.MinNS, nsDelta );
+    m_Stats.MaxNS = std::max<uint64_t>( m_Stats.MaxNS, nsDelta );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CStreamWriterBuffer::commitLine()
+{
+    if( m_FileHasEvents )
+    {
+        bool    rotate = false;
+        if( m_Options.RotateBytes &&
+            m_FileBytes >= m_Options.RotateBytes )
+        {
+            rotate = true;
+        }
+        if( m_Options.RotateSeconds &&
+            clock::now() - m_FileStartTime >= std::chrono::seconds(m_Options.RotateSeconds) )
+        {
+            rotate = true;
+        }
+        if( rotate )
+        {
+            closeFile();
+            m_FileNumber++;
+            openFile();
+        }
+    }
+
+    emit( m_Line.data(), m_Line.size() );
+
+    bool    isMetadata =
+        m_Options.JSONArray &&
+        m_Line.find( "\"ph\":\"M\"" ) != std::string::npos;
+    if( isMetadata )
+    {
+        if( m_Header.size() + m_Line.size() <= MAX_HEADER_SIZE )
+        {
+            m_Header += m_Line;
+        }
+    }
+    else
+    {
+        m_FileHasEvents = true;
+    }
+
+    m_Line.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CStreamWriterBuffer::emit(
+    const char* data,
+    size_t size )
+{
+    if( !m_File.is_open() )
+    {
+        return;
+    }
+
+    m_FileBytes += size;
+    m_Stats.BytesIn += size;
+
+    if( m_Options.Compress )
+    {
+        m_Encoder.write( data, size );
+    }
+    else
+    {
+        m_File.write( data, size );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+bool CStreamWriterBuffer::openFile()
+{
+    std::string fileName = getFileName();
+
+    if( m_Options.Append )
+    {
+        m_File.open( fileName.c_str(), std::ios::out | std::ios::binary | std::ios::app );
+    }
+    else
+    {
+        m_File.open( fileName.c_str(), std::ios::out | std::ios::binary );
+    }
+    if( !m_File.is_open() )
+    {
+        return false;
+    }
+
+    m_Stats.NumberOfFiles++;
+    m_FileBytes = 0;
+    m_FileHasEvents = false;
+    m_FileStartTime = clock::now();
+
+    if( m_Options.Compress )
+    {
+        m_Encoder.begin( &m_File );
+    }
+
+    if( m_Options.JSONArray )
+    {
+        emit( "[\n", 2 );
+        emit( m_Header.data(), m_Header.size() );
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+void CStreamWriterBuffer::closeFile()
+{
+    if( !m_File.is_open() )
+    {
+        return;
+    }
+
+    if( m_Options.JSONArray )
+    {
+        // Every record ends with a trailing comma, so terminate the array
+        // with a final record to keep the file valid JSON.
+        std::string footer = m_Options.JSONFooter.empty() ?
+            std::string("{}") :
+            m_Options.JSONFooter;
+        footer += "\n]\n";
+        emit( footer.data(), footer.size() );
+    }
+
+    if( m_Options.Compress )
+    {
+        m_Encoder.end();
+        m_Stats.BytesOut += m_Encoder.getBytesWritten();
+    }
+    else
+    {
+        m_Stats.BytesOut += m_FileBytes;
+    }
+
+    m_File.close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+std::string CStreamWriterBuffer::getFileName() const
+{
+    std::string fileName = m_BaseFileName;
+
+    if( m_Options.RotateBytes || m_Options.RotateSeconds )
+    {
+        // Insert the file number before the extension, so
+        // "name.json" becomes "name.0000.json".
+        size_t  slash = fileName.find_last_of( "/\\" );
+        size_t  dot = fileName.find_last_of( '.' );
+        if( dot == std::string::npos ||
+            ( slash != std::string::npos && dot < slash ) )
+        {
+            dot = fileName.length();
+        }
+
+        char    number[16] = "";
+        snprintf( number, sizeof(number), ".%04u", m_FileNumber );
+        fileName.insert( dot, number );
+    }
+
+    if( m_Options.Compress )
+    {
+        fileName += ".gz";
+    }
+
+    return fileName;
+}
@@ -0,0 +1,221 @@
+/*
+// Copyright (c) 2018-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <chrono>
+#include <fstream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// This is a minimal streaming gzip (deflate) encoder.  It uses LZ77 matching
+// with hash chains and the fixed Huffman codes, so it needs no third-party
+// compression library and its memory usage is constant regardless of how
+// much data is written.
+
+class CGzipEncoder
+{
+public:
+    CGzipEncoder();
+
+    void    begin( std::ofstream* pFile );
+    void    write( const char* data, size_t size );
+    void    end();
+
+    uint64_t    getBytesWritten() const { return m_BytesWritten; }
+
+private:
+    enum
+    {
+        WINDOW_SIZE = 32768,
+        HASH_BITS = 15,
+        HASH_SIZE = 1 << HASH_BITS,
+        MIN_MATCH = 3,
+        MAX_MATCH = 258,
+        MAX_CHAIN = 32,
+        OUTPUT_SIZE = 16384,
+    };
+
+    void    compressPending( bool final );
+    void    slideWindow();
+
+    void    putBits( uint32_t value, uint32_t count );
+    void    putLiteral( uint32_t symbol );
+    void    putMatch( uint32_t length, uint32_t distance );
+    void    alignToByte();
+    void    flushOutput();
+
+    std::ofstream*  m_pFile;
+
+    std::vector<unsigned char>  m_Window;
+    std::vector<int32_t>        m_Head;
+    std::vector<int32_t>        m_Prev;
+    uint32_t    m_WindowPos;
+    uint32_t    m_WindowEnd;
+
+    std::vector<unsigned char>  m_Output;
+    size_t      m_OutputSize;
+    uint32_t    m_BitBuffer;
+    uint32_t    m_BitCount;
+
+    uint32_t    m_CRC;
+    uint32_t    m_InputSize;
+    uint64_t    m_BytesWritten;
+};
+
+// This is a stream buffer that writes to a file, optionally compressing the
+// data and optionally rotating to a new numbered file after a given number
+// of bytes or seconds.  Rotation only occurs on line boundaries.  When the
+// JSON array option is set, each file is wrapped in '[' and ']', and every
+// line containing Chrome Tracing metadata ("ph":"M") is replayed at the
+// start of each subsequent file, so each file may be loaded independently.
+
+class CStreamWriterBuffer : public std::streambuf
+{
+public:
+    struct SOptions
+    {
+        SOptions() :
+            Append(false),
+            Compress(false),
+            JSONArray(false),
+            RotateBytes(0),
+            RotateSeconds(0) {}
+
+        bool        Append;
+        bool        Compress;
+        bool        JSONArray;
+        uint64_t    RotateBytes;
+        uint32_t    RotateSeconds;
+        std::string JSONFooter;
+    };
+
+    struct SStats
+    {
+        SStats() :
+            NumberOfCalls(0),
+            MinNS(UINT64_MAX),
+            MaxNS(0),
+            TotalNS(0),
+            BytesIn(0),
+            BytesOut(0),
+            NumberOfFiles(0) {}
+
+        uint64_t    NumberOfCalls;
+        uint64_t    MinNS;
+        uint64_t    MaxNS;
+        uint64_t    TotalNS;
+        uint64_t    BytesIn;
+        uint64_t    BytesOut;
+        uint64_t    NumberOfFiles;
+    };
+
+    CStreamWriterBuffer();
+    virtual ~CStreamWriterBuffer();
+
+    bool    open( const std::string& fileName, const SOptions& options );
+    void    close();
+    bool    is_open() const { return m_File.is_open(); }
+
+    SStats  getStats() const;
+
+protected:
+    virtual int_type    overflow( int_type c );
+    virtual int         sync();
+
+private:
+    enum
+    {
+        PUT_AREA_SIZE = 4096,
+        MAX_HEADER_SIZE = 256 * 1024,
+    };
+
+    typedef std::chrono::steady_clock   clock;
+
+    void    processPutArea( bool flushFile );
+    void    commitLine();
+    void    emit( const char* data, size_t size );
+
+    bool    openFile();
+    void    closeFile();
+    std::string getFileName() const;
+
+    SOptions    m_Options;
+    std::string m_BaseFileName;
+
+    std::ofstream   m_File;
+    CGzipEncoder    m_Encoder;
+
+    std::vector<char>   m_PutArea;
+    std::string m_Line;
+    std::string m_Header;
+
+    unsigned int        m_FileNumber;
+    uint64_t            m_FileBytes;
+    bool                m_FileHasEvents;
+    clock::time_point   m_FileStartTime;
+
+    SStats      m_Stats;
+};
+
+class CStreamWriter : public std::ostream
+{
+public:
+    typedef CStreamWriterBuffer::SOptions   SOptions;
+    typedef CStreamWriterBuffer::SStats     SStats;
+
+    CStreamWriter() : std::ostream( &m_Buffer ) {}
+
+    bool    open( const std::string& fileName, const SOptions& options )
+    {
+        bool    success = m_Buffer.open( fileName, options );
+        if( success )
+        {
+            clear();
+        }
+        else
+        {
+            setstate( std::ios::failbit );
+        }
+        return success;
+    }
+    void    close()
+    {
+        m_Buffer.close();
+    }
+    bool    is_open() const
+    {
+        return m_Buffer.is_open();
+    }
+
+    SStats  getStats() const
+    {
+        return m_Buffer.getStats();
+    }
+
+private:
+    CStreamWriterBuffer m_Buffer;
+};